@@ -10,14 +10,42 @@
 #include "Regularization/Reg.hpp"
 #include "Utilities/Utilities.hpp"
 #include "Cost/Cost.hpp"
+#include "GEMM/GEMM.hpp"
+#include "VecMath/VecMath.hpp"
+#include "ThreadPool/ThreadPool.hpp"
+#include "Checkpoint/Checkpoint.hpp"
+#include "MiniBatches/MiniBatches.hpp"
 
 #include <iostream>
 #include <cmath>
 #include <random>
+#include <algorithm>
+#include <sstream>
 
 namespace MLPP {
+    namespace {
+        template <class T>
+        void sumShards(BasicMatrix<T>& gradient, const std::vector<BasicMatrix<T>>& partials, int count){
+            T* g = gradient.data();
+            for(int s = 0; s < count; s++){
+                const T* partial = partials[s].data();
+                for(long j = 0; j < gradient.size(); j++){
+                    g[j] += partial[j];
+                }
+            }
+        }
+    }
+
     ANN::ANN(std::vector<std::vector<double>> inputSet, std::vector<double> outputSet)
-    : inputSet(inputSet), outputSet(outputSet), n(inputSet.size()), k(inputSet[0].size()), lrScheduler("None"), decayConstant(0), dropRate(0)
+    : inputSet(inputSet), outputSet(outputSet), outputLayer(nullptr), n(inputSet.size()), k(inputSet[0].size()), lrScheduler("None"), decayConstant(0), dropRate(0),
+      threads(1), mixedPrecision(false), shuffle(false), generator(std::random_device()()), trainingInput(inputSet), costDerivative(nullptr)
+    {
+
+    }
+
+    ANN::ANN(const DataSource& source)
+    : outputLayer(nullptr), n(source.size()), k(source.inputs()), lrScheduler("None"), decayConstant(0), dropRate(0),
+      threads(1), mixedPrecision(false), shuffle(false), generator(std::random_device()()), costDerivative(nullptr)
     {
 
     }
@@ -58,521 +86,244 @@ namespace MLPP {
         return outputLayer->a_test;
     }
 
-    void ANN::gradientDescent(double learning_rate, int max_epoch, bool UI){
-        class Cost cost; 
-        LinAlg alg;
-        double cost_prev = 0;
-        int epoch = 1;
-        forwardPass();
-        double initial_learning_rate = learning_rate;
-
-        alg.printMatrix(network[network.size() - 1].weights);
-        while(true){
-            learning_rate = applyLearningRateScheduler(initial_learning_rate, decayConstant, epoch, dropRate);
-            cost_prev = Cost(y_hat, outputSet);
-
-            auto [cumulativeHiddenLayerWGrad, outputWGrad] = computeGradients(y_hat, outputSet);
-
-            cumulativeHiddenLayerWGrad = alg.scalarMultiply(learning_rate/n, cumulativeHiddenLayerWGrad);
-            outputWGrad = alg.scalarMultiply(learning_rate/n, outputWGrad);
-            updateParameters(cumulativeHiddenLayerWGrad, outputWGrad, learning_rate); // subject to change. may want bias to have this matrix too.
-
-            std::cout << learning_rate << std::endl;
-
-            forwardPass();
-
-            if(UI) { ANN::UI(epoch, cost_prev, y_hat, outputSet); }
-
-            epoch++;
-            if(epoch > max_epoch) { break; }
+    InferenceModel ANN::compile(std::string precision) const{
+        InferenceModel model(precision);
+        for(const auto& layer : network){
+            model.addLayer(layer.weights, layer.bias, layer.activationFunction);
+        }
+        if(outputLayer){
+            std::vector<std::vector<double>> weights(outputLayer->weights.size());
+            for(int i = 0; i < weights.size(); i++){
+                weights[i] = {outputLayer->weights[i]};
+            }
+            model.addLayer(weights, {outputLayer->bias}, outputLayer->activationFunction);
         }
+        if(precision == "Int8" && !inputSet.empty()){
+            model.calibrate(inputSet);
+        }
+        return model;
     }
 
-    void ANN::SGD(double learning_rate, int max_epoch, bool UI){
-        class Cost cost; 
-        LinAlg alg;
+    void ANN::gradientDescent(double learning_rate, int max_epoch, bool UI){
+        GradientDescentOptimizer optimizer;
+        train(optimizer, learning_rate, max_epoch, n, UI);
+    }
 
+    void ANN::SGD(double learning_rate, int max_epoch, bool UI){
+        if(!hasTrainingSet()) { return; }
         double cost_prev = 0;
         int epoch = 1;
         double initial_learning_rate = learning_rate;
 
+        std::uniform_int_distribution<int> distribution(0, int(n - 1));
+        GradientDescentOptimizer optimizer;
+
+        loadWorkspace();
         while(true){
             learning_rate = applyLearningRateScheduler(initial_learning_rate, decayConstant, epoch, dropRate);
 
-            std::random_device rd;
-            std::default_random_engine generator(rd()); 
-            std::uniform_int_distribution<int> distribution(0, int(n - 1));
             int outputIndex = distribution(generator);
+            computeGradients(outputIndex, 1);
+            if(UI) { cost_prev = batchCost(outputIndex, 1); }
 
-            std::vector<double> y_hat = modelSetTest({inputSet[outputIndex]});
-            cost_prev = Cost({y_hat}, {outputSet[outputIndex]});
-
-            auto [cumulativeHiddenLayerWGrad, outputWGrad] = computeGradients(y_hat,  {outputSet[outputIndex]});
-            cumulativeHiddenLayerWGrad = alg.scalarMultiply(learning_rate/n, cumulativeHiddenLayerWGrad);
-            outputWGrad = alg.scalarMultiply(learning_rate/n, outputWGrad);
+            optimizer.beginStep(epoch);
+            for(int l = 0; l < workspace.size(); l++){
+                optimizer.update(l, workspace[l].weights.data(), workspace[l].gradient.data(), workspace[l].weights.size(), learning_rate/n);
+            }
 
-            updateParameters(cumulativeHiddenLayerWGrad, outputWGrad, learning_rate); // subject to change. may want bias to have this matrix too.
-            y_hat = modelSetTest({inputSet[outputIndex]});
+            updateBiases(1, learning_rate);
+            if(UI) { batchUI(epoch, cost_prev, outputIndex, 1); }
 
-            if(UI) { ANN::UI(epoch, cost_prev, y_hat, {outputSet[outputIndex]}); }
-            
             epoch++;
             if(epoch > max_epoch) { break; }
         }
+        storeWorkspace();
         forwardPass();
     }
 
-    void ANN::MBGD(double learning_rate, int max_epoch, int mini_batch_size, bool UI){
-        class Cost cost; 
-        LinAlg alg;
-
-        double cost_prev = 0;
-        int epoch = 1;
+    Hogwild::Report ANN::asyncSGD(double learning_rate, int max_epoch, bool UI){
+        if(!hasTrainingSet()) { return {}; }
         double initial_learning_rate = learning_rate;
+        int workers = std::min(threads, n);
 
-        // Creating the mini-batches
-        int n_mini_batch = n/mini_batch_size;
-        // always evaluate the result 
-        // always do forward pass only ONCE at end.
-        auto [inputMiniBatches, outputMiniBatches] = Utilities::createMiniBatches(inputSet, outputSet, n_mini_batch);
-        while(true){
-            learning_rate = applyLearningRateScheduler(initial_learning_rate, decayConstant, epoch, dropRate);
-            for(int i = 0; i < n_mini_batch; i++){
-                std::vector<double> y_hat = modelSetTest(inputMiniBatches[i]);
-                cost_prev = Cost(y_hat, outputMiniBatches[i]);
-
-                auto [cumulativeHiddenLayerWGrad, outputWGrad] = computeGradients(y_hat, outputMiniBatches[i]);
-                cumulativeHiddenLayerWGrad = alg.scalarMultiply(learning_rate/n, cumulativeHiddenLayerWGrad);
-                outputWGrad = alg.scalarMultiply(learning_rate/n, outputWGrad);
-
-                updateParameters(cumulativeHiddenLayerWGrad, outputWGrad, learning_rate); // subject to change. may want bias to have this matrix too.
-                y_hat = modelSetTest(inputMiniBatches[i]);
-
-                if(UI) { ANN::UI(epoch, cost_prev, y_hat, outputMiniBatches[i]); }
-            }
-            epoch++;
-            if(epoch > max_epoch) { break; }
-        }
         forwardPass();
-    }
-
-    void ANN::Momentum(double learning_rate, int max_epoch, int mini_batch_size, double gamma, bool NAG, bool UI){
-        class Cost cost; 
-        LinAlg alg;
+        double cost_prev = Cost(y_hat, outputSet);
+        loadWorkspace();
+        resizeBatch(workers);
 
-        double cost_prev = 0;
-        int epoch = 1;
-        double initial_learning_rate = learning_rate;
-
-        // Creating the mini-batches
-        int n_mini_batch = n/mini_batch_size;
-        // always evaluate the result 
-        // always do forward pass only ONCE at end.
-        auto [inputMiniBatches, outputMiniBatches] = Utilities::createMiniBatches(inputSet, outputSet, n_mini_batch);
-        
-        // Initializing necessary components for Adam. 
-        std::vector<std::vector<std::vector<double>>> v_hidden;
-        
-        std::vector<double> v_output;
-        while(true){
-            learning_rate = applyLearningRateScheduler(initial_learning_rate, decayConstant, epoch, dropRate);
-            for(int i = 0; i < n_mini_batch; i++){
-                std::vector<double> y_hat = modelSetTest(inputMiniBatches[i]);
-                cost_prev = Cost(y_hat, outputMiniBatches[i]);
-                
-                auto [cumulativeHiddenLayerWGrad, outputWGrad] = computeGradients(y_hat, outputMiniBatches[i]);
-
-                if(!network.empty() && v_hidden.empty()){ // Initing our tensor
-                    v_hidden = alg.resize(v_hidden, cumulativeHiddenLayerWGrad);
-                }
-
-                if(v_output.empty()){
-                    v_output.resize(outputWGrad.size());
-                }
-
-                if(NAG){ // "Aposterori" calculation
-                    updateParameters(v_hidden, v_output, 0); // DON'T update bias.
-                }
-
-                v_hidden = alg.addition(alg.scalarMultiply(gamma, v_hidden), alg.scalarMultiply(learning_rate/n, cumulativeHiddenLayerWGrad));
-
-                v_output = alg.addition(alg.scalarMultiply(gamma, v_output), alg.scalarMultiply(learning_rate/n, outputWGrad));
-
-                updateParameters(v_hidden, v_output, learning_rate); // subject to change. may want bias to have this matrix too.
-                y_hat = modelSetTest(inputMiniBatches[i]);
-
-                if(UI) { ANN::UI(epoch, cost_prev, y_hat, outputMiniBatches[i]); }
-            }
-            epoch++;
-            if(epoch > max_epoch) { break; }
+        for(auto& layer : workspace){
+            layer.weightSnapshots.assign(workers, layer.weights);
+            layer.biasSnapshots.assign(workers, layer.bias);
         }
-        forwardPass();
-    }
 
-    void ANN::Adagrad(double learning_rate, int max_epoch, int mini_batch_size, double e, bool UI){
-        class Cost cost; 
-        LinAlg alg;
-
-        double cost_prev = 0;
-        int epoch = 1;
-        double initial_learning_rate = learning_rate;
-
-        // Creating the mini-batches
-        int n_mini_batch = n/mini_batch_size;
-        // always evaluate the result 
-        // always do forward pass only ONCE at end.
-        auto [inputMiniBatches, outputMiniBatches] = Utilities::createMiniBatches(inputSet, outputSet, n_mini_batch);
-        
-        // Initializing necessary components for Adam. 
-        std::vector<std::vector<std::vector<double>>> v_hidden;
-        
-        std::vector<double> v_output;
-        while(true){
-            learning_rate = applyLearningRateScheduler(initial_learning_rate, decayConstant, epoch, dropRate);
-            for(int i = 0; i < n_mini_batch; i++){
-                std::vector<double> y_hat = modelSetTest(inputMiniBatches[i]);
-                cost_prev = Cost(y_hat, outputMiniBatches[i]);
-
-                auto [cumulativeHiddenLayerWGrad, outputWGrad] = computeGradients(y_hat, outputMiniBatches[i]);
-
-                if(!network.empty() && v_hidden.empty()){ // Initing our tensor
-                    v_hidden = alg.resize(v_hidden, cumulativeHiddenLayerWGrad);
+        // Worker t copies the shared parameters into its snapshot with atomic loads, runs its sample through row t of
+        // the layer buffers and into its own gradient replica, then writes the step into the shared parameters with
+        // atomic stores. The GEMMs only ever read the snapshot.
+        auto step = [&](int worker, long update, int i){
+            double learning_rate = applyLearningRateScheduler(initial_learning_rate, decayConstant, update + 1, dropRate);
+            for(auto& layer : workspace){
+                const double* w = layer.weights.data();
+                double* snapshot = layer.weightSnapshots[worker].data();
+                for(long j = 0; j < layer.weights.size(); j++){
+                    snapshot[j] = Hogwild::load(w[j]);
                 }
-
-                if(v_output.empty()){
-                    v_output.resize(outputWGrad.size());
+                for(int j = 0; j < layer.bias.size(); j++){
+                    layer.biasSnapshots[worker][j] = Hogwild::load(layer.bias[j]);
                 }
-
-                v_hidden = alg.addition(v_hidden, alg.exponentiate(cumulativeHiddenLayerWGrad, 2));
-
-                v_output = alg.addition(v_output, alg.exponentiate(outputWGrad, 2));
-
-                std::vector<std::vector<std::vector<double>>> hiddenLayerUpdations = alg.scalarMultiply(learning_rate/n, alg.elementWiseDivision(cumulativeHiddenLayerWGrad, alg.scalarAdd(e, alg.sqrt(v_hidden))));
-                std::vector<double> outputLayerUpdation = alg.scalarMultiply(learning_rate/n, alg.elementWiseDivision(outputWGrad, alg.scalarAdd(e, alg.sqrt(v_output))));
-
-                updateParameters(hiddenLayerUpdations, outputLayerUpdation, learning_rate); // subject to change. may want bias to have this matrix too.
-                y_hat = modelSetTest(inputMiniBatches[i]);
-
-                if(UI) { ANN::UI(epoch, cost_prev, y_hat, outputMiniBatches[i]); }
             }
-            epoch++;
-            if(epoch > max_epoch) { break; }
-        }
-        forwardPass();
-    }
-
-    void ANN::Adadelta(double learning_rate, int max_epoch, int mini_batch_size, double b1, double e, bool UI){
-        class Cost cost; 
-        LinAlg alg;
-
-        double cost_prev = 0;
-        int epoch = 1;
-        double initial_learning_rate = learning_rate;
-
-        // Creating the mini-batches
-        int n_mini_batch = n/mini_batch_size;
-        // always evaluate the result 
-        // always do forward pass only ONCE at end.
-        auto [inputMiniBatches, outputMiniBatches] = Utilities::createMiniBatches(inputSet, outputSet, n_mini_batch);
-        
-        // Initializing necessary components for Adam. 
-        std::vector<std::vector<std::vector<double>>> v_hidden;
-        
-        std::vector<double> v_output;
-        while(true){
-            learning_rate = applyLearningRateScheduler(initial_learning_rate, decayConstant, epoch, dropRate);
-            for(int i = 0; i < n_mini_batch; i++){
-                std::vector<double> y_hat = modelSetTest(inputMiniBatches[i]);
-                cost_prev = Cost(y_hat, outputMiniBatches[i]);
-
-                auto [cumulativeHiddenLayerWGrad, outputWGrad] = computeGradients(y_hat, outputMiniBatches[i]);
-
-                if(!network.empty() && v_hidden.empty()){ // Initing our tensor
-                    v_hidden = alg.resize(v_hidden, cumulativeHiddenLayerWGrad);
+            forwardShard(i, worker, 1);
+            backwardShard(i, worker, 1, worker);
+
+            for(int l = 0; l < workspace.size(); l++){
+                LayerWorkspace& layer = workspace[l];
+                Matrix& gradient = worker == 0 ? layer.gradient : layer.shardGradients[worker - 1];
+                addRegDerivTerm(l, layer.weightSnapshots[worker], gradient);
+
+                double* w = layer.weights.data();
+                const double* g = gradient.data();
+                for(long j = 0; j < layer.weights.size(); j++){
+                    Hogwild::store(w[j], Hogwild::load(w[j]) - learning_rate/n * g[j]);
                 }
-
-                if(v_output.empty()){
-                    v_output.resize(outputWGrad.size());
+                const double* delta = layer.delta.row(worker);
+                for(int j = 0; j < layer.bias.size(); j++){
+                    Hogwild::store(layer.bias[j], Hogwild::load(layer.bias[j]) - learning_rate/n * delta[j]);
                 }
-
-                v_hidden = alg.addition(alg.scalarMultiply(1 - b1, v_hidden), alg.scalarMultiply(b1, alg.exponentiate(cumulativeHiddenLayerWGrad, 2)));
-
-                v_output = alg.addition(v_output, alg.exponentiate(outputWGrad, 2));
-
-                std::vector<std::vector<std::vector<double>>> hiddenLayerUpdations = alg.scalarMultiply(learning_rate/n, alg.elementWiseDivision(cumulativeHiddenLayerWGrad, alg.scalarAdd(e, alg.sqrt(v_hidden))));
-                std::vector<double> outputLayerUpdation = alg.scalarMultiply(learning_rate/n, alg.elementWiseDivision(outputWGrad, alg.scalarAdd(e, alg.sqrt(v_output))));
-
-                updateParameters(hiddenLayerUpdations, outputLayerUpdation, learning_rate); // subject to change. may want bias to have this matrix too.
-                y_hat = modelSetTest(inputMiniBatches[i]);
-
-                if(UI) { ANN::UI(epoch, cost_prev, y_hat, outputMiniBatches[i]); }
             }
-            epoch++;
-            if(epoch > max_epoch) { break; }
+        };
+        Hogwild::Report report = Hogwild::run(workers, max_epoch, n, step);
+        for(auto& layer : workspace){
+            layer.weightSnapshots.clear();
+            layer.biasSnapshots.clear();
         }
+        storeWorkspace();
+
         forwardPass();
+        report.costBefore = cost_prev;
+        report.costAfter = Cost(y_hat, outputSet);
+        if(UI) { Hogwild::UI(report); }
+        return report;
     }
 
-void ANN::Adam(double learning_rate, int max_epoch, int mini_batch_size, double b1, double b2, double e, bool UI){
-        class Cost cost; 
-        LinAlg alg;
-
-        double cost_prev = 0;
-        int epoch = 1;
-        double initial_learning_rate = learning_rate;
-
-        // Creating the mini-batches
-        int n_mini_batch = n/mini_batch_size;
-        // always evaluate the result 
-        // always do forward pass only ONCE at end.
-        auto [inputMiniBatches, outputMiniBatches] = Utilities::createMiniBatches(inputSet, outputSet, n_mini_batch);
-        
-        // Initializing necessary components for Adam. 
-        std::vector<std::vector<std::vector<double>>> m_hidden;
-        std::vector<std::vector<std::vector<double>>> v_hidden;
-
-        std::vector<double> m_output;
-        std::vector<double> v_output;
-        while(true){
-            learning_rate = applyLearningRateScheduler(initial_learning_rate, decayConstant, epoch, dropRate);
-            for(int i = 0; i < n_mini_batch; i++){
-                std::vector<double> y_hat = modelSetTest(inputMiniBatches[i]);
-                cost_prev = Cost(y_hat, outputMiniBatches[i]);
-
-                auto [cumulativeHiddenLayerWGrad, outputWGrad] = computeGradients(y_hat, outputMiniBatches[i]);
-                if(!network.empty() && m_hidden.empty() && v_hidden.empty()){ // Initing our tensor
-                    m_hidden = alg.resize(m_hidden, cumulativeHiddenLayerWGrad);
-                    v_hidden = alg.resize(v_hidden, cumulativeHiddenLayerWGrad);
-                }
-
-                if(m_output.empty() && v_output.empty()){
-                    m_output.resize(outputWGrad.size());
-                    v_output.resize(outputWGrad.size());
-                }
-
-                m_hidden = alg.addition(alg.scalarMultiply(b1, m_hidden), alg.scalarMultiply(1 - b1, cumulativeHiddenLayerWGrad));
-                v_hidden = alg.addition(alg.scalarMultiply(b2, v_hidden), alg.scalarMultiply(1 - b2, alg.exponentiate(cumulativeHiddenLayerWGrad, 2)));
-
-                m_output = alg.addition(alg.scalarMultiply(b1, m_output), alg.scalarMultiply(1 - b1, outputWGrad));
-                v_output = alg.addition(alg.scalarMultiply(b2, v_output), alg.scalarMultiply(1 - b2, alg.exponentiate(outputWGrad, 2)));
-
-                std::vector<std::vector<std::vector<double>>> m_hidden_hat = alg.scalarMultiply(1/(1 - std::pow(b1, epoch)), m_hidden);
-                std::vector<std::vector<std::vector<double>>> v_hidden_hat = alg.scalarMultiply(1/(1 - std::pow(b2, epoch)), v_hidden);
-
-                std::vector<double> m_output_hat = alg.scalarMultiply(1/(1 - std::pow(b1, epoch)), m_output);
-                std::vector<double> v_output_hat = alg.scalarMultiply(1/(1 - std::pow(b2, epoch)), v_output);
+    void ANN::MBGD(double learning_rate, int max_epoch, int mini_batch_size, bool UI){
+        GradientDescentOptimizer optimizer;
+        train(optimizer, learning_rate, max_epoch, mini_batch_size, UI);
+    }
 
-                std::vector<std::vector<std::vector<double>>> hiddenLayerUpdations = alg.scalarMultiply(learning_rate/n, alg.elementWiseDivision(m_hidden_hat, alg.scalarAdd(e, alg.sqrt(v_hidden_hat))));
-                std::vector<double> outputLayerUpdation = alg.scalarMultiply(learning_rate/n, alg.elementWiseDivision(m_output_hat, alg.scalarAdd(e, alg.sqrt(v_output_hat))));
+    void ANN::Momentum(double learning_rate, int max_epoch, int mini_batch_size, double gamma, bool NAG, bool UI){
+        MomentumOptimizer optimizer(gamma, NAG);
+        train(optimizer, learning_rate, max_epoch, mini_batch_size, UI);
+    }
 
+    void ANN::Adagrad(double learning_rate, int max_epoch, int mini_batch_size, double e, bool UI){
+        AdagradOptimizer optimizer(e);
+        train(optimizer, learning_rate, max_epoch, mini_batch_size, UI);
+    }
 
-                updateParameters(hiddenLayerUpdations, outputLayerUpdation, learning_rate); // subject to change. may want bias to have this matrix too.
-                y_hat = modelSetTest(inputMiniBatches[i]);
+    void ANN::Adadelta(double learning_rate, int max_epoch, int mini_batch_size, double b1, double e, bool UI){
+        AdadeltaOptimizer optimizer(b1, e);
+        train(optimizer, learning_rate, max_epoch, mini_batch_size, UI);
+    }
 
-                if(UI) { ANN::UI(epoch, cost_prev, y_hat, outputMiniBatches[i]); }
-            }
-            epoch++;
-            if(epoch > max_epoch) { break; }
-        }
-        forwardPass();
+    void ANN::Adam(double learning_rate, int max_epoch, int mini_batch_size, double b1, double b2, double e, bool UI){
+        AdamOptimizer optimizer(b1, b2, e);
+        train(optimizer, learning_rate, max_epoch, mini_batch_size, UI);
     }
 
     void ANN::Adamax(double learning_rate, int max_epoch, int mini_batch_size, double b1, double b2, double e, bool UI){
-        class Cost cost; 
-        LinAlg alg;
-
-        double cost_prev = 0;
-        int epoch = 1;
-        double initial_learning_rate = learning_rate;
-
-        // Creating the mini-batches
-        int n_mini_batch = n/mini_batch_size;
-        // always evaluate the result 
-        // always do forward pass only ONCE at end.
-        auto [inputMiniBatches, outputMiniBatches] = Utilities::createMiniBatches(inputSet, outputSet, n_mini_batch);
-        
-        // Initializing necessary components for Adam. 
-        std::vector<std::vector<std::vector<double>>> m_hidden;
-        std::vector<std::vector<std::vector<double>>> u_hidden;
-
-        std::vector<double> m_output;
-        std::vector<double> u_output;
-        while(true){
-            learning_rate = applyLearningRateScheduler(initial_learning_rate, decayConstant, epoch, dropRate);
-            for(int i = 0; i < n_mini_batch; i++){
-                std::vector<double> y_hat = modelSetTest(inputMiniBatches[i]);
-                cost_prev = Cost(y_hat, outputMiniBatches[i]);
-
-                auto [cumulativeHiddenLayerWGrad, outputWGrad] = computeGradients(y_hat, outputMiniBatches[i]);
-                if(!network.empty() && m_hidden.empty() && u_hidden.empty()){ // Initing our tensor
-                    m_hidden = alg.resize(m_hidden, cumulativeHiddenLayerWGrad);
-                    u_hidden = alg.resize(u_hidden, cumulativeHiddenLayerWGrad);
-                }
-
-                if(m_output.empty() && u_output.empty()){
-                    m_output.resize(outputWGrad.size());
-                    u_output.resize(outputWGrad.size());
-                }
-
-                m_hidden = alg.addition(alg.scalarMultiply(b1, m_hidden), alg.scalarMultiply(1 - b1, cumulativeHiddenLayerWGrad));
-                u_hidden = alg.max(alg.scalarMultiply(b2, u_hidden), alg.abs(cumulativeHiddenLayerWGrad));
-
-                m_output = alg.addition(alg.scalarMultiply(b1, m_output), alg.scalarMultiply(1 - b1, outputWGrad));
-                u_output = alg.max(alg.scalarMultiply(b2, u_output), alg.abs(outputWGrad));
-
-                std::vector<std::vector<std::vector<double>>> m_hidden_hat = alg.scalarMultiply(1/(1 - std::pow(b1, epoch)), m_hidden);
-
-                std::vector<double> m_output_hat = alg.scalarMultiply(1/(1 - std::pow(b1, epoch)), m_output);
-
-                std::vector<std::vector<std::vector<double>>> hiddenLayerUpdations = alg.scalarMultiply(learning_rate/n, alg.elementWiseDivision(m_hidden_hat, alg.scalarAdd(e, u_hidden)));
-                std::vector<double> outputLayerUpdation = alg.scalarMultiply(learning_rate/n, alg.elementWiseDivision(m_output_hat, alg.scalarAdd(e, u_output)));
-
+        AdamaxOptimizer optimizer(b1, b2, e);
+        train(optimizer, learning_rate, max_epoch, mini_batch_size, UI);
+    }
 
-                updateParameters(hiddenLayerUpdations, outputLayerUpdation, learning_rate); // subject to change. may want bias to have this matrix too.
-                y_hat = modelSetTest(inputMiniBatches[i]);
+    void ANN::Nadam(double learning_rate, int max_epoch, int mini_batch_size, double b1, double b2, double e, bool UI){
+        NadamOptimizer optimizer(b1, b2, e);
+        train(optimizer, learning_rate, max_epoch, mini_batch_size, UI);
+    }
 
-                if(UI) { ANN::UI(epoch, cost_prev, y_hat, outputMiniBatches[i]); }
-            }
-            epoch++;
-            if(epoch > max_epoch) { break; }
-        }
-        forwardPass();
+    void ANN::AMSGrad(double learning_rate, int max_epoch, int mini_batch_size, double b1, double b2, double e, bool UI){
+        AMSGradOptimizer optimizer(b1, b2, e);
+        train(optimizer, learning_rate, max_epoch, mini_batch_size, UI);
     }
-    
-    void ANN::Nadam(double learning_rate, int max_epoch, int mini_batch_size, double b1, double b2, double e, bool UI){
-        class Cost cost; 
-        LinAlg alg;
 
+    void ANN::train(Optimizer& optimizer, double learning_rate, int max_epoch, int mini_batch_size, bool UI){
+        if(!hasTrainingSet()) { return; }
         double cost_prev = 0;
-        int epoch = 1;
         double initial_learning_rate = learning_rate;
 
-        // Creating the mini-batches
-        int n_mini_batch = n/mini_batch_size;
-        // always evaluate the result 
-        // always do forward pass only ONCE at end.
-        auto [inputMiniBatches, outputMiniBatches] = Utilities::createMiniBatches(inputSet, outputSet, n_mini_batch);
-        
-        // Initializing necessary components for Adam. 
-        std::vector<std::vector<std::vector<double>>> m_hidden;
-        std::vector<std::vector<std::vector<double>>> v_hidden;
-        std::vector<std::vector<std::vector<double>>> m_hidden_final;
-
-        std::vector<double> m_output;
-        std::vector<double> v_output;
+        MiniBatches batches(n, n/mini_batch_size);
+
+        loadWorkspace();
+        std::vector<long> blockSizes;
+        for(auto& layer : workspace){
+            blockSizes.push_back(layer.weights.size());
+        }
+        optimizer.reset(blockSizes);
+        int epoch = optimizer.step() + 1; // Past 1 only when resuming from a checkpoint.
+        if(epoch > max_epoch) { storeWorkspace(); return; }
         while(true){
             learning_rate = applyLearningRateScheduler(initial_learning_rate, decayConstant, epoch, dropRate);
-            for(int i = 0; i < n_mini_batch; i++){
-                std::vector<double> y_hat = modelSetTest(inputMiniBatches[i]);
-                cost_prev = Cost(y_hat, outputMiniBatches[i]);
-
-                auto [cumulativeHiddenLayerWGrad, outputWGrad] = computeGradients(y_hat, outputMiniBatches[i]);
-                if(!network.empty() && m_hidden.empty() && v_hidden.empty()){ // Initing our tensor
-                    m_hidden = alg.resize(m_hidden, cumulativeHiddenLayerWGrad);
-                    v_hidden = alg.resize(v_hidden, cumulativeHiddenLayerWGrad);
+            if(shuffle) { batches.shuffle(generator); }
+            for(int i = 0; i < batches.size(); i++){
+                int begin = 0;
+                int rows = batches.rows(i);
+                if(batches.inOrder()){
+                    begin = batches.first(i);
                 }
-
-                if(m_output.empty() && v_output.empty()){
-                    m_output.resize(outputWGrad.size());
-                    v_output.resize(outputWGrad.size());
+                else{
+                    gatherBatch(batches.indices(i), rows);
                 }
+                computeGradients(begin, rows);
+                if(UI) { cost_prev = batchCost(begin, rows); }
 
-                m_hidden = alg.addition(alg.scalarMultiply(b1, m_hidden), alg.scalarMultiply(1 - b1, cumulativeHiddenLayerWGrad));
-                v_hidden = alg.addition(alg.scalarMultiply(b2, v_hidden), alg.scalarMultiply(1 - b2, alg.exponentiate(cumulativeHiddenLayerWGrad, 2)));
-                
-
-                m_output = alg.addition(alg.scalarMultiply(b1, m_output), alg.scalarMultiply(1 - b1, outputWGrad));
-                v_output = alg.addition(alg.scalarMultiply(b2, v_output), alg.scalarMultiply(1 - b2, alg.exponentiate(outputWGrad, 2)));
-
-                std::vector<std::vector<std::vector<double>>> m_hidden_hat = alg.scalarMultiply(1/(1 - std::pow(b1, epoch)), m_hidden);
-                std::vector<std::vector<std::vector<double>>> v_hidden_hat = alg.scalarMultiply(1/(1 - std::pow(b2, epoch)), v_hidden);
-                std::vector<std::vector<std::vector<double>>> m_hidden_final = alg.addition(alg.scalarMultiply(b1, m_hidden_hat), alg.scalarMultiply((1 - b1)/(1 - std::pow(b1, epoch)), cumulativeHiddenLayerWGrad));
-
-                std::vector<double> m_output_hat = alg.scalarMultiply(1/(1 - std::pow(b1, epoch)), m_output);
-                std::vector<double> v_output_hat = alg.scalarMultiply(1/(1 - std::pow(b2, epoch)), v_output);
-                std::vector<double> m_output_final = alg.addition(alg.scalarMultiply(b1, m_output_hat), alg.scalarMultiply((1 - b1)/(1 - std::pow(b1, epoch)), outputWGrad));
-
-                std::vector<std::vector<std::vector<double>>> hiddenLayerUpdations = alg.scalarMultiply(learning_rate/n, alg.elementWiseDivision(m_hidden_final, alg.scalarAdd(e, alg.sqrt(v_hidden_hat))));
-                std::vector<double> outputLayerUpdation = alg.scalarMultiply(learning_rate/n, alg.elementWiseDivision(m_output_final, alg.scalarAdd(e, alg.sqrt(v_output_hat))));
-
-
-                updateParameters(hiddenLayerUpdations, outputLayerUpdation, learning_rate); // subject to change. may want bias to have this matrix too.
-                y_hat = modelSetTest(inputMiniBatches[i]);
+                // The gradients are sums over the batch rows; the step keeps the library's learning_rate/n scaling.
+                optimizer.beginStep(epoch);
+                for(int l = 0; l < workspace.size(); l++){
+                    optimizer.update(l, workspace[l].weights.data(), workspace[l].gradient.data(), workspace[l].weights.size(), learning_rate/n);
+                }
 
-                if(UI) { ANN::UI(epoch, cost_prev, y_hat, outputMiniBatches[i]); }
+                updateBiases(rows, learning_rate);
+                if(UI) { batchUI(epoch, cost_prev, begin, rows); }
             }
             epoch++;
             if(epoch > max_epoch) { break; }
         }
+        storeWorkspace();
         forwardPass();
     }
 
-    void ANN::AMSGrad(double learning_rate, int max_epoch, int mini_batch_size, double b1, double b2, double e, bool UI){
-        class Cost cost; 
-        LinAlg alg;
-
+    void ANN::train(BatchStream& batches, Optimizer& optimizer, double learning_rate, int max_epoch, bool UI){
+        if(batches.source().inputs() != k || batches.source().outputs() != 1){
+            std::cout << "The stream's samples do not match the network's " << k << " inputs and 1 output." << std::endl;
+            return;
+        }
         double cost_prev = 0;
-        int epoch = 1;
         double initial_learning_rate = learning_rate;
 
-        // Creating the mini-batches
-        int n_mini_batch = n/mini_batch_size;
-        // always evaluate the result 
-        // always do forward pass only ONCE at end.
-        auto [inputMiniBatches, outputMiniBatches] = Utilities::createMiniBatches(inputSet, outputSet, n_mini_batch);
-        
-        // Initializing necessary components for Adam. 
-        std::vector<std::vector<std::vector<double>>> m_hidden;
-        std::vector<std::vector<std::vector<double>>> v_hidden;
-
-        std::vector<std::vector<std::vector<double>>> v_hidden_hat;
-
-        std::vector<double> m_output;
-        std::vector<double> v_output;
-
-        std::vector<double> v_output_hat;
-        while(true){
+        loadWorkspace();
+        std::vector<long> blockSizes;
+        for(auto& layer : workspace){
+            blockSizes.push_back(layer.weights.size());
+        }
+        optimizer.reset(blockSizes);
+        for(int epoch = optimizer.step() + 1; epoch <= max_epoch; epoch++){
             learning_rate = applyLearningRateScheduler(initial_learning_rate, decayConstant, epoch, dropRate);
-            for(int i = 0; i < n_mini_batch; i++){
-                std::vector<double> y_hat = modelSetTest(inputMiniBatches[i]);
-                cost_prev = Cost(y_hat, outputMiniBatches[i]);
-
-                auto [cumulativeHiddenLayerWGrad, outputWGrad] = computeGradients(y_hat, outputMiniBatches[i]);
-                if(!network.empty() && m_hidden.empty() && v_hidden.empty()){ // Initing our tensor
-                    m_hidden = alg.resize(m_hidden, cumulativeHiddenLayerWGrad);
-                    v_hidden = alg.resize(v_hidden, cumulativeHiddenLayerWGrad);
-                    v_hidden_hat = alg.resize(v_hidden_hat, cumulativeHiddenLayerWGrad);
+            while(const BatchStream::Batch* batch = batches.next()){
+                useBatch(*batch);
+                int rows = batch->rows();
+                computeGradients(0, rows);
+                if(UI) { cost_prev = batchCost(0, rows); }
+
+                optimizer.beginStep(epoch);
+                for(int l = 0; l < workspace.size(); l++){
+                    optimizer.update(l, workspace[l].weights.data(), workspace[l].gradient.data(), workspace[l].weights.size(), learning_rate/n);
                 }
 
-                if(m_output.empty() && v_output.empty()){
-                    m_output.resize(outputWGrad.size());
-                    v_output.resize(outputWGrad.size());
-                    v_output_hat.resize(outputWGrad.size());
-                }
-
-                m_hidden = alg.addition(alg.scalarMultiply(b1, m_hidden), alg.scalarMultiply(1 - b1, cumulativeHiddenLayerWGrad));
-                v_hidden = alg.addition(alg.scalarMultiply(b2, v_hidden), alg.scalarMultiply(1 - b2, alg.exponentiate(cumulativeHiddenLayerWGrad, 2)));
-
-                m_output = alg.addition(alg.scalarMultiply(b1, m_output), alg.scalarMultiply(1 - b1, outputWGrad));
-                v_output = alg.addition(alg.scalarMultiply(b2, v_output), alg.scalarMultiply(1 - b2, alg.exponentiate(outputWGrad, 2)));
-
-                v_hidden_hat = alg.max(v_hidden_hat, v_hidden);
-
-                v_output_hat = alg.max(v_output_hat, v_output);
-
-                std::vector<std::vector<std::vector<double>>> hiddenLayerUpdations = alg.scalarMultiply(learning_rate/n, alg.elementWiseDivision(m_hidden, alg.scalarAdd(e, alg.sqrt(v_hidden_hat))));
-                std::vector<double> outputLayerUpdation = alg.scalarMultiply(learning_rate/n, alg.elementWiseDivision(m_output, alg.scalarAdd(e, alg.sqrt(v_output_hat))));
-
-
-                updateParameters(hiddenLayerUpdations, outputLayerUpdation, learning_rate); // subject to change. may want bias to have this matrix too.
-                y_hat = modelSetTest(inputMiniBatches[i]);
-
-                if(UI) { ANN::UI(epoch, cost_prev, y_hat, outputMiniBatches[i]); }
+                updateBiases(rows, learning_rate);
+                if(UI) { batchUI(epoch, cost_prev, 0, rows); }
             }
-            epoch++;
-            if(epoch > max_epoch) { break; }
         }
+        storeWorkspace();
         forwardPass();
+        if(UI) { BatchStream::UI(batches.timing()); }
     }
 
     double ANN::score(){
@@ -595,6 +346,82 @@ void ANN::Adam(double learning_rate, int max_epoch, int mini_batch_size, double
         }
      }
 
+    void ANN::saveCheckpoint(std::string fileName, const Optimizer* optimizer){
+        Checkpoint::Writer writer("ANN");
+        writer.add("layers", (double)network.size());
+        for(int i = 0; i < network.size(); i++){
+            network[i].save(writer, "layer" + std::to_string(i));
+        }
+        if(outputLayer){
+            outputLayer->save(writer, "output");
+        }
+        writer.add("lrScheduler", lrScheduler);
+        writer.add("decayConstant", decayConstant);
+        writer.add("dropRate", dropRate);
+        std::ostringstream state;
+        state << generator;
+        writer.add("generator", state.str());
+        if(optimizer){
+            optimizer->save(writer, "optimizer");
+        }
+        writer.write(fileName);
+    }
+
+    bool ANN::loadCheckpoint(std::string fileName, Optimizer* optimizer){
+        Checkpoint checkpoint(fileName);
+        if(!checkpoint.valid()){ return false; }
+        if(checkpoint.kind() != "ANN" || !checkpoint.has("output.weights")){
+            std::cout << fileName << " is not an ANN checkpoint." << std::endl;
+            return false;
+        }
+        int layers = checkpoint.scalar("layers");
+        // Every shape and the optimizer state are checked before anything is copied, so a failed load leaves the
+        // network and the optimizer as they were.
+        bool built = network.empty() && !outputLayer;
+        if(built){
+            for(int i = 0; i < layers; i++){
+                std::string prefix = "layer" + std::to_string(i);
+                addLayer(checkpoint.scalar(prefix + ".units"), checkpoint.text(prefix + ".activation"), checkpoint.text(prefix + ".weightInit"), checkpoint.text(prefix + ".reg"), checkpoint.scalar(prefix + ".lambda"), checkpoint.scalar(prefix + ".alpha"));
+            }
+            addOutputLayer(checkpoint.text("output.activation"), checkpoint.text("output.cost"), checkpoint.text("output.weightInit"), checkpoint.text("output.reg"), checkpoint.scalar("output.lambda"), checkpoint.scalar("output.alpha"));
+        }
+        bool matches = outputLayer && layers == network.size();
+        for(int i = 0; matches && i < layers; i++){
+            matches = network[i].fits(checkpoint, "layer" + std::to_string(i));
+        }
+        bool fits = true;
+        if(!matches || !outputLayer->fits(checkpoint, "output")){
+            std::cout << "The architecture in " << fileName << " does not match this network." << std::endl;
+            fits = false;
+        }
+        else if(optimizer && !optimizer->fits(checkpoint, "optimizer")){
+            std::cout << "The optimizer state in " << fileName << " does not fit the given optimizer." << std::endl;
+            fits = false;
+        }
+        if(!fits){
+            if(built){
+                network.clear();
+                workspace.clear();
+                delete outputLayer;
+                outputLayer = nullptr;
+            }
+            return false;
+        }
+
+        for(int i = 0; i < layers; i++){
+            network[i].load(checkpoint, "layer" + std::to_string(i));
+        }
+        outputLayer->load(checkpoint, "output");
+        lrScheduler = checkpoint.text("lrScheduler");
+        decayConstant = checkpoint.scalar("decayConstant");
+        dropRate = checkpoint.scalar("dropRate");
+        std::istringstream state(checkpoint.text("generator"));
+        state >> generator;
+        if(optimizer){ optimizer->load(checkpoint, "optimizer"); }
+        forwardPass();
+        return true;
+    }
+
      void ANN::setLearningRateScheduler(std::string type, double decayConstant){
         lrScheduler = type;
         ANN::decayConstant = decayConstant;
@@ -606,6 +433,40 @@ void ANN::Adam(double learning_rate, int max_epoch, int mini_batch_size, double
          ANN::dropRate = dropRate;
      }
 
+    void ANN::setThreads(int threads){
+        ANN::threads = std::max(threads, 1);
+        for(auto& layer : workspace){
+            layer.shardGradients.assign(ANN::threads - 1, Matrix(layer.weights.rows(), layer.weights.cols()));
+            if(mixedPrecision){ allocateSingle(layer); }
+        }
+    }
+
+    void ANN::setShuffle(bool shuffle){
+        ANN::shuffle = shuffle;
+    }
+
+    void ANN::setPrecision(std::string precision){
+        if(precision != "Double" && precision != "Mixed"){
+            std::cout << "Unknown precision " << precision << "; use \"Double\" or \"Mixed\"." << std::endl;
+            return;
+        }
+        mixedPrecision = precision == "Mixed";
+        for(auto& layer : workspace){
+            if(mixedPrecision){
+                allocateSingle(layer);
+            }
+            else{
+                layer.single = {};
+            }
+        }
+        if(mixedPrecision){
+            trainingInputSingle.assign(trainingInput);
+        }
+        else{
+            trainingInputSingle = FloatMatrix();
+        }
+    }
+
     // https://en.wikipedia.org/wiki/Learning_rate
     // Learning Rate Decay (C2W2L09) - Andrew Ng - Deep Learning Specialization
      double ANN::applyLearningRateScheduler(double learningRate, double decayConstant, double epoch, double dropRate){
@@ -626,23 +487,32 @@ void ANN::Adam(double learning_rate, int max_epoch, int mini_batch_size, double
 
     void ANN::addLayer(int n_hidden, std::string activation, std::string weightInit, std::string reg, double lambda, double alpha){
         if(network.empty()){
-            network.push_back(HiddenLayer(n_hidden, activation, inputSet, weightInit, reg, lambda, alpha));
+            if(!inputSet.empty()){
+                network.push_back(HiddenLayer(n_hidden, activation, inputSet, weightInit, reg, lambda, alpha));
+            }
+            else{
+                // A streamed network has no training set; a zero sample gives the layer its input width.
+                network.push_back(HiddenLayer(n_hidden, activation, std::vector<std::vector<double>>(1, std::vector<double>(k)), weightInit, reg, lambda, alpha));
+            }
             network[0].forwardPass();
+            addWorkspaceLayer(k, n_hidden, network[0].activationFunction);
         }
         else{
             network.push_back(HiddenLayer(n_hidden, activation, network[network.size() - 1].a, weightInit, reg, lambda, alpha));
             network[network.size() - 1].forwardPass();
+            addWorkspaceLayer(network[network.size() - 2].n_hidden, n_hidden, network[network.size() - 1].activationFunction);
         }
     }
     
     void ANN::addOutputLayer(std::string activation, std::string loss, std::string weightInit, std::string reg, double lambda, double alpha){
-        LinAlg alg;
         if(!network.empty()){
             outputLayer = new OutputLayer(network[network.size() - 1].n_hidden, activation, loss, network[network.size() - 1].a, weightInit, reg, lambda, alpha);
         }
         else{
             outputLayer = new OutputLayer(k, activation, loss, inputSet, weightInit, reg, lambda, alpha);
         }
+        addWorkspaceLayer(outputLayer->n_hidden, 1, outputLayer->activationFunction);
+        costDerivative = Cost::bufferDerivative(outputLayer->costFunction);
     }
 
     double ANN::Cost(std::vector<double> y_hat, std::vector<double> y){
@@ -650,16 +520,16 @@ void ANN::Adam(double learning_rate, int max_epoch, int mini_batch_size, double
         class Cost cost;
         double totalRegTerm = 0;
 
-        auto cost_function = outputLayer->cost_map[outputLayer->cost];
         if(!network.empty()){
             for(int i = 0; i < network.size() - 1; i++){
                 totalRegTerm += regularization.regTerm(network[i].weights, network[i].lambda, network[i].alpha, network[i].reg);
             }
         }
-        return (cost.*cost_function)(y_hat, y) + totalRegTerm + regularization.regTerm(outputLayer->weights, outputLayer->lambda, outputLayer->alpha, outputLayer->reg);
+        return cost.evaluate(outputLayer->costFunction, y_hat, y) + totalRegTerm + regularization.regTerm(outputLayer->weights, outputLayer->lambda, outputLayer->alpha, outputLayer->reg);
     }
 
     void ANN::forwardPass(){
+        if(inputSet.empty()){ return; }
         if(!network.empty()){
             network[0].input = inputSet;
             network[0].forwardPass();
@@ -677,55 +547,276 @@ void ANN::Adam(double learning_rate, int max_epoch, int mini_batch_size, double
         y_hat = outputLayer->a;
     }
 
-    void ANN::updateParameters(std::vector<std::vector<std::vector<double>>> hiddenLayerUpdations, std::vector<double> outputLayerUpdation, double learning_rate){
-        LinAlg alg;
+    bool ANN::hasTrainingSet() const{
+        if(trainingInput.empty()){
+            std::cout << "This network has no training set in memory; train it on a BatchStream." << std::endl;
+            return false;
+        }
+        return true;
+    }
 
-        outputLayer->weights = alg.subtraction(outputLayer->weights, outputLayerUpdation);
-        outputLayer->bias -= learning_rate * alg.sum_elements(outputLayer->delta) / n;
+    void ANN::addWorkspaceLayer(int inputs, int units, Activation::Function activation){
+        LayerWorkspace layer;
+        layer.weights = Matrix(inputs, units);
+        layer.bias = Vector(units);
+        layer.z = Matrix(trainingInput.rows(), units);
+        layer.a = Matrix(trainingInput.rows(), units);
+        layer.delta = Matrix(trainingInput.rows(), units);
+        layer.gradient = Matrix(inputs, units);
+        layer.shardGradients.assign(threads - 1, Matrix(inputs, units));
+        layer.activation = Activation::bufferFunction(activation);
+        if(mixedPrecision){ allocateSingle(layer); }
+        workspace.push_back(std::move(layer));
+    }
 
-        if(!network.empty()){
-                
-            network[network.size() - 1].weights = alg.subtraction(network[network.size() - 1].weights, hiddenLayerUpdations[0]);
-            network[network.size() - 1].bias = alg.subtractMatrixRows(network[network.size() - 1].bias, alg.scalarMultiply(learning_rate/n, network[network.size() - 1].delta));
+    void ANN::allocateSingle(LayerWorkspace& layer){
+        int inputs = layer.weights.rows();
+        int units = layer.weights.cols();
+        layer.single.weights = FloatMatrix(inputs, units);
+        layer.single.bias.assign(units, 0);
+        layer.single.z = FloatMatrix(trainingInput.rows(), units);
+        layer.single.a = FloatMatrix(trainingInput.rows(), units);
+        layer.single.delta = FloatMatrix(trainingInput.rows(), units);
+        layer.single.gradient = FloatMatrix(inputs, units);
+        layer.single.shardGradients.assign(threads - 1, FloatMatrix(inputs, units));
+    }
 
-            for(int i = network.size() - 2; i >= 0; i--){
-                network[i].weights = alg.subtraction(network[i].weights, hiddenLayerUpdations[(network.size() - 2) - i + 1]);
-                network[i].bias = alg.subtractMatrixRows(network[i].bias, alg.scalarMultiply(learning_rate/n, network[i].delta));
+    // The layers keep the parameters between calls; each training method copies them in and back out once.
+    void ANN::loadWorkspace(){
+        samples = &trainingInput;
+        samplesSingle = &trainingInputSingle;
+        targets = outputSet.data();
+        for(int i = 0; i < network.size(); i++){
+            for(int j = 0; j < network[i].weights.size(); j++){
+                std::copy(network[i].weights[j].begin(), network[i].weights[j].end(), workspace[i].weights.row(j));
             }
+            std::copy(network[i].bias.begin(), network[i].bias.end(), workspace[i].bias.data());
         }
+        std::copy(outputLayer->weights.begin(), outputLayer->weights.end(), workspace.back().weights.data());
+        workspace.back().bias[0] = outputLayer->bias;
     }
-    
-    std::tuple<std::vector<std::vector<std::vector<double>>>, std::vector<double>> ANN::computeGradients(std::vector<double> y_hat, std::vector<double> outputSet){
-       // std::cout << "BEGIN" << std::endl;
-        class Cost cost; 
-        Activation avn;
-        LinAlg alg;
-        Reg regularization;
 
-        std::vector<std::vector<std::vector<double>>> cumulativeHiddenLayerWGrad; // Tensor containing ALL hidden grads. 
+    void ANN::storeWorkspace(){
+        for(int i = 0; i < network.size(); i++){
+            for(int j = 0; j < network[i].weights.size(); j++){
+                std::copy(workspace[i].weights.row(j), workspace[i].weights.row(j) + workspace[i].weights.cols(), network[i].weights[j].begin());
+            }
+            std::copy(workspace[i].bias.data(), workspace[i].bias.data() + workspace[i].bias.size(), network[i].bias.begin());
+        }
+        std::copy(workspace.back().weights.data(), workspace.back().weights.data() + workspace.back().weights.rows(), outputLayer->weights.begin());
+        outputLayer->bias = workspace.back().bias[0];
+    }
 
-        auto costDeriv = outputLayer->costDeriv_map[outputLayer->cost];
-        auto outputAvn = outputLayer->activation_map[outputLayer->activation];
-        outputLayer->delta = alg.hadamard_product((cost.*costDeriv)(y_hat, outputSet), (avn.*outputAvn)(outputLayer->z, 1));
-        std::vector<double> outputWGrad = alg.mat_vec_mult(alg.transpose(outputLayer->input), outputLayer->delta);
-        outputWGrad = alg.addition(outputWGrad, regularization.regDerivTerm(outputLayer->weights, outputLayer->lambda, outputLayer->alpha, outputLayer->reg));
+    // Points the shards at a batch from a stream, which then runs as rows [0, batch.rows()).
+    void ANN::useBatch(const BatchStream::Batch& batch){
+        samples = &batch.inputs;
+        targets = batch.outputs.data();
+        if(mixedPrecision){
+            batchInputSingle.assign(batch.inputs);
+            samplesSingle = &batchInputSingle;
+        }
+    }
 
-        if(!network.empty()){
-            auto hiddenLayerAvn = network[network.size() - 1].activation_map[network[network.size() - 1].activation];
-            network[network.size() - 1].delta = alg.hadamard_product(alg.outerProduct(outputLayer->delta, outputLayer->weights), (avn.*hiddenLayerAvn)(network[network.size() - 1].z, 1));
-            std::vector<std::vector<double>> hiddenLayerWGrad = alg.matmult(alg.transpose(network[network.size() - 1].input), network[network.size() - 1].delta);
+    // Copies a shuffled batch of the training set into rows [0, rows) of the scratch buffers and points the shards there.
+    void ANN::gatherBatch(const int* indices, int rows){
+        MiniBatches::gather(trainingInput, indices, rows, batchInput);
+        MiniBatches::gather(outputSet, indices, rows, batchTargets);
+        samples = &batchInput;
+        targets = batchTargets.data();
+        if(mixedPrecision){
+            MiniBatches::gather(trainingInputSingle, indices, rows, batchInputSingle);
+            samplesSingle = &batchInputSingle;
+        }
+    }
+
+    void ANN::resizeBatch(int rows){
+        for(auto& layer : workspace){
+            int units = layer.weights.cols();
+            layer.z.resize(rows, units);
+            layer.a.resize(rows, units);
+            layer.delta.resize(rows, units);
+            if(mixedPrecision){
+                layer.single.z.resize(rows, units);
+                layer.single.a.resize(rows, units);
+                layer.single.delta.resize(rows, units);
+            }
+        }
+    }
+
+    void ANN::forwardBatch(int begin, int rows){
+        resizeBatch(rows);
+        forwardShard(begin, 0, rows);
+    }
+
+    // A shard only touches its own rows of the z, a and delta buffers, so shards can run side by side.
+    void ANN::forwardShard(int sample, int slot, int rows){
+        const double* input = samples->row(sample);
+        int ld = samples->stride();
+        for(auto& layer : workspace){
+            int units = layer.weights.cols();
+            const Matrix& weights = shardWeights(layer, slot);
+            GEMM::gemmBiasActivation(false, false, rows, units, weights.rows(), input, ld, weights.data(), weights.stride(), shardBias(layer, slot).data(), layer.activation, layer.z.row(slot), layer.z.stride(), layer.a.row(slot), layer.a.stride());
+            input = layer.a.row(slot);
+            ld = layer.a.stride();
+        }
+    }
+
+    // Shard 0 writes its weight gradients to gradient, shard s > 0 to shardGradients[s - 1].
+    void ANN::backwardShard(int sample, int slot, int rows, int shard){
+        for(int l = workspace.size() - 1; l >= 0; l--){
+            LayerWorkspace& layer = workspace[l];
+            int units = layer.weights.cols();
+            double* delta = layer.delta.row(slot);
+            if(l == workspace.size() - 1){
+                double* z = layer.z.row(slot);
+                costDerivative(layer.a.row(slot), targets + sample, delta, rows);
+                layer.activation(z, z, (long)rows * units, 1);
+                VecMath::hadamard(delta, z, delta, (long)rows * units);
+            }
+            else{
+                const LayerWorkspace& next = workspace[l + 1];
+                const Matrix& nextWeights = shardWeights(next, slot);
+                GEMM::gemmActivationDeriv(false, true, rows, units, nextWeights.cols(), next.delta.row(slot), next.delta.stride(), nextWeights.data(), nextWeights.stride(), layer.activation, layer.z.row(slot), layer.z.stride(), delta, layer.delta.stride());
+            }
+
+            const double* input = l == 0 ? samples->row(sample) : workspace[l - 1].a.row(slot);
+            int ld = l == 0 ? samples->stride() : workspace[l - 1].a.stride();
+            Matrix& gradient = shard == 0 ? layer.gradient : layer.shardGradients[shard - 1];
+            GEMM::gemm(true, false, layer.weights.rows(), units, rows, 1, input, ld, delta, layer.delta.stride(), 0, gradient.data(), gradient.stride());
+        }
+    }
 
-            cumulativeHiddenLayerWGrad.push_back(alg.addition(hiddenLayerWGrad, regularization.regDerivTerm(network[network.size() - 1].weights, network[network.size() - 1].lambda, network[network.size() - 1].alpha, network[network.size() - 1].reg))); // Adding to our cumulative hidden layer grads. Maintain reg terms as well. 
+    void ANN::forwardShardMixed(int sample, int slot, int rows){
+        const float* input = samplesSingle->row(sample);
+        int ld = samplesSingle->stride();
+        for(auto& layer : workspace){
+            auto& single = layer.single;
+            int units = single.weights.cols();
+            GEMM::gemmBiasActivation(false, false, rows, units, single.weights.rows(), input, ld, single.weights.data(), single.weights.stride(), single.bias.data(), layer.activation, single.z.row(slot), single.z.stride(), single.a.row(slot), single.a.stride());
+            input = single.a.row(slot);
+            ld = single.a.stride();
+        }
+    }
+
+    void ANN::backwardShardMixed(int sample, int slot, int rows, int shard){
+        for(int l = workspace.size() - 1; l >= 0; l--){
+            LayerWorkspace& layer = workspace[l];
+            auto& single = layer.single;
+            int units = single.weights.cols();
+            if(l == workspace.size() - 1){
+                // The output activation and delta are formed in double from the widened z, as in backwardShard, and the
+                // delta rounded once. A single precision sigmoid already rounds to 1 near z = 17, where the log loss
+                // derivative divides by zero.
+                for(int i = slot; i < slot + rows; i++){
+                    for(int j = 0; j < units; j++){ layer.z(i, j) = single.z(i, j); }
+                }
+                double* z = layer.z.row(slot);
+                double* delta = layer.delta.row(slot);
+                layer.activation(z, layer.a.row(slot), (long)rows * units, 0);
+                costDerivative(layer.a.row(slot), targets + sample, delta, rows);
+                layer.activation(z, z, (long)rows * units, 1);
+                VecMath::hadamard(delta, z, delta, (long)rows * units);
+                for(int i = slot; i < slot + rows; i++){
+                    for(int j = 0; j < units; j++){ single.delta(i, j) = layer.delta(i, j); }
+                }
+            }
+            else{
+                const auto& next = workspace[l + 1].single;
+                GEMM::gemmActivationDeriv(false, true, rows, units, next.weights.cols(), next.delta.row(slot), next.delta.stride(), next.weights.data(), next.weights.stride(), layer.activation, single.z.row(slot), single.z.stride(), single.delta.row(slot), single.delta.stride());
+            }
 
-            for(int i = network.size() - 2; i >= 0; i--){
-                auto hiddenLayerAvn = network[i].activation_map[network[i].activation];
-                network[i].delta = alg.hadamard_product(alg.matmult(network[i + 1].delta, alg.transpose(network[i + 1].weights)), (avn.*hiddenLayerAvn)(network[i].z, 1));
-                std::vector<std::vector<double>> hiddenLayerWGrad = alg.matmult(alg.transpose(network[i].input), network[i].delta);
-                cumulativeHiddenLayerWGrad.push_back(alg.addition(hiddenLayerWGrad, regularization.regDerivTerm(network[i].weights, network[i].lambda, network[i].alpha, network[i].reg))); // Adding to our cumulative hidden layer grads. Maintain reg terms as well.
+            const float* input = l == 0 ? samplesSingle->row(sample) : workspace[l - 1].single.a.row(slot);
+            int ld = l == 0 ? samplesSingle->stride() : workspace[l - 1].single.a.stride();
+            FloatMatrix& gradient = shard == 0 ? single.gradient : single.shardGradients[shard - 1];
+            GEMM::gemm(true, false, single.weights.rows(), units, rows, 1.0f, input, ld, single.delta.row(slot), single.delta.stride(), 0.0f, gradient.data(), gradient.stride());
+        }
+    }
 
+    // Leaves dC/dW of every layer in its gradient buffer and the per-sample deltas in delta, both for the given rows.
+    void ANN::computeGradients(int begin, int rows){
+        resizeBatch(rows);
+        if(mixedPrecision){
+            // The optimizer has stepped the double weights since the last batch.
+            for(auto& layer : workspace){
+                layer.single.weights.assign(layer.weights);
+                std::copy(layer.bias.data(), layer.bias.data() + layer.bias.size(), layer.single.bias.begin());
             }
         }
-        return {cumulativeHiddenLayerWGrad, outputWGrad};
+        auto forward = mixedPrecision ? &ANN::forwardShardMixed : &ANN::forwardShard;
+        auto backward = mixedPrecision ? &ANN::backwardShardMixed : &ANN::backwardShard;
+
+        int shards = std::min(threads, rows);
+        if(shards == 1){
+            (this->*forward)(begin, 0, rows);
+            (this->*backward)(begin, 0, rows, 0);
+        }
+        else{
+            auto runShards = [&](long first, long last){
+                for(long s = first; s < last; s++){
+                    int offset = s * rows / shards;
+                    int end = (s + 1) * rows / shards;
+                    (this->*forward)(begin + offset, offset, end - offset);
+                    (this->*backward)(begin + offset, offset, end - offset, s);
+                }
+            };
+            ThreadPool::parallelFor(shards, 1, std::cref(runShards));
+
+            // Summed in a fixed order, independent of which worker ran which shard.
+            for(auto& layer : workspace){
+                if(mixedPrecision){
+                    sumShards(layer.single.gradient, layer.single.shardGradients, shards - 1);
+                }
+                else{
+                    sumShards(layer.gradient, layer.shardGradients, shards - 1);
+                }
+            }
+        }
+
+        if(mixedPrecision){
+            // The output layer's delta is already in double.
+            for(int l = 0; l < workspace.size(); l++){
+                workspace[l].gradient.assign(workspace[l].single.gradient);
+                if(l < workspace.size() - 1){ workspace[l].delta.assign(workspace[l].single.delta); }
+            }
+        }
+        for(int l = 0; l < workspace.size(); l++){
+            addRegDerivTerm(l, workspace[l].weights, workspace[l].gradient);
+        }
+    }
+
+    void ANN::addRegDerivTerm(int l, const Matrix& weights, Matrix& gradient){
+        Reg regularization;
+        if(l < network.size()){
+            regularization.addRegDerivTerm(weights.data(), gradient.data(), weights.size(), network[l].lambda, network[l].alpha, network[l].reg);
+        }
+        else{
+            regularization.addRegDerivTerm(weights.data(), gradient.data(), weights.size(), outputLayer->lambda, outputLayer->alpha, outputLayer->reg);
+        }
+    }
+
+    void ANN::updateBiases(int rows, double learning_rate){
+        for(auto& layer : workspace){
+            for(int i = 0; i < rows; i++){
+                const double* delta = layer.delta.row(i);
+                for(int j = 0; j < layer.bias.size(); j++){
+                    layer.bias[j] -= learning_rate/n * delta[j];
+                }
+            }
+        }
+    }
+
+    // The UI paths below allocate, but only run when UI is set.
+    double ANN::batchCost(int begin, int rows){
+        storeWorkspace();
+        const double* a = workspace.back().a.data();
+        return Cost(std::vector<double>(a, a + rows), std::vector<double>(targets + begin, targets + begin + rows));
+    }
+
+    void ANN::batchUI(int epoch, double cost_prev, int begin, int rows){
+        storeWorkspace();
+        forwardBatch(begin, rows);
+        const double* a = workspace.back().a.data();
+        ANN::UI(epoch, cost_prev, std::vector<double>(a, a + rows), std::vector<double>(targets + begin, targets + begin + rows));
     }
 
     void ANN::UI(int epoch, double cost_prev, std::vector<double> y_hat, std::vector<double> outputSet){
@@ -9,9 +9,15 @@
 
 #include "HiddenLayer/HiddenLayer.hpp"
 #include "OutputLayer/OutputLayer.hpp"
+#include "Matrix/Matrix.hpp"
+#include "Hogwild/Hogwild.hpp"
+#include "Optimizer/Optimizer.hpp"
+#include "InferenceModel/InferenceModel.hpp"
+#include "DataSource/DataSource.hpp"
 
 #include <vector>
 #include <tuple>
+#include <random>
 #include <string>
 
 namespace  MLPP{
@@ -19,11 +25,21 @@ namespace  MLPP{
 class ANN{
         public:
         ANN(std::vector<std::vector<double>> inputSet, std::vector<double> outputSet);
+        // A network for samples streamed from source, without a copy of the training set in memory. It trains with the
+        // BatchStream overload of train(); the other trainers report an error and return, methods that evaluate the
+        // training set, such as score(), have nothing to evaluate, and an "Int8" compile is left uncalibrated.
+        explicit ANN(const DataSource& source);
         ~ANN();
         std::vector<double> modelSetTest(std::vector<std::vector<double>> X);
         double modelTest(std::vector<double> x);
+        // Frozen copy of the current weights for concurrent, allocation-free prediction; see InferenceModel. Training
+        // afterwards does not change it. Its output has a single column. An "Int8" model is calibrated on the
+        // training inputs.
+        InferenceModel compile(std::string precision = "Double") const;
         void gradientDescent(double learning_rate, int max_epoch, bool UI = 1);
         void SGD(double learning_rate, int max_epoch, bool UI = 1);
+        // Lock-free asynchronous SGD, max_epoch steps over setThreads() workers. See Hogwild.
+        Hogwild::Report asyncSGD(double learning_rate, int max_epoch, bool UI = 1);
         void MBGD(double learning_rate, int max_epoch, int mini_batch_size, bool UI = 1);
         void Momentum(double learning_rate, int max_epoch, int mini_batch_size, double gamma, bool NAG, bool UI = 1);
         void Adagrad(double learning_rate, int max_epoch, int mini_batch_size, double e, bool UI = 1);
@@ -32,12 +48,41 @@ class ANN{
         void Adamax(double learning_rate, int max_epoch, int mini_batch_size, double b1, double b2, double e, bool UI = 1);
         void Nadam(double learning_rate, int max_epoch, int mini_batch_size, double b1, double b2, double e, bool UI = 1);
         void AMSGrad(double learning_rate, int max_epoch, int mini_batch_size, double b1, double b2, double e, bool UI = 1);
+        // Mini-batch training with any optimizer; the methods above are shorthands for it. The output and hidden
+        // layer weights are the optimizer's parameter blocks, in layer order; the biases take plain gradient steps.
+        void train(Optimizer& optimizer, double learning_rate, int max_epoch, int mini_batch_size, bool UI = 1);
+        // The same, on the batches of a stream, one pass of which is an epoch. Steps are scaled by the size of the
+        // network's training set, or of the source it was made for. For a training set in memory, a shuffled
+        // MemorySource over it has the next batch gathered while the network trains on the current one. UI ends with
+        // the stream's Timing.
+        void train(BatchStream& batches, Optimizer& optimizer, double learning_rate, int max_epoch, bool UI = 1);
         double score(); 
         void save(std::string fileName); 
 
+        // Binary checkpoint of the architecture, parameters, learning rate schedule and SGD generator, plus the moments of
+        // the optimizer when one is given. See Checkpoint.
+        void saveCheckpoint(std::string fileName, const Optimizer* optimizer = nullptr);
+        // An ANN without layers takes the saved architecture; one with layers must match it. Restoring into the
+        // optimizer the run was saved with lets train() carry on from the saved epoch.
+        bool loadCheckpoint(std::string fileName, Optimizer* optimizer = nullptr);
+
         void setLearningRateScheduler(std::string type, double decayConstant);
         void setLearningRateScheduler(std::string type, double decayConstant, double dropRate);
 
+        // Splits every batch into this many row shards whose gradients are computed concurrently on the ThreadPool
+        // and summed in shard order, so a given count always trains to the same weights. Defaults to 1.
+        void setThreads(int threads);
+
+        // Reshuffles the training set before every epoch of train() and its shorthands, drawing from the checkpointed
+        // generator. Each batch is then gathered into a scratch buffer for the GEMMs; unshuffled batches, the default,
+        // are read in place.
+        void setShuffle(bool shuffle);
+
+        // "Double", the default, or "Mixed": the forward and backward passes run in single precision on a float copy of
+        // the weights, and the gradients are widened so that the optimizer accumulates every step into the double
+        // weights. The cost and its derivative stay in double. asyncSGD always runs in double.
+        void setPrecision(std::string precision);
+
         void addLayer(int n_hidden, std::string activation, std::string weightInit = "Default", std::string reg = "None", double lambda = 0.5, double alpha = 0.5); 
         void addOutputLayer(std::string activation, std::string loss, std::string weightInit = "Default", std::string reg = "None", double lambda = 0.5, double alpha = 0.5); 
         
@@ -47,8 +92,27 @@ class ANN{
             double Cost(std::vector<double> y_hat, std::vector<double> y);
 
             void forwardPass();
-            void updateParameters(std::vector<std::vector<std::vector<double>>> hiddenLayerUpdations, std::vector<double> outputLayerUpdation, double learning_rate);
-            std::tuple<std::vector<std::vector<std::vector<double>>>, std::vector<double>> computeGradients(std::vector<double> y_hat, std::vector<double> outputSet);
+            // False, after reporting it, for a network built on a DataSource, which has no training set in memory.
+            bool hasTrainingSet() const;
+
+            // Training runs on the workspace below. A batch is the row range [begin, begin + rows) of the input set;
+            // a shard runs rows [sample, sample + rows) of the input set through rows [slot, slot + rows) of the buffers.
+            void addWorkspaceLayer(int inputs, int units, Activation::Function activation);
+            void loadWorkspace();
+            void useBatch(const BatchStream::Batch& batch);
+            void gatherBatch(const int* indices, int rows);
+            void storeWorkspace();
+            void resizeBatch(int rows);
+            void forwardBatch(int begin, int rows);
+            void forwardShard(int sample, int slot, int rows);
+            void backwardShard(int sample, int slot, int rows, int shard);
+            void forwardShardMixed(int sample, int slot, int rows);
+            void backwardShardMixed(int sample, int slot, int rows, int shard);
+            void addRegDerivTerm(int l, const Matrix& weights, Matrix& gradient);
+            void computeGradients(int begin, int rows);
+            void updateBiases(int rows, double learning_rate);
+            double batchCost(int begin, int rows);
+            void batchUI(int epoch, double cost_prev, int begin, int rows);
 
             void UI(int epoch, double cost_prev, std::vector<double> y_hat, std::vector<double> outputSet);
 
@@ -66,6 +130,63 @@ class ANN{
             std::string lrScheduler;
             double decayConstant;
             double dropRate;
+
+            int threads;
+            bool mixedPrecision;
+            bool shuffle;
+
+            std::default_random_engine generator; // Draws SGD samples; part of the checkpointed training state.
+
+            // Training state of one layer, the output layer being the last with a single unit. Every buffer holds a row
+            // per training sample and is sized when the layer is added, so a training step never allocates. A streamed
+            // network's buffers grow to the batch size on its first batch instead.
+            struct LayerWorkspace{
+                Matrix weights;
+                Vector bias;
+                Matrix z; // The output layer's is overwritten with its activation derivative during backpropagation.
+                Matrix a;
+                Matrix delta;
+                Matrix gradient;
+                std::vector<Matrix> shardGradients; // Partial gradients of shards 1 to threads - 1.
+                Activation::BufferFunction activation;
+
+                // Single precision copies of the buffers above for mixed precision training; empty otherwise.
+                struct{
+                    FloatMatrix weights;
+                    std::vector<float> bias;
+                    FloatMatrix z;
+                    FloatMatrix a;
+                    FloatMatrix delta;
+                    FloatMatrix gradient;
+                    std::vector<FloatMatrix> shardGradients;
+                } single;
+
+                // Per-worker copies of weights and bias, taken with Hogwild::load before each asyncSGD step so that no
+                // worker reads the shared parameters with plain loads while others store to them. Empty otherwise.
+                std::vector<Matrix> weightSnapshots;
+                std::vector<Vector> biasSnapshots;
+            };
+            void allocateSingle(LayerWorkspace& layer);
+
+            // The parameters the shard in slot computes with: the worker's snapshot under asyncSGD, else the layer's.
+            static const Matrix& shardWeights(const LayerWorkspace& layer, int slot){
+                return layer.weightSnapshots.empty() ? layer.weights : layer.weightSnapshots[slot];
+            }
+            static const Vector& shardBias(const LayerWorkspace& layer, int slot){
+                return layer.biasSnapshots.empty() ? layer.bias : layer.biasSnapshots[slot];
+            }
+
+            Matrix trainingInput;
+            FloatMatrix trainingInputSingle;
+            // The samples the shards read: the training set, or the batch a stream last produced.
+            const Matrix* samples;
+            const FloatMatrix* samplesSingle;
+            const double* targets;
+            Matrix batchInput;
+            FloatMatrix batchInputSingle;
+            std::vector<double> batchTargets;
+            std::vector<LayerWorkspace> workspace;
+            Cost::BufferDerivative costDerivative;
     };
 }
 
@@ -7,11 +7,179 @@
 #include <iostream>
 #include "LinAlg/LinAlg.hpp"
 #include "Activation.hpp"
+#include "VecMath/VecMath.hpp"
 #include <cmath>
 #include <algorithm>
+#include <map>
 
 namespace MLPP{
 
+    namespace {
+        // One instance per activation. Branching on deriv outside the loop lets f or f' be inlined into its own loop.
+        template <double (Activation::*F)(double, bool)>
+        void elementwise(const double* z, double* a, long n, bool deriv){
+            Activation avn;
+            if(deriv){
+                for(long i = 0; i < n; i++){
+                    a[i] = (avn.*F)(z[i], true);
+                }
+                return;
+            }
+            for(long i = 0; i < n; i++){
+                a[i] = (avn.*F)(z[i], false);
+            }
+        }
+
+        // The forward pass goes through VecMath; derivatives stay element by element.
+        template <void (*Forward)(const double*, double*, long), double (Activation::*F)(double, bool)>
+        void vectorized(const double* z, double* a, long n, bool deriv){
+            if(deriv){
+                elementwise<F>(z, a, n, true);
+                return;
+            }
+            Forward(z, a, n);
+        }
+
+        // Both derivatives follow from the forward value.
+        void sigmoidBuffer(const double* z, double* a, long n, bool deriv){
+            VecMath::sigmoid(z, a, n);
+            if(deriv){
+                for(long i = 0; i < n; i++){
+                    a[i] -= a[i] * a[i];
+                }
+            }
+        }
+
+        void tanhBuffer(const double* z, double* a, long n, bool deriv){
+            VecMath::tanh(z, a, n);
+            if(deriv){
+                for(long i = 0; i < n; i++){
+                    a[i] = 1 - a[i] * a[i];
+                }
+            }
+        }
+
+        void softplusBuffer(const double* z, double* a, long n, bool deriv){
+            if(deriv){
+                sigmoidBuffer(z, a, n, false);
+                return;
+            }
+            VecMath::softplus(z, a, n);
+        }
+    }
+
+    namespace {
+        const std::map<std::string, Activation::Function>& functionNames(){
+            typedef Activation::Function Function;
+            static const std::map<std::string, Function> functions = {
+                {"Linear", Function::Linear},
+                {"Sigmoid", Function::Sigmoid},
+                {"Softmax", Function::Softmax},
+                {"Swish", Function::Swish},
+                {"Mish", Function::Mish},
+                {"SinC", Function::SinC},
+                {"Softplus", Function::Softplus},
+                {"Softsign", Function::Softsign},
+                {"CLogLog", Function::CLogLog},
+                {"Logit", Function::Logit},
+                {"GaussianCDF", Function::GaussianCDF},
+                {"RELU", Function::RELU},
+                {"GELU", Function::GELU},
+                {"Sign", Function::Sign},
+                {"UnitStep", Function::UnitStep},
+                {"Sinh", Function::Sinh},
+                {"Cosh", Function::Cosh},
+                {"Tanh", Function::Tanh},
+                {"Csch", Function::Csch},
+                {"Sech", Function::Sech},
+                {"Coth", Function::Coth},
+                {"Arsinh", Function::Arsinh},
+                {"Arcosh", Function::Arcosh},
+                {"Artanh", Function::Artanh},
+                {"Arcsch", Function::Arcsch},
+                {"Arsech", Function::Arsech},
+                {"Arcoth", Function::Arcoth}
+            };
+            return functions;
+        }
+    }
+
+    Activation::Function Activation::function(const std::string& name){
+        const std::map<std::string, Function>& functions = functionNames();
+        auto it = functions.find(name);
+        if(it == functions.end()){
+            std::cout << "Unknown activation function " << name << ", using Linear." << std::endl;
+            return Function::Linear;
+        }
+        return it->second;
+    }
+
+    Activation::BufferFunction Activation::bufferFunction(Function f){
+        switch(f){
+            case Function::Linear: return elementwise<&Activation::linear>;
+            case Function::Sigmoid: return sigmoidBuffer;
+            case Function::Softmax: return nullptr;
+            case Function::Swish: return vectorized<VecMath::swish, &Activation::swish>;
+            case Function::Mish: return vectorized<VecMath::mish, &Activation::mish>;
+            case Function::SinC: return elementwise<&Activation::sinc>;
+            case Function::Softplus: return softplusBuffer;
+            case Function::Softsign: return elementwise<&Activation::softsign>;
+            case Function::CLogLog: return elementwise<&Activation::cloglog>;
+            case Function::Logit: return elementwise<&Activation::logit>;
+            case Function::GaussianCDF: return elementwise<&Activation::gaussianCDF>;
+            case Function::RELU: return elementwise<&Activation::RELU>;
+            case Function::GELU: return vectorized<VecMath::GELU, &Activation::GELU>;
+            case Function::Sign: return elementwise<&Activation::sign>;
+            case Function::UnitStep: return elementwise<&Activation::unitStep>;
+            case Function::Sinh: return elementwise<&Activation::sinh>;
+            case Function::Cosh: return elementwise<&Activation::cosh>;
+            case Function::Tanh: return tanhBuffer;
+            case Function::Csch: return elementwise<&Activation::csch>;
+            case Function::Sech: return elementwise<&Activation::sech>;
+            case Function::Coth: return elementwise<&Activation::coth>;
+            case Function::Arsinh: return elementwise<&Activation::arsinh>;
+            case Function::Arcosh: return elementwise<&Activation::arcosh>;
+            case Function::Artanh: return elementwise<&Activation::artanh>;
+            case Function::Arcsch: return elementwise<&Activation::arcsch>;
+            case Function::Arsech: return elementwise<&Activation::arsech>;
+            case Function::Arcoth: return elementwise<&Activation::arcoth>;
+        }
+        return nullptr;
+    }
+
+    Activation::BufferFunction Activation::bufferFunction(const std::string& name){
+        auto it = functionNames().find(name);
+        return it == functionNames().end() ? nullptr : bufferFunction(it->second);
+    }
+
+    double Activation::apply(Function f, double z, bool deriv){
+        if(f == Function::Softmax){
+            return softmax(std::vector<double>{z}, deriv)[0];
+        }
+        double a;
+        bufferFunction(f)(&z, &a, 1, deriv);
+        return a;
+    }
+
+    std::vector<double> Activation::apply(Function f, std::vector<double> z, bool deriv){
+        if(f == Function::Softmax){
+            return softmax(z, deriv);
+        }
+        bufferFunction(f)(z.data(), z.data(), z.size(), deriv);
+        return z;
+    }
+
+    std::vector<std::vector<double>> Activation::apply(Function f, std::vector<std::vector<double>> z, bool deriv){
+        if(f == Function::Softmax){
+            return softmax(z, deriv);
+        }
+        BufferFunction kernel = bufferFunction(f);
+        for(int i = 0; i < z.size(); i++){
+            kernel(z[i].data(), z[i].data(), z[i].size(), deriv);
+        }
+        return z;
+    }
+
     double Activation::linear(double z, bool deriv){
         if(deriv){ return 1; }
         return z; 
@@ -40,15 +208,20 @@ namespace MLPP{
     }
 
     std::vector<double> Activation::sigmoid(std::vector<double> z, bool deriv){
-        LinAlg alg;
-        if(deriv) { return alg.subtraction(sigmoid(z), alg.hadamard_product(sigmoid(z), sigmoid(z))); }
-        return alg.elementWiseDivision(alg.onevec(z.size()), alg.addition(alg.onevec(z.size()), alg.exp(alg.scalarMultiply(-1, z))));
+        VecMath::sigmoid(z.data(), z.data(), z.size());
+        if(deriv){
+            for(int i = 0; i < z.size(); i++){
+                z[i] -= z[i] * z[i];
+            }
+        }
+        return z;
     }
 
     std::vector<std::vector<double>> Activation::sigmoid(std::vector<std::vector<double>> z, bool deriv){
-        LinAlg alg;
-        if(deriv) { return alg.subtraction(sigmoid(z), alg.hadamard_product(sigmoid(z), sigmoid(z))); }
-        return alg.elementWiseDivision(alg.onemat(z.size(), z[0].size()), alg.addition(alg.onemat(z.size(), z[0].size()), alg.exp(alg.scalarMultiply(-1, z))));
+        for(int i = 0; i < z.size(); i++){
+            z[i] = sigmoid(z[i], deriv);
+        }
+        return z;
     }
 
     std::vector<double> Activation::softmax(std::vector<double> z, bool deriv){
@@ -148,14 +321,16 @@ namespace MLPP{
             
     std::vector<double> Activation::softplus(std::vector<double> z, bool deriv){
         if(deriv) { return sigmoid(z); }
-        LinAlg alg;
-        return alg.log(alg.addition(alg.onevec(z.size()), alg.exp(z)));
+        VecMath::softplus(z.data(), z.data(), z.size());
+        return z;
     }
     
     std::vector<std::vector<double>> Activation::softplus(std::vector<std::vector<double>>  z, bool deriv){
         if(deriv) { return sigmoid(z); }
-        LinAlg alg;
-        return alg.log(alg.addition(alg.onemat(z.size(), z[0].size()), alg.exp(z)));
+        for(int i = 0; i < z.size(); i++){
+            VecMath::softplus(z[i].data(), z[i].data(), z[i].size());
+        }
+        return z;
     }
 
     double Activation::softsign(double z, bool deriv){
@@ -295,7 +470,8 @@ namespace MLPP{
         if(deriv){
             alg.addition(swish(z), alg.subtraction(sigmoid(z), alg.hadamard_product(sigmoid(z), swish(z))));
         }
-        return alg.hadamard_product(z, sigmoid(z));
+        VecMath::swish(z.data(), z.data(), z.size());
+        return z;
     }
 
     std::vector<std::vector<double>> Activation::swish(std::vector<std::vector<double>> z, bool deriv){
@@ -303,7 +479,10 @@ namespace MLPP{
         if(deriv){
             alg.addition(swish(z), alg.subtraction(sigmoid(z), alg.hadamard_product(sigmoid(z), swish(z))));
         }
-        return alg.hadamard_product(z, sigmoid(z));
+        for(int i = 0; i < z.size(); i++){
+            VecMath::swish(z[i].data(), z[i].data(), z[i].size());
+        }
+        return z;
     }
 
     double Activation::mish(double z, bool deriv){
@@ -318,7 +497,8 @@ namespace MLPP{
         if(deriv){
             return alg.addition(alg.hadamard_product(alg.hadamard_product(alg.hadamard_product(sech(softplus(z)), sech(softplus(z))), z), sigmoid(z)), alg.elementWiseDivision(mish(z), z));
         }
-        return alg.hadamard_product(z, tanh(softplus(z)));
+        VecMath::mish(z.data(), z.data(), z.size());
+        return z;
     }
 
     std::vector<std::vector<double>> Activation::mish(std::vector<std::vector<double>> z, bool deriv){
@@ -326,7 +506,10 @@ namespace MLPP{
         if(deriv){
             return alg.addition(alg.hadamard_product(alg.hadamard_product(alg.hadamard_product(sech(softplus(z)), sech(softplus(z))), z), sigmoid(z)), alg.elementWiseDivision(mish(z), z));
         }
-        return alg.hadamard_product(z, tanh(softplus(z)));
+        for(int i = 0; i < z.size(); i++){
+            VecMath::mish(z[i].data(), z[i].data(), z[i].size());
+        }
+        return z;
     }
 
     double Activation::sinc(double z, bool deriv){
@@ -561,13 +744,8 @@ namespace MLPP{
             }
             return deriv;
         }
-        std::vector<double> a; 
-        a.resize(z.size());
-
-        for(int i = 0; i < a.size(); i++){
-            a[i] = GELU(z[i]);
-        }
-        return a;
+        VecMath::GELU(z.data(), z.data(), z.size());
+        return z;
     }
 
     std::vector<std::vector<double>> Activation::GELU(std::vector<std::vector<double>> z, bool deriv){
@@ -679,20 +857,20 @@ namespace MLPP{
     }
 
     std::vector<double> Activation::tanh(std::vector<double> z, bool deriv){
-        LinAlg alg;
-        if(deriv){ 
-            return alg.scalarMultiply(-1, alg.scalarAdd(-1, alg.hadamard_product(tanh(z), tanh(z)))); 
+        VecMath::tanh(z.data(), z.data(), z.size());
+        if(deriv){
+            for(int i = 0; i < z.size(); i++){
+                z[i] = 1 - z[i] * z[i];
+            }
         }
-        return alg.elementWiseDivision(alg.subtraction(alg.exp(z), alg.exp(alg.scalarMultiply(-1, z))), alg.addition(alg.exp(z), alg.exp(alg.scalarMultiply(-1, z))));
+        return z;
     }
 
     std::vector<std::vector<double>> Activation::tanh(std::vector<std::vector<double>> z, bool deriv){
-        LinAlg alg;
-        if(deriv){ 
-            return alg.scalarMultiply(-1, alg.scalarAdd(-1, alg.hadamard_product(tanh(z), tanh(z)))); 
+        for(int i = 0; i < z.size(); i++){
+            z[i] = tanh(z[i], deriv);
         }
-
-        return alg.elementWiseDivision(alg.subtraction(alg.exp(z), alg.exp(alg.scalarMultiply(-1, z))), alg.addition(alg.exp(z), alg.exp(alg.scalarMultiply(-1, z))));
+        return z;
     }
 
     double Activation::csch(double z, bool deriv){
@@ -8,10 +8,31 @@
 #define Activation_hpp
 
 #include <vector>
+#include <string>
 
 namespace MLPP{
     class Activation{
         public:
+            // Allocation-free form used by the training workspaces: a[i] = f(z[i]), or f'(z[i]) when deriv is set, over
+            // n contiguous values. a may alias z. Looked up once by the names the layer maps use; nullptr if unknown.
+            typedef void (*BufferFunction)(const double* z, double* a, long n, bool deriv);
+            static BufferFunction bufferFunction(const std::string& name);
+
+            // The activations a layer can be built with. Layers resolve their name to one of these once, when they are
+            // constructed, and each maps to a kernel specialized for that function.
+            enum class Function { Linear, Sigmoid, Softmax, Swish, Mish, SinC, Softplus, Softsign, CLogLog, Logit, GaussianCDF, RELU, GELU, Sign, UnitStep, Sinh, Cosh, Tanh, Csch, Sech, Coth, Arsinh, Arcosh, Artanh, Arcsch, Arsech, Arcoth };
+
+            // Unknown names are reported and fall back to Linear.
+            static Function function(const std::string& name);
+
+            // nullptr for Softmax, which is not element-wise.
+            static BufferFunction bufferFunction(Function f);
+
+            // f, or f' when deriv is set, through the kernel for f. Softmax is applied a row at a time and ignores deriv.
+            double apply(Function f, double z, bool deriv = 0);
+            std::vector<double> apply(Function f, std::vector<double> z, bool deriv = 0);
+            std::vector<std::vector<double>> apply(Function f, std::vector<std::vector<double>> z, bool deriv = 0);
+
             double linear(double z, bool deriv = 0); 
             std::vector<double> linear(std::vector<double> z, bool deriv = 0);
             std::vector<std::vector<double>> linear(std::vector<std::vector<double>> z, bool deriv = 0);
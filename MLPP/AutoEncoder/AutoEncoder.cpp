@@ -9,6 +9,7 @@
 #include "LinAlg/LinAlg.hpp"
 #include "Utilities/Utilities.hpp"
 #include "Cost/Cost.hpp"
+#include "Checkpoint/Checkpoint.hpp"
 
 #include <iostream>
 #include <random>
@@ -48,7 +49,7 @@ namespace MLPP {
             std::vector<std::vector<double>> error = alg.subtraction(y_hat, inputSet);
                     
             // Calculating the weight/bias gradients for layer 2
-            std::vector<std::vector<double>> D2_1 = alg.matmult(alg.transpose(a2), error);
+            std::vector<std::vector<double>> D2_1 = alg.transposeMatmult(a2, error);
 
             // weights and bias updation for layer 2
             weights2 = alg.subtraction(weights2, alg.scalarMultiply(learning_rate/n, D2_1));
@@ -58,11 +59,11 @@ namespace MLPP {
 
             //Calculating the weight/bias for layer 1
 
-            std::vector<std::vector<double>> D1_1 = alg.matmult(error, alg.transpose(weights2));
+            std::vector<std::vector<double>> D1_1 = alg.matmultTranspose(error, weights2);
 
             std::vector<std::vector<double>> D1_2 = alg.hadamard_product(D1_1, avn.sigmoid(z2, 1));
 
-            std::vector<std::vector<double>> D1_3 = alg.matmult(alg.transpose(inputSet), D1_2);
+            std::vector<std::vector<double>> D1_3 = alg.transposeMatmult(inputSet, D1_2);
 
 
             // weight an bias updation for layer 1
@@ -157,7 +158,7 @@ namespace MLPP {
                         
                 // Calculating the weight/bias gradients for layer 2
 
-                std::vector<std::vector<double>> D2_1 = alg.matmult(alg.transpose(a2), error);
+                std::vector<std::vector<double>> D2_1 = alg.transposeMatmult(a2, error);
 
                 // weights and bias updation for layer 2
                 weights2 = alg.subtraction(weights2, alg.scalarMultiply(learning_rate/inputMiniBatches[i].size(), D2_1));
@@ -167,11 +168,11 @@ namespace MLPP {
 
                 //Calculating the weight/bias for layer 1
 
-                std::vector<std::vector<double>> D1_1 = alg.matmult(error, alg.transpose(weights2));
+                std::vector<std::vector<double>> D1_1 = alg.matmultTranspose(error, weights2);
 
                 std::vector<std::vector<double>> D1_2 = alg.hadamard_product(D1_1, avn.sigmoid(z2, 1));
 
-                std::vector<std::vector<double>> D1_3 = alg.matmult(alg.transpose(inputMiniBatches[i]), D1_2);
+                std::vector<std::vector<double>> D1_3 = alg.transposeMatmult(inputMiniBatches[i], D1_2);
 
 
                 // weight an bias updation for layer 1
@@ -206,6 +207,35 @@ namespace MLPP {
          util.saveParameters(fileName, weights2, bias2, 1, 2);
      }
 
+    void AutoEncoder::saveCheckpoint(std::string fileName){
+        Checkpoint::Writer writer("AutoEncoder");
+        writer.add("weights1", weights1);
+        writer.add("bias1", bias1);
+        writer.add("weights2", weights2);
+        writer.add("bias2", bias2);
+        writer.write(fileName);
+    }
+
+    bool AutoEncoder::loadCheckpoint(std::string fileName){
+        Checkpoint checkpoint(fileName);
+        if(!checkpoint.valid()){ return false; }
+        if(checkpoint.kind() != "AutoEncoder"){
+            std::cout << fileName << " is not an AutoEncoder checkpoint." << std::endl;
+            return false;
+        }
+        if(checkpoint.rows("weights1") != weights1.size() || checkpoint.cols("weights1") != n_hidden || checkpoint.cols("bias1") != bias1.size()
+        || checkpoint.rows("weights2") != weights2.size() || checkpoint.cols("weights2") != weights2[0].size() || checkpoint.cols("bias2") != bias2.size()){
+            std::cout << "The shapes in " << fileName << " do not match this network." << std::endl;
+            return false;
+        }
+        weights1 = checkpoint.matrix("weights1");
+        bias1 = checkpoint.vector("bias1");
+        weights2 = checkpoint.matrix("weights2");
+        bias2 = checkpoint.vector("bias2");
+        forwardPass();
+        return true;
+    }
+
     double AutoEncoder::Cost(std::vector<std::vector<double>> y_hat, std::vector<std::vector<double>> y){
         class Cost cost; 
         return cost.MSE(y_hat, inputSet);
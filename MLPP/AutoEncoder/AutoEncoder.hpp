@@ -23,6 +23,10 @@ class AutoEncoder{
         void MBGD(double learning_rate, int max_epoch, int mini_batch_size, bool UI = 1);
         double score(); 
         void save(std::string fileName);
+
+        // Binary checkpoint of the parameters; see Checkpoint. The network must have been built with the same shape.
+        void saveCheckpoint(std::string fileName);
+        bool loadCheckpoint(std::string fileName);
         
         private:
             double Cost(std::vector<std::vector<double>> y_hat, std::vector<std::vector<double>> y);
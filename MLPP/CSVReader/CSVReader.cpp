@@ -0,0 +1,226 @@
+//
+//  CSVReader.cpp
+//
+//  Memory-mapped, parallel reader for numeric CSV files.
+//
+
+#include "CSVReader.hpp"
+#include "ThreadPool/ThreadPool.hpp"
+#include <algorithm>
+#include <charconv>
+#include <climits>
+#include <cstring>
+#include <fstream>
+#include <iostream>
+#include <iterator>
+
+#if defined(__unix__) || defined(__APPLE__)
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#define MLPP_CSV_MMAP
+#endif
+
+namespace MLPP{
+    namespace {
+        // Chunks are cut at the first line break past every CHUNK_BYTES, with a few chunks per thread so uneven lines
+        // still balance.
+        const long CHUNK_BYTES = 1 << 16;
+        const int CHUNKS_PER_THREAD = 4;
+        const int MAX_REPORTED = 10;
+
+        const char* skipSpace(const char* p, const char* end){
+            while(p < end && (*p == ' ' || *p == '\t')){ p++; }
+            return p;
+        }
+
+        const double POWERS_OF_TEN[] = {1e0, 1e1, 1e2, 1e3, 1e4, 1e5, 1e6, 1e7, 1e8, 1e9, 1e10, 1e11,
+                                        1e12, 1e13, 1e14, 1e15, 1e16, 1e17, 1e18, 1e19, 1e20, 1e21, 1e22};
+
+        // Plain decimals with at most 15 digits are an exact integer divided by an exact power of ten, so one division
+        // rounds them correctly. Everything else (exponents, long mantissas, inf and nan) goes to std::from_chars.
+        std::from_chars_result parseNumber(const char* p, const char* end, double& value){
+            const char* q = p;
+            bool negative = q < end && *q == '-';
+            if(negative){ q++; }
+            unsigned long long mantissa = 0;
+            int digits = 0;
+            int decimals = 0;
+            for(; q < end && *q >= '0' && *q <= '9'; q++, digits++){ mantissa = mantissa * 10 + (*q - '0'); }
+            if(q < end && *q == '.'){
+                for(q++; q < end && *q >= '0' && *q <= '9'; q++, digits++, decimals++){ mantissa = mantissa * 10 + (*q - '0'); }
+            }
+            if(digits == 0 || digits > 15 || (q < end && (*q == 'e' || *q == 'E'))){
+                return std::from_chars(p, end, value);
+            }
+            value = (double)mantissa / POWERS_OF_TEN[decimals];
+            if(negative){ value = -value; }
+            return {q, std::errc()};
+        }
+    }
+
+    CSVReader::Line CSVReader::parseLine(const char* p, const char* end, int cols, double* out){
+        if(end > p && end[-1] == '\r'){ end--; }
+        if(skipSpace(p, end) == end){ return Line::Blank; }
+        for(int j = 0; j < cols; j++){
+            if(p == end){ return Line::TooFewFields; }
+            p = skipSpace(p, end);
+            if(p < end && *p == '+'){ p++; }
+            std::from_chars_result result = parseNumber(p, end, out[j]);
+            if(result.ec != std::errc()){ return Line::NotANumber; }
+            p = skipSpace(result.ptr, end);
+            if(p < end){
+                if(*p != ','){ return Line::NotANumber; }
+                p++;
+            }
+            else if(j < cols - 1){ return Line::TooFewFields; }
+        }
+        return Line::Parsed;
+    }
+
+    std::string CSVReader::describe(Line status, int cols){
+        return status == Line::TooFewFields ? "expected " + std::to_string(cols) + " fields." : "field is not a number.";
+    }
+
+    CSVReader::CSVReader(const std::string& fileName)
+    : fileName(fileName), base(nullptr), length(0), mapped(false), isValid(false)
+    {
+        #ifdef MLPP_CSV_MMAP
+        int fd = open(fileName.c_str(), O_RDONLY);
+        if(fd >= 0){
+            isValid = true;
+            struct stat info;
+            if(fstat(fd, &info) == 0 && info.st_size > 0){
+                void* p = mmap(nullptr, info.st_size, PROT_READ, MAP_PRIVATE, fd, 0);
+                if(p != MAP_FAILED){
+                    base = static_cast<const char*>(p);
+                    length = info.st_size;
+                    mapped = true;
+                    #ifdef MADV_SEQUENTIAL
+                    madvise(p, info.st_size, MADV_SEQUENTIAL);
+                    #endif
+                }
+            }
+            close(fd);
+        }
+        #endif
+        if(!mapped){
+            std::ifstream file(fileName, std::ios::binary);
+            isValid = file.is_open();
+            buffer.assign(std::istreambuf_iterator<char>(file), std::istreambuf_iterator<char>());
+            base = buffer.data();
+            length = buffer.size();
+        }
+    }
+
+    CSVReader::~CSVReader(){
+        #ifdef MLPP_CSV_MMAP
+        if(mapped){
+            munmap(const_cast<char*>(base), length);
+        }
+        #endif
+    }
+
+    int CSVReader::fields() const{
+        const char* p = base;
+        const char* end = base + length;
+        while(p < end){
+            const void* lineBreak = std::memchr(p, '\n', end - p);
+            const char* lineEnd = lineBreak ? static_cast<const char*>(lineBreak) : end;
+            if(lineEnd > p && lineEnd[-1] == '\r'){ lineEnd--; }
+            if(skipSpace(p, lineEnd) != lineEnd){ return 1 + std::count(p, lineEnd, ','); }
+            if(!lineBreak){ break; }
+            p = static_cast<const char*>(lineBreak) + 1;
+        }
+        return 0;
+    }
+
+    bool CSVReader::read(int cols, Matrix& out){
+        malformed.clear();
+        if(!isValid){
+            std::cout << fileName << " failed to open." << std::endl;
+            out.resize(0, cols);
+            return false;
+        }
+
+        // Chunk c covers [starts[c], starts[c + 1]), and every chunk but the first begins just after a line break.
+        long chunkBytes = std::max(CHUNK_BYTES, length / ((long)ThreadPool::numThreads() * CHUNKS_PER_THREAD) + 1);
+        std::vector<long> starts = {0};
+        while(starts.back() < length){
+            long next = starts.back() + chunkBytes;
+            if(next >= length){
+                starts.push_back(length);
+                break;
+            }
+            const void* lineBreak = std::memchr(base + next, '\n', length - next);
+            starts.push_back(lineBreak ? static_cast<const char*>(lineBreak) - base + 1 : length);
+        }
+        long chunks = starts.size() - 1;
+
+        // First pass: count the lines in each chunk so that every line knows its row before any is parsed.
+        std::vector<long> firstLine(chunks + 1, 0);
+        auto countLines = [&](long begin, long end){
+            for(long c = begin; c < end; c++){
+                const char* p = base + starts[c];
+                const char* stop = base + starts[c + 1];
+                long count = 0;
+                while(p < stop){
+                    const void* lineBreak = std::memchr(p, '\n', stop - p);
+                    count++;
+                    if(!lineBreak){ break; }
+                    p = static_cast<const char*>(lineBreak) + 1;
+                }
+                firstLine[c + 1] = count;
+            }
+        };
+        ThreadPool::parallelFor(chunks, 1, std::cref(countLines));
+        for(long c = 0; c < chunks; c++){ firstLine[c + 1] += firstLine[c]; }
+        long lines = firstLine[chunks];
+
+        // A Matrix indexes its rows, and counts its elements, with an int.
+        if(lines > INT_MAX || lines * cols > INT_MAX){
+            std::cout << fileName << ": " << lines << " lines of " << cols << " fields are too many for one matrix." << std::endl;
+            out.resize(0, cols);
+            return false;
+        }
+
+        // Second pass: parse every line straight into its own row.
+        out.resize(lines, cols);
+        std::vector<Line> status(lines);
+        auto parseChunks = [&](long begin, long end){
+            for(long c = begin; c < end; c++){
+                const char* p = base + starts[c];
+                const char* stop = base + starts[c + 1];
+                for(long line = firstLine[c]; p < stop; line++){
+                    const void* lineBreak = std::memchr(p, '\n', stop - p);
+                    const char* lineEnd = lineBreak ? static_cast<const char*>(lineBreak) : stop;
+                    status[line] = parseLine(p, lineEnd, cols, out.row(line));
+                    if(!lineBreak){ break; }
+                    p = lineEnd + 1;
+                }
+            }
+        };
+        ThreadPool::parallelFor(chunks, 1, std::cref(parseChunks));
+
+        // Close the gaps left by blank and malformed lines.
+        long kept = 0;
+        for(long line = 0; line < lines; line++){
+            if(status[line] == Line::Parsed){
+                if(kept != line){ std::memcpy(out.row(kept), out.row(line), cols * sizeof(double)); }
+                kept++;
+            }
+            else if(status[line] != Line::Blank){
+                if(malformed.size() < MAX_REPORTED){
+                    std::cout << fileName << ":" << line + 1 << ": " << describe(status[line], cols) << std::endl;
+                }
+                malformed.push_back(line + 1);
+            }
+        }
+        if(malformed.size() > MAX_REPORTED){
+            std::cout << fileName << ": " << malformed.size() - MAX_REPORTED << " more malformed lines." << std::endl;
+        }
+        out.resize(kept, cols);
+        return true;
+    }
+}
@@ -0,0 +1,58 @@
+//
+//  CSVReader.hpp
+//
+//  Memory-mapped, parallel reader for numeric CSV files.
+//
+
+#ifndef CSVReader_hpp
+#define CSVReader_hpp
+
+#include "Matrix/Matrix.hpp"
+#include <string>
+#include <vector>
+
+namespace MLPP{
+    // Reads files of comma-separated numbers, such as the ones Data::setData loads. The file is memory-mapped (read into
+    // memory where mmap is unavailable), cut into chunks on line boundaries, and the chunks are parsed on the ThreadPool
+    // straight into the rows of a Matrix.
+    class CSVReader{
+        public:
+            enum class Line : char { Parsed, Blank, TooFewFields, NotANumber };
+
+            // Parses the first cols fields of the line [begin, end), which may end in "\r", into out.
+            static Line parseLine(const char* begin, const char* end, int cols, double* out);
+            // Why read() left out a line with the given status, such as "expected 3 fields.".
+            static std::string describe(Line status, int cols);
+
+            explicit CSVReader(const std::string& fileName);
+            ~CSVReader();
+            CSVReader(const CSVReader&) = delete;
+            CSVReader& operator=(const CSVReader&) = delete;
+
+            // False if the file could not be opened.
+            bool valid() const { return isValid; }
+
+            // Reads the first cols fields of every line into a row of out, in file order. Fields after the first cols are
+            // ignored and blank lines are skipped. A line with fewer fields or with a field that is not a number is left out
+            // and reported with its line number. Returns false, with out empty, if the file could not be read or its lines
+            // would hold more than INT_MAX values.
+            bool read(int cols, Matrix& out);
+
+            // The number of fields on the first line that is not blank, 0 for an empty file.
+            int fields() const;
+
+            // 1-based numbers of the lines the last read() left out.
+            const std::vector<long>& malformedLines() const { return malformed; }
+
+        private:
+            std::string fileName;
+            const char* base;
+            long length;
+            bool mapped;
+            bool isValid;
+            std::vector<char> buffer; // The file's bytes when it could not be mapped.
+            std::vector<long> malformed;
+    };
+}
+
+#endif /* CSVReader_hpp */
@@ -0,0 +1,287 @@
+//
+//  Checkpoint.cpp
+//
+//  Versioned binary model checkpoints, memory-mapped when they are read.
+//
+
+#include "Checkpoint.hpp"
+#include <cstring>
+#include <fstream>
+#include <iostream>
+#include <iterator>
+
+#if defined(__unix__) || defined(__APPLE__)
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#define MLPP_CHECKPOINT_MMAP
+#endif
+
+namespace MLPP{
+    namespace {
+        // Layout: the header, then each section's bytes at a 64 byte aligned offset, then the directory, which holds a
+        // Record and the name for every section. The header records where the directory starts.
+        const char MAGIC[8] = {'M', 'L', 'P', 'P', 'C', 'K', 'P', 'T'};
+        const uint32_t ENDIANNESS = 0x01020304;
+        const uint64_t ALIGNMENT = 64;
+
+        const uint32_t DOUBLES = 1;
+        const uint32_t TEXT = 2;
+
+        struct Header{
+            char magic[8];
+            uint32_t version;
+            uint32_t byteOrder;
+            uint64_t sections;
+            uint64_t directory;
+        };
+
+        struct Record{
+            uint32_t type;
+            uint32_t nameLength;
+            int64_t rows;
+            int64_t cols;
+            uint64_t offset;
+            uint64_t bytes;
+        };
+
+        uint64_t align(uint64_t offset, uint64_t alignment){
+            return (offset + alignment - 1) / alignment * alignment;
+        }
+    }
+
+    Checkpoint::Writer::Writer(const std::string& kind){
+        add("kind", kind);
+    }
+
+    Checkpoint::Writer::Section& Checkpoint::Writer::section(const std::string& name){
+        for(auto& section : sections){
+            if(section.name == name){
+                section = Section();
+                section.name = name;
+                return section;
+            }
+        }
+        sections.push_back(Section());
+        sections.back().name = name;
+        return sections.back();
+    }
+
+    void Checkpoint::Writer::add(const std::string& name, const double* data, long rows, long cols){
+        Section& s = section(name);
+        s.type = DOUBLES;
+        s.rows = rows;
+        s.cols = cols;
+        s.data = data;
+    }
+
+    void Checkpoint::Writer::add(const std::string& name, const std::vector<double>& v){
+        add(name, v.data(), 1, v.size());
+    }
+
+    void Checkpoint::Writer::add(const std::string& name, const std::vector<std::vector<double>>& A){
+        Section& s = section(name);
+        s.type = DOUBLES;
+        s.rows = A.size();
+        s.cols = A.empty() ? 0 : A[0].size();
+        s.data = nullptr;
+        s.values.reserve(s.rows * s.cols);
+        for(const auto& row : A){
+            s.values.insert(s.values.end(), row.begin(), row.end());
+        }
+    }
+
+    void Checkpoint::Writer::add(const std::string& name, double value){
+        Section& s = section(name);
+        s.type = DOUBLES;
+        s.rows = 1;
+        s.cols = 1;
+        s.data = nullptr;
+        s.values.assign(1, value);
+    }
+
+    void Checkpoint::Writer::add(const std::string& name, const std::string& text){
+        Section& s = section(name);
+        s.type = TEXT;
+        s.rows = 1;
+        s.cols = text.size();
+        s.data = nullptr;
+        s.text = text;
+    }
+
+    bool Checkpoint::Writer::write(const std::string& fileName) const{
+        // Every offset is known up front, so the file is written front to back in a single pass.
+        std::vector<Record> records(sections.size());
+        uint64_t offset = sizeof(Header);
+        for(int i = 0; i < sections.size(); i++){
+            const Section& s = sections[i];
+            offset = align(offset, ALIGNMENT);
+            records[i].type = s.type;
+            records[i].nameLength = s.name.size();
+            records[i].rows = s.rows;
+            records[i].cols = s.cols;
+            records[i].offset = offset;
+            records[i].bytes = s.type == TEXT ? s.text.size() : s.rows * s.cols * sizeof(double);
+            offset += records[i].bytes;
+        }
+        Header header;
+        std::memcpy(header.magic, MAGIC, sizeof(MAGIC));
+        header.version = VERSION;
+        header.byteOrder = ENDIANNESS;
+        header.sections = sections.size();
+        header.directory = align(offset, 8);
+
+        std::ofstream file(fileName, std::ios::binary | std::ios::trunc);
+        if(!file){
+            std::cout << "Could not open " << fileName << " for writing." << std::endl;
+            return false;
+        }
+        const char zeros[ALIGNMENT] = {};
+        uint64_t position = 0;
+        auto pad = [&](uint64_t to){
+            file.write(zeros, to - position);
+            position = to;
+        };
+        file.write(reinterpret_cast<const char*>(&header), sizeof(header));
+        position = sizeof(header);
+        for(int i = 0; i < sections.size(); i++){
+            const Section& s = sections[i];
+            pad(records[i].offset);
+            const char* bytes = s.type == TEXT ? s.text.data() : reinterpret_cast<const char*>(s.data ? s.data : s.values.data());
+            file.write(bytes, records[i].bytes);
+            position += records[i].bytes;
+        }
+        pad(header.directory);
+        for(int i = 0; i < sections.size(); i++){
+            file.write(reinterpret_cast<const char*>(&records[i]), sizeof(Record));
+            file.write(sections[i].name.data(), sections[i].name.size());
+        }
+        if(!file.good()){
+            std::cout << "Could not write " << fileName << "." << std::endl;
+            return false;
+        }
+        return true;
+    }
+
+    Checkpoint::Checkpoint(const std::string& fileName)
+    : base(nullptr), length(0), mapped(false), isValid(false)
+    {
+        #ifdef MLPP_CHECKPOINT_MMAP
+        int fd = open(fileName.c_str(), O_RDONLY);
+        if(fd >= 0){
+            struct stat info;
+            if(fstat(fd, &info) == 0 && info.st_size > 0){
+                void* p = mmap(nullptr, info.st_size, PROT_READ, MAP_PRIVATE, fd, 0);
+                if(p != MAP_FAILED){
+                    base = static_cast<const char*>(p);
+                    length = info.st_size;
+                    mapped = true;
+                }
+            }
+            close(fd);
+        }
+        #endif
+        if(!mapped){
+            std::ifstream file(fileName, std::ios::binary);
+            buffer.assign(std::istreambuf_iterator<char>(file), std::istreambuf_iterator<char>());
+            base = buffer.data();
+            length = buffer.size();
+        }
+        isValid = parse(fileName);
+    }
+
+    Checkpoint::~Checkpoint(){
+        #ifdef MLPP_CHECKPOINT_MMAP
+        if(mapped){
+            munmap(const_cast<char*>(base), length);
+        }
+        #endif
+    }
+
+    bool Checkpoint::parse(const std::string& fileName){
+        Header header;
+        if(length < sizeof(Header)){
+            std::cout << "Could not read checkpoint " << fileName << "." << std::endl;
+            return false;
+        }
+        std::memcpy(&header, base, sizeof(Header));
+        if(std::memcmp(header.magic, MAGIC, sizeof(MAGIC)) != 0 || header.byteOrder != ENDIANNESS){
+            std::cout << fileName << " is not a checkpoint written on this platform." << std::endl;
+            return false;
+        }
+        if(header.version != VERSION){
+            std::cout << fileName << " is a version " << header.version << " checkpoint; only version " << VERSION << " can be read." << std::endl;
+            return false;
+        }
+
+        uint64_t position = header.directory;
+        for(uint64_t i = 0; i < header.sections; i++){
+            Record record;
+            if(position > length || length - position < sizeof(Record)){ break; }
+            std::memcpy(&record, base + position, sizeof(Record));
+            position += sizeof(Record);
+            if(length - position < record.nameLength || record.offset > length || length - record.offset < record.bytes){ break; }
+            if(record.type == DOUBLES && (record.rows < 0 || record.cols < 0 || record.bytes != uint64_t(record.rows * record.cols) * sizeof(double))){ break; }
+            std::string name(base + position, record.nameLength);
+            position += record.nameLength;
+            sections[name] = {record.type, (long)record.rows, (long)record.cols, base + record.offset};
+        }
+        if(sections.size() != header.sections){
+            std::cout << "Checkpoint " << fileName << " is truncated or corrupt." << std::endl;
+            sections.clear();
+            return false;
+        }
+        modelKind = text("kind");
+        return true;
+    }
+
+    const Checkpoint::Entry* Checkpoint::find(const std::string& name, uint32_t type) const{
+        auto it = sections.find(name);
+        return it == sections.end() || it->second.type != type ? nullptr : &it->second;
+    }
+
+    bool Checkpoint::has(const std::string& name) const{
+        return sections.count(name) > 0;
+    }
+
+    const double* Checkpoint::data(const std::string& name) const{
+        const Entry* entry = find(name, DOUBLES);
+        return entry ? reinterpret_cast<const double*>(entry->bytes) : nullptr;
+    }
+
+    long Checkpoint::rows(const std::string& name) const{
+        const Entry* entry = find(name, DOUBLES);
+        return entry ? entry->rows : 0;
+    }
+
+    long Checkpoint::cols(const std::string& name) const{
+        const Entry* entry = find(name, DOUBLES);
+        return entry ? entry->cols : 0;
+    }
+
+    std::vector<double> Checkpoint::vector(const std::string& name) const{
+        const double* p = data(name);
+        return p ? std::vector<double>(p, p + rows(name) * cols(name)) : std::vector<double>();
+    }
+
+    std::vector<std::vector<double>> Checkpoint::matrix(const std::string& name) const{
+        const double* p = data(name);
+        std::vector<std::vector<double>> A(rows(name));
+        long n = cols(name);
+        for(long i = 0; i < A.size(); i++){
+            A[i].assign(p + i * n, p + (i + 1) * n);
+        }
+        return A;
+    }
+
+    double Checkpoint::scalar(const std::string& name, double fallback) const{
+        const double* p = data(name);
+        return p && rows(name) * cols(name) > 0 ? p[0] : fallback;
+    }
+
+    std::string Checkpoint::text(const std::string& name) const{
+        const Entry* entry = find(name, TEXT);
+        return entry ? std::string(entry->bytes, entry->cols) : std::string();
+    }
+}
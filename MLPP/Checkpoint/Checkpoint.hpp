@@ -0,0 +1,96 @@
+//
+//  Checkpoint.hpp
+//
+//  Versioned binary model checkpoints, memory-mapped when they are read.
+//
+
+#ifndef Checkpoint_hpp
+#define Checkpoint_hpp
+
+#include <cstdint>
+#include <map>
+#include <string>
+#include <vector>
+
+namespace MLPP{
+    // A checkpoint is a set of named sections, each either a rows x cols block of doubles or a string, behind a small
+    // header and followed by a directory. Every block starts on a 64 byte boundary, so a mapped file can be used in
+    // place: data() points straight into the mapping and loading costs one page fault per page actually touched.
+    // Files are written in the host byte order, which the header records; other byte orders are rejected.
+    class Checkpoint{
+        public:
+            // Collects sections and writes them in one go. Blocks added by pointer are not copied, so they must stay
+            // alive until write(). Adding a name twice replaces the earlier section.
+            class Writer{
+                public:
+                    // kind names the model, such as "ANN", and is checked when the checkpoint is loaded.
+                    explicit Writer(const std::string& kind);
+
+                    void add(const std::string& name, const double* data, long rows, long cols);
+                    void add(const std::string& name, const std::vector<double>& v); // 1 x n, not copied.
+                    void add(const std::string& name, const std::vector<std::vector<double>>& A); // Copied.
+                    void add(const std::string& name, double value);
+                    void add(const std::string& name, const std::string& text);
+
+                    // False, after printing why, if the file could not be written.
+                    bool write(const std::string& fileName) const;
+
+                private:
+                    struct Section{
+                        std::string name;
+                        uint32_t type;
+                        long rows;
+                        long cols;
+                        const double* data;
+                        std::vector<double> values; // Owned copy, used when data is null.
+                        std::string text;
+                    };
+                    Section& section(const std::string& name);
+
+                    std::vector<Section> sections;
+            };
+
+            static const uint32_t VERSION = 1;
+
+            explicit Checkpoint(const std::string& fileName);
+            ~Checkpoint();
+            Checkpoint(const Checkpoint&) = delete;
+            Checkpoint& operator=(const Checkpoint&) = delete;
+
+            // False, after printing why, if the file could not be read or is not a checkpoint of this version.
+            bool valid() const { return isValid; }
+            const std::string& kind() const { return modelKind; }
+            bool has(const std::string& name) const;
+
+            // Zero-copy view of a block, valid for the lifetime of the checkpoint. nullptr if there is no such block.
+            const double* data(const std::string& name) const;
+            long rows(const std::string& name) const;
+            long cols(const std::string& name) const;
+
+            // Copies, empty when the section is missing.
+            std::vector<double> vector(const std::string& name) const;
+            std::vector<std::vector<double>> matrix(const std::string& name) const;
+            double scalar(const std::string& name, double fallback = 0) const;
+            std::string text(const std::string& name) const;
+
+        private:
+            struct Entry{
+                uint32_t type;
+                long rows;
+                long cols;
+                const char* bytes;
+            };
+            const Entry* find(const std::string& name, uint32_t type) const;
+            bool parse(const std::string& fileName);
+
+            const char* base;
+            uint64_t length;
+            bool mapped;
+            std::vector<char> buffer; // Holds the file where it cannot be mapped.
+            bool isValid;
+            std::string modelKind;
+            std::map<std::string, Entry> sections;
+    };
+}
+
+#endif /* Checkpoint_hpp */
@@ -9,8 +9,160 @@
 #include "Cost.hpp"
 #include "LinAlg/LinAlg.hpp"
 #include "Regularization/Reg.hpp"
+#include <map>
 
 namespace MLPP{
+
+    namespace {
+        void MSEBuffer(const double* y_hat, const double* y, double* d, long n){
+            for(long i = 0; i < n; i++){
+                d[i] = y_hat[i] - y[i];
+            }
+        }
+
+        void RMSEBuffer(const double* y_hat, const double* y, double* d, long n){
+            double sum = 0;
+            for(long i = 0; i < n; i++){
+                sum += (y_hat[i] - y[i]) * (y_hat[i] - y[i]);
+            }
+            double scale = 1 / (2 * std::sqrt(sum / (2 * n)));
+            for(long i = 0; i < n; i++){
+                d[i] = scale * (y_hat[i] - y[i]);
+            }
+        }
+
+        void MAEBuffer(const double* y_hat, const double* y, double* d, long n){
+            for(long i = 0; i < n; i++){
+                d[i] = y_hat[i] < 0 ? -1 : (y_hat[i] == 0 ? 0 : 1);
+            }
+        }
+
+        void MBEBuffer(const double* y_hat, const double* y, double* d, long n){
+            for(long i = 0; i < n; i++){
+                d[i] = 1;
+            }
+        }
+
+        void LogLossBuffer(const double* y_hat, const double* y, double* d, long n){
+            for(long i = 0; i < n; i++){
+                d[i] = -y[i] / y_hat[i] + (1 - y[i]) / (1 - y_hat[i]);
+            }
+        }
+
+        void CrossEntropyBuffer(const double* y_hat, const double* y, double* d, long n){
+            for(long i = 0; i < n; i++){
+                d[i] = -y[i] / y_hat[i];
+            }
+        }
+
+        void HingeLossBuffer(const double* y_hat, const double* y, double* d, long n){
+            for(long i = 0; i < n; i++){
+                d[i] = 1 - y[i] * y_hat[i] > 0 ? -y[i] : 0;
+            }
+        }
+    }
+
+    namespace {
+        const std::map<std::string, Cost::Function>& functionNames(){
+            typedef Cost::Function Function;
+            static const std::map<std::string, Function> functions = {
+                {"MSE", Function::MSE},
+                {"RMSE", Function::RMSE},
+                {"MAE", Function::MAE},
+                {"MBE", Function::MBE},
+                {"LogLoss", Function::LogLoss},
+                {"CrossEntropy", Function::CrossEntropy},
+                {"HingeLoss", Function::HingeLoss},
+                {"WassersteinLoss", Function::WassersteinLoss}
+            };
+            return functions;
+        }
+    }
+
+    Cost::Function Cost::function(const std::string& cost){
+        auto it = functionNames().find(cost);
+        if(it == functionNames().end()){
+            std::cout << "Unknown cost function " << cost << ", using MSE." << std::endl;
+            return Function::MSE;
+        }
+        return it->second;
+    }
+
+    Cost::BufferDerivative Cost::bufferDerivative(Function f){
+        switch(f){
+            case Function::MSE: return MSEBuffer;
+            case Function::RMSE: return RMSEBuffer;
+            case Function::MAE: return MAEBuffer;
+            case Function::MBE: return MBEBuffer;
+            case Function::LogLoss: return LogLossBuffer;
+            case Function::CrossEntropy: return CrossEntropyBuffer;
+            case Function::HingeLoss: return HingeLossBuffer;
+            case Function::WassersteinLoss: return HingeLossBuffer;
+        }
+        return nullptr;
+    }
+
+    Cost::BufferDerivative Cost::bufferDerivative(const std::string& cost){
+        auto it = functionNames().find(cost);
+        return it == functionNames().end() ? nullptr : bufferDerivative(it->second);
+    }
+
+    double Cost::evaluate(Function f, std::vector<double> y_hat, std::vector<double> y){
+        switch(f){
+            case Function::MSE: return MSE(y_hat, y);
+            case Function::RMSE: return RMSE(y_hat, y);
+            case Function::MAE: return MAE(y_hat, y);
+            case Function::MBE: return MBE(y_hat, y);
+            case Function::LogLoss: return LogLoss(y_hat, y);
+            case Function::CrossEntropy: return CrossEntropy(y_hat, y);
+            case Function::HingeLoss:
+            case Function::WassersteinLoss: return HingeLoss(y_hat, y);
+        }
+        return 0;
+    }
+
+    double Cost::evaluate(Function f, std::vector<std::vector<double>> y_hat, std::vector<std::vector<double>> y){
+        switch(f){
+            case Function::MSE: return MSE(y_hat, y);
+            case Function::RMSE: return RMSE(y_hat, y);
+            case Function::MAE: return MAE(y_hat, y);
+            case Function::MBE: return MBE(y_hat, y);
+            case Function::LogLoss: return LogLoss(y_hat, y);
+            case Function::CrossEntropy: return CrossEntropy(y_hat, y);
+            case Function::HingeLoss:
+            case Function::WassersteinLoss: return HingeLoss(y_hat, y);
+        }
+        return 0;
+    }
+
+    std::vector<double> Cost::derivative(Function f, std::vector<double> y_hat, std::vector<double> y){
+        switch(f){
+            case Function::MSE: return MSEDeriv(y_hat, y);
+            case Function::RMSE: return RMSEDeriv(y_hat, y);
+            case Function::MAE: return MAEDeriv(y_hat, y);
+            case Function::MBE: return MBEDeriv(y_hat, y);
+            case Function::LogLoss: return LogLossDeriv(y_hat, y);
+            case Function::CrossEntropy: return CrossEntropyDeriv(y_hat, y);
+            case Function::HingeLoss:
+            case Function::WassersteinLoss: return HingeLossDeriv(y_hat, y);
+        }
+        return {};
+    }
+
+    std::vector<std::vector<double>> Cost::derivative(Function f, std::vector<std::vector<double>> y_hat, std::vector<std::vector<double>> y){
+        switch(f){
+            case Function::MSE: return MSEDeriv(y_hat, y);
+            case Function::RMSE: return RMSEDeriv(y_hat, y);
+            case Function::MAE: return MAEDeriv(y_hat, y);
+            case Function::MBE: return MBEDeriv(y_hat, y);
+            case Function::LogLoss: return LogLossDeriv(y_hat, y);
+            case Function::CrossEntropy: return CrossEntropyDeriv(y_hat, y);
+            case Function::HingeLoss:
+            case Function::WassersteinLoss: return HingeLossDeriv(y_hat, y);
+        }
+        return {};
+    }
+
     double Cost::MSE(std::vector <double> y_hat, std::vector<double> y){
         double sum = 0;
         for(int i = 0; i < y_hat.size(); i++){
@@ -432,8 +584,8 @@ namespace MLPP{
     double Cost::dualFormSVM(std::vector<double> alpha, std::vector<std::vector<double>> X, std::vector<double> y){
         LinAlg alg;
         std::vector<std::vector<double>> Y = alg.diag(y); // Y is a diagnoal matrix. Y[i][j] = y[i] if i = i, else Y[i][j] = 0. Yt = Y.
-        std::vector<std::vector<double>> K = alg.matmult(X, alg.transpose(X)); // TO DO: DON'T forget to add non-linear kernelizations. 
-        std::vector<std::vector<double>> Q = alg.matmult(alg.matmult(alg.transpose(Y), K), Y);
+        std::vector<std::vector<double>> K = alg.matmultTranspose(X, X); // TO DO: DON'T forget to add non-linear kernelizations. 
+        std::vector<std::vector<double>> Q = alg.matmult(alg.transposeMatmult(Y, K), Y);
         double alphaQ = alg.matmult(alg.matmult({alpha}, Q), alg.transpose({alpha}))[0][0];
         std::vector<double> one = alg.onevec(alpha.size());
 
@@ -446,8 +598,8 @@ namespace MLPP{
         for(int i = 0; i < y.size(); i++){
             Y[i][i] = y[i]; // Y is a diagnoal matrix. Y[i][j] = y[i] if i = i, else Y[i][j] = 0. Yt = Y.
         }
-        std::vector<std::vector<double>> K = alg.matmult(X, alg.transpose(X)); // TO DO: DON'T forget to add non-linear kernelizations. 
-        std::vector<std::vector<double>> Q = alg.matmult(alg.matmult(alg.transpose(Y), K), Y);
+        std::vector<std::vector<double>> K = alg.matmultTranspose(X, X); // TO DO: DON'T forget to add non-linear kernelizations. 
+        std::vector<std::vector<double>> Q = alg.matmult(alg.transposeMatmult(Y, K), Y);
         std::vector<double> alphaQDeriv = alg.mat_vec_mult(Q, alpha);
         std::vector<double> one = alg.onevec(alpha.size());
 
@@ -8,10 +8,30 @@
 #define Cost_hpp
 
 #include <vector>
+#include <string>
 
 namespace MLPP{
     class Cost{
         public:
+            // Allocation-free derivative used by the training workspaces: d[i] = dC/dy_hat[i] over n values. Looked up
+            // once by the names the output layer maps use, so "WassersteinLoss" resolves to HingeLossDeriv there too.
+            typedef void (*BufferDerivative)(const double* y_hat, const double* y, double* d, long n);
+            static BufferDerivative bufferDerivative(const std::string& cost);
+
+            // The losses an output layer can be built with, resolved from the name once, when the layer is constructed.
+            enum class Function { MSE, RMSE, MAE, MBE, LogLoss, CrossEntropy, HingeLoss, WassersteinLoss };
+
+            // Unknown names are reported and fall back to MSE.
+            static Function function(const std::string& cost);
+            static BufferDerivative bufferDerivative(Function f);
+
+            // The cost and its derivative with respect to y_hat. WassersteinLoss is evaluated as HingeLoss, as the output
+            // layers always have.
+            double evaluate(Function f, std::vector<double> y_hat, std::vector<double> y);
+            double evaluate(Function f, std::vector<std::vector<double>> y_hat, std::vector<std::vector<double>> y);
+            std::vector<double> derivative(Function f, std::vector<double> y_hat, std::vector<double> y);
+            std::vector<std::vector<double>> derivative(Function f, std::vector<std::vector<double>> y_hat, std::vector<std::vector<double>> y);
+
             // Regression Costs
             double MSE(std::vector <double> y_hat, std::vector<double> y);
             double MSE(std::vector<std::vector<double>> y_hat, std::vector<std::vector<double>> y);
@@ -9,12 +9,16 @@
 #include "LinAlg/LinAlg.hpp"
 #include "Stat/Stat.hpp"
 #include "SoftmaxNet/SoftmaxNet.hpp"
+#include "CSVReader/CSVReader.hpp"
+#include "Dataset/Dataset.hpp"
+#include "MiniBatches/MiniBatches.hpp"
 #include <iostream>
 #include <random>
 #include <cmath>
 #include <fstream>
 #include <sstream>
 #include <algorithm>
+#include <filesystem>
 
 
 namespace MLPP{
@@ -24,7 +28,7 @@ namespace MLPP{
         std::vector<std::vector<double>> inputSet;
         std::vector<double> outputSet;
 
-        setData(BREAST_CANCER_SIZE, "MLPP/Data/Datasets/BreastCancer.csv", inputSet, outputSet);
+        setCachedData(BREAST_CANCER_SIZE, "MLPP/Data/Datasets/BreastCancer.csv", inputSet, outputSet);
         return {inputSet, outputSet};
     }
 
@@ -33,7 +37,7 @@ namespace MLPP{
         std::vector<std::vector<double>> inputSet;
         std::vector<double> outputSet;
 
-        setData(BREAST_CANCER_SIZE, "MLPP/Data/Datasets/BreastCancerSVM.csv", inputSet, outputSet);
+        setCachedData(BREAST_CANCER_SIZE, "MLPP/Data/Datasets/BreastCancerSVM.csv", inputSet, outputSet);
         return {inputSet, outputSet};
     }
 
@@ -43,7 +47,7 @@ namespace MLPP{
         std::vector<std::vector<double>> inputSet;
         std::vector<double> tempOutputSet;
 
-        setData(IRIS_SIZE, "/Users/marcmelikyan/Desktop/Data/Iris.csv", inputSet, tempOutputSet);
+        setCachedData(IRIS_SIZE, "/Users/marcmelikyan/Desktop/Data/Iris.csv", inputSet, tempOutputSet);
         std::vector<std::vector<double>> outputSet = oneHotRep(tempOutputSet, ONE_HOT_NUM);
         return {inputSet, outputSet};
     }
@@ -54,7 +58,7 @@ namespace MLPP{
         std::vector<std::vector<double>> inputSet;
         std::vector<double> tempOutputSet;
 
-        setData(WINE_SIZE, "MLPP/Data/Datasets/Iris.csv", inputSet, tempOutputSet);
+        setCachedData(WINE_SIZE, "MLPP/Data/Datasets/Iris.csv", inputSet, tempOutputSet);
         std::vector<std::vector<double>> outputSet = oneHotRep(tempOutputSet, ONE_HOT_NUM);
         return {inputSet, outputSet};
     }
@@ -65,7 +69,7 @@ namespace MLPP{
         std::vector<std::vector<double>> inputSet;
         std::vector<double> tempOutputSet;
 
-        setData(MNIST_SIZE, "MLPP/Data/Datasets/MnistTrain.csv", inputSet, tempOutputSet);
+        setCachedData(MNIST_SIZE, "MLPP/Data/Datasets/MnistTrain.csv", inputSet, tempOutputSet);
         std::vector<std::vector<double>> outputSet = oneHotRep(tempOutputSet, ONE_HOT_NUM);
         return {inputSet, outputSet};
     }
@@ -76,7 +80,7 @@ namespace MLPP{
         std::vector<std::vector<double>> inputSet;
         std::vector<double> tempOutputSet;
 
-        setData(MNIST_SIZE, "MLPP/Data/Datasets/MnistTest.csv", inputSet, tempOutputSet);
+        setCachedData(MNIST_SIZE, "MLPP/Data/Datasets/MnistTest.csv", inputSet, tempOutputSet);
         std::vector<std::vector<double>> outputSet = oneHotRep(tempOutputSet, ONE_HOT_NUM);
         return {inputSet, outputSet};
     }
@@ -86,7 +90,7 @@ namespace MLPP{
         std::vector<std::vector<double>> inputSet;
         std::vector<double> outputSet;
 
-        setData(CALIFORNIA_HOUSING_SIZE, "MLPP/Data/Datasets/CaliforniaHousing.csv", inputSet, outputSet);
+        setCachedData(CALIFORNIA_HOUSING_SIZE, "MLPP/Data/Datasets/CaliforniaHousing.csv", inputSet, outputSet);
         return {inputSet, outputSet};
     }
 
@@ -99,61 +103,64 @@ namespace MLPP{
     }
 
     std::tuple<std::vector<std::vector<double>>, std::vector<std::vector<double>>, std::vector<std::vector<double>>, std::vector<std::vector<double>>> Data::trainTestSplit(std::vector<std::vector<double>> inputSet, std::vector<std::vector<double>> outputSet, double testSize){
-        std::random_device rd;
-        std::default_random_engine generator(rd()); 
-
-        std::shuffle(inputSet.begin(), inputSet.end(), generator); // inputSet random shuffle
-        std::shuffle(outputSet.begin(), outputSet.end(), generator); // outputSet random shuffle)
-
-        std::vector<std::vector<double>> inputTestSet;
-        std::vector<std::vector<double>> outputTestSet; 
+        auto [trainIndices, testIndices] = trainTestIndices(inputSet.size(), testSize);
 
-        int testInputNumber = testSize * inputSet.size(); // implicit usage of floor
-        int testOutputNumber = testSize * outputSet.size(); // implicit usage of floor
-
-        for(int i = 0; i < testInputNumber; i++){
-            inputTestSet.push_back(inputSet[i]);
-            inputSet.erase(inputSet.begin());
+        std::vector<std::vector<double>> inputTrainSet, outputTrainSet, inputTestSet, outputTestSet;
+        for(int i : testIndices){
+            inputTestSet.push_back(std::move(inputSet[i]));
+            outputTestSet.push_back(std::move(outputSet[i]));
         }
-
-        for(int i = 0; i < testOutputNumber; i++){
-            outputTestSet.push_back(outputSet[i]);
-            outputSet.erase(outputSet.begin());
+        for(int i : trainIndices){
+            inputTrainSet.push_back(std::move(inputSet[i]));
+            outputTrainSet.push_back(std::move(outputSet[i]));
         }
+        return {std::move(inputTrainSet), std::move(outputTrainSet), std::move(inputTestSet), std::move(outputTestSet)};
+    }
 
-        return {inputSet, outputSet, inputTestSet, outputTestSet};
+    std::tuple<std::vector<int>, std::vector<int>> Data::trainTestIndices(int n, double testSize){
+        std::random_device rd;
+        std::default_random_engine generator(rd()); 
 
+        MiniBatches order(n, 1);
+        order.shuffle(generator);
+        int testNumber = testSize * n; // implicit usage of floor
+        const int* indices = order.indices(0);
+        return {std::vector<int>(indices + testNumber, indices + n), std::vector<int>(indices, indices + testNumber)};
     }
 
     // MULTIVARIATE SUPERVISED
 
     void Data::setData(int k, std::string fileName, std::vector<std::vector<double>>& inputSet, std::vector<double>& outputSet){
-        LinAlg alg;
-        std::string inputTemp;
-        std::string outputTemp;
-        
-        inputSet.resize(k);
-        
-        std::ifstream dataFile(fileName);
-        if(!dataFile.is_open()){
-            std::cout << fileName << " failed to open." << std::endl;
+        CSVReader reader(fileName);
+        Matrix data;
+        reader.read(k + 1, data);
+
+        inputSet.resize(data.rows());
+        for(int i = 0; i < data.rows(); i++){
+            inputSet[i].assign(data.row(i), data.row(i) + k);
+            outputSet.push_back(data(i, k));
         }
-        
-        std::string line;
-        while(std::getline(dataFile, line)){
-            std::stringstream ss(line);
-       
-            for(int i = 0; i < k; i++){
-                std::getline(ss, inputTemp, ',');
-                inputSet[i].push_back(std::stod(inputTemp));
-                
+    }
+
+    void Data::setCachedData(int k, std::string fileName, std::vector<std::vector<double>>& inputSet, std::vector<double>& outputSet){
+        std::string cacheName = cache(fileName);
+        if(cacheName.empty()){
+            // cache() has already said so if the CSV itself is missing.
+            if(std::filesystem::exists(fileName)){
+                setData(k, fileName, inputSet, outputSet);
             }
-            
-            std::getline(ss, outputTemp, ',');
-            outputSet.push_back(std::stod(outputTemp));
+            return;
+        }
+        Dataset dataset(cacheName);
+        if(!dataset.valid() || dataset.cols() < k + 1){
+            setData(k, fileName, inputSet, outputSet);
+            return;
+        }
+        inputSet.resize(dataset.rows());
+        for(long i = 0; i < dataset.rows(); i++){
+            inputSet[i].assign(dataset.row(i), dataset.row(i) + k);
+            outputSet.push_back(dataset.row(i)[k]);
         }
-        inputSet = alg.transpose(inputSet);
-        dataFile.close();
     }
 
     void Data::printData(std::vector <std::string> inputName, std::string outputName, std::vector<std::vector<double>> inputSet, std::vector<double> outputSet){
@@ -175,28 +182,10 @@ namespace MLPP{
     // UNSUPERVISED
 
     void Data::setData(int k, std::string fileName, std::vector<std::vector<double>>& inputSet){
-        LinAlg alg;
-        std::string inputTemp;
-        
-        inputSet.resize(k);
-        
-        std::ifstream dataFile(fileName);
-        if(!dataFile.is_open()){
-            std::cout << fileName << " failed to open." << std::endl;
-        }
-        
-        std::string line;
-        while(std::getline(dataFile, line)){
-            std::stringstream ss(line);
-       
-            for(int i = 0; i < k; i++){
-                std::getline(ss, inputTemp, ',');
-                inputSet[i].push_back(std::stod(inputTemp));
-                
-            }
-        }
-        inputSet = alg.transpose(inputSet);
-        dataFile.close();
+        CSVReader reader(fileName);
+        Matrix data;
+        reader.read(k, data);
+        inputSet = data.toStdVector();
     }
 
     void Data::printData(std::vector <std::string> inputName, std::vector<std::vector<double>> inputSet){
@@ -213,27 +202,14 @@ namespace MLPP{
     // SIMPLE
 
     void Data::setData(std::string fileName, std::vector <double>& inputSet, std::vector <double>& outputSet){
-        std::string inputTemp, outputTemp;
-        
-        std::ifstream dataFile(fileName);
-        if(!dataFile.is_open()){
-            std::cout << "The file failed to open." << std::endl;
-        }
-        
-        std::string line;
-        
-        
-        while(std::getline(dataFile, line)){
-            std::stringstream ss(line);
+        CSVReader reader(fileName);
+        Matrix data;
+        reader.read(2, data);
 
-            std::getline(ss, inputTemp, ',');
-            std::getline(ss, outputTemp, ',');
-            
-            inputSet.push_back(std::stod(inputTemp));
-            outputSet.push_back(std::stod(outputTemp));
+        for(int i = 0; i < data.rows(); i++){
+            inputSet.push_back(data(i, 0));
+            outputSet.push_back(data(i, 1));
         }
-            
-        dataFile.close();
     }
 
     void Data::printData(std::string& inputName, std::string& outputName, std::vector <double>& inputSet, std::vector <double>& outputSet){
@@ -248,6 +224,44 @@ namespace MLPP{
         }
     }
 
+    // BINARY CACHE
+
+    std::string Data::cache(std::string fileName){
+        // The CSV's size and modification time, recorded in the cache, say whether it is still current.
+        std::error_code error;
+        auto size = std::filesystem::file_size(fileName, error);
+        auto modified = std::filesystem::last_write_time(fileName, error);
+        if(error){
+            std::cout << fileName << " failed to open." << std::endl;
+            return "";
+        }
+        std::string source = std::to_string(size) + " " + std::to_string(modified.time_since_epoch().count());
+        std::string cacheName = fileName + ".cache";
+        if(std::filesystem::exists(cacheName, error)){
+            Dataset cached(cacheName);
+            if(cached.valid() && cached.source() == source){
+                return cacheName;
+            }
+        }
+
+        CSVReader reader(fileName);
+        Matrix data;
+        if(!reader.read(reader.fields(), data)){
+            return "";
+        }
+        // Written under a temporary name and renamed, so another process never maps a half written cache.
+        std::string partName = cacheName + "." + std::to_string(std::random_device()()) + ".part";
+        if(!Dataset::write(partName, data.data(), data.rows(), data.cols(), {}, source)){
+            return "";
+        }
+        std::filesystem::rename(partName, cacheName, error);
+        if(error){
+            std::filesystem::remove(partName, error);
+            return "";
+        }
+        return cacheName;
+    }
+
     // Images
     std::vector<std::vector<double>> Data::rgb2gray(std::vector<std::vector<std::vector<double>>> input){
         std::vector<std::vector<double>> grayScale;
@@ -649,17 +663,11 @@ namespace MLPP{
         return {wordEmbeddings, wordList};
     }
 
-    std::vector<std::vector<double>> Data::LSA(std::vector<std::string> sentences, int dim){
+    std::vector<std::vector<double>> Data::LSA(std::vector<std::string> sentences, int dim, std::string solver){
         LinAlg alg;
         std::vector<std::vector<double>> docWordData = BOW(sentences, "Binary");
 
-        auto [U, S, Vt] = alg.SVD(docWordData);
-        std::vector<std::vector<double>> S_trunc = alg.zeromat(dim, dim);
-        std::vector<std::vector<double>> Vt_trunc; 
-        for(int i = 0; i < dim; i++){ 
-            S_trunc[i][i] = S[i][i]; 
-            Vt_trunc.push_back(Vt[i]);
-        }
+        auto [U, S_trunc, Vt_trunc] = solver == "Randomized" ? alg.randomizedSVD(docWordData, dim) : alg.SVD(docWordData, dim);
 
         std::vector<std::vector<double>> embeddings = alg.matmult(S_trunc, Vt_trunc); 
         return embeddings;
@@ -26,7 +26,10 @@ class Data{
             std::tuple<std::vector<std::vector<double>>, std::vector<double>> loadCaliforniaHousing();
             std::tuple<std::vector<double>, std::vector<double>> loadFiresAndCrime();
 
+            // Rows are drawn with one shuffle of their indices, so every input stays paired with its output.
             std::tuple<std::vector<std::vector<double>>, std::vector<std::vector<double>>, std::vector<std::vector<double>>, std::vector<std::vector<double>>> trainTestSplit(std::vector<std::vector<double>> inputSet, std::vector<std::vector<double>> outputSet, double testSize);
+            // The same split of n samples as index lists, training then test, for reading the rows in place.
+            std::tuple<std::vector<int>, std::vector<int>> trainTestIndices(int n, double testSize);
 
         // Supervised
         void setData(int k, std::string fileName, std::vector<std::vector<double>>& inputSet, std::vector<double>& outputSet);
@@ -40,6 +43,11 @@ class Data{
         void setData(std::string fileName, std::vector <double>& inputSet, std::vector <double>& outputSet);
         void printData(std::string& inputName, std::string& outputName, std::vector <double>& inputSet, std::vector <double>& outputSet);
 
+        // Binary Cache
+        // Returns the path of a binary copy of the CSV fileName, fileName + ".cache", writing it the first time and again
+        // whenever the CSV's size or modification time changes. Open it with Dataset. Empty if the CSV cannot be read.
+        std::string cache(std::string fileName);
+
         // Images
         std::vector<std::vector<double>> rgb2gray(std::vector<std::vector<std::vector<double>>> input);
         std::vector<std::vector<std::vector<double>>> rgb2ycbcr(std::vector<std::vector<std::vector<double>>> input);
@@ -63,7 +71,7 @@ class Data{
         std::vector<std::vector<double>> BOW(std::vector<std::string> sentences, std::string = "Default"); 
         std::vector<std::vector<double>> TFIDF(std::vector<std::string> sentences);
         std::tuple<std::vector<std::vector<double>>, std::vector<std::string>> word2Vec(std::vector<std::string> sentences, std::string type, int windowSize, int dimension, double learning_rate, int max_epoch);
-        std::vector<std::vector<double>> LSA(std::vector<std::string> sentences, int dim);
+        std::vector<std::vector<double>> LSA(std::vector<std::string> sentences, int dim, std::string solver = "Default");
 
         std::vector<std::string> createWordList(std::vector<std::string> sentences);
 
@@ -93,6 +101,8 @@ class Data{
         }
 
         private:
+        // setData through the binary cache, falling back to parsing fileName when the cache cannot be used.
+        void setCachedData(int k, std::string fileName, std::vector<std::vector<double>>& inputSet, std::vector<double>& outputSet);
     };
 }
 
@@ -0,0 +1,309 @@
+//
+//  DataSource.cpp
+//
+//  Streams of training samples, and mini-batches prefetched from them on a background thread.
+//
+
+#include "DataSource.hpp"
+#include "CSVReader/CSVReader.hpp"
+#include <algorithm>
+#include <cstring>
+#include <iostream>
+
+namespace MLPP{
+    namespace {
+        const long BLOCK_BYTES = 1 << 20;
+        const int MAX_REPORTED = 10;
+    }
+
+    DataSource::~DataSource(){
+    }
+
+    MemorySource::MemorySource(const std::vector<std::vector<double>>& inputSet, const std::vector<double>& outputSet)
+    : inputSet(inputSet), outputSet(&outputSet), outputMatrix(nullptr), n_class(0), position(0), shuffle(false),
+      order(inputSet.size(), 1), generator(std::random_device()())
+    {
+
+    }
+
+    MemorySource::MemorySource(const std::vector<std::vector<double>>& inputSet, const std::vector<std::vector<double>>& outputSet)
+    : inputSet(inputSet), outputSet(nullptr), outputMatrix(&outputSet), n_class(0), position(0), shuffle(false),
+      order(inputSet.size(), 1), generator(std::random_device()())
+    {
+
+    }
+
+    MemorySource::MemorySource(const std::vector<std::vector<double>>& inputSet, const std::vector<double>& classes, int n_class)
+    : inputSet(inputSet), outputSet(&classes), outputMatrix(nullptr), n_class(n_class), position(0), shuffle(false),
+      order(inputSet.size(), 1), generator(std::random_device()())
+    {
+
+    }
+
+    int MemorySource::outputs() const{
+        if(n_class){ return n_class; }
+        if(outputSet){ return 1; }
+        return outputMatrix->empty() ? 0 : (*outputMatrix)[0].size();
+    }
+
+    void MemorySource::setShuffle(bool shuffle){
+        MemorySource::shuffle = shuffle;
+    }
+
+    void MemorySource::rewind(){
+        position = 0;
+        if(shuffle){ order.shuffle(generator); }
+    }
+
+    long MemorySource::read(long rows, double* x, int ldx, double* y, int ldy){
+        rows = std::min(rows, size() - position);
+        const int* indices = order.indices(0) + position;
+        for(long i = 0; i < rows; i++){
+            int sample = indices[i];
+            std::copy(inputSet[sample].begin(), inputSet[sample].end(), x + i * ldx);
+            if(n_class){
+                std::fill(y + i * ldy, y + i * ldy + n_class, 0.0);
+                int label = (*outputSet)[sample];
+                if(label >= 0 && label < n_class && label == (*outputSet)[sample]){ y[i * ldy + label] = 1; }
+            }
+            else if(outputSet){
+                y[i * ldy] = (*outputSet)[sample];
+            }
+            else{
+                std::copy((*outputMatrix)[sample].begin(), (*outputMatrix)[sample].end(), y + i * ldy);
+            }
+        }
+        position += rows;
+        return rows;
+    }
+
+    DatasetSource::DatasetSource(const std::string& fileName, int outputs)
+    : dataset(fileName), n_outputs(outputs), position(0)
+    {
+
+    }
+
+    long DatasetSource::read(long rows, double* x, int ldx, double* y, int ldy){
+        rows = std::min(rows, size() - position);
+        int n_inputs = inputs();
+        for(long i = 0; i < rows; i++, position++){
+            const double* row = dataset.row(position);
+            std::memcpy(x + i * ldx, row, n_inputs * sizeof(double));
+            std::memcpy(y + i * ldy, row + n_inputs, n_outputs * sizeof(double));
+        }
+        return rows;
+    }
+
+    CSVSource::CSVSource(const std::string& fileName, int inputs, int outputs)
+    : fileName(fileName), file(fileName, std::ios::binary), isValid(file.is_open()), n_inputs(inputs), n_outputs(outputs), lines(0),
+      buffer(BLOCK_BYTES), begin(0), end(0), endOfFile(false), line(0), seen(0), fields(inputs + outputs)
+    {
+        if(!isValid){
+            std::cout << fileName << " failed to open." << std::endl;
+            return;
+        }
+        // One streaming pass to count the samples, which sizes the training steps.
+        bool content = false;
+        while(file){
+            file.read(buffer.data(), buffer.size());
+            for(const char* p = buffer.data(); p < buffer.data() + file.gcount(); p++){
+                if(*p == '\n'){
+                    lines += content;
+                    content = false;
+                }
+                else if(*p != ' ' && *p != '\t' && *p != '\r'){
+                    content = true;
+                }
+            }
+        }
+        lines += content;
+        rewind();
+    }
+
+    void CSVSource::rewind(){
+        if(!isValid){ return; }
+        file.clear();
+        file.seekg(0);
+        begin = end = 0;
+        endOfFile = false;
+        line = 0;
+    }
+
+    // Moves the unread bytes to the front of the buffer and reads after them, growing the buffer for a line longer
+    // than it. False at the end of the file.
+    bool CSVSource::fillBuffer(){
+        if(endOfFile){ return false; }
+        std::memmove(buffer.data(), buffer.data() + begin, end - begin);
+        end -= begin;
+        begin = 0;
+        if(end == buffer.size()){ buffer.resize(2 * buffer.size()); }
+        file.read(buffer.data() + end, buffer.size() - end);
+        end += file.gcount();
+        endOfFile = !file;
+        return true;
+    }
+
+    long CSVSource::read(long rows, double* x, int ldx, double* y, int ldy){
+        if(!isValid){ return 0; }
+        long count = 0;
+        while(count < rows){
+            const char* first = buffer.data() + begin;
+            const char* last = buffer.data() + end;
+            const void* lineBreak = std::memchr(first, '\n', last - first);
+            if(!lineBreak && !endOfFile){
+                fillBuffer();
+                continue;
+            }
+            if(first == last){ break; }
+            const char* lineEnd = lineBreak ? static_cast<const char*>(lineBreak) : last;
+            begin = lineEnd - buffer.data() + (lineBreak ? 1 : 0);
+            line++;
+            CSVReader::Line status = CSVReader::parseLine(first, lineEnd, n_inputs + n_outputs, fields.data());
+            if(status == CSVReader::Line::Parsed){
+                std::copy(fields.begin(), fields.begin() + n_inputs, x + count * ldx);
+                std::copy(fields.begin() + n_inputs, fields.end(), y + count * ldy);
+                count++;
+            }
+            else if(status != CSVReader::Line::Blank && line > seen){
+                if(malformed.size() < MAX_REPORTED){
+                    std::cout << fileName << ":" << line << ": " << CSVReader::describe(status, n_inputs + n_outputs) << std::endl;
+                }
+                malformed.push_back(line);
+            }
+            seen = std::max(seen, line);
+        }
+        return count;
+    }
+
+    BatchStream::BatchStream(DataSource& source, int batchSize, long shuffleBuffer, int depth)
+    : data(source), n_batch(std::max(batchSize, 1)), capacity(std::max(shuffleBuffer, 0L)), poolRows(0), exhausted(false),
+      generator(std::random_device()()), slots(std::max(depth, 1) + 1), held(-1), stopping(false), spent{0, 0, 0, 0}
+    {
+        if(capacity > 0){
+            pool = Matrix(capacity, source.inputs() + source.outputs());
+        }
+        for(int i = 0; i < slots.size(); i++){
+            slots[i].inputs = Matrix(n_batch, source.inputs());
+            slots[i].outputs = Matrix(n_batch, source.outputs());
+            freeSlots.push_back(i);
+        }
+        producer = std::thread(&BatchStream::produce, this);
+    }
+
+    BatchStream::~BatchStream(){
+        {
+            std::lock_guard<std::mutex> guard(lock);
+            stopping = true;
+        }
+        slotFreed.notify_all();
+        producer.join();
+    }
+
+    const BatchStream::Batch* BatchStream::next(){
+        auto called = std::chrono::steady_clock::now();
+        std::unique_lock<std::mutex> guard(lock);
+        if(held >= 0){
+            spent.compute += std::chrono::duration<double>(called - handedOut).count();
+            freeSlots.push_back(held);
+            held = -1;
+            slotFreed.notify_one();
+        }
+        slotReady.wait(guard, [&]{ return !readySlots.empty(); });
+        handedOut = std::chrono::steady_clock::now();
+        spent.wait += std::chrono::duration<double>(handedOut - called).count();
+        int slot = readySlots.front();
+        readySlots.pop_front();
+        if(slots[slot].rows() == 0){
+            freeSlots.push_back(slot);
+            slotFreed.notify_one();
+            return nullptr;
+        }
+        held = slot;
+        spent.batches++;
+        return &slots[slot];
+    }
+
+    BatchStream::Timing BatchStream::timing() const{
+        std::lock_guard<std::mutex> guard(lock);
+        return spent;
+    }
+
+    void BatchStream::UI(const Timing& timing){
+        std::cout << "-----------------------------------" << std::endl;
+        std::cout << "Batch stream: " << timing.batches << " batches; preparing took " << timing.prepare << " s, waiting " << timing.wait << " s, computing " << timing.compute << " s" << std::endl;
+        if(timing.batches == 0){ return; }
+        double prepare = timing.prepare / timing.batches, wait = timing.wait / timing.batches;
+        std::cout << "Per batch: preparing " << prepare << " s, waiting " << wait << " s" << std::endl;
+        std::cout << "Bottleneck: " << (wait > prepare / 2 ? "data preparation" : "compute") << std::endl;
+    }
+
+    void BatchStream::produce(){
+        while(true){
+            data.rewind();
+            poolRows = 0;
+            exhausted = false;
+            long rows;
+            do{
+                int slot;
+                {
+                    std::unique_lock<std::mutex> guard(lock);
+                    slotFreed.wait(guard, [&]{ return stopping || !freeSlots.empty(); });
+                    if(stopping){ return; }
+                    slot = freeSlots.front();
+                    freeSlots.pop_front();
+                }
+                auto start = std::chrono::steady_clock::now();
+                rows = fill(slots[slot]);
+                double seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+                {
+                    std::lock_guard<std::mutex> guard(lock);
+                    spent.prepare += seconds;
+                    readySlots.push_back(slot);
+                }
+                slotReady.notify_one();
+            } while(rows > 0);
+        }
+    }
+
+    long BatchStream::fill(Batch& batch){
+        int inputs = data.inputs();
+        int outputs = data.outputs();
+        batch.inputs.resize(n_batch, inputs);
+        batch.outputs.resize(n_batch, outputs);
+        long rows = 0;
+        if(capacity == 0){
+            // In order: the source writes straight into the batch.
+            while(rows < n_batch){
+                long read = data.read(n_batch - rows, batch.inputs.row(rows), inputs, batch.outputs.row(rows), outputs);
+                if(read == 0){ break; }
+                rows += read;
+            }
+        }
+        else{
+            // Top the pool up, then draw the batch from it, moving the pool's last sample into each hole. A pool smaller
+            // than the batch is topped up again whenever it runs dry, so only the last batch of a pass is short.
+            for(; rows < n_batch; rows++){
+                if(rows == 0 || poolRows == 0){
+                    while(poolRows < capacity && !exhausted){
+                        double* row = pool.row(poolRows);
+                        long read = data.read(capacity - poolRows, row, pool.stride(), row + inputs, pool.stride());
+                        exhausted = read == 0;
+                        poolRows += read;
+                    }
+                    if(poolRows == 0){ break; }
+                }
+                long j = std::uniform_int_distribution<long>(0, poolRows - 1)(generator);
+                const double* sample = pool.row(j);
+                std::copy(sample, sample + inputs, batch.inputs.row(rows));
+                std::copy(sample + inputs, sample + inputs + outputs, batch.outputs.row(rows));
+                poolRows--;
+                if(j != poolRows){
+                    std::copy(pool.row(poolRows), pool.row(poolRows) + inputs + outputs, pool.row(j));
+                }
+            }
+        }
+        batch.inputs.resize(rows, inputs);
+        batch.outputs.resize(rows, outputs);
+        return rows;
+    }
+}
@@ -0,0 +1,195 @@
+//
+//  DataSource.hpp
+//
+//  Streams of training samples, and mini-batches prefetched from them on a background thread.
+//
+
+#ifndef DataSource_hpp
+#define DataSource_hpp
+
+#include "Matrix/Matrix.hpp"
+#include "Dataset/Dataset.hpp"
+#include "MiniBatches/MiniBatches.hpp"
+#include <chrono>
+#include <condition_variable>
+#include <deque>
+#include <fstream>
+#include <mutex>
+#include <random>
+#include <string>
+#include <thread>
+#include <vector>
+
+namespace MLPP{
+    // Samples that training reads front to back, a block of rows at a time, so that a pass never needs all of them in
+    // memory at once. Each sample is inputs() doubles followed by outputs() doubles.
+    class DataSource{
+        public:
+            virtual ~DataSource();
+
+            // Samples per pass.
+            virtual long size() const = 0;
+            virtual int inputs() const = 0;
+            virtual int outputs() const = 0;
+
+            // Starts the next pass from the first sample.
+            virtual void rewind() = 0;
+
+            // Copies up to rows samples into x and y, row-major with strides ldx and ldy, and returns how many it copied.
+            // Returns 0 once the pass is over.
+            virtual long read(long rows, double* x, int ldx, double* y, int ldy) = 0;
+    };
+
+    // Samples held in memory elsewhere. They are referenced, not copied, so they must outlive the source.
+    class MemorySource : public DataSource{
+        public:
+            MemorySource(const std::vector<std::vector<double>>& inputSet, const std::vector<double>& outputSet);
+            MemorySource(const std::vector<std::vector<double>>& inputSet, const std::vector<std::vector<double>>& outputSet);
+            // Class labels in [0, n_class), read as the one-hot rows of Data::oneHotRep.
+            MemorySource(const std::vector<std::vector<double>>& inputSet, const std::vector<double>& classes, int n_class);
+
+            long size() const override { return inputSet.size(); }
+            int inputs() const override { return inputSet.empty() ? 0 : inputSet[0].size(); }
+            int outputs() const override;
+            void rewind() override;
+            long read(long rows, double* x, int ldx, double* y, int ldy) override;
+
+            // Reads every pass in a new random order. Under a BatchStream the shuffle and the gathering of the rows
+            // happen on its background thread. Set it before the stream is constructed.
+            void setShuffle(bool shuffle);
+
+        private:
+            const std::vector<std::vector<double>>& inputSet;
+            const std::vector<double>* outputSet;
+            const std::vector<std::vector<double>>* outputMatrix;
+            int n_class;
+            long position;
+            bool shuffle;
+            MiniBatches order;
+            std::default_random_engine generator;
+    };
+
+    // Samples in a mapped Dataset, such as the ones Data::cache writes, whose last outputs columns are the outputs.
+    // Pages are only read as a pass reaches them. A source whose file failed to load is empty, with no columns.
+    class DatasetSource : public DataSource{
+        public:
+            DatasetSource(const std::string& fileName, int outputs = 1);
+
+            bool valid() const { return dataset.valid(); }
+            long size() const override { return valid() ? dataset.rows() : 0; }
+            int inputs() const override { return valid() ? dataset.cols() - n_outputs : 0; }
+            int outputs() const override { return valid() ? n_outputs : 0; }
+            void rewind() override { position = 0; }
+            long read(long rows, double* x, int ldx, double* y, int ldy) override;
+
+        private:
+            Dataset dataset;
+            int n_outputs;
+            long position;
+    };
+
+    // Samples parsed from a CSV file as it is read, a block at a time. Each line holds the inputs and then the outputs,
+    // as for Data::setData. Malformed lines are skipped, and reported like CSVReader does the first time they are read.
+    class CSVSource : public DataSource{
+        public:
+            CSVSource(const std::string& fileName, int inputs, int outputs = 1);
+
+            bool valid() const { return isValid; }
+            // Lines that are not blank, counted when the source is opened. Malformed lines are included.
+            long size() const override { return lines; }
+            int inputs() const override { return n_inputs; }
+            int outputs() const override { return n_outputs; }
+            void rewind() override;
+            long read(long rows, double* x, int ldx, double* y, int ldy) override;
+
+            // 1-based numbers of the lines skipped so far.
+            const std::vector<long>& malformedLines() const { return malformed; }
+
+        private:
+            bool fillBuffer();
+
+            std::string fileName;
+            std::ifstream file;
+            bool isValid;
+            int n_inputs;
+            int n_outputs;
+            long lines;
+            std::vector<char> buffer;
+            long begin; // The unread bytes are [begin, end) of buffer.
+            long end;
+            bool endOfFile;
+            long line;
+            long seen; // The furthest line any pass has read.
+            std::vector<double> fields;
+            std::vector<long> malformed;
+    };
+
+    // Mini-batches drawn from a DataSource on a background thread, which keeps up to depth batches ready ahead of the
+    // trainer and carries on into the next pass. With a shuffle buffer of s samples every batch row is drawn at random
+    // from the next s samples of the source, so a stream is shuffled in bounded memory; 0 keeps the source order.
+    // Memory is the shuffle buffer plus depth + 1 batches, however long the source is. The source belongs to the
+    // background thread for the lifetime of the stream.
+    class BatchStream{
+        public:
+            struct Batch{
+                Matrix inputs;
+                Matrix outputs;
+                int rows() const { return inputs.rows(); }
+            };
+
+            // Seconds spent on each side of the stream since it was constructed. When the trainer waits, per batch, for
+            // more than half the time it takes to prepare one, preparation is the bottleneck; a wait near zero means it
+            // is hidden behind compute. Work the trainer does on a batch after next() returns counts as compute.
+            struct Timing{
+                long batches;   // Batches handed to the trainer.
+                double prepare; // Reading and shuffling batches, on the background thread.
+                double wait;    // The trainer blocked in next() for a batch.
+                double compute; // The trainer held a batch, from next() returning it to the following call.
+            };
+
+            BatchStream(DataSource& source, int batchSize, long shuffleBuffer = 0, int depth = 2);
+            ~BatchStream();
+            BatchStream(const BatchStream&) = delete;
+            BatchStream& operator=(const BatchStream&) = delete;
+
+            DataSource& source() const { return data; }
+            int batchSize() const { return n_batch; }
+
+            // The next batch of the current pass, valid until the next call, or nullptr once the pass is over. The call
+            // after a nullptr starts the next pass. The last batch of a pass may be short.
+            const Batch* next();
+
+            Timing timing() const;
+
+            // Prints a Timing and which side of the stream is the bottleneck.
+            static void UI(const Timing& timing);
+
+        private:
+            void produce();
+            long fill(Batch& batch);
+
+            DataSource& data;
+            int n_batch;
+            long capacity;
+            Matrix pool; // The shuffle buffer; its first poolRows rows are samples not yet drawn.
+            long poolRows;
+            bool exhausted;
+            std::default_random_engine generator;
+
+            // Slots cycle from free to ready (filled by the producer) to held (by the trainer) and back. A ready slot
+            // with no rows marks the end of a pass.
+            std::vector<Batch> slots;
+            std::deque<int> freeSlots;
+            std::deque<int> readySlots;
+            int held;
+            bool stopping;
+            Timing spent;
+            std::chrono::steady_clock::time_point handedOut;
+            mutable std::mutex lock;
+            std::condition_variable slotFreed;
+            std::condition_variable slotReady;
+            std::thread producer;
+    };
+}
+
+#endif /* DataSource_hpp */
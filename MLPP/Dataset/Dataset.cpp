@@ -0,0 +1,46 @@
+//
+//  Dataset.cpp
+//
+//  Binary datasets, memory-mapped and used in place when they are read.
+//
+
+#include "Dataset.hpp"
+#include <iostream>
+#include <sstream>
+
+namespace MLPP{
+    bool Dataset::write(const std::string& fileName, const double* data, long rows, long cols,
+                        const std::vector<std::string>& columnNames, const std::string& source){
+        Checkpoint::Writer writer("Dataset");
+        writer.add("data", data, rows, cols);
+        if(!columnNames.empty()){
+            std::string joined;
+            for(int j = 0; j < columnNames.size(); j++){
+                joined += (j ? "\n" : "") + columnNames[j];
+            }
+            writer.add("columns", joined);
+        }
+        writer.add("source", source);
+        return writer.write(fileName);
+    }
+
+    Dataset::Dataset(const std::string& fileName)
+    : checkpoint(fileName), isValid(false), values(nullptr), n_rows(0), n_cols(0)
+    {
+        if(!checkpoint.valid()){ return; }
+        if(checkpoint.kind() != "Dataset" || !checkpoint.has("data")){
+            std::cout << fileName << " is not a dataset." << std::endl;
+            return;
+        }
+        values = checkpoint.data("data");
+        n_rows = checkpoint.rows("data");
+        n_cols = checkpoint.cols("data");
+        if(checkpoint.has("columns")){
+            std::istringstream joined(checkpoint.text("columns"));
+            std::string name;
+            while(std::getline(joined, name)){ names.push_back(name); }
+        }
+        sourceNote = checkpoint.text("source");
+        isValid = true;
+    }
+}
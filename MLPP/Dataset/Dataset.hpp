@@ -0,0 +1,50 @@
+//
+//  Dataset.hpp
+//
+//  Binary datasets, memory-mapped and used in place when they are read.
+//
+
+#ifndef Dataset_hpp
+#define Dataset_hpp
+
+#include "Checkpoint/Checkpoint.hpp"
+#include <string>
+#include <vector>
+
+namespace MLPP{
+    // A rows x cols block of doubles stored row-major in a checkpoint of kind "Dataset", with optional column names and a
+    // note of the source it was built from. Opening one maps the file, so the rows are available without parsing or
+    // copying; Data::cache keeps one of these next to each CSV it loads.
+    class Dataset{
+        public:
+            // False, after printing why, if the file could not be written.
+            static bool write(const std::string& fileName, const double* data, long rows, long cols,
+                              const std::vector<std::string>& columnNames = {}, const std::string& source = "");
+
+            explicit Dataset(const std::string& fileName);
+
+            // False, after printing why, if the file could not be read or does not hold a dataset.
+            bool valid() const { return isValid; }
+            long rows() const { return n_rows; }
+            long cols() const { return n_cols; }
+
+            // Zero-copy views into the mapping, valid for the lifetime of the dataset.
+            const double* data() const { return values; }
+            const double* row(long i) const { return values + i * n_cols; }
+
+            // Empty when the dataset was written without names.
+            const std::vector<std::string>& columnNames() const { return names; }
+            const std::string& source() const { return sourceNote; }
+
+        private:
+            Checkpoint checkpoint;
+            bool isValid;
+            const double* values;
+            long n_rows;
+            long n_cols;
+            std::vector<std::string> names;
+            std::string sourceNote;
+    };
+}
+
+#endif /* Dataset_hpp */
@@ -235,7 +235,7 @@ namespace MLPP{
     std::vector<std::vector<double>> DualSVC::kernelFunction(std::vector<std::vector<double>> A, std::vector<std::vector<double>> B, std::string kernel){
         LinAlg alg;
         if(kernel == "Linear"){
-            return alg.matmult(inputSet, alg.transpose(inputSet));
+            return alg.matmultTranspose(inputSet, inputSet);
         } // warning: non-void function does not return a value in all control paths [-Wreturn-type]
     }
 }
\ No newline at end of file
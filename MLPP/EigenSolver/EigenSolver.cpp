@@ -0,0 +1,358 @@
+//
+//  EigenSolver.cpp
+//
+//  Eigen-decomposition of real symmetric matrices.
+//
+
+#include "EigenSolver.hpp"
+#include "GEMM/GEMM.hpp"
+#include "Householder/Householder.hpp"
+#include <cmath>
+#include <limits>
+#include <random>
+#include <algorithm>
+#include <functional>
+#include <utility>
+
+namespace MLPP{
+
+    namespace {
+        // Householder reflectors applied together in the back-transformation.
+        const int NB = 32;
+        const double EPS = std::numeric_limits<double>::epsilon();
+
+        // Builds H_k from column k of a, below the diagonal, so that H_k zeroes everything under the subdiagonal.
+        // u goes to row k of U from column k + 1 onwards. Returns false when the column is already reduced.
+        bool householder(const Matrix& a, int k, std::vector<double>& d, std::vector<double>& e, Matrix& U, std::vector<double>& beta){
+            int m = a.rows() - k - 1;
+            double* u = U.row(k) + k + 1;
+            for(int i = 0; i < m; i++){
+                u[i] = a(k + 1 + i, k);
+            }
+            d[k] = a(k, k);
+            e[k] = Householder::reflector(u, m, beta[k]);
+            return beta[k] != 0;
+        }
+
+        // p = A22 u, where A22 is the trailing block of a from (k + 1, k + 1), reading each stored row once.
+        void symmetricProduct(const Matrix& a, int k, const double* u, std::vector<double>& p){
+            int m = a.rows() - k - 1;
+            std::fill(p.begin(), p.begin() + m, 0.0);
+            for(int i = 0; i < m; i++){
+                const double* row = a.row(k + 1 + i) + k + 1;
+                double ui = u[i];
+                double s = 0;
+                for(int j = 0; j < i; j++){
+                    s += row[j] * u[j];
+                    p[j] += row[j] * ui;
+                }
+                p[i] += s + row[i] * ui;
+            }
+        }
+
+        // Reduces the symmetric matrix held in the lower triangle of a to tridiagonal T = Q^T A Q, with the
+        // diagonal in d and the subdiagonal in e (e[i] = T(i + 1, i), e[n - 1] = 0). Q = H_0 H_1 ... H_{n-3},
+        // where H_k = I - beta[k] u u^T and u is stored in row k of U from column k + 1 onwards.
+        void tridiagonalize(Matrix& a, std::vector<double>& d, std::vector<double>& e, Matrix& U, std::vector<double>& beta){
+            int n = a.rows();
+            int r = std::max(n - 2, 0);
+            d.assign(n, 0);
+            e.assign(n, 0);
+            U.resize(r, n);
+            U.fill(0);
+            beta.assign(r, 0);
+            std::vector<double> p(n), w(n);
+
+            for(int k = 0; k < r; k++){
+                if(!householder(a, k, d, e, U, beta)){
+                    continue;
+                }
+                int m = n - k - 1;
+                const double* u = U.row(k) + k + 1;
+
+                // w = p - (beta / 2)(p^T u) u with p = beta A22 u
+                symmetricProduct(a, k, u, p);
+                double pu = 0;
+                for(int i = 0; i < m; i++){
+                    p[i] *= beta[k];
+                    pu += p[i] * u[i];
+                }
+                double c = 0.5 * beta[k] * pu;
+                for(int i = 0; i < m; i++){
+                    w[i] = p[i] - c * u[i];
+                }
+
+                // A22 -= u w^T + w u^T
+                for(int i = 0; i < m; i++){
+                    double* row = a.row(k + 1 + i) + k + 1;
+                    double ui = u[i];
+                    double wi = w[i];
+                    for(int j = 0; j <= i; j++){
+                        row[j] -= ui * w[j] + wi * u[j];
+                    }
+                }
+            }
+            if(n >= 2){
+                d[n - 2] = a(n - 2, n - 2);
+                e[n - 2] = a(n - 1, n - 2);
+            }
+            if(n >= 1){
+                d[n - 1] = a(n - 1, n - 1);
+            }
+        }
+
+        // Overwrites x with (T - shift I)^-1 x for the tridiagonal T = (d, e), by Gaussian elimination with
+        // partial pivoting. U has two superdiagonals; pivots below tiny are raised to tiny.
+        void shiftedSolve(const std::vector<double>& d, const std::vector<double>& e, double shift, double tiny, double* x, std::vector<double>& u0, std::vector<double>& u1, std::vector<double>& u2){
+            int n = d.size();
+            double r0 = d[0] - shift;
+            double r1 = n > 1 ? e[0] : 0;
+            for(int i = 0; i < n - 1; i++){
+                double sub = e[i];
+                double a1 = d[i + 1] - shift;
+                double next = i + 1 < n - 1 ? e[i + 1] : 0;
+                double mult;
+                if(std::abs(r0) >= std::abs(sub)){
+                    if(r0 == 0){ r0 = tiny; }
+                    mult = sub / r0;
+                    u0[i] = r0;
+                    u1[i] = r1;
+                    u2[i] = 0;
+                    r0 = a1 - mult * r1;
+                    r1 = next;
+                }
+                else{
+                    mult = r0 / sub;
+                    u0[i] = sub;
+                    u1[i] = a1;
+                    u2[i] = next;
+                    r0 = r1 - mult * a1;
+                    r1 = -mult * next;
+                    std::swap(x[i], x[i + 1]);
+                }
+                x[i + 1] -= mult * x[i];
+            }
+            u0[n - 1] = r0;
+            for(int i = 0; i < n; i++){
+                if(std::abs(u0[i]) < tiny){
+                    u0[i] = u0[i] < 0 ? -tiny : tiny;
+                }
+            }
+
+            x[n - 1] /= u0[n - 1];
+            if(n > 1){
+                x[n - 2] = (x[n - 2] - u1[n - 2] * x[n - 1]) / u0[n - 2];
+            }
+            for(int i = n - 3; i >= 0; i--){
+                x[i] = (x[i] - u1[i] * x[i + 1] - u2[i] * x[i + 2]) / u0[i];
+            }
+        }
+
+    }
+
+    // Implicit QL with Wilkinson shifts. Overwrites d with the eigenvalues of (d, e) and destroys e.
+    bool EigenSolver::tridiagonalEigenvalues(std::vector<double>& d, std::vector<double>& e){
+        int n = d.size();
+        double f = 0;
+        double tst1 = 0;
+        bool converged = true;
+        for(int l = 0; l < n; l++){
+            tst1 = std::max(tst1, std::abs(d[l]) + std::abs(e[l]));
+            int m = l;
+            while(m < n - 1 && std::abs(e[m]) > EPS * tst1){
+                m++;
+            }
+            if(m > l){
+                int iter = 0;
+                do{
+                    if(++iter > 30){
+                        converged = false;
+                        break;
+                    }
+                    double g = d[l];
+                    double p = (d[l + 1] - g) / (2 * e[l]);
+                    double r = std::hypot(p, 1.0);
+                    if(p < 0){ r = -r; }
+                    d[l] = e[l] / (p + r);
+                    d[l + 1] = e[l] * (p + r);
+                    double dl1 = d[l + 1];
+                    double h = g - d[l];
+                    for(int i = l + 2; i < n; i++){
+                        d[i] -= h;
+                    }
+                    f += h;
+
+                    p = d[m];
+                    double c = 1, c2 = 1, c3 = 1;
+                    double el1 = e[l + 1];
+                    double s = 0, s2 = 0;
+                    for(int i = m - 1; i >= l; i--){
+                        c3 = c2;
+                        c2 = c;
+                        s2 = s;
+                        g = c * e[i];
+                        h = c * p;
+                        r = std::hypot(p, e[i]);
+                        e[i + 1] = s * r;
+                        s = e[i] / r;
+                        c = p / r;
+                        p = c * d[i] - s * g;
+                        d[i + 1] = h + s * (c * g + s * d[i]);
+                    }
+                    p = -s * s2 * c3 * el1 * e[l] / dl1;
+                    e[l] = s * p;
+                    d[l] = c * p;
+                } while(std::abs(e[l]) > EPS * tst1);
+            }
+            d[l] += f;
+            e[l] = 0;
+        }
+        return converged;
+    }
+
+    // Orthonormalizes rows [begin, end) of S in order. Panels of NB rows are projected against the rows
+    // before them with two passes of block classical Gram-Schmidt, so large clusters run through GEMM.
+    void EigenSolver::orthonormalizeRows(Matrix& S, int begin, int end){
+        int n = S.cols();
+        std::vector<double> H((long)NB * (end - begin));
+        for(int p0 = begin; p0 < end; p0 += NB){
+            int pb = std::min(NB, end - p0);
+            int prev = p0 - begin;
+            for(int pass = 0; pass < 2; pass++){
+                if(prev > 0){
+                    GEMM::gemm(false, true, pb, prev, n, 1.0, S.row(p0), S.stride(), S.row(begin), S.stride(), 0.0, H.data(), prev);
+                    GEMM::gemm(false, false, pb, n, prev, -1.0, H.data(), prev, S.row(begin), S.stride(), 1.0, S.row(p0), S.stride());
+                }
+                for(int r = p0; r < p0 + pb; r++){
+                    double* x = S.row(r);
+                    for(int q = p0; q < r; q++){
+                        const double* y = S.row(q);
+                        double s = 0;
+                        for(int i = 0; i < n; i++){
+                            s += x[i] * y[i];
+                        }
+                        for(int i = 0; i < n; i++){
+                            x[i] -= s * y[i];
+                        }
+                    }
+                    double norm = 0;
+                    for(int i = 0; i < n; i++){
+                        norm += x[i] * x[i];
+                    }
+                    norm = std::sqrt(norm);
+                    double scale = norm > 0 ? 1 / norm : 0;
+                    for(int i = 0; i < n; i++){
+                        x[i] *= scale;
+                    }
+                }
+            }
+        }
+    }
+
+    // Eigenvectors of the tridiagonal (d, e) for the eigenvalues in lambda (descending), one per row of S,
+    // by two steps of inverse iteration from a random start. As in LAPACK's stein, eigenvalues closer
+    // than 1e-3 ||T|| form a cluster whose vectors are reorthogonalized after every step.
+    void EigenSolver::tridiagonalEigenvectors(const std::vector<double>& d, const std::vector<double>& e, const std::vector<double>& lambda, Matrix& S){
+        int n = d.size();
+        int k = lambda.size();
+        S.resize(k, n);
+        if(n == 0){ return; }
+
+        double tnorm = 0;
+        for(int i = 0; i < n; i++){
+            tnorm = std::max(tnorm, std::abs(d[i]) + std::abs(e[i]) + (i > 0 ? std::abs(e[i - 1]) : 0));
+        }
+        if(tnorm == 0){ tnorm = 1; }
+        const double ortol = 1e-3 * tnorm;
+        const double pertol = 10 * EPS * tnorm;
+        const double tiny = EPS * tnorm;
+
+        // Repeated eigenvalues would give identical iterates, so their shifts are nudged apart.
+        std::vector<double> shift(lambda);
+        for(int j = 1; j < k; j++){
+            if(lambda[j - 1] - lambda[j] <= ortol && shift[j - 1] - shift[j] < pertol){
+                shift[j] = shift[j - 1] - pertol;
+            }
+        }
+
+        std::mt19937 gen(0);
+        std::uniform_real_distribution<double> dist(-1.0, 1.0);
+        for(int j = 0; j < k; j++){
+            double* x = S.row(j);
+            for(int i = 0; i < n; i++){
+                x[i] = dist(gen);
+            }
+        }
+
+        std::vector<double> u0(n), u1(n), u2(n);
+        for(int begin = 0; begin < k; ){
+            int end = begin + 1;
+            while(end < k && lambda[end - 1] - lambda[end] <= ortol){
+                end++;
+            }
+            for(int it = 0; it < 2; it++){
+                for(int j = begin; j < end; j++){
+                    // Scale the right-hand side down so the solve cannot overflow near a tiny pivot. A row that
+                    // orthonormalization zeroed out has no norm to divide by.
+                    double* x = S.row(j);
+                    double l1 = 0;
+                    for(int i = 0; i < n; i++){
+                        l1 += std::abs(x[i]);
+                    }
+                    double scale = l1 > 0 ? n * tiny / l1 : tiny;
+                    for(int i = 0; i < n; i++){
+                        x[i] *= scale;
+                    }
+                    shiftedSolve(d, e, shift[j], tiny, x, u0, u1, u2);
+                }
+                orthonormalizeRows(S, begin, end);
+            }
+            begin = end;
+        }
+    }
+
+    EigenSolver::EigenSolver(const Matrix& A, int k)
+    : isConverged(true)
+    {
+        int n = A.rows();
+        Matrix a(n, n);
+        for(int i = 0; i < n; i++){
+            std::copy(A.row(i), A.row(i) + n, a.row(i));
+        }
+        compute(a, k);
+    }
+
+    EigenSolver::EigenSolver(const std::vector<std::vector<double>>& A, int k)
+    : isConverged(true)
+    {
+        Matrix a(A);
+        compute(a, k);
+    }
+
+    void EigenSolver::compute(Matrix& A, int k){
+        int n = A.rows();
+        if(k <= 0 || k > n){ k = n; }
+
+        std::vector<double> d, e, beta;
+        Matrix U;
+        tridiagonalize(A, d, e, U, beta);
+
+        std::vector<double> lambda = d;
+        std::vector<double> work = e;
+        isConverged = tridiagonalEigenvalues(lambda, work);
+        std::sort(lambda.begin(), lambda.end(), std::greater<double>());
+        lambda.resize(k);
+
+        Matrix S;
+        tridiagonalEigenvectors(d, e, lambda, S);
+        Householder::apply(U, beta, 1, S);
+
+        values = Vector(std::move(lambda));
+        vectors.resize(n, k);
+        for(int i = 0; i < n; i++){
+            for(int j = 0; j < k; j++){
+                vectors(i, j) = S(j, i);
+            }
+        }
+    }
+}
@@ -0,0 +1,52 @@
+//
+//  EigenSolver.hpp
+//
+//  Eigen-decomposition of real symmetric matrices.
+//
+
+#ifndef EigenSolver_hpp
+#define EigenSolver_hpp
+
+#include "Matrix/Matrix.hpp"
+#include <vector>
+
+namespace MLPP{
+    // Reduces A to tridiagonal form with Householder reflections, finds the eigenvalues of the
+    // tridiagonal matrix by implicit QL, and recovers eigenvectors by inverse iteration followed by a
+    // blocked back-transformation. Asking for the top k eigenpairs only costs O(n^2 k) past the reduction.
+    class EigenSolver{
+        public:
+            // Only the lower triangle of A is read. k > 0 keeps the k largest eigenpairs; otherwise all are kept.
+            explicit EigenSolver(const Matrix& A, int k = 0);
+            explicit EigenSolver(const std::vector<std::vector<double>>& A, int k = 0);
+
+            // Sorted in descending order.
+            const Vector& eigenvalues() const { return values; }
+
+            // n x k, one unit eigenvector per column, in the same order as eigenvalues().
+            const Matrix& eigenvectors() const { return vectors; }
+
+            // False if the QL iteration hit its iteration limit, which only happens on non-finite input.
+            bool converged() const { return isConverged; }
+
+            // Building blocks for symmetric tridiagonal T with diagonal d and subdiagonal e (e[i] = T(i + 1, i)).
+            // Implicit QL; overwrites d with the eigenvalues, unsorted, and destroys e. Returns false if it stalled.
+            static bool tridiagonalEigenvalues(std::vector<double>& d, std::vector<double>& e);
+
+            // Unit eigenvectors for the given eigenvalues, which must be in descending order, one per row of S.
+            static void tridiagonalEigenvectors(const std::vector<double>& d, const std::vector<double>& e, const std::vector<double>& lambda, Matrix& S);
+
+            // Orthonormalizes rows [begin, end) of S, each against all the rows before it in the range.
+            // A row that lies in the span of the earlier ones is left as zero.
+            static void orthonormalizeRows(Matrix& S, int begin, int end);
+
+        private:
+            void compute(Matrix& A, int k);
+
+            Vector values;
+            Matrix vectors;
+            bool isConverged;
+    };
+}
+
+#endif /* EigenSolver_hpp */
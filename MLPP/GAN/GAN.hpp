@@ -25,6 +25,11 @@ class GAN{
         double score(); 
         void save(std::string fileName);
 
+        // Binary checkpoint of the architecture and parameters; see Checkpoint. A model without layers takes the saved
+        // architecture on load, one with layers must match it.
+        void saveCheckpoint(std::string fileName);
+        bool loadCheckpoint(std::string fileName);
+
         void addLayer(int n_hidden, std::string activation, std::string weightInit = "Default", std::string reg = "None", double lambda = 0.5, double alpha = 0.5); 
         void addOutputLayer(std::string weightInit = "Default", std::string reg = "None", double lambda = 0.5, double alpha = 0.5); 
         
@@ -0,0 +1,924 @@
+//
+//  GEMM.cpp
+//
+//  Packed, cache-blocked general matrix multiplication.
+//
+
+#include "GEMM.hpp"
+#include "ThreadPool/ThreadPool.hpp"
+#include "VecMath/VecMath.hpp"
+#include <algorithm>
+#include <atomic>
+#include <cstring>
+#include <functional>
+#include <vector>
+
+#if defined(__x86_64__) || defined(__i386__)
+#include <immintrin.h>
+#define MLPP_GEMM_X86
+#endif
+
+namespace MLPP{
+    namespace {
+        // Blocking follows the usual Goto/BLIS layout: a KC x NC panel of B stays in L3, an MC x KC block of A in L2,
+        // and the micro-kernel streams one MR x KC sliver of A against one KC x NR sliver of B out of L1.
+        // MC and NC are multiples of every MR and NR below, so packed blocks never outgrow their buffers.
+        const int MC = 96;
+        const int KC = 256;
+        const int NC = 1536;
+
+        // Products this small are cheaper to compute directly than to pack.
+        const long SMALL_GEMM = 4096;
+
+        // Below roughly 64^3 multiply-adds, handing stripes to other threads costs more than it saves.
+        const long PARALLEL_GEMM = 1L << 18;
+
+        // T is double or float throughout; the float kernels have twice the lanes per register.
+        template <class T>
+        struct KernelInfo{
+            int mr;
+            int nr;
+            void (*fn)(int kc, const T* Ap, const T* Bp, T* C, int ldc, T alpha, T beta);
+        };
+
+        template <class T, int MR, int NR>
+        inline void storeTile(const T* acc, T* C, int ldc, T alpha, T beta){
+            for(int i = 0; i < MR; i++){
+                for(int j = 0; j < NR; j++){
+                    T value = alpha * acc[i * NR + j];
+                    C[(long)i * ldc + j] = beta == 0 ? value : value + beta * C[(long)i * ldc + j];
+                }
+            }
+        }
+
+        template <class T>
+        void scalarKernel(int kc, const T* Ap, const T* Bp, T* C, int ldc, T alpha, T beta){
+            T acc[4 * 4] = {};
+            for(int p = 0; p < kc; p++){
+                for(int i = 0; i < 4; i++){
+                    const T a = Ap[i];
+                    for(int j = 0; j < 4; j++){
+                        acc[i * 4 + j] += a * Bp[j];
+                    }
+                }
+                Ap += 4;
+                Bp += 4;
+            }
+            storeTile<T, 4, 4>(acc, C, ldc, alpha, beta);
+        }
+
+        #ifdef MLPP_GEMM_X86
+        // 6 x 8 tile: twelve ymm accumulators, two B loads and six A broadcasts per step of k.
+        __attribute__((target("avx2,fma")))
+        void avx2Kernel(int kc, const double* Ap, const double* Bp, double* C, int ldc, double alpha, double beta){
+            __m256d c[6][2];
+            #pragma GCC unroll 6
+            for(int i = 0; i < 6; i++){
+                c[i][0] = _mm256_setzero_pd();
+                c[i][1] = _mm256_setzero_pd();
+            }
+            for(int p = 0; p < kc; p++){
+                const __m256d b0 = _mm256_loadu_pd(Bp);
+                const __m256d b1 = _mm256_loadu_pd(Bp + 4);
+                #pragma GCC unroll 6
+                for(int i = 0; i < 6; i++){
+                    const __m256d a = _mm256_broadcast_sd(Ap + i);
+                    c[i][0] = _mm256_fmadd_pd(a, b0, c[i][0]);
+                    c[i][1] = _mm256_fmadd_pd(a, b1, c[i][1]);
+                }
+                Ap += 6;
+                Bp += 8;
+            }
+            const __m256d va = _mm256_set1_pd(alpha);
+            const __m256d vb = _mm256_set1_pd(beta);
+            #pragma GCC unroll 6
+            for(int i = 0; i < 6; i++){
+                double* Ci = C + (long)i * ldc;
+                if(beta == 0){
+                    _mm256_storeu_pd(Ci, _mm256_mul_pd(va, c[i][0]));
+                    _mm256_storeu_pd(Ci + 4, _mm256_mul_pd(va, c[i][1]));
+                }
+                else{
+                    _mm256_storeu_pd(Ci, _mm256_fmadd_pd(vb, _mm256_loadu_pd(Ci), _mm256_mul_pd(va, c[i][0])));
+                    _mm256_storeu_pd(Ci + 4, _mm256_fmadd_pd(vb, _mm256_loadu_pd(Ci + 4), _mm256_mul_pd(va, c[i][1])));
+                }
+            }
+        }
+
+        // 8 x 24 tile: twenty-four zmm accumulators, three B loads and eight A broadcasts per step of k.
+        __attribute__((target("avx512f")))
+        void avx512Kernel(int kc, const double* Ap, const double* Bp, double* C, int ldc, double alpha, double beta){
+            __m512d c[8][3];
+            #pragma GCC unroll 8
+            for(int i = 0; i < 8; i++){
+                c[i][0] = _mm512_setzero_pd();
+                c[i][1] = _mm512_setzero_pd();
+                c[i][2] = _mm512_setzero_pd();
+            }
+            for(int p = 0; p < kc; p++){
+                const __m512d b0 = _mm512_loadu_pd(Bp);
+                const __m512d b1 = _mm512_loadu_pd(Bp + 8);
+                const __m512d b2 = _mm512_loadu_pd(Bp + 16);
+                #pragma GCC unroll 8
+                for(int i = 0; i < 8; i++){
+                    const __m512d a = _mm512_set1_pd(Ap[i]);
+                    c[i][0] = _mm512_fmadd_pd(a, b0, c[i][0]);
+                    c[i][1] = _mm512_fmadd_pd(a, b1, c[i][1]);
+                    c[i][2] = _mm512_fmadd_pd(a, b2, c[i][2]);
+                }
+                Ap += 8;
+                Bp += 24;
+            }
+            const __m512d va = _mm512_set1_pd(alpha);
+            const __m512d vb = _mm512_set1_pd(beta);
+            #pragma GCC unroll 8
+            for(int i = 0; i < 8; i++){
+                double* Ci = C + (long)i * ldc;
+                #pragma GCC unroll 3
+                for(int j = 0; j < 3; j++){
+                    if(beta == 0){
+                        _mm512_storeu_pd(Ci + 8 * j, _mm512_mul_pd(va, c[i][j]));
+                    }
+                    else{
+                        _mm512_storeu_pd(Ci + 8 * j, _mm512_fmadd_pd(vb, _mm512_loadu_pd(Ci + 8 * j), _mm512_mul_pd(va, c[i][j])));
+                    }
+                }
+            }
+        }
+
+        // 6 x 16 single precision tile, laid out as the double one.
+        __attribute__((target("avx2,fma")))
+        void avx2KernelFloat(int kc, const float* Ap, const float* Bp, float* C, int ldc, float alpha, float beta){
+            __m256 c[6][2];
+            #pragma GCC unroll 6
+            for(int i = 0; i < 6; i++){
+                c[i][0] = _mm256_setzero_ps();
+                c[i][1] = _mm256_setzero_ps();
+            }
+            for(int p = 0; p < kc; p++){
+                const __m256 b0 = _mm256_loadu_ps(Bp);
+                const __m256 b1 = _mm256_loadu_ps(Bp + 8);
+                #pragma GCC unroll 6
+                for(int i = 0; i < 6; i++){
+                    const __m256 a = _mm256_broadcast_ss(Ap + i);
+                    c[i][0] = _mm256_fmadd_ps(a, b0, c[i][0]);
+                    c[i][1] = _mm256_fmadd_ps(a, b1, c[i][1]);
+                }
+                Ap += 6;
+                Bp += 16;
+            }
+            const __m256 va = _mm256_set1_ps(alpha);
+            const __m256 vb = _mm256_set1_ps(beta);
+            #pragma GCC unroll 6
+            for(int i = 0; i < 6; i++){
+                float* Ci = C + (long)i * ldc;
+                if(beta == 0){
+                    _mm256_storeu_ps(Ci, _mm256_mul_ps(va, c[i][0]));
+                    _mm256_storeu_ps(Ci + 8, _mm256_mul_ps(va, c[i][1]));
+                }
+                else{
+                    _mm256_storeu_ps(Ci, _mm256_fmadd_ps(vb, _mm256_loadu_ps(Ci), _mm256_mul_ps(va, c[i][0])));
+                    _mm256_storeu_ps(Ci + 8, _mm256_fmadd_ps(vb, _mm256_loadu_ps(Ci + 8), _mm256_mul_ps(va, c[i][1])));
+                }
+            }
+        }
+
+        // 8 x 48 single precision tile.
+        __attribute__((target("avx512f")))
+        void avx512KernelFloat(int kc, const float* Ap, const float* Bp, float* C, int ldc, float alpha, float beta){
+            __m512 c[8][3];
+            #pragma GCC unroll 8
+            for(int i = 0; i < 8; i++){
+                c[i][0] = _mm512_setzero_ps();
+                c[i][1] = _mm512_setzero_ps();
+                c[i][2] = _mm512_setzero_ps();
+            }
+            for(int p = 0; p < kc; p++){
+                const __m512 b0 = _mm512_loadu_ps(Bp);
+                const __m512 b1 = _mm512_loadu_ps(Bp + 16);
+                const __m512 b2 = _mm512_loadu_ps(Bp + 32);
+                #pragma GCC unroll 8
+                for(int i = 0; i < 8; i++){
+                    const __m512 a = _mm512_set1_ps(Ap[i]);
+                    c[i][0] = _mm512_fmadd_ps(a, b0, c[i][0]);
+                    c[i][1] = _mm512_fmadd_ps(a, b1, c[i][1]);
+                    c[i][2] = _mm512_fmadd_ps(a, b2, c[i][2]);
+                }
+                Ap += 8;
+                Bp += 48;
+            }
+            const __m512 va = _mm512_set1_ps(alpha);
+            const __m512 vb = _mm512_set1_ps(beta);
+            #pragma GCC unroll 8
+            for(int i = 0; i < 8; i++){
+                float* Ci = C + (long)i * ldc;
+                #pragma GCC unroll 3
+                for(int j = 0; j < 3; j++){
+                    if(beta == 0){
+                        _mm512_storeu_ps(Ci + 16 * j, _mm512_mul_ps(va, c[i][j]));
+                    }
+                    else{
+                        _mm512_storeu_ps(Ci + 16 * j, _mm512_fmadd_ps(vb, _mm512_loadu_ps(Ci + 16 * j), _mm512_mul_ps(va, c[i][j])));
+                    }
+                }
+            }
+        }
+
+        // Fewer rows of op(A) than a micro-tile against an untransposed B. Packing would cost as much as the product, so
+        // each strip of C columns is instead accumulated in registers over the whole depth, reading B straight from memory
+        // once per row; the strip stays in cache for the next row. Used for single samples pushed through a layer.
+        __attribute__((target("avx2,fma")))
+        void avx2Rows(bool transA, int m, int n, int k, double alpha, const double* A, int lda, const double* B, int ldb, double beta, double* C, int ldc){
+            const __m256d va = _mm256_set1_pd(alpha);
+            const __m256d vb = _mm256_set1_pd(beta);
+            int j = 0;
+            for(; j + 16 <= n; j += 16){
+                for(int i = 0; i < m; i++){
+                    __m256d c[4] = {_mm256_setzero_pd(), _mm256_setzero_pd(), _mm256_setzero_pd(), _mm256_setzero_pd()};
+                    for(int p = 0; p < k; p++){
+                        const __m256d a = _mm256_set1_pd(transA ? A[(long)p * lda + i] : A[(long)i * lda + p]);
+                        const double* b = B + (long)p * ldb + j;
+                        #pragma GCC unroll 4
+                        for(int r = 0; r < 4; r++){ c[r] = _mm256_fmadd_pd(a, _mm256_loadu_pd(b + 4 * r), c[r]); }
+                    }
+                    double* Ci = C + (long)i * ldc + j;
+                    #pragma GCC unroll 4
+                    for(int r = 0; r < 4; r++){
+                        __m256d value = _mm256_mul_pd(va, c[r]);
+                        _mm256_storeu_pd(Ci + 4 * r, beta == 0 ? value : _mm256_fmadd_pd(vb, _mm256_loadu_pd(Ci + 4 * r), value));
+                    }
+                }
+            }
+            for(; j < n; j += 4){
+                int cols = std::min(4, n - j);
+                const __m256i mask = _mm256_cmpgt_epi64(_mm256_set1_epi64x(cols), _mm256_set_epi64x(3, 2, 1, 0));
+                for(int i = 0; i < m; i++){
+                    __m256d c = _mm256_setzero_pd();
+                    for(int p = 0; p < k; p++){
+                        const __m256d a = _mm256_set1_pd(transA ? A[(long)p * lda + i] : A[(long)i * lda + p]);
+                        c = _mm256_fmadd_pd(a, _mm256_maskload_pd(B + (long)p * ldb + j, mask), c);
+                    }
+                    double* Ci = C + (long)i * ldc + j;
+                    __m256d value = _mm256_mul_pd(va, c);
+                    _mm256_maskstore_pd(Ci, mask, beta == 0 ? value : _mm256_fmadd_pd(vb, _mm256_maskload_pd(Ci, mask), value));
+                }
+            }
+        }
+
+        __attribute__((target("avx512f")))
+        void avx512Rows(bool transA, int m, int n, int k, double alpha, const double* A, int lda, const double* B, int ldb, double beta, double* C, int ldc){
+            const __m512d va = _mm512_set1_pd(alpha);
+            const __m512d vb = _mm512_set1_pd(beta);
+            int j = 0;
+            for(; j + 32 <= n; j += 32){
+                for(int i = 0; i < m; i++){
+                    __m512d c[4] = {_mm512_setzero_pd(), _mm512_setzero_pd(), _mm512_setzero_pd(), _mm512_setzero_pd()};
+                    for(int p = 0; p < k; p++){
+                        const __m512d a = _mm512_set1_pd(transA ? A[(long)p * lda + i] : A[(long)i * lda + p]);
+                        const double* b = B + (long)p * ldb + j;
+                        #pragma GCC unroll 4
+                        for(int r = 0; r < 4; r++){ c[r] = _mm512_fmadd_pd(a, _mm512_loadu_pd(b + 8 * r), c[r]); }
+                    }
+                    double* Ci = C + (long)i * ldc + j;
+                    #pragma GCC unroll 4
+                    for(int r = 0; r < 4; r++){
+                        __m512d value = _mm512_mul_pd(va, c[r]);
+                        _mm512_storeu_pd(Ci + 8 * r, beta == 0 ? value : _mm512_fmadd_pd(vb, _mm512_loadu_pd(Ci + 8 * r), value));
+                    }
+                }
+            }
+            for(; j < n; j += 8){
+                const __mmask8 mask = n - j >= 8 ? 0xFF : (1 << (n - j)) - 1;
+                for(int i = 0; i < m; i++){
+                    __m512d c = _mm512_setzero_pd();
+                    for(int p = 0; p < k; p++){
+                        const __m512d a = _mm512_set1_pd(transA ? A[(long)p * lda + i] : A[(long)i * lda + p]);
+                        c = _mm512_fmadd_pd(a, _mm512_maskz_loadu_pd(mask, B + (long)p * ldb + j), c);
+                    }
+                    double* Ci = C + (long)i * ldc + j;
+                    __m512d value = _mm512_mul_pd(va, c);
+                    _mm512_mask_storeu_pd(Ci, mask, beta == 0 ? value : _mm512_fmadd_pd(vb, _mm512_maskz_loadu_pd(mask, Ci), value));
+                }
+            }
+        }
+
+        __attribute__((target("avx2,fma")))
+        void avx2RowsFloat(bool transA, int m, int n, int k, float alpha, const float* A, int lda, const float* B, int ldb, float beta, float* C, int ldc){
+            const __m256 va = _mm256_set1_ps(alpha);
+            const __m256 vb = _mm256_set1_ps(beta);
+            int j = 0;
+            for(; j + 32 <= n; j += 32){
+                for(int i = 0; i < m; i++){
+                    __m256 c[4] = {_mm256_setzero_ps(), _mm256_setzero_ps(), _mm256_setzero_ps(), _mm256_setzero_ps()};
+                    for(int p = 0; p < k; p++){
+                        const __m256 a = _mm256_set1_ps(transA ? A[(long)p * lda + i] : A[(long)i * lda + p]);
+                        const float* b = B + (long)p * ldb + j;
+                        #pragma GCC unroll 4
+                        for(int r = 0; r < 4; r++){ c[r] = _mm256_fmadd_ps(a, _mm256_loadu_ps(b + 8 * r), c[r]); }
+                    }
+                    float* Ci = C + (long)i * ldc + j;
+                    #pragma GCC unroll 4
+                    for(int r = 0; r < 4; r++){
+                        __m256 value = _mm256_mul_ps(va, c[r]);
+                        _mm256_storeu_ps(Ci + 8 * r, beta == 0 ? value : _mm256_fmadd_ps(vb, _mm256_loadu_ps(Ci + 8 * r), value));
+                    }
+                }
+            }
+            for(; j < n; j += 8){
+                int cols = std::min(8, n - j);
+                const __m256i mask = _mm256_cmpgt_epi32(_mm256_set1_epi32(cols), _mm256_setr_epi32(0, 1, 2, 3, 4, 5, 6, 7));
+                for(int i = 0; i < m; i++){
+                    __m256 c = _mm256_setzero_ps();
+                    for(int p = 0; p < k; p++){
+                        const __m256 a = _mm256_set1_ps(transA ? A[(long)p * lda + i] : A[(long)i * lda + p]);
+                        c = _mm256_fmadd_ps(a, _mm256_maskload_ps(B + (long)p * ldb + j, mask), c);
+                    }
+                    float* Ci = C + (long)i * ldc + j;
+                    __m256 value = _mm256_mul_ps(va, c);
+                    _mm256_maskstore_ps(Ci, mask, beta == 0 ? value : _mm256_fmadd_ps(vb, _mm256_maskload_ps(Ci, mask), value));
+                }
+            }
+        }
+
+        __attribute__((target("avx512f")))
+        void avx512RowsFloat(bool transA, int m, int n, int k, float alpha, const float* A, int lda, const float* B, int ldb, float beta, float* C, int ldc){
+            const __m512 va = _mm512_set1_ps(alpha);
+            const __m512 vb = _mm512_set1_ps(beta);
+            int j = 0;
+            for(; j + 64 <= n; j += 64){
+                for(int i = 0; i < m; i++){
+                    __m512 c[4] = {_mm512_setzero_ps(), _mm512_setzero_ps(), _mm512_setzero_ps(), _mm512_setzero_ps()};
+                    for(int p = 0; p < k; p++){
+                        const __m512 a = _mm512_set1_ps(transA ? A[(long)p * lda + i] : A[(long)i * lda + p]);
+                        const float* b = B + (long)p * ldb + j;
+                        #pragma GCC unroll 4
+                        for(int r = 0; r < 4; r++){ c[r] = _mm512_fmadd_ps(a, _mm512_loadu_ps(b + 16 * r), c[r]); }
+                    }
+                    float* Ci = C + (long)i * ldc + j;
+                    #pragma GCC unroll 4
+                    for(int r = 0; r < 4; r++){
+                        __m512 value = _mm512_mul_ps(va, c[r]);
+                        _mm512_storeu_ps(Ci + 16 * r, beta == 0 ? value : _mm512_fmadd_ps(vb, _mm512_loadu_ps(Ci + 16 * r), value));
+                    }
+                }
+            }
+            for(; j < n; j += 16){
+                const __mmask16 mask = n - j >= 16 ? 0xFFFF : (1 << (n - j)) - 1;
+                for(int i = 0; i < m; i++){
+                    __m512 c = _mm512_setzero_ps();
+                    for(int p = 0; p < k; p++){
+                        const __m512 a = _mm512_set1_ps(transA ? A[(long)p * lda + i] : A[(long)i * lda + p]);
+                        c = _mm512_fmadd_ps(a, _mm512_maskz_loadu_ps(mask, B + (long)p * ldb + j), c);
+                    }
+                    float* Ci = C + (long)i * ldc + j;
+                    __m512 value = _mm512_mul_ps(va, c);
+                    _mm512_mask_storeu_ps(Ci, mask, beta == 0 ? value : _mm512_fmadd_ps(vb, _mm512_maskz_loadu_ps(mask, Ci), value));
+                }
+            }
+        }
+        #endif
+
+        GEMM::Kernel bestKernel(){
+            #ifdef MLPP_GEMM_X86
+            __builtin_cpu_init();
+            if(__builtin_cpu_supports("avx512f")){ return GEMM::AVX512; }
+            if(__builtin_cpu_supports("avx2") && __builtin_cpu_supports("fma")){ return GEMM::AVX2; }
+            #endif
+            return GEMM::Scalar;
+        }
+
+        std::atomic<int> activeKernel(GEMM::Auto);
+
+        KernelInfo<double> kernelInfo(GEMM::Kernel kernel, double){
+            #ifdef MLPP_GEMM_X86
+            if(kernel == GEMM::AVX512){ return {8, 24, &avx512Kernel}; }
+            if(kernel == GEMM::AVX2){ return {6, 8, &avx2Kernel}; }
+            #endif
+            return {4, 4, &scalarKernel<double>};
+        }
+
+        KernelInfo<float> kernelInfo(GEMM::Kernel kernel, float){
+            #ifdef MLPP_GEMM_X86
+            if(kernel == GEMM::AVX512){ return {8, 48, &avx512KernelFloat}; }
+            if(kernel == GEMM::AVX2){ return {6, 16, &avx2KernelFloat}; }
+            #endif
+            return {4, 4, &scalarKernel<float>};
+        }
+
+        #ifdef MLPP_GEMM_X86
+        void rowsKernel(GEMM::Kernel kernel, bool transA, int m, int n, int k, double alpha, const double* A, int lda, const double* B, int ldb, double beta, double* C, int ldc){
+            if(kernel == GEMM::AVX512){ avx512Rows(transA, m, n, k, alpha, A, lda, B, ldb, beta, C, ldc); }
+            else{ avx2Rows(transA, m, n, k, alpha, A, lda, B, ldb, beta, C, ldc); }
+        }
+
+        void rowsKernel(GEMM::Kernel kernel, bool transA, int m, int n, int k, float alpha, const float* A, int lda, const float* B, int ldb, float beta, float* C, int ldc){
+            if(kernel == GEMM::AVX512){ avx512RowsFloat(transA, m, n, k, alpha, A, lda, B, ldb, beta, C, ldc); }
+            else{ avx2RowsFloat(transA, m, n, k, alpha, A, lda, B, ldb, beta, C, ldc); }
+        }
+        #endif
+
+        // Packs an mc x kc block of op(A) into row slivers of height mr, zero-padding the last sliver.
+        template <class T>
+        void packA(bool transA, const T* A, int lda, int i0, int k0, int mc, int kc, int mr, T* Ap){
+            for(int ip = 0; ip < mc; ip += mr){
+                int rows = std::min(mr, mc - ip);
+                if(transA){
+                    for(int p = 0; p < kc; p++){
+                        const T* a = A + (long)(k0 + p) * lda + i0 + ip;
+                        for(int r = 0; r < rows; r++){ Ap[p * mr + r] = a[r]; }
+                        for(int r = rows; r < mr; r++){ Ap[p * mr + r] = 0; }
+                    }
+                }
+                else{
+                    for(int r = 0; r < rows; r++){
+                        const T* a = A + (long)(i0 + ip + r) * lda + k0;
+                        for(int p = 0; p < kc; p++){ Ap[p * mr + r] = a[p]; }
+                    }
+                    for(int r = rows; r < mr; r++){
+                        for(int p = 0; p < kc; p++){ Ap[p * mr + r] = 0; }
+                    }
+                }
+                Ap += mr * kc;
+            }
+        }
+
+        // Packs a kc x nc block of op(B) into column slivers of width nr, zero-padding the last sliver.
+        template <class T>
+        void packB(bool transB, const T* B, int ldb, int k0, int j0, int kc, int nc, int nr, T* Bp){
+            for(int jp = 0; jp < nc; jp += nr){
+                int cols = std::min(nr, nc - jp);
+                if(transB){
+                    for(int c = 0; c < cols; c++){
+                        const T* b = B + (long)(j0 + jp + c) * ldb + k0;
+                        for(int p = 0; p < kc; p++){ Bp[p * nr + c] = b[p]; }
+                    }
+                    for(int c = cols; c < nr; c++){
+                        for(int p = 0; p < kc; p++){ Bp[p * nr + c] = 0; }
+                    }
+                }
+                else{
+                    for(int p = 0; p < kc; p++){
+                        const T* b = B + (long)(k0 + p) * ldb + j0 + jp;
+                        for(int c = 0; c < cols; c++){ Bp[p * nr + c] = b[c]; }
+                        for(int c = cols; c < nr; c++){ Bp[p * nr + c] = 0; }
+                    }
+                }
+                Bp += nr * kc;
+            }
+        }
+
+        // Work done on a block of C once it holds its final product, in place of a separate pass over the whole matrix.
+        // act and z are indexed like C.
+        template <class T>
+        struct Epilogue{
+            const T* bias;
+            GEMM::ElementwiseFunction f;
+            T* act; // Forward: act = f(C + bias).
+            int ldact;
+            const T* z; // Backward: C = C ⊙ f'(z).
+            int ldz;
+        };
+
+        // The same epilogue for the sub-matrix of C starting at row i and column j.
+        template <class T>
+        Epilogue<T> offset(const Epilogue<T>& e, long i, long j){
+            Epilogue<T> shifted = e;
+            if(e.bias){ shifted.bias += j; }
+            if(e.act){ shifted.act += i * e.ldact + j; }
+            if(e.z){ shifted.z += i * e.ldz + j; }
+            return shifted;
+        }
+
+        // C points at element (i0, j0) of the full matrix. When the rows of the block are contiguous in every buffer, the
+        // element-wise map runs over the whole block in one call rather than row by row.
+        void map(GEMM::ElementwiseFunction f, const double* x, double* y, long n){
+            f(x, y, n, 0);
+        }
+
+        void scaleByDerivative(GEMM::ElementwiseFunction f, const double* z, double* c, long n){
+            double deriv[256];
+            for(long q = 0; q < n; q += 256){
+                int len = (int)std::min(256L, n - q);
+                f(z + q, deriv, len, 1);
+                VecMath::hadamard(c + q, deriv, c + q, len);
+            }
+        }
+
+        // The element-wise functions work in double, so single precision goes through them a chunk at a time.
+        void map(GEMM::ElementwiseFunction f, const float* x, float* y, long n){
+            double chunk[256];
+            for(long q = 0; q < n; q += 256){
+                int len = (int)std::min(256L, n - q);
+                std::copy(x + q, x + q + len, chunk);
+                f(chunk, chunk, len, 0);
+                std::copy(chunk, chunk + len, y + q);
+            }
+        }
+
+        void scaleByDerivative(GEMM::ElementwiseFunction f, const float* z, float* c, long n){
+            double deriv[256];
+            for(long q = 0; q < n; q += 256){
+                int len = (int)std::min(256L, n - q);
+                std::copy(z + q, z + q + len, deriv);
+                f(deriv, deriv, len, 1);
+                for(int i = 0; i < len; i++){ c[q + i] *= deriv[i]; }
+            }
+        }
+
+        template <class T>
+        void finish(const Epilogue<T>& e, T* C, int ldc, int i0, int j0, int rows, int cols){
+            if(e.bias){
+                for(int i = 0; i < rows; i++){
+                    T* c = C + (long)i * ldc;
+                    for(int j = 0; j < cols; j++){ c[j] += e.bias[j0 + j]; }
+                }
+            }
+            long n = cols;
+            int lines = rows;
+            if(cols == ldc && (!e.act || e.ldact == ldc) && (!e.z || e.ldz == ldc)){
+                n = (long)rows * cols;
+                lines = 1;
+            }
+            for(int i = 0; i < lines; i++){
+                T* c = C + (long)i * ldc;
+                if(e.act){
+                    map(e.f, c, e.act + (long)(i0 + i) * e.ldact + j0, n);
+                }
+                if(e.z){
+                    scaleByDerivative(e.f, e.z + (long)(i0 + i) * e.ldz + j0, c, n);
+                }
+            }
+        }
+
+        template <class T>
+        void scaleC(int m, int n, T beta, T* C, int ldc){
+            for(int i = 0; i < m; i++){
+                T* c = C + (long)i * ldc;
+                for(int j = 0; j < n; j++){
+                    c[j] = beta == 0 ? 0 : beta * c[j];
+                }
+            }
+        }
+
+        template <class T>
+        void smallGemm(bool transA, bool transB, int m, int n, int k, T alpha, const T* A, int lda, const T* B, int ldb, T beta, T* C, int ldc, const Epilogue<T>* epilogue){
+            for(int i = 0; i < m; i++){
+                T* c = C + (long)i * ldc;
+                for(int j = 0; j < n; j++){
+                    T sum = 0;
+                    for(int p = 0; p < k; p++){
+                        T a = transA ? A[(long)p * lda + i] : A[(long)i * lda + p];
+                        T b = transB ? B[(long)j * ldb + p] : B[(long)p * ldb + j];
+                        sum += a * b;
+                    }
+                    c[j] = beta == 0 ? alpha * sum : alpha * sum + beta * c[j];
+                }
+                if(epilogue){ finish(*epilogue, c, ldc, i, 0, 1, n); }
+            }
+        }
+
+        template <class T>
+        void blockedGemm(bool transA, bool transB, int m, int n, int k, T alpha, const T* A, int lda, const T* B, int ldb, T beta, T* C, int ldc, const Epilogue<T>* epilogue){
+            KernelInfo<T> info = kernelInfo(GEMM::kernel(), T());
+            const int MR = info.mr;
+            const int NR = info.nr;
+
+            thread_local std::vector<T> Abuf;
+            thread_local std::vector<T> Bbuf;
+            Abuf.resize((long)MC * KC);
+            Bbuf.resize((long)KC * NC);
+            T tile[8 * 48];
+
+            for(int jc = 0; jc < n; jc += NC){
+                int nc = std::min(NC, n - jc);
+                for(int pc = 0; pc < k; pc += KC){
+                    int kc = std::min(KC, k - pc);
+                    T betaBlock = pc == 0 ? beta : 1; // Later depth blocks accumulate onto the first.
+                    const Epilogue<T>* last = pc + kc == k ? epilogue : nullptr;
+                    packB(transB, B, ldb, pc, jc, kc, nc, NR, Bbuf.data());
+
+                    for(int ic = 0; ic < m; ic += MC){
+                        int mc = std::min(MC, m - ic);
+                        packA(transA, A, lda, ic, pc, mc, kc, MR, Abuf.data());
+
+                        for(int jr = 0; jr < nc; jr += NR){
+                            int nr = std::min(NR, nc - jr);
+                            for(int ir = 0; ir < mc; ir += MR){
+                                int mr = std::min(MR, mc - ir);
+                                T* Cij = C + (long)(ic + ir) * ldc + jc + jr;
+                                const T* Ap = Abuf.data() + (long)ir * kc;
+                                const T* Bp = Bbuf.data() + (long)jr * kc;
+                                if(mr == MR && nr == NR){
+                                    info.fn(kc, Ap, Bp, Cij, ldc, alpha, betaBlock);
+                                }
+                                else{ // Edge tile: compute the full tile aside and copy back the valid part.
+                                    info.fn(kc, Ap, Bp, tile, NR, 1, 0);
+                                    for(int i = 0; i < mr; i++){
+                                        for(int j = 0; j < nr; j++){
+                                            T value = alpha * tile[i * NR + j];
+                                            T& c = Cij[(long)i * ldc + j];
+                                            c = betaBlock == 0 ? value : value + betaBlock * c;
+                                        }
+                                    }
+                                }
+                            }
+                        }
+                        if(last){ finish(*last, C + (long)ic * ldc + jc, ldc, ic, jc, mc, nc); }
+                    }
+                }
+            }
+        }
+
+        template <class T>
+        void multiply(bool transA, bool transB, int m, int n, int k, T alpha, const T* A, int lda, const T* B, int ldb, T beta, T* C, int ldc, const Epilogue<T>* epilogue){
+            if(m <= 0 || n <= 0){ return; }
+            if(k <= 0 || alpha == 0){
+                scaleC(m, n, beta, C, ldc);
+                if(epilogue){ finish(*epilogue, C, ldc, 0, 0, m, n); }
+                return;
+            }
+            #ifdef MLPP_GEMM_X86
+            GEMM::Kernel kernel = GEMM::kernel();
+            if(!transB && kernel != GEMM::Scalar && m < kernelInfo(kernel, T()).mr){
+                rowsKernel(kernel, transA, m, n, k, alpha, A, lda, B, ldb, beta, C, ldc);
+                if(epilogue){ finish(*epilogue, C, ldc, 0, 0, m, n); }
+                return;
+            }
+            #endif
+            if((long)m * n * k <= SMALL_GEMM){
+                smallGemm(transA, transB, m, n, k, alpha, A, lda, B, ldb, beta, C, ldc, epilogue);
+                return;
+            }
+            if((long)m * n * k < PARALLEL_GEMM || ThreadPool::numThreads() == 1){
+                blockedGemm(transA, transB, m, n, k, alpha, A, lda, B, ldb, beta, C, ldc, epilogue);
+                return;
+            }
+
+            // Each thread owns a stripe of C along its longer side and packs its own blocks, so no synchronisation is needed.
+            // The stripes are passed by reference so that the std::function wrapping them does not allocate.
+            if(m >= n){
+                auto rowStripe = [&](long begin, long end){
+                    const T* Ai = transA ? A + begin : A + begin * lda;
+                    Epilogue<T> stripe;
+                    if(epilogue){ stripe = offset(*epilogue, begin, 0); }
+                    blockedGemm(transA, transB, int(end - begin), n, k, alpha, Ai, lda, B, ldb, beta, C + begin * ldc, ldc, epilogue ? &stripe : nullptr);
+                };
+                ThreadPool::parallelFor(m, 32, std::cref(rowStripe));
+            }
+            else{
+                auto columnStripe = [&](long begin, long end){
+                    const T* Bj = transB ? B + begin * ldb : B + begin;
+                    Epilogue<T> stripe;
+                    if(epilogue){ stripe = offset(*epilogue, 0, begin); }
+                    blockedGemm(transA, transB, m, int(end - begin), k, alpha, A, lda, Bj, ldb, beta, C + begin, ldc, epilogue ? &stripe : nullptr);
+                };
+                ThreadPool::parallelFor(n, 64, std::cref(columnStripe));
+            }
+        }
+
+        // Int8 products. The packed B holds groups of four consecutive rows, zero-padded to a multiple of four, with the
+        // four bytes of each column adjacent and the columns padded to a multiple of 16. Four bytes of a row of A, read
+        // as one int32, against one group is then a four-way dot product per column.
+        int int8Columns(int n){
+            return (n + 15) / 16 * 16;
+        }
+
+        inline int32_t group(const uint8_t* a){
+            int32_t value;
+            std::memcpy(&value, a, 4);
+            return value;
+        }
+
+        void scalarInt8(int m, int n, int groups, const uint8_t* A, int lda, const int8_t* Bp, const double* scale, const double* offset, double* C, int ldc){
+            const int np = int8Columns(n);
+            for(int i = 0; i < m; i++){
+                const uint8_t* a = A + (long)i * lda;
+                for(int j = 0; j < n; j += 16){
+                    // Sixteen columns at a time, so each group of B is read front to back.
+                    int32_t acc[16] = {};
+                    for(int q = 0; q < groups; q++){
+                        const int8_t* b = Bp + ((long)q * np + j) * 4;
+                        for(int c = 0; c < 16; c++){
+                            for(int r = 0; r < 4; r++){ acc[c] += a[4 * q + r] * b[4 * c + r]; }
+                        }
+                    }
+                    for(int c = 0; c < std::min(16, n - j); c++){
+                        C[(long)i * ldc + j + c] = acc[c] * scale[j + c] + offset[j + c];
+                    }
+                }
+            }
+        }
+
+        #ifdef MLPP_GEMM_X86
+        // R rows x 8 columns. AVX2 has no u8 x s8 dot product that cannot saturate, so both sides are widened to 16 bits
+        // and multiplied in pairs, leaving two partial sums per column that are added once at the end.
+        template <int R>
+        __attribute__((target("avx2,fma")))
+        void avx2Int8Tile(int groups, int np, const uint8_t* A, int lda, const int8_t* Bp, int n, const double* scale, const double* offset, double* C, int ldc){
+            __m256i acc[R][2];
+            #pragma GCC unroll 4
+            for(int r = 0; r < R; r++){
+                acc[r][0] = _mm256_setzero_si256();
+                acc[r][1] = _mm256_setzero_si256();
+            }
+            for(int q = 0; q < groups; q++){
+                __m256i bytes = _mm256_loadu_si256((const __m256i*)(Bp + (long)q * np * 4));
+                __m256i b0 = _mm256_cvtepi8_epi16(_mm256_castsi256_si128(bytes));
+                __m256i b1 = _mm256_cvtepi8_epi16(_mm256_extracti128_si256(bytes, 1));
+                #pragma GCC unroll 4
+                for(int r = 0; r < R; r++){
+                    __m256i a = _mm256_broadcastq_epi64(_mm_cvtepu8_epi16(_mm_cvtsi32_si128(group(A + (long)r * lda + 4 * q))));
+                    acc[r][0] = _mm256_add_epi32(acc[r][0], _mm256_madd_epi16(a, b0));
+                    acc[r][1] = _mm256_add_epi32(acc[r][1], _mm256_madd_epi16(a, b1));
+                }
+            }
+            #pragma GCC unroll 4
+            for(int r = 0; r < R; r++){
+                // hadd leaves the columns in the order 0 1 4 5 | 2 3 6 7.
+                __m256i sums = _mm256_permute4x64_epi64(_mm256_hadd_epi32(acc[r][0], acc[r][1]), 0xD8);
+                double* Ci = C + (long)r * ldc;
+                if(n >= 8){
+                    __m256d lo = _mm256_cvtepi32_pd(_mm256_castsi256_si128(sums));
+                    __m256d hi = _mm256_cvtepi32_pd(_mm256_extracti128_si256(sums, 1));
+                    _mm256_storeu_pd(Ci, _mm256_fmadd_pd(lo, _mm256_loadu_pd(scale), _mm256_loadu_pd(offset)));
+                    _mm256_storeu_pd(Ci + 4, _mm256_fmadd_pd(hi, _mm256_loadu_pd(scale + 4), _mm256_loadu_pd(offset + 4)));
+                }
+                else{
+                    alignas(32) int32_t tail[8];
+                    _mm256_store_si256((__m256i*)tail, sums);
+                    for(int j = 0; j < n; j++){ Ci[j] = tail[j] * scale[j] + offset[j]; }
+                }
+            }
+        }
+
+        template <int R>
+        __attribute__((target("avx2,fma")))
+        void avx2Int8Rows(int n, int groups, const uint8_t* A, int lda, const int8_t* Bp, const double* scale, const double* offset, double* C, int ldc){
+            const int np = int8Columns(n);
+            for(int j = 0; j < n; j += 8){
+                avx2Int8Tile<R>(groups, np, A, lda, Bp + (long)j * 4, n - j, scale + j, offset + j, C + j, ldc);
+            }
+        }
+
+        // R rows x 16 NB columns: vpdpbusd multiplies four unsigned bytes of A by four signed bytes of B and adds all four
+        // products to a 32 bit lane, so there is nothing to widen and nothing can saturate.
+        template <int R, int NB>
+        __attribute__((target("avx512f,avx512vnni")))
+        void vnniTile(int groups, int np, const uint8_t* A, int lda, const int8_t* Bp, int n, const double* scale, const double* offset, double* C, int ldc){
+            __m512i acc[R][NB];
+            #pragma GCC unroll 4
+            for(int r = 0; r < R; r++){
+                #pragma GCC unroll 4
+                for(int c = 0; c < NB; c++){ acc[r][c] = _mm512_setzero_si512(); }
+            }
+            for(int q = 0; q < groups; q++){
+                __m512i b[NB];
+                #pragma GCC unroll 4
+                for(int c = 0; c < NB; c++){ b[c] = _mm512_loadu_si512(Bp + (long)q * np * 4 + c * 64); }
+                #pragma GCC unroll 4
+                for(int r = 0; r < R; r++){
+                    __m512i a = _mm512_set1_epi32(group(A + (long)r * lda + 4 * q));
+                    #pragma GCC unroll 4
+                    for(int c = 0; c < NB; c++){ acc[r][c] = _mm512_dpbusd_epi32(acc[r][c], a, b[c]); }
+                }
+            }
+            #pragma GCC unroll 4
+            for(int c = 0; c < NB; c++){
+                const int j = 16 * c;
+                const int left = n - j;
+                const __mmask16 mask = left >= 16 ? 0xFFFF : (1u << left) - 1;
+                const __mmask8 lo = mask & 0xFF;
+                const __mmask8 hi = mask >> 8;
+                __m512d sLo = _mm512_maskz_loadu_pd(lo, scale + j), sHi = _mm512_maskz_loadu_pd(hi, scale + j + 8);
+                __m512d oLo = _mm512_maskz_loadu_pd(lo, offset + j), oHi = _mm512_maskz_loadu_pd(hi, offset + j + 8);
+                #pragma GCC unroll 4
+                for(int r = 0; r < R; r++){
+                    double* Ci = C + (long)r * ldc + j;
+                    __m512d vLo = _mm512_cvtepi32_pd(_mm512_castsi512_si256(acc[r][c]));
+                    __m512d vHi = _mm512_cvtepi32_pd(_mm512_extracti64x4_epi64(acc[r][c], 1));
+                    _mm512_mask_storeu_pd(Ci, lo, _mm512_fmadd_pd(vLo, sLo, oLo));
+                    _mm512_mask_storeu_pd(Ci + 8, hi, _mm512_fmadd_pd(vHi, sHi, oHi));
+                }
+            }
+        }
+
+        template <int R>
+        __attribute__((target("avx512f,avx512vnni")))
+        void vnniRows(int n, int groups, const uint8_t* A, int lda, const int8_t* Bp, const double* scale, const double* offset, double* C, int ldc){
+            const int np = int8Columns(n);
+            for(int j = 0; j < np; j += 64){
+                const int8_t* Bj = Bp + (long)j * 4;
+                switch(std::min(4, (np - j) / 16)){
+                    case 4: vnniTile<R, 4>(groups, np, A, lda, Bj, n - j, scale + j, offset + j, C + j, ldc); break;
+                    case 3: vnniTile<R, 3>(groups, np, A, lda, Bj, n - j, scale + j, offset + j, C + j, ldc); break;
+                    case 2: vnniTile<R, 2>(groups, np, A, lda, Bj, n - j, scale + j, offset + j, C + j, ldc); break;
+                    default: vnniTile<R, 1>(groups, np, A, lda, Bj, n - j, scale + j, offset + j, C + j, ldc); break;
+                }
+            }
+        }
+
+        bool hasVNNI(){
+            __builtin_cpu_init();
+            return __builtin_cpu_supports("avx512f") && __builtin_cpu_supports("avx512vnni");
+        }
+        #endif
+
+        // Rows go through the kernels four at a time, with the last one to three rows in a tile of their own height.
+        void int8Rows(int m, int n, int k, const uint8_t* A, int lda, const int8_t* Bp, const double* scale, const double* offset, double* C, int ldc){
+            typedef void (*Rows)(int, int, const uint8_t*, int, const int8_t*, const double*, const double*, double*, int);
+            const int groups = (k + 3) / 4;
+            #ifdef MLPP_GEMM_X86
+            static const bool vnni = hasVNNI();
+            GEMM::Kernel kernel = GEMM::kernel();
+            if(kernel != GEMM::Scalar){
+                const Rows vnniRowsOf[4] = {&vnniRows<1>, &vnniRows<2>, &vnniRows<3>, &vnniRows<4>};
+                const Rows avx2RowsOf[4] = {&avx2Int8Rows<1>, &avx2Int8Rows<2>, &avx2Int8Rows<3>, &avx2Int8Rows<4>};
+                const Rows* rows = kernel == GEMM::AVX512 && vnni ? vnniRowsOf : avx2RowsOf;
+                for(int i = 0; i < m; i += 4){
+                    rows[std::min(4, m - i) - 1](n, groups, A + (long)i * lda, lda, Bp, scale, offset, C + (long)i * ldc, ldc);
+                }
+                return;
+            }
+            #endif
+            scalarInt8(m, n, groups, A, lda, Bp, scale, offset, C, ldc);
+        }
+    }
+
+    void GEMM::gemm(bool transA, bool transB, int m, int n, int k, double alpha, const double* A, int lda, const double* B, int ldb, double beta, double* C, int ldc){
+        multiply<double>(transA, transB, m, n, k, alpha, A, lda, B, ldb, beta, C, ldc, nullptr);
+    }
+
+    void GEMM::gemm(bool transA, bool transB, int m, int n, int k, float alpha, const float* A, int lda, const float* B, int ldb, float beta, float* C, int ldc){
+        multiply<float>(transA, transB, m, n, k, alpha, A, lda, B, ldb, beta, C, ldc, nullptr);
+    }
+
+    void GEMM::gemmBiasActivation(bool transA, bool transB, int m, int n, int k, const double* A, int lda, const double* B, int ldb, const double* bias, ElementwiseFunction f, double* Z, int ldz, double* Act, int ldact){
+        Epilogue<double> epilogue = {bias, f, f ? Act : nullptr, ldact, nullptr, 0};
+        multiply<double>(transA, transB, m, n, k, 1, A, lda, B, ldb, 0, Z, ldz, &epilogue);
+    }
+
+    void GEMM::gemmBiasActivation(bool transA, bool transB, int m, int n, int k, const float* A, int lda, const float* B, int ldb, const float* bias, ElementwiseFunction f, float* Z, int ldz, float* Act, int ldact){
+        Epilogue<float> epilogue = {bias, f, f ? Act : nullptr, ldact, nullptr, 0};
+        multiply<float>(transA, transB, m, n, k, 1, A, lda, B, ldb, 0, Z, ldz, &epilogue);
+    }
+
+    void GEMM::gemmActivationDeriv(bool transA, bool transB, int m, int n, int k, const double* A, int lda, const double* B, int ldb, ElementwiseFunction f, const double* Z, int ldz, double* C, int ldc){
+        Epilogue<double> epilogue = {nullptr, f, nullptr, 0, f ? Z : nullptr, ldz};
+        multiply<double>(transA, transB, m, n, k, 1, A, lda, B, ldb, 0, C, ldc, &epilogue);
+    }
+
+    void GEMM::gemmActivationDeriv(bool transA, bool transB, int m, int n, int k, const float* A, int lda, const float* B, int ldb, ElementwiseFunction f, const float* Z, int ldz, float* C, int ldc){
+        Epilogue<float> epilogue = {nullptr, f, nullptr, 0, f ? Z : nullptr, ldz};
+        multiply<float>(transA, transB, m, n, k, 1, A, lda, B, ldb, 0, C, ldc, &epilogue);
+    }
+
+    void GEMM::gemmInt8(int m, int n, int k, const uint8_t* A, int lda, const int8_t* Bp, const double* scale, const double* offset, double* C, int ldc){
+        if(m <= 0 || n <= 0){ return; }
+        if((long)m * n * k < PARALLEL_GEMM || ThreadPool::numThreads() == 1){
+            int8Rows(m, n, k, A, lda, Bp, scale, offset, C, ldc);
+            return;
+        }
+        auto rowStripe = [&](long begin, long end){
+            int8Rows(int(end - begin), n, k, A + begin * lda, lda, Bp, scale, offset, C + begin * ldc, ldc);
+        };
+        ThreadPool::parallelFor(m, 32, std::cref(rowStripe));
+    }
+
+    long GEMM::packedInt8Size(int k, int n){
+        return (long)(k + 3) / 4 * 4 * int8Columns(n);
+    }
+
+    void GEMM::packInt8(int k, int n, const int8_t* B, int ldb, int8_t* Bp){
+        const int np = int8Columns(n);
+        std::fill(Bp, Bp + packedInt8Size(k, n), 0);
+        for(int p = 0; p < k; p++){
+            for(int j = 0; j < n; j++){
+                Bp[((long)(p / 4) * np + j) * 4 + p % 4] = B[(long)p * ldb + j];
+            }
+        }
+    }
+
+    void GEMM::setKernel(Kernel kernel){
+        if(kernel != Auto){
+            kernel = Kernel(std::min<int>(kernel, bestKernel()));
+        }
+        activeKernel = kernel;
+    }
+
+    GEMM::Kernel GEMM::kernel(){
+        int kernel = activeKernel;
+        if(kernel == Auto){
+            static const Kernel best = bestKernel();
+            return best;
+        }
+        return Kernel(kernel);
+    }
+
+    std::string GEMM::kernelName(){
+        switch(kernel()){
+            case AVX512: return "AVX-512";
+            case AVX2: return "AVX2";
+            default: return "Scalar";
+        }
+    }
+}
@@ -0,0 +1,56 @@
+//
+//  GEMM.hpp
+//
+//  Packed, cache-blocked general matrix multiplication.
+//
+
+#ifndef GEMM_hpp
+#define GEMM_hpp
+
+#include <cstdint>
+#include <string>
+
+namespace MLPP{
+    class GEMM{
+        public:
+            enum Kernel { Auto, Scalar, AVX2, AVX512 };
+
+            // Computes C = alpha * op(A) * op(B) + beta * C on row-major buffers, where op(X) is X or Xᵀ.
+            // op(A) is m x k, op(B) is k x n and C is m x n. When beta is 0, C is not read.
+            static void gemm(bool transA, bool transB, int m, int n, int k, double alpha, const double* A, int lda, const double* B, int ldb, double beta, double* C, int ldc);
+            // Single precision, with the same blocking and twice the lanes per register.
+            static void gemm(bool transA, bool transB, int m, int n, int k, float alpha, const float* A, int lda, const float* B, int ldb, float beta, float* C, int ldc);
+
+            // Element-wise map with the signature of Activation::BufferFunction: writes f(x), or f'(x) when deriv is set, to y.
+            typedef void (*ElementwiseFunction)(const double* x, double* y, long n, bool deriv);
+
+            // Dense layer forward pass: Z = op(A) * op(B) + bias, with bias added to every row, and Act = f(Z). Each tile of
+            // Z gets its bias and activation as soon as its last depth block is accumulated, while it is still in cache.
+            // bias may be null; Act is only written when f is given.
+            static void gemmBiasActivation(bool transA, bool transB, int m, int n, int k, const double* A, int lda, const double* B, int ldb, const double* bias, ElementwiseFunction f, double* Z, int ldz, double* Act, int ldact);
+            // f still maps doubles; single precision blocks are widened for it a chunk at a time.
+            static void gemmBiasActivation(bool transA, bool transB, int m, int n, int k, const float* A, int lda, const float* B, int ldb, const float* bias, ElementwiseFunction f, float* Z, int ldz, float* Act, int ldact);
+
+            // Dense layer backward pass: C = (op(A) * op(B)) ⊙ f'(Z), applying the derivative tile by tile in the same way.
+            // Z is only read.
+            static void gemmActivationDeriv(bool transA, bool transB, int m, int n, int k, const double* A, int lda, const double* B, int ldb, ElementwiseFunction f, const double* Z, int ldz, double* C, int ldc);
+            static void gemmActivationDeriv(bool transA, bool transB, int m, int n, int k, const float* A, int lda, const float* B, int ldb, ElementwiseFunction f, const float* Z, int ldz, float* C, int ldc);
+
+            // Int8 product for quantized inference: C = (A * B) * scale + offset, where A is m x k and unsigned, B is k x n and
+            // signed, the products are summed exactly in 32 bits, and scale and offset hold one value per column. B must be
+            // packed by packInt8. Rows of A are read four bytes at a time, so lda must be at least k rounded up to a multiple
+            // of four; the bytes past k may hold anything. Uses AVX-512 VNNI when the CPU has it.
+            static void gemmInt8(int m, int n, int k, const uint8_t* A, int lda, const int8_t* Bp, const double* scale, const double* offset, double* C, int ldc);
+            // Bytes taken by a packed k x n int8 matrix, and the packing itself.
+            static long packedInt8Size(int k, int n);
+            static void packInt8(int k, int n, const int8_t* B, int ldb, int8_t* Bp);
+
+            // The micro-kernel is picked once from CPUID; forcing one is meant for testing and benchmarking.
+            // Forcing a kernel the CPU lacks falls back to the best supported one.
+            static void setKernel(Kernel kernel);
+            static Kernel kernel();
+            static std::string kernelName();
+    };
+}
+
+#endif /* GEMM_hpp */
@@ -7,6 +7,8 @@
 #include "HiddenLayer.hpp"
 #include "Activation/Activation.hpp"
 #include "LinAlg/LinAlg.hpp"
+#include "GEMM/GEMM.hpp"
+#include "Matrix/Matrix.hpp"
 #include "Utilities/Utilities.hpp"
 
 #include <iostream>
@@ -18,97 +20,54 @@ namespace MLPP {
     {
         weights = Utilities::weightInitialization(input[0].size(), n_hidden, weightInit);
         bias = Utilities::biasInitialization(n_hidden);
-
-        activation_map["Linear"] = &Activation::linear;
-        activationTest_map["Linear"] = &Activation::linear;
-
-        activation_map["Sigmoid"] = &Activation::sigmoid;
-        activationTest_map["Sigmoid"] = &Activation::sigmoid;
-
-        activation_map["Swish"] = &Activation::swish;
-        activationTest_map["Swish"] = &Activation::swish;
-
-        activation_map["Mish"] = &Activation::mish;
-        activationTest_map["Mish"] = &Activation::mish;
-
-        activation_map["SinC"] = &Activation::sinc;
-        activationTest_map["SinC"] = &Activation::sinc;
-
-        activation_map["Softplus"] = &Activation::softplus;
-        activationTest_map["Softplus"] = &Activation::softplus;
-
-        activation_map["Softsign"] = &Activation::softsign;
-        activationTest_map["Softsign"] = &Activation::softsign;
-
-        activation_map["CLogLog"] = &Activation::cloglog;
-        activationTest_map["CLogLog"] = &Activation::cloglog;
-
-        activation_map["Logit"] = &Activation::logit;
-        activationTest_map["Logit"] = &Activation::logit;
-
-        activation_map["GaussianCDF"] = &Activation::gaussianCDF;
-        activationTest_map["GaussianCDF"] = &Activation::gaussianCDF;
-
-        activation_map["RELU"] = &Activation::RELU;
-        activationTest_map["RELU"] = &Activation::RELU;
-
-        activation_map["GELU"] = &Activation::GELU;
-        activationTest_map["GELU"] = &Activation::GELU;
-
-        activation_map["Sign"] = &Activation::sign;
-        activationTest_map["Sign"] = &Activation::sign;
-
-        activation_map["UnitStep"] = &Activation::unitStep;
-        activationTest_map["UnitStep"] = &Activation::unitStep;
-
-        activation_map["Sinh"] = &Activation::sinh;
-        activationTest_map["Sinh"] = &Activation::sinh;
-
-        activation_map["Cosh"] = &Activation::cosh;
-        activationTest_map["Cosh"] = &Activation::cosh;
-
-        activation_map["Tanh"] = &Activation::tanh;
-        activationTest_map["Tanh"] = &Activation::tanh;
-
-        activation_map["Csch"] = &Activation::csch;
-        activationTest_map["Csch"] = &Activation::csch;   
-
-        activation_map["Sech"] = &Activation::sech;
-        activationTest_map["Sech"] = &Activation::sech;  
-
-        activation_map["Coth"] = &Activation::coth;
-        activationTest_map["Coth"] = &Activation::coth;  
-
-        activation_map["Arsinh"] = &Activation::arsinh;
-        activationTest_map["Arsinh"] = &Activation::arsinh;
-
-        activation_map["Arcosh"] = &Activation::arcosh;
-        activationTest_map["Arcosh"] = &Activation::arcosh;
-
-        activation_map["Artanh"] = &Activation::artanh;
-        activationTest_map["Artanh"] = &Activation::artanh;
-
-        activation_map["Arcsch"] = &Activation::arcsch;
-        activationTest_map["Arcsch"] = &Activation::arcsch;
-
-        activation_map["Arsech"] = &Activation::arsech;
-        activationTest_map["Arsech"] = &Activation::arsech;
-
-        activation_map["Arcoth"] = &Activation::arcoth;
-        activationTest_map["Arcoth"] = &Activation::arcoth;
+        activationFunction = Activation::function(activation);
     }
 
     void HiddenLayer::forwardPass(){
+        // Element-wise activations are fused into the product so z and a come out of a single pass.
+        Activation::BufferFunction f = Activation::bufferFunction(activationFunction);
+        if(f && !input.empty()){
+            Matrix X(input), W(weights);
+            Matrix Z(X.rows(), n_hidden), A(X.rows(), n_hidden);
+            GEMM::gemmBiasActivation(false, false, X.rows(), n_hidden, X.cols(), X.data(), X.stride(), W.data(), W.stride(), bias.data(), f, Z.data(), Z.stride(), A.data(), A.stride());
+            z = Z.toStdVector();
+            a = A.toStdVector();
+            return;
+        }
         LinAlg alg;
         Activation avn;
         z = alg.mat_vec_add(alg.matmult(input, weights), bias);
-        a = (avn.*activation_map[activation])(z, 0);
+        a = avn.apply(activationFunction, z, 0);
     }
 
     void HiddenLayer::Test(std::vector<double> x){
         LinAlg alg;
         Activation avn;
         z_test = alg.addition(alg.mat_vec_mult(alg.transpose(weights), x), bias); 
-        a_test = (avn.*activationTest_map[activation])(z_test, 0);
+        a_test = avn.apply(activationFunction, z_test, 0);
+    }
+
+    void HiddenLayer::save(Checkpoint::Writer& writer, const std::string& prefix) const{
+        writer.add(prefix + ".units", (double)n_hidden);
+        writer.add(prefix + ".activation", activation);
+        writer.add(prefix + ".weightInit", weightInit);
+        writer.add(prefix + ".reg", reg);
+        writer.add(prefix + ".lambda", lambda);
+        writer.add(prefix + ".alpha", alpha);
+        writer.add(prefix + ".weights", weights);
+        writer.add(prefix + ".bias", bias);
+    }
+
+    bool HiddenLayer::fits(const Checkpoint& checkpoint, const std::string& prefix) const{
+        return checkpoint.rows(prefix + ".weights") == weights.size() && checkpoint.cols(prefix + ".weights") == n_hidden && checkpoint.cols(prefix + ".bias") == bias.size();
+    }
+
+    bool HiddenLayer::load(const Checkpoint& checkpoint, const std::string& prefix){
+        if(!fits(checkpoint, prefix)){
+            return false;
+        }
+        weights = checkpoint.matrix(prefix + ".weights");
+        bias = checkpoint.vector(prefix + ".bias");
+        return true;
     }
 }
\ No newline at end of file
@@ -8,9 +8,9 @@
 #define HiddenLayer_hpp
 
 #include "Activation/Activation.hpp"
+#include "Checkpoint/Checkpoint.hpp"
 
 #include <vector>
-#include <map>
 #include <string>
 
 namespace  MLPP {
@@ -29,8 +29,7 @@ namespace  MLPP {
             std::vector<std::vector<double>> z;
             std::vector<std::vector<double>> a;
 
-            std::map<std::string, std::vector<std::vector<double>> (Activation::*)(std::vector<std::vector<double>>, bool)> activation_map;
-            std::map<std::string, std::vector<double> (Activation::*)(std::vector<double>, bool)> activationTest_map;
+            Activation::Function activationFunction; // Resolved from activation when the layer is built.
 
             std::vector<double> z_test;
             std::vector<double> a_test;
@@ -46,6 +45,12 @@ namespace  MLPP {
 
             void forwardPass();
             void Test(std::vector<double> x);
+
+            // Architecture, weights and bias under the given name prefix. load() only restores the weights and bias, and
+            // fails, leaving the layer as it was, unless fits() does: their shapes must equal the layer's.
+            void save(Checkpoint::Writer& writer, const std::string& prefix) const;
+            bool fits(const Checkpoint& checkpoint, const std::string& prefix) const;
+            bool load(const Checkpoint& checkpoint, const std::string& prefix);
     };
 }
 
@@ -0,0 +1,53 @@
+//
+//  Hogwild.cpp
+//
+//  Lock-free asynchronous SGD driver shared by the linear models and ANN.
+//
+
+#include "Hogwild.hpp"
+#include "ThreadPool/ThreadPool.hpp"
+
+#include <iostream>
+#include <chrono>
+#include <random>
+#include <algorithm>
+
+namespace MLPP{
+    Hogwild::Report Hogwild::run(int threads, long updates, int n, const std::function<void(int, long, int)>& step){
+        Report report;
+        report.threads = std::max(threads, 1);
+        report.updates = updates;
+        report.costBefore = 0;
+        report.costAfter = 0;
+        if(n <= 0){
+            report.updates = 0;
+            report.seconds = 0;
+            report.updatesPerSecond = 0;
+            return report;
+        }
+
+        auto start = std::chrono::steady_clock::now();
+        auto worker = [&](long first, long last){
+            for(long t = first; t < last; t++){
+                std::default_random_engine generator(t);
+                std::uniform_int_distribution<int> distribution(0, n - 1);
+                for(long update = t; update < updates; update += report.threads){
+                    step(t, update, distribution(generator));
+                }
+            }
+        };
+        ThreadPool::parallelFor(report.threads, 1, std::cref(worker));
+
+        report.seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+        report.updatesPerSecond = report.seconds > 0 ? updates / report.seconds : 0;
+        return report;
+    }
+
+    void Hogwild::UI(const Report& report){
+        std::cout << "-----------------------------------" << std::endl;
+        std::cout << "Hogwild SGD: " << report.updates << " updates on " << report.threads << " threads in " << report.seconds << " s (" << report.updatesPerSecond << " updates/s)" << std::endl;
+        std::cout << "The cost function has been minimized by " << report.costBefore - report.costAfter << std::endl;
+        std::cout << "Current Cost:" << std::endl;
+        std::cout << report.costAfter << std::endl;
+    }
+}
@@ -0,0 +1,53 @@
+//
+//  Hogwild.hpp
+//
+//  Lock-free asynchronous SGD driver shared by the linear models and ANN.
+//
+
+#ifndef Hogwild_hpp
+#define Hogwild_hpp
+
+#include <functional>
+
+namespace MLPP{
+    // Hogwild! (Niu, Recht, Re and Wright, 2011): several workers sample training rows and write their SGD steps to
+    // the shared parameters without any locking. When each sample only touches a few parameters the updates rarely
+    // collide, and the occasional lost update costs less than synchronizing would.
+    class Hogwild{
+        public:
+            struct Report{
+                int threads;
+                long updates;
+                double seconds;
+                double updatesPerSecond;
+                double costBefore; // Training-set cost before and after the run, filled in by the model.
+                double costAfter;
+            };
+
+            // Performs updates SGD steps in total, dealt round-robin to the given number of workers. Worker t draws
+            // row indices in [0, n) from its own generator seeded with t and calls step(t, update, index), where update
+            // is the position of the step in the round-robin order. Workers run on the ThreadPool, so at most
+            // ThreadPool::numThreads() of them are live at once. With one worker the run is fully reproducible. With no
+            // rows to draw, n <= 0, no steps are taken.
+            static Report run(int threads, long updates, int n, const std::function<void(int, long, int)>& step);
+
+            // Prints the throughput and the change in cost of a run.
+            static void UI(const Report& report);
+
+            // Steps must read and write the shared parameters only through these relaxed atomic loads and stores; a
+            // step that needs plain loads, such as a GEMM, reads a snapshot copied with load(). They compile to plain
+            // moves on x86 and ARM but keep the concurrent accesses well defined. A read-modify-write made of the two
+            // can drop a concurrent update, which Hogwild tolerates.
+            static double load(const double& x){
+                double value;
+                __atomic_load(&x, &value, __ATOMIC_RELAXED);
+                return value;
+            }
+
+            static void store(double& x, double value){
+                __atomic_store(&x, &value, __ATOMIC_RELAXED);
+            }
+    };
+}
+
+#endif /* Hogwild_hpp */
@@ -0,0 +1,86 @@
+//
+//  Householder.cpp
+//
+//  Householder reflections shared by the matrix factorisations.
+//
+
+#include "Householder.hpp"
+#include "GEMM/GEMM.hpp"
+#include <cmath>
+#include <algorithm>
+
+namespace MLPP{
+
+    namespace {
+        // Reflectors applied together by Householder::apply.
+        const int NB = 32;
+    }
+
+    double Householder::reflector(double* x, int m, double& beta){
+        double alpha = x[0];
+        double sigma = 0;
+        for(int i = 1; i < m; i++){
+            sigma += x[i] * x[i];
+        }
+        if(sigma == 0){
+            beta = 0;
+            std::fill(x, x + m, 0.0);
+            return alpha;
+        }
+        double norm = std::sqrt(alpha * alpha + sigma);
+        double v0 = alpha <= 0 ? alpha - norm : -sigma / (alpha + norm);
+        beta = 2 * v0 * v0 / (sigma + v0 * v0);
+        x[0] = 1;
+        for(int i = 1; i < m; i++){
+            x[i] /= v0;
+        }
+        return norm;
+    }
+
+    void Householder::apply(const Matrix& V, const std::vector<double>& beta, int offset, Matrix& X, bool transpose){
+        apply(V.rows(), V.data(), V.stride(), beta.data(), offset, X.rows(), X.cols(), X.data(), X.stride(), transpose);
+    }
+
+    // Blocks of NB reflectors are applied in the compact WY form H_j0 ... H_j0+nb-1 = I - Y T Y^T (LAPACK's larft),
+    // so each block costs three GEMM calls instead of nb passes over X.
+    void Householder::apply(int r, const double* V, int ldv, const double* beta, int offset, int k, int n, double* X, int ldx, bool transpose){
+        if(r == 0 || k == 0){ return; }
+
+        std::vector<double> T(NB * NB), W((long)k * NB), W2((long)k * NB), t(NB);
+        int blocks = (r + NB - 1) / NB;
+        for(int b = 0; b < blocks; b++){
+            // Q x applies the last block first, Q^T x the first.
+            int j0 = (transpose ? b : blocks - 1 - b) * NB;
+            int nb = std::min(NB, r - j0);
+            int c0 = j0 + offset;
+            int len = n - c0;
+            const double* Vb = V + (long)j0 * ldv;
+
+            std::fill(T.begin(), T.end(), 0.0);
+            for(int j = 0; j < nb; j++){
+                const double* vj = Vb + (long)j * ldv + c0;
+                for(int i = 0; i < j; i++){
+                    const double* vi = Vb + (long)i * ldv + c0;
+                    double s = 0;
+                    for(int c = 0; c < len; c++){
+                        s += vi[c] * vj[c];
+                    }
+                    t[i] = -beta[j0 + j] * s;
+                }
+                for(int i = 0; i < j; i++){
+                    double s = 0;
+                    for(int q = i; q < j; q++){
+                        s += T[i * NB + q] * t[q];
+                    }
+                    T[i * NB + j] = s;
+                }
+                T[j * NB + j] = beta[j0 + j];
+            }
+
+            // X -= ((X Y) T^T) Y^T, with T in place of T^T for the transpose
+            GEMM::gemm(false, true, k, nb, len, 1.0, X + c0, ldx, Vb + c0, ldv, 0.0, W.data(), nb);
+            GEMM::gemm(false, !transpose, k, nb, nb, 1.0, W.data(), nb, T.data(), NB, 0.0, W2.data(), nb);
+            GEMM::gemm(false, false, k, len, nb, -1.0, W2.data(), nb, Vb + c0, ldv, 1.0, X + c0, ldx);
+        }
+    }
+}
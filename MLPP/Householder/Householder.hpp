@@ -0,0 +1,31 @@
+//
+//  Householder.hpp
+//
+//  Householder reflections shared by the matrix factorisations.
+//
+
+#ifndef Householder_hpp
+#define Householder_hpp
+
+#include "Matrix/Matrix.hpp"
+#include <vector>
+
+namespace MLPP{
+    // A reflector is H = I - beta v v^T with v[0] = 1. Sequences of them are stored one per row of a Matrix,
+    // the vector of H_j starting at column j + offset, and are applied in blocks through GEMM.
+    class Householder{
+        public:
+            // Overwrites x[0..m) with the v for which H x = alpha e_1 and returns alpha.
+            // When x is already a multiple of e_1, H = I: beta is 0 and x is zeroed.
+            static double reflector(double* x, int m, double& beta);
+
+            // Replaces every row x of X with Q x, or Q^T x when transpose is set, where Q = H_0 H_1 ... H_{r-1}
+            // and r = V.rows().
+            static void apply(const Matrix& V, const std::vector<double>& beta, int offset, Matrix& X, bool transpose = false);
+
+            // The same on raw row-major blocks: r reflectors in V and a k x n block X.
+            static void apply(int r, const double* V, int ldv, const double* beta, int offset, int k, int n, double* X, int ldx, bool transpose = false);
+    };
+}
+
+#endif /* Householder_hpp */
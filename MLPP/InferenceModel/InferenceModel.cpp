@@ -0,0 +1,280 @@
+//
+//  InferenceModel.cpp
+//
+//  Immutable, thread-safe forward pass of a trained network.
+//
+
+#include "InferenceModel.hpp"
+#include "GEMM/GEMM.hpp"
+#include "VecMath/VecMath.hpp"
+#include <algorithm>
+#include <cmath>
+#include <iostream>
+
+namespace MLPP{
+    namespace {
+        // Bytes per cache line.
+        const int LINE = 64;
+
+        // Numerically stable softmax of each row, in place.
+        void softmaxRows(double* Y, int ldy, int rows, int cols){
+            for(int i = 0; i < rows; i++){
+                double* y = Y + (long)i * ldy;
+                double max = *std::max_element(y, y + cols);
+                VecMath::shift(-max, y, y, cols);
+                VecMath::exp(y, y, cols);
+                double sum = 0;
+                for(int j = 0; j < cols; j++){ sum += y[j]; }
+                VecMath::scale(1 / sum, y, y, cols);
+            }
+        }
+
+        void softmaxRows(float* Y, int ldy, int rows, int cols){
+            for(int i = 0; i < rows; i++){
+                float* y = Y + (long)i * ldy;
+                float max = *std::max_element(y, y + cols);
+                double sum = 0;
+                for(int j = 0; j < cols; j++){
+                    y[j] = std::exp(y[j] - max);
+                    sum += y[j];
+                }
+                for(int j = 0; j < cols; j++){ y[j] /= sum; }
+            }
+        }
+
+        template <class Layer, class T>
+        void forwardLayer(const Layer& layer, const T* X, int ldx, int rows, T* Y, int ldy){
+            const BasicMatrix<T>& W = layer.weights;
+            // Z and the activation share a buffer: the epilogue maps each finished block of Z in place.
+            GEMM::gemmBiasActivation(false, false, rows, W.cols(), W.rows(), X, ldx, W.data(), W.stride(), layer.bias.data(), layer.f, Y, ldy, Y, ldy);
+            if(!layer.f){
+                softmaxRows(Y, ldy, rows, W.cols());
+            }
+        }
+
+        // Runs the rows of X through every layer into Y. Hidden activations alternate between two buffers owned by the
+        // calling thread, so only the layers are shared between callers.
+        template <class Layer, class T>
+        void forwardLayers(const std::vector<Layer>& layers, int width, const T* X, int ldx, int rows, T* Y, int ldy){
+            thread_local BasicMatrix<T> scratch[2];
+            const T* input = X;
+            int ld = ldx;
+            for(int l = 0; l < layers.size(); l++){
+                T* output = Y;
+                int ldo = ldy;
+                if(l < layers.size() - 1){
+                    scratch[l % 2].resize(rows, width);
+                    output = scratch[l % 2].data();
+                    ldo = width;
+                }
+                forwardLayer(layers[l], input, ld, rows, output, ldo);
+                input = output;
+                ld = ldo;
+            }
+        }
+
+        void quantize(const double* x, int n, double scale, int zero, uint8_t* q){
+            const double inverse = 1 / scale;
+            for(int j = 0; j < n; j++){
+                double v = std::min(std::max(x[j] * inverse + zero, 0.0), 255.0);
+                q[j] = uint8_t(v + 0.5);
+            }
+        }
+
+        // The Int8 forward pass. Each layer quantizes its input into a byte buffer, so a single double buffer is enough
+        // for the hidden activations, which come out of the GEMM dequantized.
+        template <class Layer>
+        void forwardQuantized(const std::vector<Layer>& layers, int width, const double* X, int ldx, int rows, double* Y, int ldy){
+            thread_local std::vector<uint8_t> bytes;
+            thread_local Matrix scratch;
+            const double* input = X;
+            int ld = ldx;
+            for(int l = 0; l < layers.size(); l++){
+                const Layer& layer = layers[l];
+                const int stride = (layer.inputs + LINE - 1) / LINE * LINE;
+                if(bytes.size() < (size_t)rows * stride){
+                    bytes.resize((size_t)rows * stride);
+                }
+                for(int i = 0; i < rows; i++){
+                    uint8_t* q = bytes.data() + (long)i * stride;
+                    quantize(input + (long)i * ld, layer.inputs, layer.inputScale, layer.inputZero, q);
+                    std::fill(q + layer.inputs, q + stride, 0);
+                }
+                double* output = Y;
+                int ldo = ldy;
+                if(l < layers.size() - 1){
+                    scratch.resize(rows, width);
+                    output = scratch.data();
+                    ldo = width;
+                }
+                GEMM::gemmInt8(rows, layer.units, layer.inputs, bytes.data(), stride, layer.weights.data(), layer.scale.data(), layer.offset.data(), output, ldo);
+                if(layer.f){
+                    for(int i = 0; i < rows; i++){
+                        layer.f(output + (long)i * ldo, output + (long)i * ldo, layer.units, false);
+                    }
+                }
+                else{
+                    softmaxRows(output, ldo, rows, layer.units);
+                }
+                input = output;
+                ld = ldo;
+            }
+        }
+    }
+
+    InferenceModel::InferenceModel(std::string precision)
+    : isSingle(precision == "Single"), isInt8(precision == "Int8"), n_layers(0), n_inputs(0), n_outputs(0), width(0)
+    {
+        if(precision != "Double" && precision != "Single" && precision != "Int8"){
+            std::cout << "Unknown precision " << precision << "; using \"Double\"." << std::endl;
+        }
+    }
+
+    void InferenceModel::addLayer(const std::vector<std::vector<double>>& weights, const std::vector<double>& bias, Activation::Function activation){
+        int rows = weights.size();
+        int cols = rows ? weights[0].size() : 0;
+        if(n_layers > 0 && rows != n_outputs){
+            std::cout << "A layer with " << rows << " inputs cannot follow one with " << n_outputs << " units." << std::endl;
+            return;
+        }
+        if(bias.size() != cols){
+            std::cout << "The bias has " << bias.size() << " entries for a layer of " << cols << " units." << std::endl;
+            return;
+        }
+        if(isSingle){
+            add(singleLayers, weights, bias, activation);
+        }
+        else{
+            add(layers, weights, bias, activation);
+        }
+        quantizedLayers.clear();
+        if(n_layers == 0){
+            n_inputs = rows;
+        }
+        n_layers++;
+        n_outputs = cols;
+    }
+
+    template <class T>
+    void InferenceModel::add(std::vector<Layer<T>>& layers, const std::vector<std::vector<double>>& weights, const std::vector<double>& bias, Activation::Function activation){
+        const int line = LINE / sizeof(T);
+        int rows = weights.size();
+        int cols = rows ? weights[0].size() : 0;
+        Layer<T> layer;
+        layer.weights = BasicMatrix<T>(rows, cols, (cols + line - 1) / line * line, 0);
+        for(int i = 0; i < rows; i++){
+            std::copy(weights[i].begin(), weights[i].end(), layer.weights.row(i));
+        }
+        layer.bias.assign(bias.begin(), bias.end());
+        layer.f = Activation::bufferFunction(activation);
+        width = std::max(width, layer.weights.stride());
+        layers.push_back(std::move(layer));
+    }
+
+    void InferenceModel::calibrate(const Matrix& sample){
+        if(!isInt8){
+            std::cout << "Only an \"Int8\" model is calibrated." << std::endl;
+            return;
+        }
+        if(sample.rows() == 0 || sample.cols() != n_inputs){
+            std::cout << "Calibration needs at least one sample of " << n_inputs << " features." << std::endl;
+            return;
+        }
+        quantizedLayers.clear();
+        Matrix input, output;
+        input.assign(sample);
+        for(const auto& layer : layers){
+            const Matrix& W = layer.weights;
+            QuantizedLayer q;
+            q.inputs = W.rows();
+            q.units = W.cols();
+            q.f = layer.f;
+
+            // The input range always includes 0, so zero padding and zero inputs are exact.
+            double lo = 0, hi = 0;
+            for(int i = 0; i < input.rows(); i++){
+                auto range = std::minmax_element(input.row(i), input.row(i) + input.cols());
+                lo = std::min(lo, *range.first);
+                hi = std::max(hi, *range.second);
+            }
+            q.inputScale = hi > lo ? (hi - lo) / 255 : 1;
+            q.inputZero = int(std::round(-lo / q.inputScale));
+
+            // Symmetric weights, one scale per unit.
+            std::vector<int8_t> weights((long)q.inputs * q.units);
+            q.scale.resize(q.units);
+            q.offset.resize(q.units);
+            for(int j = 0; j < q.units; j++){
+                double max = 0;
+                for(int p = 0; p < q.inputs; p++){ max = std::max(max, std::abs(W(p, j))); }
+                double scale = max > 0 ? max / 127 : 1;
+                long sum = 0;
+                for(int p = 0; p < q.inputs; p++){
+                    weights[(long)p * q.units + j] = int8_t(std::round(W(p, j) / scale));
+                    sum += weights[(long)p * q.units + j];
+                }
+                q.scale[j] = q.inputScale * scale;
+                q.offset[j] = layer.bias[j] - q.inputZero * sum * q.scale[j];
+            }
+            q.weights.resize(GEMM::packedInt8Size(q.inputs, q.units));
+            GEMM::packInt8(q.inputs, q.units, weights.data(), q.units, q.weights.data());
+            quantizedLayers.push_back(std::move(q));
+
+            output.resize(input.rows(), W.cols());
+            forwardLayer(layer, input.data(), input.stride(), input.rows(), output.data(), output.stride());
+            std::swap(input, output);
+        }
+    }
+
+    void InferenceModel::calibrate(const std::vector<std::vector<double>>& sample){
+        const int limit = 1024;
+        int rows = std::min<int>(sample.size(), limit);
+        Matrix X(rows, rows ? sample[0].size() : 0);
+        for(int i = 0; i < rows; i++){
+            const std::vector<double>& x = sample[(long)i * sample.size() / rows];
+            std::copy(x.begin(), x.end(), X.row(i));
+        }
+        calibrate(X);
+    }
+
+    void InferenceModel::predictBatch(const Matrix& X, Matrix& out) const{
+        int rows = X.rows();
+        if(n_layers == 0){
+            out.assign(X);
+            return;
+        }
+        if(X.cols() != n_inputs){
+            std::cout << "Expected " << n_inputs << " features per sample, got " << X.cols() << "." << std::endl;
+            out.resize(0, n_outputs);
+            return;
+        }
+        out.resize(rows, n_outputs);
+        if(!quantizedLayers.empty()){
+            forwardQuantized(quantizedLayers, width, X.data(), X.stride(), rows, out.data(), out.stride());
+        }
+        else if(isSingle){
+            thread_local FloatMatrix input, output;
+            input.assign(X);
+            output.resize(rows, n_outputs);
+            forwardLayers(singleLayers, width, input.data(), input.stride(), rows, output.data(), output.stride());
+            out.assign(output);
+        }
+        else{
+            forwardLayers(layers, width, X.data(), X.stride(), rows, out.data(), out.stride());
+        }
+    }
+
+    std::vector<double> InferenceModel::predict(const std::vector<double>& x) const{
+        Matrix X(std::vector<std::vector<double>>{x});
+        Matrix out;
+        predictBatch(X, out);
+        if(out.rows() == 0){ return {}; }
+        return std::vector<double>(out.row(0), out.row(0) + out.cols());
+    }
+
+    std::vector<std::vector<double>> InferenceModel::predict(const std::vector<std::vector<double>>& X) const{
+        Matrix out;
+        predictBatch(Matrix(X), out);
+        return out.toStdVector();
+    }
+}
@@ -0,0 +1,83 @@
+//
+//  InferenceModel.hpp
+//
+//  Immutable, thread-safe forward pass of a trained network.
+//
+
+#ifndef InferenceModel_hpp
+#define InferenceModel_hpp
+
+#include "Matrix/Matrix.hpp"
+#include "Activation/Activation.hpp"
+#include <cstdint>
+#include <string>
+#include <vector>
+
+namespace MLPP{
+    // A frozen copy of a feed-forward network's weights, produced by ANN::compile() or MANN::compile(). Prediction
+    // only reads the model, so any number of threads may call it at once, and it does not allocate once a thread's
+    // scratch buffers and the output matrix have grown to the batch size.
+    class InferenceModel{
+        public:
+            // "Double", "Single" to store the weights and run every layer in single precision, or "Int8" to quantize
+            // them to 8 bits once calibrate() has seen some inputs. Inputs and outputs are double either way.
+            explicit InferenceModel(std::string precision = "Double");
+
+            // Appends a dense layer a = f(x * weights + bias); weights is inputs x units. Used while compiling.
+            void addLayer(const std::vector<std::vector<double>>& weights, const std::vector<double>& bias, Activation::Function activation);
+
+            // Int8 only: runs sample through the double layers to find the range of every layer's input, then quantizes
+            // each layer's weights per unit and its inputs per layer. The vector overload uses at most 1024 evenly spaced
+            // rows. Until it is called the model predicts in double.
+            void calibrate(const Matrix& sample);
+            void calibrate(const std::vector<std::vector<double>>& sample);
+
+            int inputs() const { return n_inputs; }
+            int outputs() const { return n_outputs; }
+            int numLayers() const { return n_layers; }
+            bool singlePrecision() const { return isSingle; }
+            bool quantized() const { return !quantizedLayers.empty(); }
+
+            // One sample per row of X. out is resized to X.rows() x outputs(), keeping its allocation when large enough,
+            // or to no rows if X does not have inputs() columns; predict() then returns an empty vector.
+            void predictBatch(const Matrix& X, Matrix& out) const;
+
+            // Convenience wrappers that allocate their results.
+            std::vector<double> predict(const std::vector<double>& x) const;
+            std::vector<std::vector<double>> predict(const std::vector<std::vector<double>>& X) const;
+
+        private:
+            template <class T>
+            struct Layer{
+                BasicMatrix<T> weights; // inputs x units, each row padded to a whole number of cache lines.
+                std::vector<T> bias;
+                Activation::BufferFunction f; // nullptr for Softmax, which is applied row by row.
+            };
+
+            struct QuantizedLayer{
+                std::vector<int8_t> weights; // Packed by GEMM::packInt8.
+                std::vector<double> scale; // Per unit: the input scale times the unit's weight scale.
+                std::vector<double> offset; // Per unit: the bias less what the input zero point adds to each sum.
+                double inputScale; // An input x is stored as round(x / inputScale) + inputZero, clamped to [0, 255].
+                int inputZero;
+                int inputs;
+                int units;
+                Activation::BufferFunction f;
+            };
+
+            template <class T>
+            void add(std::vector<Layer<T>>& layers, const std::vector<std::vector<double>>& weights, const std::vector<double>& bias, Activation::Function activation);
+
+            std::vector<Layer<double>> layers;
+            std::vector<Layer<float>> singleLayers; // Used instead of layers in single precision.
+            std::vector<QuantizedLayer> quantizedLayers; // Used instead of layers once an Int8 model is calibrated.
+            bool isSingle;
+            bool isInt8;
+            int n_layers;
+            int n_inputs;
+            int n_outputs;
+            int width; // Widest padded layer, which sizes the scratch buffers.
+    };
+}
+
+#endif /* InferenceModel_hpp */
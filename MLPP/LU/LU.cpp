@@ -0,0 +1,186 @@
+//
+//  LU.cpp
+//
+//  Partial-pivoting LU factorisation of a square matrix.
+//
+
+#include "LU.hpp"
+#include "GEMM/GEMM.hpp"
+#include <cmath>
+#include <limits>
+#include <algorithm>
+#include <utility>
+
+namespace MLPP{
+
+    namespace {
+        // Panel width of the blocked factorisation. The trailing update of each panel is a GEMM call.
+        const int NB = 64;
+    }
+
+    LU::LU(const std::vector<std::vector<double>>& A)
+    : n(A.size()), lu(A), pivots(A.size()), sign(1), isSingular(false)
+    {
+        factor();
+    }
+
+    LU::LU(const Matrix& A)
+    : n(A.rows()), lu(A.rows(), A.rows()), pivots(A.rows()), sign(1), isSingular(false)
+    {
+        for(int i = 0; i < n; i++){
+            std::copy(A.row(i), A.row(i) + n, lu.row(i));
+        }
+        factor();
+    }
+
+    // Right-looking blocked elimination: factor a panel of NB columns with row pivoting, solve for the
+    // matching block row of U, then fold both into the trailing submatrix with a single rank-NB update.
+    void LU::factor(){
+        double maxAbs = 0;
+        for(int i = 0; i < n; i++){
+            for(int j = 0; j < n; j++){
+                maxAbs = std::max(maxAbs, std::abs(lu(i, j)));
+            }
+        }
+        const double tol = n * std::numeric_limits<double>::epsilon() * maxAbs;
+        if(maxAbs == 0){ isSingular = true; }
+
+        for(int j0 = 0; j0 < n; j0 += NB){
+            int jb = std::min(NB, n - j0);
+            int jend = j0 + jb;
+
+            for(int j = j0; j < jend; j++){
+                int p = j;
+                for(int i = j + 1; i < n; i++){
+                    if(std::abs(lu(i, j)) > std::abs(lu(p, j))){ p = i; }
+                }
+                pivots[j] = p;
+                if(p != j){
+                    std::swap_ranges(lu.row(j), lu.row(j) + n, lu.row(p));
+                    sign = -sign;
+                }
+
+                double pivot = lu(j, j);
+                if(std::abs(pivot) <= tol){ isSingular = true; }
+                if(pivot == 0){ continue; }
+
+                for(int i = j + 1; i < n; i++){
+                    double l = lu(i, j) /= pivot;
+                    double* ri = lu.row(i);
+                    const double* rj = lu.row(j);
+                    for(int c = j + 1; c < jend; c++){
+                        ri[c] -= l * rj[c];
+                    }
+                }
+            }
+
+            if(jend == n){ break; }
+
+            // U12 = L11^-1 A12
+            for(int r = j0 + 1; r < jend; r++){
+                double* rr = lu.row(r);
+                for(int q = j0; q < r; q++){
+                    double l = rr[q];
+                    const double* rq = lu.row(q);
+                    for(int c = jend; c < n; c++){
+                        rr[c] -= l * rq[c];
+                    }
+                }
+            }
+
+            // A22 -= L21 U12
+            GEMM::gemm(false, false, n - jend, n - jend, jb, -1.0, lu.row(jend) + j0, lu.stride(), lu.row(j0) + jend, lu.stride(), 1.0, lu.row(jend) + jend, lu.stride());
+        }
+    }
+
+    double LU::det() const{
+        double d = sign;
+        for(int i = 0; i < n; i++){
+            d *= lu(i, i);
+        }
+        return d;
+    }
+
+    // Overwrites X (already holding B) with A^-1 B. Rows of X are updated as whole vectors so every
+    // inner loop runs over contiguous memory regardless of the number of right-hand sides.
+    void LU::substitute(Matrix& X) const{
+        int m = X.cols();
+        if(isSingular){
+            X.fill(std::numeric_limits<double>::quiet_NaN());
+            return;
+        }
+        for(int j = 0; j < n; j++){
+            if(pivots[j] != j){
+                std::swap_ranges(X.row(j), X.row(j) + m, X.row(pivots[j]));
+            }
+        }
+        for(int i = 1; i < n; i++){
+            double* xi = X.row(i);
+            for(int q = 0; q < i; q++){
+                double l = lu(i, q);
+                const double* xq = X.row(q);
+                for(int c = 0; c < m; c++){
+                    xi[c] -= l * xq[c];
+                }
+            }
+        }
+        for(int i = n - 1; i >= 0; i--){
+            double* xi = X.row(i);
+            for(int q = i + 1; q < n; q++){
+                double u = lu(i, q);
+                const double* xq = X.row(q);
+                for(int c = 0; c < m; c++){
+                    xi[c] -= u * xq[c];
+                }
+            }
+            double inv = 1 / lu(i, i);
+            for(int c = 0; c < m; c++){
+                xi[c] *= inv;
+            }
+        }
+    }
+
+    std::vector<double> LU::solve(const std::vector<double>& b) const{
+        Matrix X(n, 1);
+        for(int i = 0; i < n; i++){
+            X(i, 0) = b[i];
+        }
+        substitute(X);
+        std::vector<double> x(n);
+        for(int i = 0; i < n; i++){
+            x[i] = X(i, 0);
+        }
+        return x;
+    }
+
+    std::vector<std::vector<double>> LU::solve(const std::vector<std::vector<double>>& B) const{
+        Matrix X(B);
+        substitute(X);
+        return X.toStdVector();
+    }
+
+    void LU::solve(const Matrix& B, Matrix& X) const{
+        if(&B != &X){
+            X.resize(B.rows(), B.cols());
+            for(int i = 0; i < B.rows(); i++){
+                std::copy(B.row(i), B.row(i) + B.cols(), X.row(i));
+            }
+        }
+        substitute(X);
+    }
+
+    std::vector<std::vector<double>> LU::inverse() const{
+        Matrix X;
+        inverse(X);
+        return X.toStdVector();
+    }
+
+    void LU::inverse(Matrix& X) const{
+        X.resize(n, n);
+        X.fill(0);
+        for(int i = 0; i < n; i++){
+            X(i, i) = 1;
+        }
+        substitute(X);
+    }
+}
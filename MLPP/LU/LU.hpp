@@ -0,0 +1,50 @@
+//
+//  LU.hpp
+//
+//  Partial-pivoting LU factorisation of a square matrix.
+//
+
+#ifndef LU_hpp
+#define LU_hpp
+
+#include "Matrix/Matrix.hpp"
+#include <vector>
+
+namespace MLPP{
+    // Factors PA = LU once so that det, inverse and any number of solves reuse the same O(n^3) work.
+    // L is unit lower triangular and U upper triangular; both are kept in a single n x n buffer.
+    class LU{
+        public:
+            explicit LU(const std::vector<std::vector<double>>& A);
+            explicit LU(const Matrix& A);
+
+            int size() const { return n; }
+
+            // True when a pivot is negligible relative to the largest entry of A. Solves and inverses
+            // of a singular factorisation are filled with NaN rather than amplifying round-off.
+            bool singular() const { return isSingular; }
+            double det() const;
+
+            // Solves Ax = b.
+            std::vector<double> solve(const std::vector<double>& b) const;
+
+            // Solves AX = B for every column of B at once. B is n x m.
+            std::vector<std::vector<double>> solve(const std::vector<std::vector<double>>& B) const;
+            void solve(const Matrix& B, Matrix& X) const;
+
+            std::vector<std::vector<double>> inverse() const;
+            void inverse(Matrix& X) const;
+
+        private:
+            void factor();
+            void substitute(Matrix& X) const;
+
+            int n;
+            Matrix lu;
+            std::vector<int> pivots;
+            int sign;
+            bool isSingular;
+    };
+}
+
+#endif /* LU_hpp */
@@ -6,15 +6,41 @@
 
 #include "LinAlg.hpp"
 #include "Stat/Stat.hpp"
+#include "GEMM/GEMM.hpp"
+#include "LU/LU.hpp"
+#include "QR/QR.hpp"
+#include "EigenSolver/EigenSolver.hpp"
+#include "SVDSolver/SVDSolver.hpp"
+#include "ThreadPool/ThreadPool.hpp"
+#include "VecMath/VecMath.hpp"
 #include <iostream>
 #include <random>
 #include <map>
 #include <cmath>
+#include <limits>
+#include <algorithm>
+#include <functional>
 
 namespace MLPP{
 
+    namespace {
+        // Calls doing less work than this (in multiply-adds or element moves) stay on the calling thread.
+        const long PARALLEL_WORK = 1L << 16;
+
+        // Runs body over [0, rows), splitting the rows across the pool once rows * workPerRow is large enough.
+        // The body is passed on by reference so that wrapping it in a std::function never allocates.
+        template <class F>
+        void forRows(long rows, long workPerRow, const F& body){
+            if(rows * workPerRow < PARALLEL_WORK){
+                body(0, rows);
+                return;
+            }
+            ThreadPool::parallelFor(rows, std::max(1L, (PARALLEL_WORK / 4) / std::max(1L, workPerRow)), std::cref(body));
+        }
+    }
+
     std::vector<std::vector<double>> LinAlg::gramMatrix(std::vector<std::vector<double>> A){
-        return matmult(transpose(A), A); // AtA
+        return transposeMatmult(A, A); // AtA
     }
 
     /*bool LinAlg::linearIndependenceChecker(std::vector<std::vector<double>> A){
@@ -27,11 +53,8 @@ namespace MLPP{
         // compute the Gram matrix G = Aᵀ A
         auto G = gramMatrix(A);
     
-        // use G.size() (its dimension) rather than A.size()
-        int k = static_cast<int>(G.size());
-        double determinant = det(G, k);
-    
-        return determinant != 0.0;
+        // a vanishing pivot is a zero determinant up to round-off
+        return !LU(G).singular();
     }
     
     std::vector<std::vector<double>> LinAlg::gaussianNoise(int n, int m){
@@ -50,64 +73,74 @@ namespace MLPP{
         return A; 
     }
 
-    std::vector<std::vector<double>> LinAlg::addition(std::vector<std::vector<double>> A, std::vector<std::vector<double>> B){
-        std::vector<std::vector<double>> C;
-        C.resize(A.size());
-        for(int i = 0; i < C.size(); i++){
-            C[i].resize(A[0].size());
-        }
-        
+    std::vector<std::vector<double>> LinAlg::addition(const std::vector<std::vector<double>>& A, const std::vector<std::vector<double>>& B){
+        std::vector<std::vector<double>> C(A.size());
         for(int i = 0; i < A.size(); i++){
-            for(int j = 0; j < A[0].size(); j++){
-                C[i][j] = A[i][j] + B[i][j];
+            const double* a = A[i].data();
+            const double* b = B[i].data();
+            C[i].resize(A[0].size());
+            double* c = C[i].data();
+            for(int j = 0; j < C[i].size(); j++){
+                c[j] = a[j] + b[j];
             }
         }
         return C;
     }
 
-    std::vector<std::vector<double>> LinAlg::subtraction(std::vector<std::vector<double>> A, std::vector<std::vector<double>> B){
-        std::vector<std::vector<double>> C;
-        C.resize(A.size());
-        for(int i = 0; i < C.size(); i++){
-            C[i].resize(A[0].size());
-        }
-
+    std::vector<std::vector<double>> LinAlg::subtraction(const std::vector<std::vector<double>>& A, const std::vector<std::vector<double>>& B){
+        std::vector<std::vector<double>> C(A.size());
         for(int i = 0; i < A.size(); i++){
-            for(int j = 0; j < A[0].size(); j++){
-                C[i][j] = A[i][j] - B[i][j];
+            const double* a = A[i].data();
+            const double* b = B[i].data();
+            C[i].resize(A[0].size());
+            double* c = C[i].data();
+            for(int j = 0; j < C[i].size(); j++){
+                c[j] = a[j] - b[j];
             }
         }
         return C;
     }
 
-    std::vector<std::vector<double>> LinAlg::matmult(std::vector<std::vector<double>> A, std::vector<std::vector<double>> B){
-        std::vector<std::vector<double>> C;
-        C.resize(A.size());
-        for(int i = 0; i < C.size(); i++){
+    std::vector<std::vector<double>> LinAlg::matmult(const std::vector<std::vector<double>>& A, const std::vector<std::vector<double>>& B){
+        if(A.size() * B.size() * B[0].size() > 4096){ // Large products go through the packed kernel.
+            Matrix C;
+            matmult(Matrix(A), Matrix(B), C);
+            return C.toStdVector();
+        }
+        std::vector<std::vector<double>> C(A.size());
+        for(int i = 0; i < A.size(); i++){
             C[i].resize(B[0].size());
+            double* c = C[i].data();
+            for(int k = 0; k < B.size(); k++){
+                const double a_ik = A[i][k];
+                const double* b = B[k].data();
+                for(int j = 0; j < C[i].size(); j++){
+                    c[j] += a_ik * b[j];
+                }
+            }
         }
-        
-        for(int i = 0; i < A.size(); i++){ 
-            for(int k = 0; k < B.size(); k++){ 
-                for(int j = 0; j < B[0].size(); j++){ 
-                    C[i][j] += A[i][k] * B[k][j]; 
-                } 
-            } 
-        } 
         return C;
     }
 
-    std::vector<std::vector<double>> LinAlg::hadamard_product(std::vector<std::vector<double>> A, std::vector<std::vector<double>> B){
-        std::vector<std::vector<double>> C;
-        C.resize(A.size());
-        for(int i = 0; i < C.size(); i++){
-            C[i].resize(A[0].size());
-        }
-        
+    std::vector<std::vector<double>> LinAlg::transposeMatmult(const std::vector<std::vector<double>>& A, const std::vector<std::vector<double>>& B){
+        Matrix C;
+        transposeMatmult(Matrix(A), Matrix(B), C);
+        return C.toStdVector();
+    }
+
+    std::vector<std::vector<double>> LinAlg::matmultTranspose(const std::vector<std::vector<double>>& A, const std::vector<std::vector<double>>& B){
+        Matrix C;
+        matmultTranspose(Matrix(A), Matrix(B), C);
+        return C.toStdVector();
+    }
+
+    std::vector<std::vector<double>> LinAlg::hadamard_product(const std::vector<std::vector<double>>& A, const std::vector<std::vector<double>>& B){
+        std::vector<std::vector<double>> C(A.size());
         for(int i = 0; i < A.size(); i++){
-            for(int j = 0; j < A[0].size(); j++){
-                C[i][j] = A[i][j] * B[i][j];
-            }
+            const double* a = A[i].data();
+            const double* b = B[i].data();
+            C[i].resize(A[0].size());
+            VecMath::hadamard(a, b, C[i].data(), C[i].size());
         }
         return C;
     }
@@ -141,7 +174,7 @@ namespace MLPP{
         return C;    
     }
 
-    std::vector<std::vector<double>> LinAlg::elementWiseDivision(std::vector<std::vector<double>> A, std::vector<std::vector<double>> B){
+    std::vector<std::vector<double>> LinAlg::elementWiseDivision(const std::vector<std::vector<double>>& A, const std::vector<std::vector<double>>& B){
         std::vector<std::vector<double>> C;
         C.resize(A.size());
         for(int i = 0; i < C.size(); i++){
@@ -155,51 +188,39 @@ namespace MLPP{
         return C;
     }
 
-    std::vector<std::vector<double>> LinAlg::transpose(std::vector<std::vector<double>> A){
+    std::vector<std::vector<double>> LinAlg::transpose(const std::vector<std::vector<double>>& A){
         std::vector<std::vector<double>> AT;
         AT.resize(A[0].size());
-        for(int i = 0; i < AT.size(); i++){
-            AT[i].resize(A.size());
-        }
-        
-        for(int i = 0; i < A[0].size(); i++){
-            for(int j = 0; j < A.size(); j++){
-                AT[i][j] = A[j][i];
+        forRows(AT.size(), A.size(), [&](long begin, long end){
+            for(long i = begin; i < end; i++){
+                AT[i].resize(A.size());
+                for(int j = 0; j < A.size(); j++){
+                    AT[i][j] = A[j][i];
+                }
             }
-        }
+        });
         return AT;
     }
 
     std::vector<std::vector<double>> LinAlg::scalarMultiply(double scalar, std::vector<std::vector<double>> A){
         for(int i = 0; i < A.size(); i++){
-            for(int j = 0; j < A[i].size(); j++){
-                A[i][j] *= scalar;
-            }
+            VecMath::scale(scalar, A[i].data(), A[i].data(), A[i].size());
         }
         return A;
     }
 
     std::vector<std::vector<double>> LinAlg::scalarAdd(double scalar, std::vector<std::vector<double>> A){
         for(int i = 0; i < A.size(); i++){
-            for(int j = 0; j < A[i].size(); j++){
-                A[i][j] += scalar;
-            }
+            VecMath::shift(scalar, A[i].data(), A[i].data(), A[i].size());
         }
         return A;
     }
 
     std::vector<std::vector<double>> LinAlg::log(std::vector<std::vector<double>> A){
-        std::vector<std::vector<double>> B;
-        B.resize(A.size());
-        for(int i = 0; i < B.size(); i++){
-            B[i].resize(A[0].size());
-        }
         for(int i = 0; i < A.size(); i++){
-            for(int j = 0; j < A[i].size(); j++){
-                B[i][j] = std::log(A[i][j]);
-            }
+            VecMath::log(A[i].data(), A[i].data(), A[i].size());
         }
-        return B;
+        return A;
     }
 
     std::vector<std::vector<double>> LinAlg::log10(std::vector<std::vector<double>> A){
@@ -217,31 +238,17 @@ namespace MLPP{
     }
 
     std::vector<std::vector<double>> LinAlg::exp(std::vector<std::vector<double>> A){
-        std::vector<std::vector<double>> B;
-        B.resize(A.size());
-        for(int i = 0; i < B.size(); i++){
-            B[i].resize(A[0].size());
-        }
         for(int i = 0; i < A.size(); i++){
-            for(int j = 0; j < A[i].size(); j++){
-                B[i][j] = std::exp(A[i][j]);
-            }
+            VecMath::exp(A[i].data(), A[i].data(), A[i].size());
         }
-        return B;
+        return A;
     }
 
     std::vector<std::vector<double>> LinAlg::erf(std::vector<std::vector<double>> A){
-        std::vector<std::vector<double>> B;
-        B.resize(A.size());
-        for(int i = 0; i < B.size(); i++){
-            B[i].resize(A[0].size());
-        }
         for(int i = 0; i < A.size(); i++){
-            for(int j = 0; j < A[i].size(); j++){
-                B[i][j] = std::erf(A[i][j]);
-            }
+            VecMath::erf(A[i].data(), A[i].data(), A[i].size());
         }
-        return B;
+        return A;
     }
 
     std::vector<std::vector<double>> LinAlg::exponentiate(std::vector<std::vector<double>> A, double p){
@@ -254,7 +261,10 @@ namespace MLPP{
     }
 
     std::vector<std::vector<double>> LinAlg::sqrt(std::vector<std::vector<double>> A){
-        return exponentiate(A, 0.5); 
+        for(int i = 0; i < A.size(); i++){
+            VecMath::sqrt(A[i].data(), A[i].data(), A[i].size());
+        }
+        return A;
     }
 
     std::vector<std::vector<double>> LinAlg::cbrt(std::vector<std::vector<double>> A){
@@ -276,17 +286,10 @@ namespace MLPP{
     }
 
     std::vector<std::vector<double>> LinAlg::abs(std::vector<std::vector<double>> A){
-        std::vector<std::vector<double>> B;
-        B.resize(A.size());
-        for(int i = 0; i < B.size(); i++){
-            B[i].resize(A[0].size());
-        }
-        for(int i = 0; i < B.size(); i++){
-            for(int j = 0; j < B[i].size(); j++){
-                B[i][j] = std::abs(A[i][j]);
-            }
+        for(int i = 0; i < A.size(); i++){
+            VecMath::abs(A[i].data(), A[i].data(), A[i].size());
         }
-        return B;
+        return A;
     }
 
     /*
@@ -322,41 +325,13 @@ namespace MLPP{
         }
         return deter;
     }*/
+    // Determinant of the leading d x d block, read off the pivots of its LU factorisation.
     double LinAlg::det(std::vector<std::vector<double>> A, int d){
-
-        double deter = 0;
-        std::vector<std::vector<double>> B;
-        B.resize(d);
+        Matrix B(d, d);
         for(int i = 0; i < d; i++){
-            B[i].resize(d);
+            std::copy(A[i].begin(), A[i].begin() + d, B.row(i));
         }
-
-        if (d == 1) {
-            // 1×1 determinant is just the single entry
-            return A[0][0];
-        }
-        if(d == 2){
-            return A[0][0] * A[1][1] - A[0][1] * A[1][0];
-        }
-
-        else{
-            for(int i = 0; i < d; i++){
-                int sub_i = 0;
-                for(int j = 1; j < d; j++){
-                    int sub_j = 0;
-                    for(int k = 0; k < d; k++){
-                        if(k == i){
-                            continue;
-                        }
-                        B[sub_i][sub_j] = A[j][k];
-                        sub_j++;
-                    }
-                    sub_i++;
-                }
-                deter += std::pow(-1, i) * A[0][i] * det(B, d-1);
-            }
-        }
-        return deter;
+        return LU(B).det();
     }
 
     double LinAlg::trace(std::vector<std::vector<double>> A){
@@ -425,14 +400,43 @@ namespace MLPP{
       return adj;
     }
 
-    // The inverse can be computed as (1 / determinant(A)) * adjoint(A)
+    // Singular matrices come back filled with NaN.
     std::vector<std::vector<double>> LinAlg::inverse(std::vector<std::vector<double>> A){
-      return scalarMultiply(1/det(A, int(A.size())), adjoint(A));
+        return LU(A).inverse();
     }
     
-    // This is simply the Moore-Penrose least squares approximation of the inverse. 
+    // The Moore-Penrose pseudoinverse. When A has full column rank it is R^-1 Q^T from the QR factorization of A,
+    // and when A has full row rank the transpose of that for A^T. Otherwise it is V S^+ U^T, where S^+ inverts the
+    // singular values above the rank tolerance.
     std::vector<std::vector<double>> LinAlg::pinverse(std::vector<std::vector<double>> A){
-        return matmult(inverse(matmult(transpose(A), A)), transpose(A));
+        int m = A.size();
+        int n = A[0].size();
+        bool wide = m < n;
+        QR qr(wide ? transpose(A) : A);
+        if(!qr.rankDeficient()){
+            int p = std::max(m, n);
+            Matrix I(p, p, 0.0);
+            for(int i = 0; i < p; i++){
+                I(i, i) = 1;
+            }
+            Matrix X;
+            qr.solve(I, X);
+            return wide ? transpose(X.toStdVector()) : X.toStdVector();
+        }
+
+        SVDSolver svd(A);
+        const Vector& S = svd.singularValues();
+        Matrix W = svd.Vt();
+        double tol = std::max(m, n) * std::numeric_limits<double>::epsilon() * (S.empty() ? 0 : S[0]);
+        for(int i = 0; i < W.rows(); i++){
+            double scale = S[i] > tol ? 1 / S[i] : 0;
+            for(int j = 0; j < n; j++){
+                W(i, j) *= scale;
+            }
+        }
+        Matrix X(n, m);
+        GEMM::gemm(true, true, n, m, W.rows(), 1.0, W.data(), W.stride(), svd.U().data(), svd.U().stride(), 0.0, X.data(), X.stride());
+        return X.toStdVector();
     }
 
     std::vector<std::vector<double>> LinAlg::zeromat(int n, int m){
@@ -491,15 +495,8 @@ namespace MLPP{
     }
 
     std::vector<double> LinAlg::max(std::vector<double> a, std::vector<double> b){
-        std::vector<double> c; 
-        c.resize(a.size());
-        for(int i = 0; i < c.size(); i++){
-            if(a[i] >= b[i]) { 
-                c[i] = a[i]; 
-            }
-            else { c[i] = b[i]; }
-        }
-        return c;
+        VecMath::max(a.data(), b.data(), a.data(), a.size());
+        return a;
     }
 
     double LinAlg::max(std::vector<std::vector<double>> A){
@@ -552,157 +549,67 @@ namespace MLPP{
     }
 
     std::vector<std::vector<double>> LinAlg::cov(std::vector<std::vector<double>> A){
-        Stat stat;
-        std::vector<std::vector<double>> covMat;
-        covMat.resize(A.size());
-        for(int i = 0; i < covMat.size(); i++){
-            covMat[i].resize(A.size());
-        }
-        for(int i = 0; i < A.size(); i++){
-            for(int j = 0; j < A.size(); j++){
-                covMat[i][j] = stat.covariance(A[i], A[j]);
+        // Each row of A is a variable. Centring every row once turns the n^2 pairwise covariances into X Xᵀ / (m - 1).
+        Matrix X(A);
+        int m = X.cols();
+        forRows(X.rows(), m, [&](long begin, long end){
+            for(long i = begin; i < end; i++){
+                double* x = X.row(i);
+                double mean = 0;
+                for(int j = 0; j < m; j++){
+                    mean += x[j];
+                }
+                mean /= m;
+                for(int j = 0; j < m; j++){
+                    x[j] -= mean;
+                }
             }
-        }
-        return covMat;
+        });
+        Matrix covMat;
+        matmultTranspose(X, X, covMat);
+        scalarMultiply(1.0 / (m - 1), covMat, covMat);
+        return covMat.toStdVector();
     }
 
     std::tuple<std::vector<std::vector<double>>, std::vector<std::vector<double>>> LinAlg::eig(std::vector<std::vector<double>> A){
+        return eig(A, A.size());
+    }
+
+    std::tuple<std::vector<std::vector<double>>, std::vector<std::vector<double>>> LinAlg::eig(std::vector<std::vector<double>> A, int k){
         /*
         A (the entered parameter) in most use cases will be X'X, XX', etc. and must be symmetric.
-        That simply means that 1) X' = X and 2) X is a square matrix. This function that computes the 
-        eigenvalues of a matrix is utilizing Jacobi's method. 
+        The eigenvectors are returned as columns, next to a diagonal matrix of the eigenvalues in descending order.
         */
-
-        double diagonal = true; // Perform the iterative Jacobi algorithm unless and until we reach a diagonal matrix which yields us the eigenvals. 
-        
-        std::map<int, int> val_to_vec; 
-        std::vector<std::vector<double>> a_new;
-        std::vector<std::vector<double>> eigenvectors = identity(A.size());
-        do{
-            double a_ij = A[0][1];
-            double sub_i = 0; 
-            double sub_j = 1;
-            for(int i = 0; i < A.size(); i++){
-                for(int j = 0; j < A[i].size(); j++){
-                    if(i != j && std::abs(A[i][j]) > a_ij){
-                        a_ij = A[i][j];
-                        sub_i = i; 
-                        sub_j = j;
-                    }
-                    else if(i != j && std::abs(A[i][j]) == a_ij){
-                        if(i < sub_i){
-                            a_ij = A[i][j];
-                            sub_i = i; 
-                            sub_j = j;
-                        }
-                    }
-                }
-            }
-
-            double a_ii = A[sub_i][sub_i];
-            double a_jj = A[sub_j][sub_j]; 
-            double a_ji = A[sub_j][sub_i]; 
-            double theta; 
-
-            if(a_ii == a_jj) {
-                theta = M_PI / 4; 
-            }
-            else{
-                theta = 0.5 * atan(2 * a_ij / (a_ii - a_jj));
-            }
-
-            std::vector<std::vector<double>> P = identity(A.size());
-            P[sub_i][sub_j] = -std::sin(theta);
-            P[sub_i][sub_i] = std::cos(theta);
-            P[sub_j][sub_j] = std::cos(theta);
-            P[sub_j][sub_i] = std::sin(theta);
-
-            a_new = matmult(matmult(inverse(P), A), P);
-
-            for(int i = 0; i < a_new.size(); i++){
-                for(int j = 0; j < a_new[i].size(); j++){
-                    if(i != j && std::round(a_new[i][j]) == 0){
-                        a_new[i][j] = 0;
-                    }
-                }
-            }
-
-            bool non_zero = false;
-            for(int i = 0; i < a_new.size(); i++){
-                for(int j = 0; j < a_new[i].size(); j++){
-                    if(i != j && std::round(a_new[i][j]) != 0){
-                        non_zero = true;
-                    }
-                }
-            }   
-
-            if(non_zero) { 
-                diagonal = false;
-            }
-            else{
-                diagonal = true;
-            }
-
-            if(a_new == A){
-                diagonal = true; 
-                for(int i = 0; i < a_new.size(); i++){
-                    for(int j = 0; j < a_new[i].size(); j++){
-                        if(i != j){
-                            a_new[i][j] = 0;
-                        }
-                    }
-                }   
-            }
-            
-            eigenvectors = matmult(eigenvectors, P);
-            A = a_new;
-
-        } while(!diagonal);
-
-        std::vector<std::vector<double>> a_new_prior = a_new;
-        
-        // Bubble Sort. Should change this later.
-        for(int i = 0; i < a_new.size() - 1; i++){
-            for(int j = 0; j < a_new.size() - 1 - i; j++){
-                if(a_new[j][j] < a_new[j + 1][j + 1]){
-                    double temp = a_new[j + 1][j + 1];
-                    a_new[j + 1][j + 1] = a_new[j][j];
-                    a_new[j][j] = temp;
-                }
-            }
+        EigenSolver solver(A, k);
+        std::vector<std::vector<double>> eigenvals = zeromat(solver.eigenvalues().size(), solver.eigenvalues().size());
+        for(int i = 0; i < eigenvals.size(); i++){
+            eigenvals[i][i] = solver.eigenvalues()[i];
         }
+        return {solver.eigenvectors().toStdVector(), eigenvals};
+    }
 
+    std::tuple<std::vector<std::vector<double>>, std::vector<std::vector<double>>, std::vector<std::vector<double>>> LinAlg::SVD(std::vector<std::vector<double>> A){
+        return SVD(A, 0);
+    }
 
-        for(int i = 0; i < a_new.size(); i++){
-            for(int j = 0; j < a_new.size(); j++){
-                if(a_new[i][i] == a_new_prior[j][j]){
-                    val_to_vec[i] = j;
-                }
-            }
-        }
-
-        std::vector<std::vector<double>> eigen_temp = eigenvectors;
-        for(int i = 0; i < eigenvectors.size(); i++){
-            for(int j = 0; j < eigenvectors[i].size(); j++){
-                eigenvectors[i][j] = eigen_temp[i][val_to_vec[j]];  
-            }
+    std::tuple<std::vector<std::vector<double>>, std::vector<std::vector<double>>, std::vector<std::vector<double>>> LinAlg::SVD(std::vector<std::vector<double>> A, int rank){
+        SVDSolver svd(A, rank);
+        std::vector<std::vector<double>> sigma = zeromat(svd.singularValues().size(), svd.singularValues().size());
+        for(int i = 0; i < sigma.size(); i++){
+            sigma[i][i] = svd.singularValues()[i];
         }
-        return {eigenvectors, a_new};
-
+        return {svd.U().toStdVector(), sigma, svd.Vt().toStdVector()};
     }
 
-    std::tuple<std::vector<std::vector<double>>, std::vector<std::vector<double>>, std::vector<std::vector<double>>> LinAlg::SVD(std::vector<std::vector<double>> A){
-        auto [left_eigenvecs, eigenvals] = eig(matmult(A, transpose(A)));
-        auto [right_eigenvecs, right_eigenvals] = eig(matmult(transpose(A), A));
-
-        std::vector<std::vector<double>> singularvals = sqrt(eigenvals);
-        std::vector<std::vector<double>> sigma = zeromat(A.size(), A[0].size());
-         for(int i = 0; i < singularvals.size(); i++){
-            for(int j = 0; j < singularvals[i].size(); j++){
-                sigma[i][j] = singularvals[i][j];
-            }
+    std::tuple<std::vector<std::vector<double>>, std::vector<std::vector<double>>, std::vector<std::vector<double>>> LinAlg::randomizedSVD(std::vector<std::vector<double>> A, int k, int oversampling, int powerIterations){
+        Matrix U, Vt;
+        Vector S;
+        randomizedSVD(Matrix(A), k, U, S, Vt, oversampling, powerIterations);
+        std::vector<std::vector<double>> sigma = zeromat(S.size(), S.size());
+        for(int i = 0; i < S.size(); i++){
+            sigma[i][i] = S[i];
         }
-        return {left_eigenvecs, sigma, right_eigenvecs};
+        return {U.toStdVector(), sigma, Vt.toStdVector()};
     }
 
     std::vector<double> LinAlg::vectorProjection(std::vector<double> a, std::vector<double> b){
@@ -731,10 +638,18 @@ namespace MLPP{
     }
 
     std::tuple<std::vector<std::vector<double>>, std::vector<std::vector<double>>> LinAlg::QRD(std::vector<std::vector<double>> A){
-        std::vector<std::vector<double>> Q = gramSchmidtProcess(A);
-        std::vector<std::vector<double>> R = matmult(transpose(Q), A);
+        QR qr(A);
+        std::vector<std::vector<double>> Q = qr.Q();
+        std::vector<std::vector<double>> R = qr.R();
+        for(int i = 0; i < R.size(); i++){
+            if(R[i][i] < 0){
+                R[i] = scalarMultiply(-1, R[i]);
+                for(int j = 0; j < Q.size(); j++){
+                    Q[j][i] = -Q[j][i];
+                }
+            }
+        }
         return {Q, R};
-
     }
     
     std::tuple<std::vector<std::vector<double>>, std::vector<std::vector<double>>> LinAlg::chol(std::vector<std::vector<double>> A){
@@ -781,7 +696,42 @@ namespace MLPP{
     }
 
     std::vector<double> LinAlg::solve(std::vector<std::vector<double>> A, std::vector<double> b){
-        return mat_vec_mult(inverse(A), b);
+        return LU(A).solve(b);
+    }
+
+    std::vector<double> LinAlg::lstsq(std::vector<std::vector<double>> A, std::vector<double> b){
+        if(A.size() >= A[0].size()){
+            QR qr(A);
+            if(!qr.rankDeficient()){
+                return qr.solve(b);
+            }
+        }
+        return mat_vec_mult(pinverse(A), b);
+    }
+
+    std::vector<double> LinAlg::cholSolve(std::vector<std::vector<double>> A, std::vector<double> b){
+        int n = A.size();
+        auto [L, Lt] = chol(A);
+        for(int i = 0; i < n; i++){
+            if(!(L[i][i] > 0)){
+                return std::vector<double>(n, std::numeric_limits<double>::quiet_NaN());
+            }
+        }
+        // L y = b, then L^T x = y. Both sweeps walk rows of L or L^T, so every inner loop is contiguous.
+        std::vector<double> x = b;
+        for(int i = 0; i < n; i++){
+            for(int k = 0; k < i; k++){
+                x[i] -= L[i][k] * x[k];
+            }
+            x[i] /= L[i][i];
+        }
+        for(int i = n - 1; i >= 0; i--){
+            for(int k = i + 1; k < n; k++){
+                x[i] -= Lt[i][k] * x[k];
+            }
+            x[i] /= Lt[i][i];
+        }
+        return x;
     }
 
     bool LinAlg::positiveDefiniteChecker(std::vector<std::vector<double>> A){
@@ -835,7 +785,7 @@ namespace MLPP{
         }
     }
 
-    std::vector<std::vector<double>> LinAlg::outerProduct(std::vector<double> a, std::vector<double> b){
+    std::vector<std::vector<double>> LinAlg::outerProduct(const std::vector<double>& a, const std::vector<double>& b){
         std::vector<std::vector<double>> C;
         C.resize(a.size());
         for(int i = 0; i < C.size(); i++){
@@ -844,18 +794,14 @@ namespace MLPP{
         return C;
     }
 
-    std::vector<double> LinAlg::hadamard_product(std::vector<double> a, std::vector<double> b){
+    std::vector<double> LinAlg::hadamard_product(const std::vector<double>& a, const std::vector<double>& b){
         std::vector<double> c;
         c.resize(a.size());
-        
-        for(int i = 0; i < a.size(); i++){
-            c[i] = a[i] * b[i];
-        }
-        
+        VecMath::hadamard(a.data(), b.data(), c.data(), a.size());
         return c;
     }
 
-    std::vector<double> LinAlg::elementWiseDivision(std::vector<double> a, std::vector<double> b){
+    std::vector<double> LinAlg::elementWiseDivision(const std::vector<double>& a, const std::vector<double>& b){
         std::vector<double> c;
         c.resize(a.size());
 
@@ -866,20 +812,16 @@ namespace MLPP{
     }
 
     std::vector<double> LinAlg::scalarMultiply(double scalar, std::vector<double> a){
-        for(int i = 0; i < a.size(); i++){
-            a[i] *= scalar;
-        }
+        VecMath::scale(scalar, a.data(), a.data(), a.size());
         return a;
     }
 
     std::vector<double> LinAlg::scalarAdd(double scalar, std::vector<double> a){
-        for(int i = 0; i < a.size(); i++){
-            a[i] += scalar;
-        }
+        VecMath::shift(scalar, a.data(), a.data(), a.size());
         return a;
     }
 
-    std::vector<double> LinAlg::addition(std::vector<double> a, std::vector<double> b){
+    std::vector<double> LinAlg::addition(const std::vector<double>& a, const std::vector<double>& b){
         std::vector<double> c;
         c.resize(a.size());
         for(int i = 0; i < a.size(); i++){
@@ -888,7 +830,7 @@ namespace MLPP{
         return c;
     }
 
-    std::vector<double> LinAlg::subtraction(std::vector<double> a, std::vector<double> b){
+    std::vector<double> LinAlg::subtraction(const std::vector<double>& a, const std::vector<double>& b){
         std::vector<double> c;
         c.resize(a.size());
         for(int i = 0; i < a.size(); i++){
@@ -905,12 +847,8 @@ namespace MLPP{
     }
 
     std::vector<double> LinAlg::log(std::vector<double> a){
-        std::vector<double> b; 
-        b.resize(a.size());
-        for(int i = 0; i < a.size(); i++){
-            b[i] = std::log(a[i]);
-        }
-        return b; 
+        VecMath::log(a.data(), a.data(), a.size());
+        return a;
     }
 
     std::vector<double> LinAlg::log10(std::vector<double> a){
@@ -923,21 +861,13 @@ namespace MLPP{
     }
 
     std::vector<double> LinAlg::exp(std::vector<double> a){
-        std::vector<double> b;
-        b.resize(a.size());
-        for(int i = 0; i < a.size(); i++){
-            b[i] = std::exp(a[i]);
-        }
-        return b;
+        VecMath::exp(a.data(), a.data(), a.size());
+        return a;
     }
 
     std::vector<double> LinAlg::erf(std::vector<double> a){
-        std::vector<double> b;
-        b.resize(a.size());
-        for(int i = 0; i < a.size(); i++){
-            b[i] = std::erf(a[i]);
-        }
-        return b;
+        VecMath::erf(a.data(), a.data(), a.size());
+        return a;
     }
 
     std::vector<double> LinAlg::exponentiate(std::vector<double> a, double p){
@@ -950,14 +880,15 @@ namespace MLPP{
     }
 
     std::vector<double> LinAlg::sqrt(std::vector<double> a){
-        return exponentiate(a, 0.5);
+        VecMath::sqrt(a.data(), a.data(), a.size());
+        return a;
     }
 
     std::vector<double> LinAlg::cbrt(std::vector<double> a){
         return exponentiate(a, double(1)/double(3));
     } 
 
-    double LinAlg::dot(std::vector<double> a, std::vector<double> b){
+    double LinAlg::dot(const std::vector<double>& a, const std::vector<double>& b){
         double c = 0;
         for(int i = 0; i < a.size(); i++){
             c += a[i] * b[i];
@@ -977,12 +908,8 @@ namespace MLPP{
     }
 
     std::vector<double> LinAlg::abs(std::vector<double> a){
-        std::vector<double> b; 
-        b.resize(a.size());
-        for(int i = 0; i < b.size(); i++){
-            b[i] = std::abs(a[i]);
-        }
-        return b;
+        VecMath::abs(a.data(), a.data(), a.size());
+        return a;
     }
 
     std::vector<double> LinAlg::zerovec(int n){
@@ -1129,15 +1056,19 @@ namespace MLPP{
         return A;
     }
 
-    std::vector<double> LinAlg::mat_vec_mult(std::vector<std::vector<double>> A, std::vector<double> b){
+    std::vector<double> LinAlg::mat_vec_mult(const std::vector<std::vector<double>>& A, const std::vector<double>& b){
         std::vector<double> c;
         c.resize(A.size());
-            
-        for(int i = 0; i < A.size(); i++){
-            for(int k = 0; k < b.size(); k++){
-                c[i] += A[i][k] * b[k];
+        forRows(A.size(), b.size(), [&](long begin, long end){
+            for(long i = begin; i < end; i++){
+                const double* a = A[i].data();
+                double sum = 0;
+                for(int k = 0; k < b.size(); k++){
+                    sum += a[k] * b[k];
+                }
+                c[i] = sum;
             }
-        }
+        });
         return c;
     }
 
@@ -1272,4 +1203,361 @@ namespace MLPP{
         }
         return C;
     }
+
+    namespace {
+        template <class F>
+        void mapElements(const Matrix& A, Matrix& B, F f){
+            B.resize(A.rows(), A.cols());
+            for(int i = 0; i < A.rows(); i++){
+                const double* a = A.row(i);
+                double* b = B.row(i);
+                for(int j = 0; j < A.cols(); j++){
+                    b[j] = f(a[j]);
+                }
+            }
+        }
+
+        template <class F>
+        void zipElements(const Matrix& A, const Matrix& B, Matrix& C, F f){
+            C.resize(A.rows(), A.cols());
+            for(int i = 0; i < A.rows(); i++){
+                const double* a = A.row(i);
+                const double* b = B.row(i);
+                double* c = C.row(i);
+                for(int j = 0; j < A.cols(); j++){
+                    c[j] = f(a[j], b[j]);
+                }
+            }
+        }
+
+        template <class F>
+        void mapElements(const Vector& a, Vector& b, F f){
+            b.resize(a.size());
+            const double* x = a.data();
+            double* y = b.data();
+            for(int i = 0; i < a.size(); i++){
+                y[i] = f(x[i]);
+            }
+        }
+
+        template <class F>
+        void zipElements(const Vector& a, const Vector& b, Vector& c, F f){
+            c.resize(a.size());
+            const double* x = a.data();
+            const double* y = b.data();
+            double* z = c.data();
+            for(int i = 0; i < a.size(); i++){
+                z[i] = f(x[i], y[i]);
+            }
+        }
+
+        // Row-at-a-time versions for the operations VecMath vectorizes.
+        void mapRows(const Matrix& A, Matrix& B, void (*f)(const double*, double*, long)){
+            B.resize(A.rows(), A.cols());
+            for(int i = 0; i < A.rows(); i++){
+                f(A.row(i), B.row(i), A.cols());
+            }
+        }
+
+        void zipRows(const Matrix& A, const Matrix& B, Matrix& C, void (*f)(const double*, const double*, double*, long)){
+            C.resize(A.rows(), A.cols());
+            for(int i = 0; i < A.rows(); i++){
+                f(A.row(i), B.row(i), C.row(i), A.cols());
+            }
+        }
+    }
+
+    void LinAlg::addition(const Matrix& A, const Matrix& B, Matrix& C){
+        zipElements(A, B, C, [](double a, double b){ return a + b; });
+    }
+
+    void LinAlg::subtraction(const Matrix& A, const Matrix& B, Matrix& C){
+        zipElements(A, B, C, [](double a, double b){ return a - b; });
+    }
+
+    // In the three products below C must not alias A or B.
+    void LinAlg::matmult(const Matrix& A, const Matrix& B, Matrix& C){
+        C.resize(A.rows(), B.cols());
+        GEMM::gemm(false, false, A.rows(), B.cols(), A.cols(), 1, A.data(), A.stride(), B.data(), B.stride(), 0, C.data(), C.stride());
+    }
+
+    void LinAlg::transposeMatmult(const Matrix& A, const Matrix& B, Matrix& C){
+        C.resize(A.cols(), B.cols());
+        GEMM::gemm(true, false, A.cols(), B.cols(), A.rows(), 1, A.data(), A.stride(), B.data(), B.stride(), 0, C.data(), C.stride());
+    }
+
+    void LinAlg::matmultTranspose(const Matrix& A, const Matrix& B, Matrix& C){
+        C.resize(A.rows(), B.rows());
+        GEMM::gemm(false, true, A.rows(), B.rows(), A.cols(), 1, A.data(), A.stride(), B.data(), B.stride(), 0, C.data(), C.stride());
+    }
+
+    void LinAlg::hadamard_product(const Matrix& A, const Matrix& B, Matrix& C){
+        zipRows(A, B, C, VecMath::hadamard);
+    }
+
+    void LinAlg::elementWiseDivision(const Matrix& A, const Matrix& B, Matrix& C){
+        zipElements(A, B, C, [](double a, double b){ return a / b; });
+    }
+
+    void LinAlg::transpose(const Matrix& A, Matrix& AT){
+        // AT must not alias A.
+        AT.resize(A.cols(), A.rows());
+        // Work on 32 x 32 tiles so that both the reads and the strided writes stay in cache.
+        const int T = 32;
+        forRows((A.rows() + T - 1) / T, (long)T * A.cols(), [&](long begin, long end){
+            for(int i0 = begin * T; i0 < std::min<long>(end * T, A.rows()); i0 += T){
+                for(int j0 = 0; j0 < A.cols(); j0 += T){
+                    for(int i = i0; i < std::min(i0 + T, A.rows()); i++){
+                        const double* a = A.row(i);
+                        for(int j = j0; j < std::min(j0 + T, A.cols()); j++){
+                            AT(j, i) = a[j];
+                        }
+                    }
+                }
+            }
+        });
+    }
+
+    void LinAlg::scalarMultiply(double scalar, const Matrix& A, Matrix& B){
+        B.resize(A.rows(), A.cols());
+        for(int i = 0; i < A.rows(); i++){
+            VecMath::scale(scalar, A.row(i), B.row(i), A.cols());
+        }
+    }
+
+    void LinAlg::scalarAdd(double scalar, const Matrix& A, Matrix& B){
+        B.resize(A.rows(), A.cols());
+        for(int i = 0; i < A.rows(); i++){
+            VecMath::shift(scalar, A.row(i), B.row(i), A.cols());
+        }
+    }
+
+    void LinAlg::log(const Matrix& A, Matrix& B){
+        mapRows(A, B, VecMath::log);
+    }
+
+    void LinAlg::log10(const Matrix& A, Matrix& B){
+        mapElements(A, B, [](double a){ return std::log10(a); });
+    }
+
+    void LinAlg::exp(const Matrix& A, Matrix& B){
+        mapRows(A, B, VecMath::exp);
+    }
+
+    void LinAlg::erf(const Matrix& A, Matrix& B){
+        mapRows(A, B, VecMath::erf);
+    }
+
+    void LinAlg::exponentiate(const Matrix& A, double p, Matrix& B){
+        mapElements(A, B, [p](double a){ return std::pow(a, p); });
+    }
+
+    void LinAlg::sqrt(const Matrix& A, Matrix& B){
+        mapRows(A, B, VecMath::sqrt);
+    }
+
+    void LinAlg::cbrt(const Matrix& A, Matrix& B){
+        mapElements(A, B, [](double a){ return std::cbrt(a); });
+    }
+
+    void LinAlg::abs(const Matrix& A, Matrix& B){
+        mapRows(A, B, VecMath::abs);
+    }
+
+    void LinAlg::sin(const Matrix& A, Matrix& B){
+        mapElements(A, B, [](double a){ return std::sin(a); });
+    }
+
+    void LinAlg::cos(const Matrix& A, Matrix& B){
+        mapElements(A, B, [](double a){ return std::cos(a); });
+    }
+
+    void LinAlg::round(const Matrix& A, Matrix& B){
+        mapElements(A, B, [](double a){ return std::round(a); });
+    }
+
+    void LinAlg::max(const Matrix& A, const Matrix& B, Matrix& C){
+        zipRows(A, B, C, VecMath::max);
+    }
+
+    double LinAlg::sum_elements(const Matrix& A){
+        double sum = 0;
+        for(int i = 0; i < A.rows(); i++){
+            const double* a = A.row(i);
+            for(int j = 0; j < A.cols(); j++){
+                sum += a[j];
+            }
+        }
+        return sum;
+    }
+
+    double LinAlg::norm_2(const Matrix& A){
+        double sum = 0;
+        for(int i = 0; i < A.rows(); i++){
+            const double* a = A.row(i);
+            for(int j = 0; j < A.cols(); j++){
+                sum += a[j] * a[j];
+            }
+        }
+        return std::sqrt(sum);
+    }
+
+    void LinAlg::mat_vec_add(const Matrix& A, const Vector& b, Matrix& C){
+        C.resize(A.rows(), A.cols());
+        for(int i = 0; i < A.rows(); i++){
+            const double* a = A.row(i);
+            double* c = C.row(i);
+            for(int j = 0; j < A.cols(); j++){
+                c[j] = a[j] + b[j];
+            }
+        }
+    }
+
+    void LinAlg::mat_vec_mult(const Matrix& A, const Vector& b, Vector& c){
+        // c must not alias b.
+        c.resize(A.rows());
+        forRows(A.rows(), A.cols(), [&](long begin, long end){
+            for(long i = begin; i < end; i++){
+                const double* a = A.row(i);
+                double sum = 0;
+                for(int k = 0; k < A.cols(); k++){
+                    sum += a[k] * b[k];
+                }
+                c[i] = sum;
+            }
+        });
+    }
+
+    void LinAlg::eig(const Matrix& A, Matrix& eigenvectors, Vector& eigenvalues, int k){
+        EigenSolver solver(A, k);
+        eigenvectors = solver.eigenvectors();
+        eigenvalues = solver.eigenvalues();
+    }
+
+    void LinAlg::SVD(const Matrix& A, Matrix& U, Vector& S, Matrix& Vt, int rank){
+        SVDSolver svd(A, rank);
+        U = svd.U();
+        S = svd.singularValues();
+        Vt = svd.Vt();
+    }
+
+    void LinAlg::randomizedSVD(const Matrix& A, int k, Matrix& U, Vector& S, Matrix& Vt, int oversampling, int powerIterations){
+        int m = A.rows();
+        int n = A.cols();
+        int l = std::min(k + oversampling, std::min(m, n));
+
+        // The range basis Q is kept transposed (l x m) so that it can be orthonormalized row by row.
+        Matrix omegaT(l, n);
+        std::mt19937 gen(0);
+        std::normal_distribution<double> dist(0.0, 1.0);
+        for(int i = 0; i < l; i++){
+            for(int j = 0; j < n; j++){
+                omegaT(i, j) = dist(gen);
+            }
+        }
+        Matrix QT(l, m);
+        GEMM::gemm(false, true, l, m, n, 1.0, omegaT.data(), omegaT.stride(), A.data(), A.stride(), 0.0, QT.data(), QT.stride());
+        EigenSolver::orthonormalizeRows(QT, 0, l);
+
+        // Each pass through Aᵀ and back sharpens the decay of the sampled spectrum; re-orthonormalizing in between
+        // keeps the small singular directions from being lost to round-off.
+        Matrix ZT(l, n);
+        for(int it = 0; it < powerIterations; it++){
+            GEMM::gemm(false, false, l, n, m, 1.0, QT.data(), QT.stride(), A.data(), A.stride(), 0.0, ZT.data(), ZT.stride());
+            EigenSolver::orthonormalizeRows(ZT, 0, l);
+            GEMM::gemm(false, true, l, m, n, 1.0, ZT.data(), ZT.stride(), A.data(), A.stride(), 0.0, QT.data(), QT.stride());
+            EigenSolver::orthonormalizeRows(QT, 0, l);
+        }
+
+        // B = Qᵀ A is only l x n; its SVD gives A ~ (Q U_B) S Vt.
+        Matrix B(l, n);
+        GEMM::gemm(false, false, l, n, m, 1.0, QT.data(), QT.stride(), A.data(), A.stride(), 0.0, B.data(), B.stride());
+        SVDSolver svd(B, k);
+        U.resize(m, svd.U().cols());
+        GEMM::gemm(true, false, m, U.cols(), l, 1.0, QT.data(), QT.stride(), svd.U().data(), svd.U().stride(), 0.0, U.data(), U.stride());
+        S = svd.singularValues();
+        Vt = svd.Vt();
+    }
+
+    void LinAlg::addition(const Vector& a, const Vector& b, Vector& c){
+        zipElements(a, b, c, [](double x, double y){ return x + y; });
+    }
+
+    void LinAlg::subtraction(const Vector& a, const Vector& b, Vector& c){
+        zipElements(a, b, c, [](double x, double y){ return x - y; });
+    }
+
+    void LinAlg::hadamard_product(const Vector& a, const Vector& b, Vector& c){
+        c.resize(a.size());
+        VecMath::hadamard(a.data(), b.data(), c.data(), a.size());
+    }
+
+    void LinAlg::elementWiseDivision(const Vector& a, const Vector& b, Vector& c){
+        zipElements(a, b, c, [](double x, double y){ return x / y; });
+    }
+
+    void LinAlg::scalarMultiply(double scalar, const Vector& a, Vector& b){
+        b.resize(a.size());
+        VecMath::scale(scalar, a.data(), b.data(), a.size());
+    }
+
+    void LinAlg::scalarAdd(double scalar, const Vector& a, Vector& b){
+        b.resize(a.size());
+        VecMath::shift(scalar, a.data(), b.data(), a.size());
+    }
+
+    void LinAlg::log(const Vector& a, Vector& b){
+        b.resize(a.size());
+        VecMath::log(a.data(), b.data(), a.size());
+    }
+
+    void LinAlg::exp(const Vector& a, Vector& b){
+        b.resize(a.size());
+        VecMath::exp(a.data(), b.data(), a.size());
+    }
+
+    void LinAlg::sqrt(const Vector& a, Vector& b){
+        b.resize(a.size());
+        VecMath::sqrt(a.data(), b.data(), a.size());
+    }
+
+    void LinAlg::abs(const Vector& a, Vector& b){
+        b.resize(a.size());
+        VecMath::abs(a.data(), b.data(), a.size());
+    }
+
+    void LinAlg::max(const Vector& a, const Vector& b, Vector& c){
+        c.resize(a.size());
+        VecMath::max(a.data(), b.data(), c.data(), a.size());
+    }
+
+    void LinAlg::outerProduct(const Vector& a, const Vector& b, Matrix& C){
+        C.resize(a.size(), b.size());
+        for(int i = 0; i < a.size(); i++){
+            double* c = C.row(i);
+            for(int j = 0; j < b.size(); j++){
+                c[j] = a[i] * b[j];
+            }
+        }
+    }
+
+    double LinAlg::dot(const Vector& a, const Vector& b){
+        double c = 0;
+        for(int i = 0; i < a.size(); i++){
+            c += a[i] * b[i];
+        }
+        return c;
+    }
+
+    double LinAlg::norm_2(const Vector& a){
+        return std::sqrt(dot(a, a));
+    }
+
+    double LinAlg::sum_elements(const Vector& a){
+        double sum = 0;
+        for(int i = 0; i < a.size(); i++){
+            sum += a[i];
+        }
+        return sum;
+    }
 }
\ No newline at end of file
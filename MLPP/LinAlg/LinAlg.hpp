@@ -7,6 +7,8 @@
 #ifndef LinAlg_hpp
 #define LinAlg_hpp
 
+#include "Matrix/Matrix.hpp"
+
 #include <vector>
 #include <tuple>
 
@@ -22,19 +24,23 @@ namespace MLPP{
 
         std::vector<std::vector<double>> gaussianNoise(int n, int m);
 
-        std::vector<std::vector<double>> addition(std::vector<std::vector<double>> A, std::vector<std::vector<double>> B);
+        std::vector<std::vector<double>> addition(const std::vector<std::vector<double>>& A, const std::vector<std::vector<double>>& B);
 
-        std::vector<std::vector<double>> subtraction(std::vector<std::vector<double>> A, std::vector<std::vector<double>> B);
+        std::vector<std::vector<double>> subtraction(const std::vector<std::vector<double>>& A, const std::vector<std::vector<double>>& B);
         
-        std::vector<std::vector<double>> matmult(std::vector<std::vector<double>> A, std::vector<std::vector<double>> B);
+        std::vector<std::vector<double>> matmult(const std::vector<std::vector<double>>& A, const std::vector<std::vector<double>>& B);
+
+        std::vector<std::vector<double>> transposeMatmult(const std::vector<std::vector<double>>& A, const std::vector<std::vector<double>>& B); // AᵀB without forming Aᵀ
+
+        std::vector<std::vector<double>> matmultTranspose(const std::vector<std::vector<double>>& A, const std::vector<std::vector<double>>& B); // ABᵀ without forming Bᵀ
         
-        std::vector<std::vector<double>> hadamard_product(std::vector<std::vector<double>> A, std::vector<std::vector<double>> B);
+        std::vector<std::vector<double>> hadamard_product(const std::vector<std::vector<double>>& A, const std::vector<std::vector<double>>& B);
 
         std::vector<std::vector<double>> kronecker_product(std::vector<std::vector<double>> A, std::vector<std::vector<double>> B);
 
-        std::vector<std::vector<double>> elementWiseDivision(std::vector<std::vector<double>> A, std::vector<std::vector<double>> B);
+        std::vector<std::vector<double>> elementWiseDivision(const std::vector<std::vector<double>>& A, const std::vector<std::vector<double>>& B);
         
-        std::vector<std::vector<double>> transpose(std::vector<std::vector<double>> A);
+        std::vector<std::vector<double>> transpose(const std::vector<std::vector<double>>& A);
         
         std::vector<std::vector<double>> scalarMultiply(double scalar, std::vector<std::vector<double>> A);
 
@@ -98,16 +104,38 @@ namespace MLPP{
 
         std::tuple<std::vector<std::vector<double>>, std::vector<std::vector<double>>> eig(std::vector<std::vector<double>> A);
 
+        // Only the k largest eigenpairs.
+        std::tuple<std::vector<std::vector<double>>, std::vector<std::vector<double>>> eig(std::vector<std::vector<double>> A, int k);
+
+        // Thin SVD {U, S, Vt}: U is m x r, S the r x r diagonal of singular values in descending order and Vt is r x n,
+        // with r = min(m, n).
         std::tuple<std::vector<std::vector<double>>, std::vector<std::vector<double>>, std::vector<std::vector<double>>> SVD(std::vector<std::vector<double>> A);
 
+        // Truncated to the rank largest singular values.
+        std::tuple<std::vector<std::vector<double>>, std::vector<std::vector<double>>, std::vector<std::vector<double>>> SVD(std::vector<std::vector<double>> A, int rank);
+
+        // Approximate top-k SVD by randomized range finding (Halko, Martinsson & Tropp): A is sampled with k + oversampling
+        // Gaussian vectors, refined by powerIterations passes of A Aᵀ, and only the small projected matrix is decomposed.
+        // Costs O(mnk) rather than a full decomposition. The sketch uses a fixed seed, so results are reproducible.
+        std::tuple<std::vector<std::vector<double>>, std::vector<std::vector<double>>, std::vector<std::vector<double>>> randomizedSVD(std::vector<std::vector<double>> A, int k, int oversampling = 10, int powerIterations = 2);
+
         std::vector<double> vectorProjection(std::vector<double> a, std::vector<double> b);
 
         std::vector<std::vector<double>> gramSchmidtProcess(std::vector<std::vector<double>> A);
 
+        // Householder QR with the signs chosen so that R has a non-negative diagonal, as Gram-Schmidt would give.
         std::tuple<std::vector<std::vector<double>>, std::vector<std::vector<double>>> QRD(std::vector<std::vector<double>> A);
 
         std::tuple<std::vector<std::vector<double>>, std::vector<std::vector<double>>> chol(std::vector<std::vector<double>> A);
 
+        // Least-squares solution of Ax = b through the QR factorization of A. Wide or rank-deficient A
+        // gets the minimum-norm solution from the pseudoinverse instead.
+        std::vector<double> lstsq(std::vector<std::vector<double>> A, std::vector<double> b);
+
+        // Solves Ax = b for symmetric positive definite A by Cholesky, about half the work of LU.
+        // Comes back filled with NaN if A is not positive definite.
+        std::vector<double> cholSolve(std::vector<std::vector<double>> A, std::vector<double> b);
+
         double sum_elements(std::vector<std::vector<double>> A);
 
         std::vector<double> flatten(std::vector<std::vector<double>> A);
@@ -124,19 +152,19 @@ namespace MLPP{
         
         // VECTOR FUNCTIONS
 
-        std::vector<std::vector<double>> outerProduct(std::vector<double> a, std::vector<double> b); // This multiplies a, bT 
+        std::vector<std::vector<double>> outerProduct(const std::vector<double>& a, const std::vector<double>& b); // This multiplies a, bT 
         
-        std::vector<double> hadamard_product(std::vector<double> a, std::vector<double> b);
+        std::vector<double> hadamard_product(const std::vector<double>& a, const std::vector<double>& b);
 
-        std::vector<double> elementWiseDivision(std::vector<double> a, std::vector<double> b);
+        std::vector<double> elementWiseDivision(const std::vector<double>& a, const std::vector<double>& b);
         
         std::vector<double> scalarMultiply(double scalar, std::vector<double> a);
 
         std::vector<double> scalarAdd(double scalar, std::vector<double> a);
         
-        std::vector<double> addition(std::vector<double> a, std::vector<double> b);
+        std::vector<double> addition(const std::vector<double>& a, const std::vector<double>& b);
         
-        std::vector<double> subtraction(std::vector<double> a, std::vector<double> b);
+        std::vector<double> subtraction(const std::vector<double>& a, const std::vector<double>& b);
 
         std::vector<double> subtractMatrixRows(std::vector<double> a, std::vector<std::vector<double>> B);
 
@@ -154,7 +182,7 @@ namespace MLPP{
 
         std::vector<double> cbrt(std::vector<double> a);
         
-        double dot(std::vector<double> a, std::vector<double> b);
+        double dot(const std::vector<double>& a, const std::vector<double>& b);
 
         std::vector<double> cross(std::vector<double> a, std::vector<double> b);
 
@@ -195,7 +223,7 @@ namespace MLPP{
         // MATRIX-VECTOR FUNCTIONS
         std::vector<std::vector<double>> mat_vec_add(std::vector<std::vector<double>> A, std::vector<double> b);
 
-        std::vector<double> mat_vec_mult(std::vector<std::vector<double>> A, std::vector<double> b);
+        std::vector<double> mat_vec_mult(const std::vector<std::vector<double>>& A, const std::vector<double>& b);
 
         // TENSOR FUNCTIONS
         std::vector<std::vector<std::vector<double>>> addition(std::vector<std::vector<std::vector<double>>> A, std::vector<std::vector<std::vector<double>>> B);
@@ -228,6 +256,100 @@ namespace MLPP{
 
         std::vector<std::vector<std::vector<double>>> vector_wise_tensor_product(std::vector<std::vector<std::vector<double>>> A, std::vector<std::vector<double>> B);
 
+        // CONTIGUOUS MATRIX FUNCTIONS
+        // Outputs are resized in place, reusing their allocation when it is large enough.
+        // Element-wise routines allow the output to alias an input.
+        void addition(const Matrix& A, const Matrix& B, Matrix& C);
+
+        void subtraction(const Matrix& A, const Matrix& B, Matrix& C);
+
+        void matmult(const Matrix& A, const Matrix& B, Matrix& C);
+
+        void transposeMatmult(const Matrix& A, const Matrix& B, Matrix& C);
+
+        void matmultTranspose(const Matrix& A, const Matrix& B, Matrix& C);
+
+        void hadamard_product(const Matrix& A, const Matrix& B, Matrix& C);
+
+        void elementWiseDivision(const Matrix& A, const Matrix& B, Matrix& C);
+
+        void transpose(const Matrix& A, Matrix& AT);
+
+        void scalarMultiply(double scalar, const Matrix& A, Matrix& B);
+
+        void scalarAdd(double scalar, const Matrix& A, Matrix& B);
+
+        void log(const Matrix& A, Matrix& B);
+
+        void log10(const Matrix& A, Matrix& B);
+
+        void exp(const Matrix& A, Matrix& B);
+
+        void erf(const Matrix& A, Matrix& B);
+
+        void exponentiate(const Matrix& A, double p, Matrix& B);
+
+        void sqrt(const Matrix& A, Matrix& B);
+
+        void cbrt(const Matrix& A, Matrix& B);
+
+        void abs(const Matrix& A, Matrix& B);
+
+        void sin(const Matrix& A, Matrix& B);
+
+        void cos(const Matrix& A, Matrix& B);
+
+        void round(const Matrix& A, Matrix& B);
+
+        void max(const Matrix& A, const Matrix& B, Matrix& C);
+
+        double sum_elements(const Matrix& A);
+
+        double norm_2(const Matrix& A);
+
+        void mat_vec_add(const Matrix& A, const Vector& b, Matrix& C);
+
+        void mat_vec_mult(const Matrix& A, const Vector& b, Vector& c);
+
+        // Eigenpairs of a symmetric matrix, eigenvalues descending and eigenvectors as columns. k > 0 keeps the k largest.
+        void eig(const Matrix& A, Matrix& eigenvectors, Vector& eigenvalues, int k = 0);
+
+        // Thin SVD A = U diag(S) Vt. rank > 0 keeps only the rank largest singular triplets.
+        void SVD(const Matrix& A, Matrix& U, Vector& S, Matrix& Vt, int rank = 0);
+
+        void randomizedSVD(const Matrix& A, int k, Matrix& U, Vector& S, Matrix& Vt, int oversampling = 10, int powerIterations = 2);
+
+        // CONTIGUOUS VECTOR FUNCTIONS
+        void addition(const Vector& a, const Vector& b, Vector& c);
+
+        void subtraction(const Vector& a, const Vector& b, Vector& c);
+
+        void hadamard_product(const Vector& a, const Vector& b, Vector& c);
+
+        void elementWiseDivision(const Vector& a, const Vector& b, Vector& c);
+
+        void scalarMultiply(double scalar, const Vector& a, Vector& b);
+
+        void scalarAdd(double scalar, const Vector& a, Vector& b);
+
+        void log(const Vector& a, Vector& b);
+
+        void exp(const Vector& a, Vector& b);
+
+        void sqrt(const Vector& a, Vector& b);
+
+        void abs(const Vector& a, Vector& b);
+
+        void max(const Vector& a, const Vector& b, Vector& c);
+
+        void outerProduct(const Vector& a, const Vector& b, Matrix& C);
+
+        double dot(const Vector& a, const Vector& b);
+
+        double norm_2(const Vector& a);
+
+        double sum_elements(const Vector& a);
+
         private:
     };
 
@@ -6,6 +6,7 @@
 
 #include "LinReg.hpp"
 #include "LinAlg/LinAlg.hpp"
+#include "QR/QR.hpp"
 #include "Stat/Stat.hpp"
 #include "Regularization/Reg.hpp"
 #include "Utilities/Utilities.hpp"
@@ -264,8 +265,9 @@ namespace MLPP{
             std::vector<double> error = alg.subtraction(y_hat, outputSet);
 
             std::vector<double> first_derivative = alg.mat_vec_mult(alg.transpose(inputSet), error);
-            std::vector<std::vector<double>> second_derivative = alg.matmult(alg.transpose(inputSet), inputSet);
-            weights = alg.subtraction(weights, alg.scalarMultiply(learning_rate/n, alg.mat_vec_mult(alg.transpose(alg.inverse(second_derivative)), first_derivative)));
+            std::vector<std::vector<double>> second_derivative = alg.transposeMatmult(inputSet, inputSet);
+            // The Hessian X^T X is symmetric positive definite, so H^-1 g comes from a Cholesky solve.
+            weights = alg.subtraction(weights, alg.scalarMultiply(learning_rate/n, alg.cholSolve(second_derivative, first_derivative)));
             weights = regularization.regWeights(weights, lambda, alpha, reg);
             bias -= learning_rate * alg.sum_elements(error) / n;
             forwardPass();
@@ -353,13 +355,14 @@ namespace MLPP{
             for(int j = 0; j < k; ++j)
                 X_aug[i][j + 1] = inputSet[i][j];
         }
-        auto Xt = alg.transpose(X_aug);
-        auto XtX = alg.matmult(Xt, X_aug);
-        std::vector<double> theta = alg.mat_vec_mult(alg.inverse(XtX), alg.mat_vec_mult(Xt, outputSet));
-        if(std::isnan(theta[0])){
+        // Least squares through X = QR rather than the normal equations themselves: X^T X is never formed,
+        // so its squared condition number never enters.
+        QR X_qr(X_aug);
+        if(X_qr.rankDeficient()){
             std::cout << "ERR 99: Resulting matrix was noninvertible/degenerate, and so the normal equation could not be performed. Try utilizing gradient descent." << std::endl;
             return;
         }
+        std::vector<double> theta = X_qr.solve(outputSet);
         bias = theta[0];
         weights.resize(k);
         for(int j = 0; j < k; ++j)
@@ -10,19 +10,29 @@
 #include "Regularization/Reg.hpp"
 #include "Utilities/Utilities.hpp"
 #include "Cost/Cost.hpp"
+#include "GEMM/GEMM.hpp"
+#include "VecMath/VecMath.hpp"
+#include "MiniBatches/MiniBatches.hpp"
 
 #include <iostream>
 #include <random>
 
 namespace MLPP{
     LogReg::LogReg(std::vector<std::vector<double>> inputSet, std::vector<double> outputSet, std::string reg, double lambda, double alpha)
-    : inputSet(inputSet), outputSet(outputSet), n(inputSet.size()), k(inputSet[0].size()), reg(reg), lambda(lambda), alpha(alpha)
+    : inputSet(inputSet), outputSet(outputSet), n(inputSet.size()), k(inputSet[0].size()), shuffle(false), generator(std::random_device()()), reg(reg), lambda(lambda), alpha(alpha)
     {
         y_hat.resize(n);
         weights = Utilities::weightInitialization(k);
         bias = Utilities::biasInitialization();
     }
 
+    LogReg::LogReg(const DataSource& source, std::string reg, double lambda, double alpha)
+    : n(source.size()), k(source.inputs()), shuffle(false), generator(std::random_device()()), reg(reg), lambda(lambda), alpha(alpha)
+    {
+        weights = Utilities::weightInitialization(k);
+        bias = Utilities::biasInitialization();
+    }
+
     std::vector<double> LogReg::modelSetTest(std::vector<std::vector<double>> X){
         return Evaluate(X);
     }
@@ -32,6 +42,7 @@ namespace MLPP{
     }
 
     void LogReg::gradientDescent(double learning_rate, int max_epoch, bool UI){
+        if(!hasTrainingSet()) { return; }
         LinAlg alg;
         Reg regularization; 
         double cost_prev = 0;
@@ -63,6 +74,7 @@ namespace MLPP{
     }
 
     void LogReg::MLE(double learning_rate, int max_epoch, bool UI){
+        if(!hasTrainingSet()) { return; }
         LinAlg alg;
         Reg regularization;
         double cost_prev = 0;
@@ -92,6 +104,7 @@ namespace MLPP{
     }
 
     void LogReg::SGD(double learning_rate, int max_epoch, bool UI){
+        if(!hasTrainingSet()) { return; }
         LinAlg alg;
         Reg regularization;
         double cost_prev = 0;
@@ -128,33 +141,72 @@ namespace MLPP{
         forwardPass();
     }
 
+    Hogwild::Report LogReg::asyncSGD(double learning_rate, int max_epoch, int threads, bool UI){
+        if(!hasTrainingSet()) { return {}; }
+        Activation avn;
+        Reg regularization;
+        forwardPass();
+        double cost_prev = Cost(y_hat, outputSet);
+
+        // The same step as SGD, but only the coordinates where the sample is nonzero are read, written and
+        // regularized, so workers on sparse rows rarely touch the same weights.
+        bool regularize = reg != "None";
+        auto step = [&](int, long, int i){
+            const std::vector<double>& x = inputSet[i];
+            double z = Hogwild::load(bias);
+            for(int j = 0; j < k; j++){
+                if(x[j] != 0){ z += Hogwild::load(weights[j]) * x[j]; }
+            }
+            double error = avn.sigmoid(z) - outputSet[i];
+
+            for(int j = 0; j < k; j++){
+                if(x[j] != 0){
+                    double w = Hogwild::load(weights[j]) - learning_rate * error * x[j];
+                    Hogwild::store(weights[j], regularize ? regularization.regWeight(w, lambda, alpha, reg) : w);
+                }
+            }
+            Hogwild::store(bias, Hogwild::load(bias) - learning_rate * error);
+        };
+        Hogwild::Report report = Hogwild::run(threads, max_epoch, n, step);
+
+        forwardPass();
+        report.costBefore = cost_prev;
+        report.costAfter = Cost(y_hat, outputSet);
+        if(UI) { Hogwild::UI(report); }
+        return report;
+    }
+
     void LogReg::MBGD(double learning_rate, int max_epoch, int mini_batch_size, bool UI){
-        LinAlg alg;
+        if(!hasTrainingSet()) { return; }
         Reg regularization;
         double cost_prev = 0;
         int epoch = 1;
 
-        // Creating the mini-batches
-        int n_mini_batch = n/mini_batch_size;
-        auto [inputMiniBatches, outputMiniBatches] = Utilities::createMiniBatches(inputSet, outputSet, n_mini_batch);
+        MiniBatches batches(n, n/mini_batch_size);
+        std::vector<double> gradient(k), batch_y_hat, batch_y;
         
         while(true){
-            for(int i = 0; i < n_mini_batch; i++){
-                std::vector<double> y_hat = Evaluate(inputMiniBatches[i]);
-                cost_prev = Cost(y_hat, outputMiniBatches[i]);
-                
-                std::vector<double> error = alg.subtraction(y_hat, outputMiniBatches[i]);
+            if(shuffle) { batches.shuffle(generator); }
+            for(int i = 0; i < batches.size(); i++){
+                int rows = batches.rows(i);
+                double errorSum = batchGradient(batches.indices(i), rows, gradient, batch_y_hat);
+                if(UI) {
+                    MiniBatches::gather(outputSet, batches.indices(i), rows, batch_y);
+                    cost_prev = Cost(batch_y_hat, batch_y);
+                }
 
                 // Calculating the weight gradients
-                weights = alg.subtraction(weights, alg.scalarMultiply(learning_rate/outputMiniBatches[i].size(), alg.mat_vec_mult(alg.transpose(inputMiniBatches[i]), error)));
+                for(int j = 0; j < k; j++){
+                    weights[j] -= learning_rate/rows * gradient[j];
+                }
                 weights = regularization.regWeights(weights, lambda, alpha, reg);
     
                 // Calculating the bias gradients
-                bias -= learning_rate * alg.sum_elements(error) / outputMiniBatches[i].size();
-                y_hat = Evaluate(inputMiniBatches[i]);
+                bias -= learning_rate * errorSum / rows;
                     
                 if(UI) { 
-                    Utilities::CostInfo(epoch, cost_prev, Cost(y_hat, outputMiniBatches[i]));
+                    batchGradient(batches.indices(i), rows, gradient, batch_y_hat);
+                    Utilities::CostInfo(epoch, cost_prev, Cost(batch_y_hat, batch_y));
                     Utilities::UI(weights, bias); 
                 }
             }
@@ -164,11 +216,110 @@ namespace MLPP{
         forwardPass(); 
     }
 
+    void LogReg::train(Optimizer& optimizer, double learning_rate, int max_epoch, int mini_batch_size, bool UI){
+        if(!hasTrainingSet()) { return; }
+        Reg regularization;
+        double cost_prev = 0;
+        int epoch = 1;
+
+        MiniBatches batches(n, n/mini_batch_size);
+        std::vector<double> gradient(k), batch_y_hat, batch_y;
+        optimizer.reset({k, 1});
+
+        while(true){
+            if(shuffle) { batches.shuffle(generator); }
+            for(int i = 0; i < batches.size(); i++){
+                int rows = batches.rows(i);
+                double biasGradient = batchGradient(batches.indices(i), rows, gradient, batch_y_hat) / rows;
+                if(UI) {
+                    MiniBatches::gather(outputSet, batches.indices(i), rows, batch_y);
+                    cost_prev = Cost(batch_y_hat, batch_y);
+                }
+
+                // Calculating the gradients
+                for(int j = 0; j < k; j++){
+                    gradient[j] *= 1.0/rows;
+                }
+                regularization.addRegDerivTerm(weights.data(), gradient.data(), k, lambda, alpha, reg);
+
+                optimizer.beginStep(epoch);
+                optimizer.update(0, weights.data(), gradient.data(), k, learning_rate);
+                optimizer.update(1, &bias, &biasGradient, 1, learning_rate);
+
+                if(UI) { 
+                    batchGradient(batches.indices(i), rows, gradient, batch_y_hat);
+                    Utilities::CostInfo(epoch, cost_prev, Cost(batch_y_hat, batch_y));
+                    Utilities::UI(weights, bias); 
+                }
+            }
+            epoch++;
+            if(epoch > max_epoch) { break; }
+        }
+        forwardPass(); 
+    }
+
+    void LogReg::train(BatchStream& batches, Optimizer& optimizer, double learning_rate, int max_epoch, bool UI){
+        if(batches.source().inputs() != k || batches.source().outputs() != 1){
+            std::cout << "The stream's samples do not match the model's " << k << " inputs and 1 output." << std::endl;
+            return;
+        }
+        Reg regularization;
+        std::vector<double> batch_y_hat, error, gradient(k);
+        optimizer.reset({k, 1});
+
+        // sigmoid(Xw + b) for the rows of a batch.
+        auto evaluate = [&](const BatchStream::Batch& batch){
+            int rows = batch.rows();
+            batch_y_hat.resize(rows);
+            GEMM::gemm(false, false, rows, 1, k, 1, batch.inputs.data(), batch.inputs.stride(), weights.data(), 1, 0, batch_y_hat.data(), 1);
+            VecMath::shift(bias, batch_y_hat.data(), batch_y_hat.data(), rows);
+            VecMath::sigmoid(batch_y_hat.data(), batch_y_hat.data(), rows);
+        };
+        auto batchCost = [&](const BatchStream::Batch& batch){
+            const double* y = batch.outputs.data();
+            return Cost(batch_y_hat, std::vector<double>(y, y + batch.rows()));
+        };
+
+        for(int epoch = optimizer.step() + 1; epoch <= max_epoch; epoch++){
+            while(const BatchStream::Batch* batch = batches.next()){
+                int rows = batch->rows();
+                evaluate(*batch);
+                double cost_prev = UI ? batchCost(*batch) : 0;
+
+                error.resize(rows);
+                const double* y = batch->outputs.data();
+                double biasGradient = 0;
+                for(int i = 0; i < rows; i++){
+                    error[i] = batch_y_hat[i] - y[i];
+                    biasGradient += error[i] / rows;
+                }
+                GEMM::gemm(true, false, k, 1, rows, 1.0/rows, batch->inputs.data(), batch->inputs.stride(), error.data(), 1, 0, gradient.data(), 1);
+                regularization.addRegDerivTerm(weights.data(), gradient.data(), k, lambda, alpha, reg);
+
+                optimizer.beginStep(epoch);
+                optimizer.update(0, weights.data(), gradient.data(), k, learning_rate);
+                optimizer.update(1, &bias, &biasGradient, 1, learning_rate);
+
+                if(UI) {
+                    evaluate(*batch);
+                    Utilities::CostInfo(epoch, cost_prev, batchCost(*batch));
+                    Utilities::UI(weights, bias);
+                }
+            }
+        }
+        if(!inputSet.empty()){ forwardPass(); }
+        if(UI) { BatchStream::UI(batches.timing()); }
+    }
+
     double LogReg::score(){
         Utilities util;
         return util.performance(y_hat, outputSet);
     }
 
+    void LogReg::setShuffle(bool shuffle){
+        LogReg::shuffle = shuffle;
+    }
+
     void LogReg::save(std::string fileName){
          Utilities util;
          util.saveParameters(fileName, weights, bias);
@@ -193,7 +344,42 @@ namespace MLPP{
         return avn.sigmoid(alg.dot(weights, x) + bias);
     }
 
+    // Computed as Evaluate() and the transposed product would be, sample by sample in the same order.
+    double LogReg::batchGradient(const int* indices, int rows, std::vector<double>& gradient, std::vector<double>& batch_y_hat) const{
+        batch_y_hat.resize(rows);
+        for(int r = 0; r < rows; r++){
+            const double* x = inputSet[indices[r]].data();
+            double sum = 0;
+            for(int j = 0; j < k; j++){
+                sum += x[j] * weights[j];
+            }
+            batch_y_hat[r] = sum;
+        }
+        VecMath::shift(bias, batch_y_hat.data(), batch_y_hat.data(), rows);
+        VecMath::sigmoid(batch_y_hat.data(), batch_y_hat.data(), rows);
+
+        std::fill(gradient.begin(), gradient.end(), 0);
+        double errorSum = 0;
+        for(int r = 0; r < rows; r++){
+            const double* x = inputSet[indices[r]].data();
+            double error = batch_y_hat[r] - outputSet[indices[r]];
+            for(int j = 0; j < k; j++){
+                gradient[j] += x[j] * error;
+            }
+            errorSum += error;
+        }
+        return errorSum;
+    }
+
     // sigmoid ( wTx + b )
+    bool LogReg::hasTrainingSet() const{
+        if(inputSet.empty()){
+            std::cout << "This model has no training set in memory; train it on a BatchStream." << std::endl;
+            return false;
+        }
+        return true;
+    }
+
     void LogReg::forwardPass(){
         y_hat = Evaluate(inputSet); 
     }
@@ -7,9 +7,14 @@
 #ifndef LogReg_hpp
 #define LogReg_hpp
 
+#include "Hogwild/Hogwild.hpp"
+#include "Optimizer/Optimizer.hpp"
+#include "DataSource/DataSource.hpp"
+
 
 #include <vector>
 #include <string>
+#include <random>
 
 namespace MLPP {
 
@@ -17,14 +22,29 @@ namespace MLPP {
         
         public:
             LogReg(std::vector<std::vector<double>> inputSet, std::vector<double> outputSet, std::string reg = "None", double lambda = 0.5, double alpha = 0.5);
+            // A model for samples streamed from source, without a copy of the training set in memory. It trains with the
+            // BatchStream overload of train(); the other trainers report an error and return, and score() has nothing to
+            // evaluate.
+            explicit LogReg(const DataSource& source, std::string reg = "None", double lambda = 0.5, double alpha = 0.5);
             std::vector<double> modelSetTest(std::vector<std::vector<double>> X);
             double modelTest(std::vector<double> x);
             void gradientDescent(double learning_rate, int max_epoch, bool UI = 1);
             void MLE(double learning_rate, int max_epoch, bool UI = 1);
             void SGD(double learning_rate, int max_epoch, bool UI = 1);
+            // Lock-free asynchronous SGD, max_epoch steps over the given number of threads. See Hogwild.
+            Hogwild::Report asyncSGD(double learning_rate, int max_epoch, int threads, bool UI = 1);
             void MBGD(double learning_rate, int max_epoch, int mini_batch_size, bool UI = 1);
+            // Mini-batch training with any optimizer. The weights are its parameter block 0 and the bias block 1, and
+            // the regularization term is part of the gradient.
+            void train(Optimizer& optimizer, double learning_rate, int max_epoch, int mini_batch_size, bool UI = 1);
+            // The same, on the batches of a stream, one pass of which is an epoch. As in ANN, an optimizer that kept
+            // restored state through its reset carries on from its saved step. UI ends with the stream's Timing.
+            void train(BatchStream& batches, Optimizer& optimizer, double learning_rate, int max_epoch, bool UI = 1);
             double score();
             void save(std::string fileName);
+
+            // Reshuffles the training set before every epoch of MBGD() and train(). Off by default.
+            void setShuffle(bool shuffle);
             
             /* add for test*/
             const std::vector<double>& getWeights() const { return weights; }
@@ -37,6 +57,12 @@ namespace MLPP {
             std::vector<double> Evaluate(std::vector<std::vector<double>> X);
             double Evaluate(std::vector<double> x);
             void forwardPass();
+            // False, after reporting it, for a model built on a DataSource, which has no training set in memory.
+            bool hasTrainingSet() const;
+
+            // Sums the weight gradient of the listed samples, read in place, into gradient and returns the sum of their
+            // errors, which is the summed bias gradient. The predictions for them are left in batch_y_hat.
+            double batchGradient(const int* indices, int rows, std::vector<double>& gradient, std::vector<double>& batch_y_hat) const;
         
             std::vector<std::vector<double>> inputSet;
             std::vector<double> outputSet;
@@ -48,6 +74,9 @@ namespace MLPP {
             int k;
             double learning_rate;
 
+            bool shuffle;
+            std::default_random_engine generator;
+
             // Regularization Params
             std::string reg;
             double lambda; /* Regularization Parameter */
@@ -10,12 +10,15 @@
 #include "Regularization/Reg.hpp"
 #include "Utilities/Utilities.hpp"
 #include "Cost/Cost.hpp"
+#include "Checkpoint/Checkpoint.hpp"
+#include "ThreadPool/ThreadPool.hpp"
 
 #include <iostream>
+#include <algorithm>
 
 namespace MLPP {
     MANN::MANN(std::vector<std::vector<double>> inputSet, std::vector<std::vector<double>> outputSet)
-    : inputSet(inputSet), outputSet(outputSet), n(inputSet.size()), k(inputSet[0].size()), n_output(outputSet[0].size())
+    : inputSet(inputSet), outputSet(outputSet), outputLayer(nullptr), n(inputSet.size()), k(inputSet[0].size()), n_output(outputSet[0].size()), threads(1)
     {
 
     }
@@ -56,71 +59,152 @@ namespace MLPP {
         return outputLayer->a_test;
     }
 
-    void MANN::gradientDescent(double learning_rate, int max_epoch, bool UI){
-        class Cost cost; 
-        Activation avn;
-        LinAlg alg;
-        Reg regularization;
+    InferenceModel MANN::compile(std::string precision) const{
+        InferenceModel model(precision);
+        for(const auto& layer : network){
+            model.addLayer(layer.weights, layer.bias, layer.activationFunction);
+        }
+        if(outputLayer){
+            model.addLayer(outputLayer->weights, outputLayer->bias, outputLayer->activationFunction);
+        }
+        if(precision == "Int8"){
+            model.calibrate(inputSet);
+        }
+        return model;
+    }
 
+    void MANN::gradientDescent(double learning_rate, int max_epoch, bool UI){
         double cost_prev = 0;
         int epoch = 1;
         forwardPass();
 
+        std::vector<ShardGradient> gradients;
+
         while(true){
-            cost_prev = Cost(y_hat, outputSet);
- 
-            if(outputLayer->activation == "Softmax"){
-                outputLayer->delta = alg.subtraction(y_hat, outputSet);
-            }
-            else{
-                auto costDeriv = outputLayer->costDeriv_map[outputLayer->cost];
-                auto outputAvn = outputLayer->activation_map[outputLayer->activation];
-                outputLayer->delta = alg.hadamard_product((cost.*costDeriv)(y_hat, outputSet), (avn.*outputAvn)(outputLayer->z, 1));
-            }
+            if(UI) { cost_prev = Cost(y_hat, outputSet); }
 
-            std::vector<std::vector<double>> outputWGrad = alg.matmult(alg.transpose(outputLayer->input), outputLayer->delta);
-
-            outputLayer->weights = alg.subtraction(outputLayer->weights, alg.scalarMultiply(learning_rate/n, outputWGrad));
-            outputLayer->weights = regularization.regWeights(outputLayer->weights, outputLayer->lambda, outputLayer->alpha, outputLayer->reg);
-            outputLayer->bias = alg.subtractMatrixRows(outputLayer->bias, alg.scalarMultiply(learning_rate/n, outputLayer->delta));
-
-            if(!network.empty()){
-                auto hiddenLayerAvn = network[network.size() - 1].activation_map[network[network.size() - 1].activation];
-                network[network.size() - 1].delta = alg.hadamard_product(alg.matmult(outputLayer->delta, alg.transpose(outputLayer->weights)), (avn.*hiddenLayerAvn)(network[network.size() - 1].z, 1));
-                std::vector<std::vector<double>> hiddenLayerWGrad = alg.matmult(alg.transpose(network[network.size() - 1].input), network[network.size() - 1].delta);
-                
-                network[network.size() - 1].weights = alg.subtraction(network[network.size() - 1].weights, alg.scalarMultiply(learning_rate/n, hiddenLayerWGrad));
-                network[network.size() - 1].weights = regularization.regWeights(network[network.size() - 1].weights, network[network.size() - 1].lambda, network[network.size() - 1].alpha, network[network.size() - 1].reg);
-                network[network.size() - 1].bias = alg.subtractMatrixRows(network[network.size() - 1].bias, alg.scalarMultiply(learning_rate/n, network[network.size() - 1].delta));
-
-                for(int i = network.size() - 2; i >= 0; i--){
-                    auto hiddenLayerAvn = network[i].activation_map[network[i].activation];
-                    network[i].delta = alg.hadamard_product(alg.matmult(network[i + 1].delta, network[i + 1].weights), (avn.*hiddenLayerAvn)(network[i].z, 1));
-                    std::vector<std::vector<double>> hiddenLayerWGrad = alg.matmult(alg.transpose(network[i].input), network[i].delta);
-                    network[i].weights = alg.subtraction(network[i].weights, alg.scalarMultiply(learning_rate/n, hiddenLayerWGrad));
-                    network[i].weights = regularization.regWeights(network[i].weights, network[i].lambda, network[i].alpha, network[i].reg);
-                    network[i].bias = alg.subtractMatrixRows(network[i].bias, alg.scalarMultiply(learning_rate/n, network[i].delta));
-                }
-            }
-            
-            forwardPass();
+            step(inputSet, outputSet, learning_rate, gradients);
 
             if(UI) { 
-                Utilities::CostInfo(epoch, cost_prev, Cost(y_hat, outputSet));
-                std::cout << "Layer " << network.size() + 1 << ": " << std::endl;
-                Utilities::UI(outputLayer->weights, outputLayer->bias); 
-                if(!network.empty()){
-                    std::cout << "Layer " << network.size() << ": " << std::endl; 
-                    for(int i = network.size() - 1; i >= 0; i--){
-                        std::cout << "Layer " << i + 1 << ": " << std::endl;
-                        Utilities::UI(network[i].weights, network[i].bias); 
-                    }
-                }
+                forwardPass();
+                layerUI(epoch, cost_prev, Cost(y_hat, outputSet));
             }
 
             epoch++;
             if(epoch > max_epoch) { break; }
         }
+        forwardPass();
+    }
+
+    void MANN::MBGD(BatchStream& batches, double learning_rate, int max_epoch, bool UI){
+        if(batches.source().inputs() != k || batches.source().outputs() != n_output){
+            std::cout << "The stream's samples do not match the network's " << k << " inputs and " << n_output << " outputs." << std::endl;
+            return;
+        }
+        std::vector<ShardGradient> gradients;
+        for(int epoch = 1; epoch <= max_epoch; epoch++){
+            while(const BatchStream::Batch* batch = batches.next()){
+                std::vector<std::vector<double>> X = batch->inputs.toStdVector();
+                std::vector<std::vector<double>> Y = batch->outputs.toStdVector();
+                double cost_prev = UI ? Cost(modelSetTest(X), Y) : 0;
+
+                step(X, Y, learning_rate, gradients);
+
+                if(UI) { layerUI(epoch, cost_prev, Cost(modelSetTest(X), Y)); }
+            }
+        }
+        forwardPass();
+        if(UI) { BatchStream::UI(batches.timing()); }
+    }
+
+    void MANN::step(const std::vector<std::vector<double>>& X, const std::vector<std::vector<double>>& Y, double learning_rate, std::vector<ShardGradient>& gradients){
+        LinAlg alg;
+        Reg regularization;
+
+        int rows = X.size();
+        int shards = std::min(threads, rows);
+        gradients.resize(std::max<int>(gradients.size(), shards));
+
+        ThreadPool::parallelFor(shards, 1, [&](long first, long last){
+            for(long s = first; s < last; s++){
+                computeGradients(X, Y, s * rows / shards, (s + 1) * rows / shards, gradients[s]);
+            }
+        });
+
+        // Summed in a fixed order, independent of which worker ran which shard.
+        ShardGradient& gradient = gradients[0];
+        for(int s = 1; s < shards; s++){
+            for(int l = 0; l <= network.size(); l++){
+                gradient.weights[l] = alg.addition(gradient.weights[l], gradients[s].weights[l]);
+                gradient.bias[l] = alg.addition(gradient.bias[l], gradients[s].bias[l]);
+            }
+        }
+
+        outputLayer->weights = alg.subtraction(outputLayer->weights, alg.scalarMultiply(learning_rate/rows, gradient.weights[network.size()]));
+        outputLayer->weights = regularization.regWeights(outputLayer->weights, outputLayer->lambda, outputLayer->alpha, outputLayer->reg);
+        outputLayer->bias = alg.subtraction(outputLayer->bias, alg.scalarMultiply(learning_rate/rows, gradient.bias[network.size()]));
+
+        for(int i = network.size() - 1; i >= 0; i--){
+            network[i].weights = alg.subtraction(network[i].weights, alg.scalarMultiply(learning_rate/rows, gradient.weights[i]));
+            network[i].weights = regularization.regWeights(network[i].weights, network[i].lambda, network[i].alpha, network[i].reg);
+            network[i].bias = alg.subtraction(network[i].bias, alg.scalarMultiply(learning_rate/rows, gradient.bias[i]));
+        }
+    }
+
+    void MANN::layerUI(int epoch, double cost_prev, double cost){
+        Utilities::CostInfo(epoch, cost_prev, cost);
+        std::cout << "Layer " << network.size() + 1 << ": " << std::endl;
+        Utilities::UI(outputLayer->weights, outputLayer->bias); 
+        if(!network.empty()){
+            std::cout << "Layer " << network.size() << ": " << std::endl; 
+            for(int i = network.size() - 1; i >= 0; i--){
+                std::cout << "Layer " << i + 1 << ": " << std::endl;
+                Utilities::UI(network[i].weights, network[i].bias); 
+            }
+        }
+    }
+
+    // Forward and backward pass over rows [begin, end) on local copies, leaving the layers untouched.
+    void MANN::computeGradients(const std::vector<std::vector<double>>& X, const std::vector<std::vector<double>>& Y, int begin, int end, ShardGradient& gradient) const{
+        class Cost cost;
+        Activation avn;
+        LinAlg alg;
+
+        std::vector<std::vector<double>> outputs(Y.begin() + begin, Y.begin() + end);
+        std::vector<std::vector<std::vector<double>>> input(network.size() + 1);
+        std::vector<std::vector<std::vector<double>>> z(network.size());
+        input[0].assign(X.begin() + begin, X.begin() + end);
+        for(int i = 0; i < network.size(); i++){
+            z[i] = alg.mat_vec_add(alg.matmult(input[i], network[i].weights), network[i].bias);
+            input[i + 1] = avn.apply(network[i].activationFunction, z[i], 0);
+        }
+
+        std::vector<std::vector<double>> outputZ = alg.mat_vec_add(alg.matmult(input[network.size()], outputLayer->weights), outputLayer->bias);
+        std::vector<std::vector<double>> delta;
+        if(outputLayer->activation == "Softmax"){
+            delta = alg.subtraction(avn.apply(outputLayer->activationFunction, outputZ, 0), outputs);
+        }
+        else{
+            delta = alg.hadamard_product(cost.derivative(outputLayer->costFunction, avn.apply(outputLayer->activationFunction, outputZ, 0), outputs), avn.apply(outputLayer->activationFunction, outputZ, 1));
+        }
+
+        gradient.weights.resize(network.size() + 1);
+        gradient.bias.resize(network.size() + 1);
+        for(int l = network.size(); l >= 0; l--){
+            if(l < network.size()){
+                const std::vector<std::vector<double>>& nextWeights = l + 1 < network.size() ? network[l + 1].weights : outputLayer->weights;
+                delta = alg.hadamard_product(alg.matmultTranspose(delta, nextWeights), avn.apply(network[l].activationFunction, z[l], 1));
+            }
+            gradient.weights[l] = alg.transposeMatmult(input[l], delta);
+            gradient.bias[l].assign(delta[0].size(), 0);
+            for(int i = 0; i < delta.size(); i++){
+                gradient.bias[l] = alg.addition(gradient.bias[l], delta[i]);
+            }
+        }
+    }
+
+    void MANN::setThreads(int threads){
+        MANN::threads = std::max(threads, 1);
     }
 
     double MANN::score(){
@@ -143,6 +227,56 @@ namespace MLPP {
         }
      }
 
+    void MANN::saveCheckpoint(std::string fileName){
+        Checkpoint::Writer writer("MANN");
+        writer.add("layers", (double)network.size());
+        for(int i = 0; i < network.size(); i++){
+            network[i].save(writer, "layer" + std::to_string(i));
+        }
+        if(outputLayer){
+            outputLayer->save(writer, "output");
+        }
+        writer.write(fileName);
+    }
+
+    bool MANN::loadCheckpoint(std::string fileName){
+        Checkpoint checkpoint(fileName);
+        if(!checkpoint.valid()){ return false; }
+        if(checkpoint.kind() != "MANN" || !checkpoint.has("output.weights")){
+            std::cout << fileName << " is not a MANN checkpoint." << std::endl;
+            return false;
+        }
+        int layers = checkpoint.scalar("layers");
+        // Every shape is checked before anything is copied, so a failed load leaves the network as it was.
+        bool built = network.empty() && !outputLayer;
+        if(built){
+            for(int i = 0; i < layers; i++){
+                std::string prefix = "layer" + std::to_string(i);
+                addLayer(checkpoint.scalar(prefix + ".units"), checkpoint.text(prefix + ".activation"), checkpoint.text(prefix + ".weightInit"), checkpoint.text(prefix + ".reg"), checkpoint.scalar(prefix + ".lambda"), checkpoint.scalar(prefix + ".alpha"));
+            }
+            addOutputLayer(checkpoint.text("output.activation"), checkpoint.text("output.cost"), checkpoint.text("output.weightInit"), checkpoint.text("output.reg"), checkpoint.scalar("output.lambda"), checkpoint.scalar("output.alpha"));
+        }
+        bool matches = outputLayer && layers == network.size();
+        for(int i = 0; matches && i < layers; i++){
+            matches = network[i].fits(checkpoint, "layer" + std::to_string(i));
+        }
+        if(!matches || !outputLayer->fits(checkpoint, "output")){
+            std::cout << "The architecture in " << fileName << " does not match this network." << std::endl;
+            if(built){
+                network.clear();
+                delete outputLayer;
+                outputLayer = nullptr;
+            }
+            return false;
+        }
+        for(int i = 0; i < layers; i++){
+            network[i].load(checkpoint, "layer" + std::to_string(i));
+        }
+        outputLayer->load(checkpoint, "output");
+        forwardPass();
+        return true;
+    }
+
     void MANN::addLayer(int n_hidden, std::string activation, std::string weightInit, std::string reg, double lambda, double alpha){
         if(network.empty()){
             network.push_back(HiddenLayer(n_hidden, activation, inputSet, weightInit, reg, lambda, alpha));
@@ -156,7 +290,7 @@ namespace MLPP {
     
     void MANN::addOutputLayer(std::string activation, std::string loss, std::string weightInit, std::string reg, double lambda, double alpha){
         if(!network.empty()){
-            outputLayer = new MultiOutputLayer(n_output, network[0].n_hidden, activation, loss, network[network.size() - 1].a, weightInit, reg, lambda, alpha);
+            outputLayer = new MultiOutputLayer(n_output, network[network.size() - 1].n_hidden, activation, loss, network[network.size() - 1].a, weightInit, reg, lambda, alpha);
         }
         else{
             outputLayer = new MultiOutputLayer(n_output, k, activation, loss, inputSet, weightInit, reg, lambda, alpha);
@@ -168,13 +302,12 @@ namespace MLPP {
         class Cost cost;
         double totalRegTerm = 0;
 
-        auto cost_function = outputLayer->cost_map[outputLayer->cost];
         if(!network.empty()){
             for(int i = 0; i < network.size() - 1; i++){
                 totalRegTerm += regularization.regTerm(network[i].weights, network[i].lambda, network[i].alpha, network[i].reg);
             }
         }
-        return (cost.*cost_function)(y_hat, y) + totalRegTerm + regularization.regTerm(outputLayer->weights, outputLayer->lambda, outputLayer->alpha, outputLayer->reg);
+        return cost.evaluate(outputLayer->costFunction, y_hat, y) + totalRegTerm + regularization.regTerm(outputLayer->weights, outputLayer->lambda, outputLayer->alpha, outputLayer->reg);
     }
 
     void MANN::forwardPass(){
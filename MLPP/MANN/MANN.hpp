@@ -9,6 +9,8 @@
 
 #include "HiddenLayer/HiddenLayer.hpp"
 #include "MultiOutputLayer/MultiOutputLayer.hpp"
+#include "InferenceModel/InferenceModel.hpp"
+#include "DataSource/DataSource.hpp"
 
 #include <vector>
 #include <string>
@@ -21,10 +23,27 @@ class MANN{
         ~MANN();
         std::vector<std::vector<double>> modelSetTest(std::vector<std::vector<double>> X);
         std::vector<double> modelTest(std::vector<double> x);
+        // Frozen copy of the current weights for concurrent, allocation-free prediction; see InferenceModel. An "Int8"
+        // model is calibrated on the training inputs.
+        InferenceModel compile(std::string precision = "Double") const;
         void gradientDescent(double learning_rate, int max_epoch, bool UI = 1);
+        // Mini-batch gradient descent on the batches of a stream, one pass of which is an epoch. For a training set in
+        // memory, a shuffled MemorySource over it has the next batch gathered while the network trains on the current
+        // one. Each batch is still converted to nested vectors on the training thread, so that copy shows up in the
+        // Timing as compute rather than preparation. UI ends with the stream's Timing.
+        void MBGD(BatchStream& batches, double learning_rate, int max_epoch, bool UI = 1);
         double score(); 
         void save(std::string fileName);
 
+        // Binary checkpoint of the architecture and parameters; see Checkpoint. A model without layers takes the saved
+        // architecture on load, one with layers must match it.
+        void saveCheckpoint(std::string fileName);
+        bool loadCheckpoint(std::string fileName);
+
+        // Splits the training set into this many row shards whose gradients are computed concurrently on the
+        // ThreadPool and summed in shard order, so a given count always trains to the same weights. Defaults to 1.
+        void setThreads(int threads);
+
         void addLayer(int n_hidden, std::string activation, std::string weightInit = "Default", std::string reg = "None", double lambda = 0.5, double alpha = 0.5); 
         void addOutputLayer(std::string activation, std::string loss, std::string weightInit = "Default", std::string reg = "None", double lambda = 0.5, double alpha = 0.5); 
         
@@ -32,6 +51,16 @@ class MANN{
             double Cost(std::vector<std::vector<double>> y_hat, std::vector<std::vector<double>> y);
             void forwardPass();
 
+            // Weight gradient and column sums of the deltas of every layer over one shard, the output layer last.
+            struct ShardGradient{
+                std::vector<std::vector<std::vector<double>>> weights;
+                std::vector<std::vector<double>> bias;
+            };
+            void computeGradients(const std::vector<std::vector<double>>& X, const std::vector<std::vector<double>>& Y, int begin, int end, ShardGradient& gradient) const;
+            // One gradient step on the samples X, Y, scaled by their count.
+            void step(const std::vector<std::vector<double>>& X, const std::vector<std::vector<double>>& Y, double learning_rate, std::vector<ShardGradient>& gradients);
+            void layerUI(int epoch, double cost_prev, double cost);
+
             std::vector<std::vector<double>> inputSet;
             std::vector<std::vector<double>> outputSet;
             std::vector<std::vector<double>> y_hat;
@@ -42,6 +71,8 @@ class MANN{
             int n;
             int k;
             int n_output;
+
+            int threads;
     };
 }
 
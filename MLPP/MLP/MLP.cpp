@@ -35,6 +35,20 @@ namespace MLPP {
         return Evaluate(x);
     }
 
+    InferenceModel MLP::compile(std::string precision) const{
+        InferenceModel model(precision);
+        model.addLayer(weights1, bias1, Activation::Function::Sigmoid);
+        std::vector<std::vector<double>> output(weights2.size());
+        for(int i = 0; i < output.size(); i++){
+            output[i] = {weights2[i]};
+        }
+        model.addLayer(output, {bias2}, Activation::Function::Sigmoid);
+        if(precision == "Int8"){
+            model.calibrate(inputSet);
+        }
+        return model;
+    }
+
     void MLP::gradientDescent(double learning_rate, int max_epoch, bool UI){
         Activation avn;
         LinAlg alg;
@@ -68,7 +82,7 @@ namespace MLPP {
 
             std::vector<std::vector<double>> D1_2 = alg.hadamard_product(D1_1, avn.sigmoid(z2, 1));
 
-            std::vector<std::vector<double>> D1_3 = alg.matmult(alg.transpose(inputSet), D1_2);
+            std::vector<std::vector<double>> D1_3 = alg.transposeMatmult(inputSet, D1_2);
 
 
             // weight an bias updation for layer 1
@@ -186,7 +200,7 @@ namespace MLPP {
 
                 std::vector<std::vector<double>> D1_2 = alg.hadamard_product(D1_1, avn.sigmoid(z2, 1));
 
-                std::vector<std::vector<double>> D1_3 = alg.matmult(alg.transpose(inputMiniBatches[i]), D1_2);
+                std::vector<std::vector<double>> D1_3 = alg.transposeMatmult(inputMiniBatches[i], D1_2);
 
 
                 // weight an bias updation for layer 1
@@ -7,6 +7,8 @@
 #ifndef MLP_hpp
 #define MLP_hpp
 
+#include "InferenceModel/InferenceModel.hpp"
+
 #include <vector>
 #include <map>
 #include <string>
@@ -24,6 +26,10 @@ class MLP{
         double score(); 
         void save(std::string fileName);
         
+        // Frozen copy of the current weights for concurrent, allocation-free prediction; see InferenceModel. An "Int8"
+        // model is calibrated on the training inputs.
+        InferenceModel compile(std::string precision = "Double") const;
+        
         private:
             double Cost(std::vector <double> y_hat, std::vector<double> y);
 
@@ -0,0 +1,102 @@
+//
+//  Matrix.cpp
+//
+//  Contiguous row-major storage used by the LinAlg kernels.
+//
+
+#include "Matrix.hpp"
+#include <algorithm>
+
+namespace MLPP{
+    template <class T>
+    BasicMatrix<T>::BasicMatrix()
+    : n_rows(0), n_cols(0), ld(0)
+    {
+
+    }
+
+    template <class T>
+    BasicMatrix<T>::BasicMatrix(int rows, int cols, T value)
+    : n_rows(rows), n_cols(cols), ld(cols), buffer((long)rows * cols, value)
+    {
+
+    }
+
+    template <class T>
+    BasicMatrix<T>::BasicMatrix(int rows, int cols, int stride, T value)
+    : n_rows(rows), n_cols(cols), ld(std::max(stride, cols)), buffer((long)rows * std::max(stride, cols), value)
+    {
+
+    }
+
+    template <class T>
+    BasicMatrix<T>::BasicMatrix(const std::vector<std::vector<double>>& A)
+    : n_rows(A.size()), n_cols(A.empty() ? 0 : A[0].size()), ld(n_cols)
+    {
+        buffer.resize((long)n_rows * n_cols);
+        for(int i = 0; i < n_rows; i++){
+            std::copy(A[i].begin(), A[i].begin() + n_cols, row(i));
+        }
+    }
+
+    template <class T>
+    void BasicMatrix<T>::resize(int rows, int cols){
+        if(rows == n_rows && cols == n_cols){ return; }
+        n_rows = rows;
+        n_cols = cols;
+        ld = cols;
+        if(buffer.size() < (size_t)rows * cols){
+            buffer.resize((long)rows * cols);
+        }
+    }
+
+    template <class T>
+    void BasicMatrix<T>::fill(T value){
+        for(int i = 0; i < n_rows; i++){
+            std::fill(row(i), row(i) + n_cols, value);
+        }
+    }
+
+    template <class T>
+    std::vector<std::vector<double>> BasicMatrix<T>::toStdVector() const{
+        std::vector<std::vector<double>> A(n_rows);
+        for(int i = 0; i < n_rows; i++){
+            A[i].assign(row(i), row(i) + n_cols);
+        }
+        return A;
+    }
+
+    template class BasicMatrix<double>;
+    template class BasicMatrix<float>;
+
+    Vector::Vector()
+    {
+
+    }
+
+    Vector::Vector(int n, double value)
+    : buffer(n, value)
+    {
+
+    }
+
+    Vector::Vector(const std::vector<double>& a)
+    : buffer(a)
+    {
+
+    }
+
+    Vector::Vector(std::vector<double>&& a)
+    : buffer(std::move(a))
+    {
+
+    }
+
+    void Vector::resize(int n){
+        buffer.resize(n);
+    }
+
+    void Vector::fill(double value){
+        std::fill(buffer.begin(), buffer.end(), value);
+    }
+}
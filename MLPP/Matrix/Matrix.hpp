@@ -0,0 +1,97 @@
+//
+//  Matrix.hpp
+//
+//  Contiguous row-major storage used by the LinAlg kernels.
+//
+
+#ifndef Matrix_hpp
+#define Matrix_hpp
+
+#include <vector>
+#include <utility>
+
+namespace MLPP{
+    // A dense row-major matrix held in a single buffer. Element (i, j) lives at data()[i * stride() + j].
+    // The stride may exceed cols() so that rows can be padded; the padding is never read by LinAlg.
+    // T is double, or float for single precision compute; conversions to and from nested vectors always go through double.
+    template <class T>
+    class BasicMatrix{
+        public:
+            BasicMatrix();
+            BasicMatrix(int rows, int cols, T value = 0);
+            BasicMatrix(int rows, int cols, int stride, T value);
+            explicit BasicMatrix(const std::vector<std::vector<double>>& A);
+
+            // Reshapes the matrix with a packed stride, keeping the allocation whenever it is already large enough. A
+            // matrix that already has the shape is left as it is, padded stride included.
+            void resize(int rows, int cols);
+            void fill(T value);
+
+            std::vector<std::vector<double>> toStdVector() const;
+
+            int rows() const { return n_rows; }
+            int cols() const { return n_cols; }
+            int stride() const { return ld; }
+            int size() const { return n_rows * n_cols; }
+            bool empty() const { return n_rows == 0 || n_cols == 0; }
+            bool contiguous() const { return ld == n_cols; }
+
+            T* data() { return buffer.data(); }
+            const T* data() const { return buffer.data(); }
+            T* row(int i) { return buffer.data() + (long)i * ld; }
+            const T* row(int i) const { return buffer.data() + (long)i * ld; }
+
+            T& operator()(int i, int j) { return buffer[(long)i * ld + j]; }
+            T operator()(int i, int j) const { return buffer[(long)i * ld + j]; }
+
+            // Copies other into this matrix, rounding or widening each element, with the same shape. The stride is
+            // packed unless this matrix already had that shape.
+            template <class U>
+            void assign(const BasicMatrix<U>& other){
+                resize(other.rows(), other.cols());
+                for(int i = 0; i < n_rows; i++){
+                    const U* source = other.row(i);
+                    T* target = row(i);
+                    for(int j = 0; j < n_cols; j++){ target[j] = (T)source[j]; }
+                }
+            }
+
+        private:
+            int n_rows;
+            int n_cols;
+            int ld;
+            std::vector<T> buffer;
+    };
+
+    typedef BasicMatrix<double> Matrix;
+    typedef BasicMatrix<float> FloatMatrix;
+
+    // A dense vector. Moving a std::vector<double> in or out does not copy.
+    class Vector{
+        public:
+            Vector();
+            explicit Vector(int n, double value = 0);
+            explicit Vector(const std::vector<double>& a);
+            explicit Vector(std::vector<double>&& a);
+
+            void resize(int n);
+            void fill(double value);
+
+            const std::vector<double>& toStdVector() const { return buffer; }
+            std::vector<double> release() { return std::move(buffer); }
+
+            int size() const { return (int)buffer.size(); }
+            bool empty() const { return buffer.empty(); }
+
+            double* data() { return buffer.data(); }
+            const double* data() const { return buffer.data(); }
+
+            double& operator[](int i) { return buffer[i]; }
+            double operator[](int i) const { return buffer[i]; }
+
+        private:
+            std::vector<double> buffer;
+    };
+}
+
+#endif /* Matrix_hpp */
@@ -0,0 +1,28 @@
+//
+//  MiniBatches.cpp
+//
+//  Mini-batches as ranges of an order of the sample indices.
+//
+
+#include "MiniBatches.hpp"
+#include <numeric>
+
+namespace MLPP{
+    MiniBatches::MiniBatches(int n, int n_mini_batch)
+    : order(std::max(n, 0)), n_batches(std::min(std::max(n_mini_batch, 1), std::max(n, 0))), perBatch(n_batches ? n / n_batches : 0), ordered(true)
+    {
+        std::iota(order.begin(), order.end(), 0);
+    }
+
+    void MiniBatches::shuffle(std::default_random_engine& generator){
+        std::shuffle(order.begin(), order.end(), generator);
+        ordered = false;
+    }
+
+    void MiniBatches::gather(const std::vector<double>& source, const int* rows, int count, std::vector<double>& scratch){
+        scratch.resize(count);
+        for(int i = 0; i < count; i++){
+            scratch[i] = source[rows[i]];
+        }
+    }
+}
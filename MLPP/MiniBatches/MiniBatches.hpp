@@ -0,0 +1,58 @@
+//
+//  MiniBatches.hpp
+//
+//  Mini-batches as ranges of an order of the sample indices.
+//
+
+#ifndef MiniBatches_hpp
+#define MiniBatches_hpp
+
+#include "Matrix/Matrix.hpp"
+#include <algorithm>
+#include <random>
+#include <vector>
+
+namespace MLPP{
+    // Batch i is a range of an order of the samples, so batches are views of the training set rather than copies of
+    // it, and reshuffling between epochs rewrites n indices however wide a sample is. Models read a batch's samples in
+    // place through indices(), or gather them into a scratch buffer when a kernel needs the rows evenly spaced.
+    class MiniBatches{
+        public:
+            // n samples in n_mini_batch batches of n / n_mini_batch, the last taking the remainder, as in
+            // Utilities::createMiniBatches, and at least one batch if there are samples. The samples start in order.
+            MiniBatches(int n, int n_mini_batch);
+
+            int size() const { return n_batches; }
+            int samples() const { return order.size(); }
+
+            // Draws a new order of the samples.
+            void shuffle(std::default_random_engine& generator);
+
+            // True until the first shuffle. Batch i is then the contiguous samples [first(i), first(i) + rows(i)).
+            bool inOrder() const { return ordered; }
+
+            int first(int i) const { return i * perBatch; }
+            int rows(int i) const { return i == n_batches - 1 ? samples() - first(i) : perBatch; }
+
+            // The sample indices of batch i.
+            const int* indices(int i) const { return order.data() + first(i); }
+
+            // Copies the listed rows of source into the first count rows of scratch, which keeps its buffer between calls.
+            template <class T>
+            static void gather(const BasicMatrix<T>& source, const int* rows, int count, BasicMatrix<T>& scratch){
+                scratch.resize(count, source.cols());
+                for(int i = 0; i < count; i++){
+                    std::copy(source.row(rows[i]), source.row(rows[i]) + source.cols(), scratch.row(i));
+                }
+            }
+            static void gather(const std::vector<double>& source, const int* rows, int count, std::vector<double>& scratch);
+
+        private:
+            std::vector<int> order;
+            int n_batches;
+            int perBatch;
+            bool ordered;
+    };
+}
+
+#endif /* MiniBatches_hpp */
@@ -0,0 +1,363 @@
+//
+//  Optimizer.cpp
+//
+//  First-order optimizers that update a model's parameters in place.
+//
+
+#include "Optimizer.hpp"
+#include "VecMath/VecMath.hpp"
+#include <cmath>
+#include <cstring>
+
+#if defined(__x86_64__) || defined(__i386__)
+#include <immintrin.h>
+#define MLPP_OPTIMIZER_X86
+#endif
+
+namespace MLPP{
+    namespace {
+        #define MLPP_OPTIMIZER_INLINE inline __attribute__((always_inline))
+
+        // Each update rule is written once as a functor over V, which is either double or one of GCC's generic
+        // vector types, and only uses arithmetic, comparisons and sqrtV below. Every operation is correctly rounded
+        // per lane, so a parameter's update does not depend on where it sits in the buffer. Nothing returns a
+        // vector type by value, which would change the ABI without AVX enabled.
+        MLPP_OPTIMIZER_INLINE void sqrtV(double& y, double x){ y = std::sqrt(x); }
+
+        #ifdef MLPP_OPTIMIZER_X86
+        typedef double Vec4 __attribute__((vector_size(32)));
+        typedef double Vec8 __attribute__((vector_size(64)));
+
+        // Builtins rather than the intrinsics, which cannot be inlined into the target-neutral functors. They are
+        // only ever expanded inside the AVX2 and AVX-512 entry points, so the ABI of the builtins' returns is moot.
+        #pragma GCC diagnostic push
+        #pragma GCC diagnostic ignored "-Wpsabi"
+        MLPP_OPTIMIZER_INLINE void sqrtV(Vec4& y, const Vec4& x){ y = __builtin_ia32_sqrtpd256(x); }
+        MLPP_OPTIMIZER_INLINE void sqrtV(Vec8& y, const Vec8& x){ y = __builtin_ia32_sqrtpd512_mask(x, x, (unsigned char)-1, 4); }
+        #pragma GCC diagnostic pop
+        #endif
+
+        struct GradientDescentStep{
+            double lr;
+            template <class V>
+            MLPP_OPTIMIZER_INLINE void operator()(V& w, const V& g) const{
+                w -= lr * g;
+            }
+        };
+
+        struct MomentumStep{
+            double lr, gamma;
+            bool NAG;
+            template <class V>
+            MLPP_OPTIMIZER_INLINE void operator()(V& w, const V& g, V& v) const{
+                if(NAG){ w -= v; }
+                v = gamma * v + lr * g;
+                w -= v;
+            }
+        };
+
+        struct AdagradStep{
+            double lr, e;
+            template <class V>
+            MLPP_OPTIMIZER_INLINE void operator()(V& w, const V& g, V& v) const{
+                v += g * g;
+                V s; sqrtV(s, v);
+                w -= lr * g / (e + s);
+            }
+        };
+
+        struct AdadeltaStep{
+            double lr, b1, e;
+            template <class V>
+            MLPP_OPTIMIZER_INLINE void operator()(V& w, const V& g, V& v) const{
+                v = (1 - b1) * v + b1 * g * g;
+                V s; sqrtV(s, v);
+                w -= lr * g / (e + s);
+            }
+        };
+
+        struct AdamStep{
+            double lr, b1, b2, e, c1, c2;
+            template <class V>
+            MLPP_OPTIMIZER_INLINE void operator()(V& w, const V& g, V& m, V& v) const{
+                m = b1 * m + (1 - b1) * g;
+                v = b2 * v + (1 - b2) * g * g;
+                V s; sqrtV(s, c2 * v);
+                w -= lr * (c1 * m) / (e + s);
+            }
+        };
+
+        struct AdamaxStep{
+            double lr, b1, b2, e, c1;
+            template <class V>
+            MLPP_OPTIMIZER_INLINE void operator()(V& w, const V& g, V& m, V& u) const{
+                m = b1 * m + (1 - b1) * g;
+                V decayed = b2 * u, magnitude = g < 0 ? -g : g;
+                u = decayed >= magnitude ? decayed : magnitude;
+                w -= lr * (c1 * m) / (e + u);
+            }
+        };
+
+        struct NadamStep{
+            double lr, b1, b2, e, c1, c2;
+            template <class V>
+            MLPP_OPTIMIZER_INLINE void operator()(V& w, const V& g, V& m, V& v) const{
+                m = b1 * m + (1 - b1) * g;
+                v = b2 * v + (1 - b2) * g * g;
+                V m_final = b1 * c1 * m + (1 - b1) * c1 * g;
+                V s; sqrtV(s, c2 * v);
+                w -= lr * m_final / (e + s);
+            }
+        };
+
+        struct AMSGradStep{
+            double lr, b1, b2, e;
+            template <class V>
+            MLPP_OPTIMIZER_INLINE void operator()(V& w, const V& g, V& m, V& v, V& u) const{
+                m = b1 * m + (1 - b1) * g;
+                v = b2 * v + (1 - b2) * g * g;
+                u = u >= v ? u : v; // v_hat
+                V s; sqrtV(s, u);
+                w -= lr * m / (e + s);
+            }
+        };
+
+        template <class V>
+        MLPP_OPTIMIZER_INLINE void load(V& v, const double* x){
+            std::memcpy(&v, x, sizeof(V));
+        }
+
+        template <class V>
+        MLPP_OPTIMIZER_INLINE void store(double* x, const V& v){
+            std::memcpy(x, &v, sizeof(V));
+        }
+
+        // One pass over a block: whole registers, then the tail an element at a time. The N moment buffers are read
+        // and written alongside the weights.
+        template <class V, int N, class Step>
+        MLPP_OPTIMIZER_INLINE void fusedArrays(const Step& step, double* w, const double* g, double* const* moments, long n){
+            const int W = sizeof(V) / sizeof(double);
+            long i = 0;
+            for(; i + W <= n; i += W){
+                V wv, gv;
+                load(wv, w + i);
+                load(gv, g + i);
+                V mv[N > 0 ? N : 1];
+                if constexpr(N > 0){
+                    for(int j = 0; j < N; j++){
+                        load(mv[j], moments[j] + i);
+                    }
+                }
+                if constexpr(N == 0){ step(wv, gv); }
+                if constexpr(N == 1){ step(wv, gv, mv[0]); }
+                if constexpr(N == 2){ step(wv, gv, mv[0], mv[1]); }
+                if constexpr(N == 3){ step(wv, gv, mv[0], mv[1], mv[2]); }
+                store<V>(w + i, wv);
+                if constexpr(N > 0){
+                    for(int j = 0; j < N; j++){
+                        store<V>(moments[j] + i, mv[j]);
+                    }
+                }
+            }
+            for(; i < n; i++){
+                if constexpr(N == 0){ step(w[i], g[i]); }
+                if constexpr(N == 1){ step(w[i], g[i], moments[0][i]); }
+                if constexpr(N == 2){ step(w[i], g[i], moments[0][i], moments[1][i]); }
+                if constexpr(N == 3){ step(w[i], g[i], moments[0][i], moments[1][i], moments[2][i]); }
+            }
+        }
+
+        template <int N, class Step>
+        void scalarFused(const Step& step, double* w, const double* g, double* const* moments, long n){
+            fusedArrays<double, N>(step, w, g, moments, n);
+        }
+
+        #ifdef MLPP_OPTIMIZER_X86
+        template <int N, class Step>
+        __attribute__((target("avx2,fma")))
+        void avx2Fused(const Step& step, double* w, const double* g, double* const* moments, long n){
+            fusedArrays<Vec4, N>(step, w, g, moments, n);
+        }
+
+        template <int N, class Step>
+        __attribute__((target("avx512f")))
+        void avx512Fused(const Step& step, double* w, const double* g, double* const* moments, long n){
+            fusedArrays<Vec8, N>(step, w, g, moments, n);
+        }
+        #endif
+
+        template <int N, class Step>
+        void fused(const Step& step, double* w, const double* g, double* const* moments, long n){
+            switch(VecMath::kernel()){
+                #ifdef MLPP_OPTIMIZER_X86
+                case VecMath::AVX512: avx512Fused<N>(step, w, g, moments, n); return;
+                case VecMath::AVX2: avx2Fused<N>(step, w, g, moments, n); return;
+                #endif
+                default: scalarFused<N>(step, w, g, moments, n);
+            }
+        }
+    }
+
+    Optimizer::Optimizer(int n_moments)
+    : t(0), n_moments(n_moments), restored(false)
+    {
+
+    }
+
+    Optimizer::~Optimizer(){
+
+    }
+
+    void Optimizer::reset(const std::vector<long>& blockSizes){
+        bool resume = restored && moments.size() == blockSizes.size() * n_moments;
+        for(int block = 0; resume && block < blockSizes.size(); block++){
+            for(int which = 0; which < n_moments; which++){
+                resume = resume && moments[block * n_moments + which].size() == blockSizes[block];
+            }
+        }
+        restored = false;
+        if(resume){ return; }
+
+        moments.assign(blockSizes.size() * n_moments, Vector());
+        for(int block = 0; block < blockSizes.size(); block++){
+            for(int which = 0; which < n_moments; which++){
+                moments[block * n_moments + which] = Vector(blockSizes[block]);
+            }
+        }
+        t = 0;
+    }
+
+    void Optimizer::save(Checkpoint::Writer& writer, const std::string& prefix) const{
+        writer.add(prefix + ".step", (double)t);
+        writer.add(prefix + ".moments", (double)n_moments);
+        writer.add(prefix + ".buffers", (double)moments.size());
+        for(int i = 0; i < moments.size(); i++){
+            writer.add(prefix + ".buffer" + std::to_string(i), moments[i].toStdVector());
+        }
+    }
+
+    bool Optimizer::fits(const Checkpoint& checkpoint, const std::string& prefix) const{
+        return checkpoint.scalar(prefix + ".moments", -1) == n_moments;
+    }
+
+    bool Optimizer::load(const Checkpoint& checkpoint, const std::string& prefix){
+        if(!fits(checkpoint, prefix)){
+            return false;
+        }
+        int buffers = checkpoint.scalar(prefix + ".buffers");
+        moments.assign(buffers, Vector());
+        for(int i = 0; i < buffers; i++){
+            moments[i] = Vector(checkpoint.vector(prefix + ".buffer" + std::to_string(i)));
+        }
+        t = checkpoint.scalar(prefix + ".step");
+        restored = true;
+        return true;
+    }
+
+    void Optimizer::beginStep(int t){
+        Optimizer::t = t;
+    }
+
+    double* Optimizer::moment(int block, int which){
+        return moments[block * n_moments + which].data();
+    }
+
+    GradientDescentOptimizer::GradientDescentOptimizer()
+    : Optimizer(0)
+    {
+
+    }
+
+    void GradientDescentOptimizer::update(int, double* weights, const double* gradient, long n, double learning_rate){
+        fused<0>(GradientDescentStep{learning_rate}, weights, gradient, nullptr, n);
+    }
+
+    MomentumOptimizer::MomentumOptimizer(double gamma, bool NAG)
+    : Optimizer(1), gamma(gamma), NAG(NAG)
+    {
+
+    }
+
+    void MomentumOptimizer::update(int block, double* weights, const double* gradient, long n, double learning_rate){
+        double* moments[] = {moment(block, 0)};
+        fused<1>(MomentumStep{learning_rate, gamma, NAG}, weights, gradient, moments, n);
+    }
+
+    AdagradOptimizer::AdagradOptimizer(double e)
+    : Optimizer(1), e(e)
+    {
+
+    }
+
+    void AdagradOptimizer::update(int block, double* weights, const double* gradient, long n, double learning_rate){
+        double* moments[] = {moment(block, 0)};
+        fused<1>(AdagradStep{learning_rate, e}, weights, gradient, moments, n);
+    }
+
+    AdadeltaOptimizer::AdadeltaOptimizer(double b1, double e)
+    : Optimizer(1), b1(b1), e(e)
+    {
+
+    }
+
+    void AdadeltaOptimizer::update(int block, double* weights, const double* gradient, long n, double learning_rate){
+        double* moments[] = {moment(block, 0)};
+        fused<1>(AdadeltaStep{learning_rate, b1, e}, weights, gradient, moments, n);
+    }
+
+    AdamOptimizer::AdamOptimizer(double b1, double b2, double e)
+    : AdamOptimizer(b1, b2, e, 2)
+    {
+
+    }
+
+    AdamOptimizer::AdamOptimizer(double b1, double b2, double e, int n_moments)
+    : Optimizer(n_moments), b1(b1), b2(b2), e(e), c1(0), c2(0)
+    {
+        beginStep(1);
+    }
+
+    void AdamOptimizer::beginStep(int t){
+        Optimizer::beginStep(t);
+        c1 = 1/(1 - std::pow(b1, t));
+        c2 = 1/(1 - std::pow(b2, t));
+    }
+
+    void AdamOptimizer::update(int block, double* weights, const double* gradient, long n, double learning_rate){
+        double* moments[] = {moment(block, 0), moment(block, 1)};
+        fused<2>(AdamStep{learning_rate, b1, b2, e, c1, c2}, weights, gradient, moments, n);
+    }
+
+    AdamaxOptimizer::AdamaxOptimizer(double b1, double b2, double e)
+    : AdamOptimizer(b1, b2, e, 2)
+    {
+
+    }
+
+    void AdamaxOptimizer::update(int block, double* weights, const double* gradient, long n, double learning_rate){
+        double* moments[] = {moment(block, 0), moment(block, 1)};
+        fused<2>(AdamaxStep{learning_rate, b1, b2, e, c1}, weights, gradient, moments, n);
+    }
+
+    NadamOptimizer::NadamOptimizer(double b1, double b2, double e)
+    : AdamOptimizer(b1, b2, e, 2)
+    {
+
+    }
+
+    void NadamOptimizer::update(int block, double* weights, const double* gradient, long n, double learning_rate){
+        double* moments[] = {moment(block, 0), moment(block, 1)};
+        fused<2>(NadamStep{learning_rate, b1, b2, e, c1, c2}, weights, gradient, moments, n);
+    }
+
+    AMSGradOptimizer::AMSGradOptimizer(double b1, double b2, double e)
+    : AdamOptimizer(b1, b2, e, 3)
+    {
+
+    }
+
+    void AMSGradOptimizer::update(int block, double* weights, const double* gradient, long n, double learning_rate){
+        double* moments[] = {moment(block, 0), moment(block, 1), moment(block, 2)};
+        fused<3>(AMSGradStep{learning_rate, b1, b2, e}, weights, gradient, moments, n);
+    }
+}
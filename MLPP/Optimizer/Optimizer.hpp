@@ -0,0 +1,126 @@
+//
+//  Optimizer.hpp
+//
+//  First-order optimizers that update a model's parameters in place.
+//
+
+#ifndef Optimizer_hpp
+#define Optimizer_hpp
+
+#include "Matrix/Matrix.hpp"
+#include "Checkpoint/Checkpoint.hpp"
+#include <vector>
+
+namespace MLPP{
+    // A model hands its parameters to an optimizer as blocks of contiguous doubles, such as one block per layer's
+    // weights, together with the gradient of each block. The optimizer keeps its moment estimates per block and
+    // applies every step as a single pass over the block, vectorized with the VecMath kernel and without temporaries.
+    class Optimizer{
+        public:
+            virtual ~Optimizer();
+
+            // Sizes one set of moment buffers per parameter block and zeroes them. Models call it when training starts.
+            // Right after load(), a reset with the saved block sizes keeps the restored state instead.
+            void reset(const std::vector<long>& blockSizes);
+
+            // Called once per step, before its blocks are updated. t counts from 1 and drives the bias corrections.
+            virtual void beginStep(int t);
+
+            // The last step begun; 0 after a reset that cleared the state.
+            int step() const { return t; }
+
+            // The moments and step count, for resuming with an optimizer of the same type and settings. load() fails,
+            // leaving the optimizer as it was, unless fits() does: the checkpoint must hold as many moments per block.
+            void save(Checkpoint::Writer& writer, const std::string& prefix) const;
+            bool fits(const Checkpoint& checkpoint, const std::string& prefix) const;
+            bool load(const Checkpoint& checkpoint, const std::string& prefix);
+
+            // weights -= step(gradient) over the n parameters of the given block.
+            virtual void update(int block, double* weights, const double* gradient, long n, double learning_rate) = 0;
+
+        protected:
+            explicit Optimizer(int n_moments);
+            double* moment(int block, int which);
+
+            int t;
+
+        private:
+            int n_moments;
+            std::vector<Vector> moments;
+            bool restored;
+    };
+
+    // w -= lr * g
+    class GradientDescentOptimizer : public Optimizer{
+        public:
+            GradientDescentOptimizer();
+            void update(int block, double* weights, const double* gradient, long n, double learning_rate) override;
+    };
+
+    // v = gamma * v + lr * g; w -= v. With NAG the previous velocity is applied first as a look-ahead step.
+    class MomentumOptimizer : public Optimizer{
+        public:
+            MomentumOptimizer(double gamma, bool NAG);
+            void update(int block, double* weights, const double* gradient, long n, double learning_rate) override;
+        private:
+            double gamma;
+            bool NAG;
+    };
+
+    // v += g^2; w -= lr * g / (e + sqrt(v))
+    class AdagradOptimizer : public Optimizer{
+        public:
+            explicit AdagradOptimizer(double e);
+            void update(int block, double* weights, const double* gradient, long n, double learning_rate) override;
+        private:
+            double e;
+    };
+
+    // v = (1 - b1) * v + b1 * g^2; w -= lr * g / (e + sqrt(v))
+    class AdadeltaOptimizer : public Optimizer{
+        public:
+            AdadeltaOptimizer(double b1, double e);
+            void update(int block, double* weights, const double* gradient, long n, double learning_rate) override;
+        private:
+            double b1;
+            double e;
+    };
+
+    // Adam and its variants, with the moment decay rates b1 and b2. Bias corrections use the step count t.
+    class AdamOptimizer : public Optimizer{
+        public:
+            AdamOptimizer(double b1, double b2, double e);
+            void beginStep(int t) override;
+            void update(int block, double* weights, const double* gradient, long n, double learning_rate) override;
+        protected:
+            AdamOptimizer(double b1, double b2, double e, int n_moments);
+            double b1;
+            double b2;
+            double e;
+            double c1; // 1 / (1 - b1^t)
+            double c2; // 1 / (1 - b2^t)
+    };
+
+    // Adam with the infinity norm in place of the second moment.
+    class AdamaxOptimizer : public AdamOptimizer{
+        public:
+            AdamaxOptimizer(double b1, double b2, double e);
+            void update(int block, double* weights, const double* gradient, long n, double learning_rate) override;
+    };
+
+    // Adam with Nesterov momentum.
+    class NadamOptimizer : public AdamOptimizer{
+        public:
+            NadamOptimizer(double b1, double b2, double e);
+            void update(int block, double* weights, const double* gradient, long n, double learning_rate) override;
+    };
+
+    // Adam on the running maximum of the second moment, without bias correction.
+    class AMSGradOptimizer : public AdamOptimizer{
+        public:
+            AMSGradOptimizer(double b1, double b2, double e);
+            void update(int block, double* weights, const double* gradient, long n, double learning_rate) override;
+    };
+}
+
+#endif /* Optimizer_hpp */
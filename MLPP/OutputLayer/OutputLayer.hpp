@@ -8,10 +8,10 @@
 #define OutputLayer_hpp
 
 #include "Activation/Activation.hpp"
+#include "Checkpoint/Checkpoint.hpp"
 #include "Cost/Cost.hpp"
 
 #include <vector>
-#include <map>
 #include <string>
 
 namespace  MLPP {
@@ -31,10 +31,9 @@ namespace  MLPP {
             std::vector<double> z;
             std::vector<double> a;
 
-            std::map<std::string, std::vector<double> (Activation::*)(std::vector<double>, bool)> activation_map;
-            std::map<std::string, double (Activation::*)(double, bool)> activationTest_map;
-            std::map<std::string, double (Cost::*)(std::vector<double>, std::vector<double>)> cost_map;
-            std::map<std::string, std::vector<double> (Cost::*)(std::vector<double>, std::vector<double>)> costDeriv_map;
+            // Resolved from activation and cost when the layer is built.
+            Activation::Function activationFunction;
+            Cost::Function costFunction;
 
             double z_test;
             double a_test; 
@@ -50,6 +49,12 @@ namespace  MLPP {
 
             void forwardPass();
             void Test(std::vector<double> x);
+
+            // Architecture, weights and bias under the given name prefix. load() only restores the weights and bias, and
+            // fails, leaving the layer as it was, unless fits() does: their shapes must equal the layer's.
+            void save(Checkpoint::Writer& writer, const std::string& prefix) const;
+            bool fits(const Checkpoint& checkpoint, const std::string& prefix) const;
+            bool load(const Checkpoint& checkpoint, const std::string& prefix);
     };
 }
 
@@ -7,38 +7,155 @@
 #include "PCA.hpp"
 #include "LinAlg/LinAlg.hpp"
 #include "Data/Data.hpp"
+#include "GEMM/GEMM.hpp"
 
 #include <iostream>
 #include <random>
+#include <cmath>
+#include <algorithm>
 
 namespace MLPP{
 
-    PCA::PCA(std::vector<std::vector<double>> inputSet, int k)
-    : inputSet(inputSet), k(k)
+    PCA::PCA(std::vector<std::vector<double>> inputSet, int k, std::string solver)
+    : inputSet(inputSet), k(k), solver(solver), samplesSeen(0)
     {
 
     }
 
+    PCA::PCA(int k, std::string solver)
+    : k(k), solver(solver), samplesSeen(0)
+    {
+
+    }
+
+    // Incremental SVD (Ross et al., as in scikit-learn's IncrementalPCA). The previous fit is summarized by
+    // its scaled basis U diag(sigma); the batch contributes its own centered columns plus one column that
+    // accounts for the shift between the old mean and the batch mean. The SVD of those k + b + 1 columns
+    // is the SVD of all data seen so far, truncated to rank k.
+    void PCA::partialFit(std::vector<std::vector<double>> batch){
+        LinAlg alg;
+        int d = batch.size();
+        int b = d ? batch[0].size() : 0;
+        if(b == 0){ return; }
+        if(samplesSeen == 0){
+            runningMean = Vector(d);
+            M2 = Vector(d);
+        }
+        else if(d != runningMean.size()){
+            std::cout << "ERR: batch has " << d << " features but PCA was fitted on " << runningMean.size() << "." << std::endl;
+            return;
+        }
+
+        long total = samplesSeen + b;
+        int r = sigma.size();
+        Matrix M(d, r + b + 1);
+        double shiftScale = std::sqrt((double)samplesSeen * b / total);
+        for(int i = 0; i < d; i++){
+            double batchMean = 0;
+            for(int j = 0; j < b; j++){
+                batchMean += batch[i][j];
+            }
+            batchMean /= b;
+            double batchM2 = 0;
+            double* mi = M.row(i);
+            for(int q = 0; q < r; q++){
+                mi[q] = basis(i, q) * sigma[q];
+            }
+            for(int j = 0; j < b; j++){
+                double x = batch[i][j] - batchMean;
+                mi[r + j] = x;
+                batchM2 += x * x;
+            }
+            double delta = batchMean - runningMean[i];
+            mi[r + b] = shiftScale * delta;
+
+            // Chan et al.'s pairwise update of the mean and the sum of squared deviations.
+            M2[i] += batchM2 + delta * delta * samplesSeen * b / total;
+            runningMean[i] += delta * b / total;
+        }
+
+        Matrix Vt;
+        if(solver == "Randomized"){
+            alg.randomizedSVD(M, std::min(k, std::min(d, r + b + 1)), basis, sigma, Vt);
+        }
+        else{
+            alg.SVD(M, basis, sigma, Vt, k);
+        }
+        samplesSeen = total;
+    }
+
+    std::vector<std::vector<double>> PCA::transform(std::vector<std::vector<double>> batch){
+        int d = basis.rows();
+        int r = basis.cols();
+        int b = batch.empty() ? 0 : batch[0].size();
+        Matrix X(d, b);
+        for(int i = 0; i < d; i++){
+            for(int j = 0; j < b; j++){
+                X(i, j) = batch[i][j] - runningMean[i];
+            }
+        }
+        Matrix P(r, b);
+        GEMM::gemm(true, false, r, b, d, 1.0, basis.data(), basis.stride(), X.data(), X.stride(), 0.0, P.data(), P.stride());
+        return P.toStdVector();
+    }
+
+    std::vector<double> PCA::variance() const{
+        std::vector<double> var(M2.size());
+        for(int i = 0; i < M2.size(); i++){
+            var[i] = samplesSeen > 1 ? M2[i] / (samplesSeen - 1) : 0;
+        }
+        return var;
+    }
+
     std::vector<std::vector<double>> PCA::principalComponents(){
         LinAlg alg;
         Data data; 
+        if(samplesSeen > 0){
+            std::cout << "ERR: an incremental PCA keeps no samples to project; use transform." << std::endl;
+            return {};
+        }
 
-        auto [U, S, Vt] = alg.SVD(alg.cov(inputSet));
+        // The principal directions are the left singular vectors of the centered data, so the covariance
+        // matrix is never formed.
         X_normalized = data.meanCentering(inputSet);
-        U_reduce.resize(U.size());
-        for(int i = 0; i < k; i++){
-            for(int j = 0; j < U.size(); j++){
-                U_reduce[j].push_back(U[j][i]);
+        auto [U, S, Vt] = solver == "Randomized" ? alg.randomizedSVD(X_normalized, k) : alg.SVD(X_normalized, k);
+        U_reduce = U;
+        Z = alg.transposeMatmult(U_reduce, X_normalized);
+        return Z;
+    }
+    std::vector<std::vector<double>> PCA::components() const{
+        if(samplesSeen > 0){
+            Matrix components(basis.cols(), basis.rows());
+            for(int i = 0; i < basis.rows(); i++){
+                for(int q = 0; q < basis.cols(); q++){
+                    components(q, i) = basis(i, q);
+                }
             }
+            return components.toStdVector();
         }
-        Z = alg.matmult(alg.transpose(U_reduce), X_normalized);
-        return Z;
+        LinAlg alg;
+        return U_reduce.empty() ? U_reduce : alg.transpose(U_reduce);
     }
+
     // Simply tells us the percentage of variance maintained. 
     double PCA::score(){
         LinAlg alg;
+        if(samplesSeen > 0){
+            // The retained singular values account for sum(sigma^2) of the total sum of squares.
+            double kept = 0, total = 0;
+            for(int q = 0; q < sigma.size(); q++){
+                kept += sigma[q] * sigma[q];
+            }
+            for(int i = 0; i < M2.size(); i++){
+                total += M2[i];
+            }
+            if(total == 0){
+                total += 1e-10;
+            }
+            return kept / total;
+        }
         std::vector<std::vector<double>> X_approx = alg.matmult(U_reduce, Z);
-        double num, den = 0;
+        double num = 0, den = 0;
         for(int i = 0; i < X_normalized.size(); i++){
             num += alg.norm_sq(alg.subtraction(X_normalized[i], X_approx[i]));
         }
@@ -7,21 +7,51 @@
 #ifndef PCA_hpp
 #define PCA_hpp
 
+#include "Matrix/Matrix.hpp"
 #include <vector>
+#include <string>
 
 namespace MLPP{
     class PCA{
         
         public:
-            PCA(std::vector<std::vector<double>> inputSet, int k);
+            // solver = "Randomized" approximates the top k directions with a randomized SVD, which is much
+            // cheaper than the exact decomposition when k is small next to the data.
+            PCA(std::vector<std::vector<double>> inputSet, int k, std::string solver = "Default");
+
+            // Incremental mode: no data up front, batches arrive through partialFit. Only the running mean,
+            // variance and a rank-k basis are kept, so memory stays at O(k * features) however much is streamed.
+            PCA(int k, std::string solver = "Default");
+
+            // batch is laid out like inputSet, one row per feature and one column per sample.
+            void partialFit(std::vector<std::vector<double>> batch);
+
+            // Projects batch onto the basis fitted so far, centering it with the running mean. k x samples.
+            std::vector<std::vector<double>> transform(std::vector<std::vector<double>> batch);
+
+            // Fits inputSet and returns its projections, k x samples. Incremental mode keeps no samples to
+            // project, so there it returns nothing; use transform instead.
             std::vector<std::vector<double>> principalComponents();
+            // The fitted basis, k x features, one principal direction per row. Empty before a batch fit.
+            std::vector<std::vector<double>> components() const;
             double score(); 
+
+            std::vector<double> mean() const { return runningMean.toStdVector(); }
+            std::vector<double> variance() const;
         private:
             std::vector<std::vector<double>> inputSet;
             std::vector<std::vector<double>> X_normalized;
             std::vector<std::vector<double>> U_reduce;
             std::vector<std::vector<double>> Z;  
             int k;
+            std::string solver;
+
+            // Incremental state. M2 holds each feature's sum of squared deviations from the running mean.
+            long samplesSeen;
+            Vector runningMean;
+            Vector M2;
+            Vector sigma;
+            Matrix basis;
     };
 }
 
@@ -0,0 +1,182 @@
+//
+//  QR.cpp
+//
+//  Householder QR factorization and least-squares solves.
+//
+
+#include "QR.hpp"
+#include "Householder/Householder.hpp"
+#include <cmath>
+#include <limits>
+#include <algorithm>
+
+namespace MLPP{
+
+    namespace {
+        // Columns factored per panel. Everything to the right of a panel is updated by one blocked reflection.
+        const int NB = 32;
+    }
+
+    QR::QR(const std::vector<std::vector<double>>& A)
+    : m(A.size()), n(A.empty() ? 0 : A[0].size()), isRankDeficient(false)
+    {
+        Matrix AT(n, m);
+        for(int i = 0; i < m; i++){
+            for(int j = 0; j < n; j++){
+                AT(j, i) = A[i][j];
+            }
+        }
+        factor(AT);
+    }
+
+    QR::QR(const Matrix& A)
+    : m(A.rows()), n(A.cols()), isRankDeficient(false)
+    {
+        Matrix AT(n, m);
+        for(int i = 0; i < m; i++){
+            for(int j = 0; j < n; j++){
+                AT(j, i) = A(i, j);
+            }
+        }
+        factor(AT);
+    }
+
+    // AT holds A transposed so that each column being reduced is a contiguous row. Reflector j goes to row j of
+    // qv from column j. Within a panel the columns are reduced one at a time; the remaining columns then
+    // take all of the panel's reflectors at once through Householder::apply.
+    void QR::factor(Matrix& AT){
+        int k = std::min(m, n);
+        qv.resize(k, m);
+        qv.fill(0);
+        beta.assign(k, 0);
+        r.resize(k, n);
+        r.fill(0);
+        for(int j0 = 0; j0 < k; j0 += NB){
+            int nb = std::min(NB, k - j0);
+            for(int j = j0; j < j0 + nb; j++){
+                double* v = qv.row(j) + j;
+                std::copy(AT.row(j) + j, AT.row(j) + m, v);
+                r(j, j) = Householder::reflector(v, m - j, beta[j]);
+                if(beta[j] == 0){ continue; }
+                for(int c = j + 1; c < j0 + nb; c++){
+                    double* col = AT.row(c) + j;
+                    double s = 0;
+                    for(int i = 0; i < m - j; i++){
+                        s += v[i] * col[i];
+                    }
+                    s *= beta[j];
+                    for(int i = 0; i < m - j; i++){
+                        col[i] -= s * v[i];
+                    }
+                }
+            }
+            if(j0 + nb < n){
+                Householder::apply(nb, qv.row(j0), qv.stride(), beta.data() + j0, j0, n - j0 - nb, m, AT.row(j0 + nb), AT.stride(), true);
+            }
+        }
+        // Entry i of column c is final once reflector i has reached it.
+        for(int c = 0; c < n; c++){
+            for(int i = 0; i < std::min(c, k); i++){
+                r(i, c) = AT(c, i);
+            }
+        }
+
+        double maxDiag = 0;
+        for(int j = 0; j < k; j++){
+            maxDiag = std::max(maxDiag, std::abs(r(j, j)));
+        }
+        const double tol = std::max(m, n) * std::numeric_limits<double>::epsilon() * maxDiag;
+        isRankDeficient = m < n || maxDiag == 0;
+        for(int j = 0; j < k; j++){
+            if(std::abs(r(j, j)) <= tol){ isRankDeficient = true; }
+        }
+    }
+
+    std::vector<std::vector<double>> QR::Q() const{
+        int k = std::min(m, n);
+        Matrix X(k, m, 0.0);
+        for(int i = 0; i < k; i++){
+            X(i, i) = 1;
+        }
+        multiplyQ(X);
+        std::vector<std::vector<double>> q(m, std::vector<double>(k));
+        for(int i = 0; i < k; i++){
+            for(int j = 0; j < m; j++){
+                q[j][i] = X(i, j);
+            }
+        }
+        return q;
+    }
+
+    std::vector<std::vector<double>> QR::R() const{
+        return r.toStdVector();
+    }
+
+    void QR::multiplyQ(Matrix& X, bool transpose) const{
+        Householder::apply(qv, beta, 0, X, transpose);
+    }
+
+    void QR::substitute(Matrix& BT, Matrix& X) const{
+        int k = BT.rows();
+        X.resize(n, k);
+        if(isRankDeficient){
+            X.fill(std::numeric_limits<double>::quiet_NaN());
+            return;
+        }
+        multiplyQ(BT, true);
+        for(int i = 0; i < n; i++){
+            for(int c = 0; c < k; c++){
+                X(i, c) = BT(c, i);
+            }
+        }
+        for(int i = n - 1; i >= 0; i--){
+            double* xi = X.row(i);
+            for(int q = i + 1; q < n; q++){
+                double u = r(i, q);
+                const double* xq = X.row(q);
+                for(int c = 0; c < k; c++){
+                    xi[c] -= u * xq[c];
+                }
+            }
+            double inv = 1 / r(i, i);
+            for(int c = 0; c < k; c++){
+                xi[c] *= inv;
+            }
+        }
+    }
+
+    std::vector<double> QR::solve(const std::vector<double>& b) const{
+        Matrix BT(1, m);
+        std::copy(b.begin(), b.begin() + m, BT.row(0));
+        Matrix X;
+        substitute(BT, X);
+        std::vector<double> x(n);
+        for(int i = 0; i < n; i++){
+            x[i] = X(i, 0);
+        }
+        return x;
+    }
+
+    std::vector<std::vector<double>> QR::solve(const std::vector<std::vector<double>>& B) const{
+        int k = B.empty() ? 0 : B[0].size();
+        Matrix BT(k, m);
+        for(int i = 0; i < m; i++){
+            for(int c = 0; c < k; c++){
+                BT(c, i) = B[i][c];
+            }
+        }
+        Matrix X;
+        substitute(BT, X);
+        return X.toStdVector();
+    }
+
+    void QR::solve(const Matrix& B, Matrix& X) const{
+        Matrix BT(B.cols(), m);
+        for(int i = 0; i < m; i++){
+            for(int c = 0; c < B.cols(); c++){
+                BT(c, i) = B(i, c);
+            }
+        }
+        substitute(BT, X);
+    }
+}
@@ -0,0 +1,60 @@
+//
+//  QR.hpp
+//
+//  Householder QR factorization and least-squares solves.
+//
+
+#ifndef QR_hpp
+#define QR_hpp
+
+#include "Matrix/Matrix.hpp"
+#include <vector>
+
+namespace MLPP{
+    // Factors the m x n matrix A = QR with Householder reflections, blocked so that most of the work is GEMM.
+    // Q is kept implicitly as its reflectors. Unlike the normal equations, solving through R does not square
+    // the condition number of A.
+    class QR{
+        public:
+            explicit QR(const std::vector<std::vector<double>>& A);
+            explicit QR(const Matrix& A);
+
+            int rows() const { return m; }
+            int cols() const { return n; }
+
+            // True when A has fewer than n independent columns, judged from the diagonal of R relative to its
+            // largest entry. Always true for m < n. Solves of a rank-deficient factorization are filled with NaN.
+            bool rankDeficient() const { return isRankDeficient; }
+
+            // Thin factors: Q is m x min(m, n) with orthonormal columns, R is min(m, n) x n upper triangular.
+            std::vector<std::vector<double>> Q() const;
+            std::vector<std::vector<double>> R() const;
+            const Matrix& triangular() const { return r; }
+
+            // Replaces every row x of X, of length m, with Q x, or Q^T x when transpose is set. Only the first
+            // min(m, n) entries of a row are read when forming Q x.
+            void multiplyQ(Matrix& X, bool transpose = false) const;
+
+            // The x minimizing ||Ax - b||_2. Requires m >= n.
+            std::vector<double> solve(const std::vector<double>& b) const;
+
+            // The same for every column of B at once. B is m x k and the result n x k.
+            std::vector<std::vector<double>> solve(const std::vector<std::vector<double>>& B) const;
+            void solve(const Matrix& B, Matrix& X) const;
+
+        private:
+            void factor(Matrix& AT);
+
+            // Solves R X = (Q^T B) for the k x m block BT holding B transposed; the result goes to X, n x k.
+            void substitute(Matrix& BT, Matrix& X) const;
+
+            int m;
+            int n;
+            Matrix qv;
+            std::vector<double> beta;
+            Matrix r;
+            bool isRankDeficient;
+    };
+}
+
+#endif /* QR_hpp */
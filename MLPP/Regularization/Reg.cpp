@@ -12,6 +12,7 @@
 
 // Revise
 #include <cmath> 
+#include <algorithm>
 
 namespace MLPP{
 
@@ -124,6 +125,36 @@ namespace MLPP{
         return regDeriv;
     }
 
+    void Reg::addRegDerivTerm(const double* weights, double* grad, long n, double lambda, double alpha, const std::string& reg){
+        if(reg == "Ridge"){
+            for(long i = 0; i < n; i++){
+                grad[i] += lambda * weights[i];
+            }
+        }
+        else if(reg == "Lasso" || reg == "ElasticNet"){
+            double l1 = reg == "Lasso" ? lambda : alpha * lambda;
+            double l2 = reg == "Lasso" ? 0 : (1 - alpha) * lambda;
+            for(long i = 0; i < n; i++){
+                double sign = weights[i] < 0 ? -1 : (weights[i] == 0 ? 0 : 1);
+                grad[i] += l1 * sign + l2 * weights[i];
+            }
+        }
+        else if(reg == "WeightClipping"){
+            for(long i = 0; i < n; i++){
+                grad[i] += std::min(std::max(weights[i], lambda), alpha);
+            }
+        }
+    }
+
+    double Reg::regWeight(double weight, double lambda, double alpha, const std::string& reg){
+        if(reg == "WeightClipping"){
+            return std::min(std::max(weight, lambda), alpha);
+        }
+        double grad = 0;
+        addRegDerivTerm(&weight, &grad, 1, lambda, alpha, reg);
+        return weight - grad;
+    }
+
     double Reg::regDerivTerm(std::vector<double> weights, double lambda, double alpha, std::string reg, int j){
         Activation act;
         if(reg == "Ridge"){
@@ -8,6 +8,7 @@
 #define Reg_hpp
 
 #include <vector>
+#include <string>
 
 namespace MLPP{
     class Reg{
@@ -22,6 +23,12 @@ namespace MLPP{
             std::vector<double> regDerivTerm(std::vector<double> weights, double lambda, double alpha, std::string reg);
             std::vector<std::vector<double>> regDerivTerm(std::vector<std::vector<double>>, double lambda, double alpha, std::string reg);
 
+            // Adds regDerivTerm of n contiguous weights onto grad in place, without the per-element copies.
+            void addRegDerivTerm(const double* weights, double* grad, long n, double lambda, double alpha, const std::string& reg);
+
+            // regWeights for a single weight, for the sparse SGD steps that only touch the coordinates a sample uses.
+            double regWeight(double weight, double lambda, double alpha, const std::string& reg);
+
         private:
             double regDerivTerm(std::vector<double> weights, double lambda, double alpha, std::string reg, int j);
             double regDerivTerm(std::vector<std::vector<double>> weights, double lambda, double alpha, std::string reg, int i, int j);
@@ -104,6 +104,37 @@ namespace MLPP{
         forwardPass();
     }
 
+    Hogwild::Report SVC::asyncSGD(double learning_rate, int max_epoch, int threads, bool UI){
+        forwardPass();
+        double cost_prev = Cost(z, outputSet, weights, C);
+
+        // The same step as SGD, but only the coordinates where the sample is nonzero are read, written and
+        // shrunk by the Ridge term, so workers on sparse rows rarely touch the same weights.
+        auto step = [&](int, long, int i){
+            const std::vector<double>& x = inputSet[i];
+            double output = Hogwild::load(bias);
+            for(int j = 0; j < k; j++){
+                if(x[j] != 0){ output += Hogwild::load(weights[j]) * x[j]; }
+            }
+            double costDeriv = 1 - outputSet[i] * output > 0 ? -C * outputSet[i] : 0;
+
+            for(int j = 0; j < k; j++){
+                if(x[j] != 0){
+                    double w = Hogwild::load(weights[j]) - learning_rate * costDeriv * x[j];
+                    Hogwild::store(weights[j], w - learning_rate * w);
+                }
+            }
+            Hogwild::store(bias, Hogwild::load(bias) - learning_rate * costDeriv);
+        };
+        Hogwild::Report report = Hogwild::run(threads, max_epoch, n, step);
+
+        forwardPass();
+        report.costBefore = cost_prev;
+        report.costAfter = Cost(z, outputSet, weights, C);
+        if(UI) { Hogwild::UI(report); }
+        return report;
+    }
+
     void SVC::MBGD(double learning_rate, int max_epoch, int mini_batch_size, bool UI){
         class Cost cost; 
         Activation avn;
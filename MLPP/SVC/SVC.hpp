@@ -10,6 +10,8 @@
 #ifndef SVC_hpp
 #define SVC_hpp
 
+#include "Hogwild/Hogwild.hpp"
+
 
 #include <vector>
 #include <string>
@@ -24,6 +26,8 @@ namespace MLPP {
             double modelTest(std::vector<double> x);
             void gradientDescent(double learning_rate, int max_epoch, bool UI = 1);
             void SGD(double learning_rate, int max_epoch, bool UI = 1);
+            // Lock-free asynchronous SGD, max_epoch steps over the given number of threads. See Hogwild.
+            Hogwild::Report asyncSGD(double learning_rate, int max_epoch, int threads, bool UI = 1);
             void MBGD(double learning_rate, int max_epoch, int mini_batch_size, bool UI = 1);
             double score();
             void save(std::string fileName);
@@ -0,0 +1,214 @@
+//
+//  SVDSolver.cpp
+//
+//  Thin singular value decomposition.
+//
+
+#include "SVDSolver.hpp"
+#include "EigenSolver/EigenSolver.hpp"
+#include "Householder/Householder.hpp"
+#include "QR/QR.hpp"
+#include <cmath>
+#include <limits>
+#include <random>
+#include <algorithm>
+#include <functional>
+
+namespace MLPP{
+
+    namespace {
+        void transposeInto(const Matrix& A, Matrix& AT){
+            AT.resize(A.cols(), A.rows());
+            for(int i = 0; i < A.rows(); i++){
+                for(int j = 0; j < A.cols(); j++){
+                    AT(j, i) = A(i, j);
+                }
+            }
+        }
+
+        // Thin SVD of the p x q matrix A, p >= q, which is overwritten. The r largest singular values go to lambda
+        // and their vectors to the rows of U (r x p) and V (r x q). Returns false if the QL iteration stalled.
+        bool bidiagonalSVD(Matrix& A, int r, std::vector<double>& lambda, Matrix& U, Matrix& V){
+            int p = A.rows();
+            int q = A.cols();
+
+            // A = QL B QR^T with B upper bidiagonal (diagonal d, superdiagonal f). The left reflectors are rows
+            // of L starting at column j, the right ones rows of R starting at column j + 1.
+            std::vector<double> d(q), f(q, 0.0), betaL(q), betaR(std::max(q - 2, 0)), y(q);
+            Matrix L(q, p, 0.0);
+            Matrix R(std::max(q - 2, 0), q, 0.0);
+            for(int j = 0; j < q; j++){
+                double* v = L.row(j) + j;
+                for(int i = j; i < p; i++){
+                    v[i - j] = A(i, j);
+                }
+                d[j] = Householder::reflector(v, p - j, betaL[j]);
+                int len = q - j - 1;
+                if(betaL[j] != 0 && len > 0){
+                    // A[j:, j+1:] -= beta v (v^T A[j:, j+1:])
+                    std::fill(y.begin(), y.begin() + len, 0.0);
+                    for(int i = j; i < p; i++){
+                        const double* row = A.row(i) + j + 1;
+                        double vi = v[i - j];
+                        for(int c = 0; c < len; c++){
+                            y[c] += vi * row[c];
+                        }
+                    }
+                    for(int i = j; i < p; i++){
+                        double* row = A.row(i) + j + 1;
+                        double s = betaL[j] * v[i - j];
+                        for(int c = 0; c < len; c++){
+                            row[c] -= s * y[c];
+                        }
+                    }
+                }
+
+                if(len >= 2){
+                    double* w = R.row(j) + j + 1;
+                    std::copy(A.row(j) + j + 1, A.row(j) + q, w);
+                    f[j] = Householder::reflector(w, len, betaR[j]);
+                    if(betaR[j] != 0){
+                        // A[j+1:, j+1:] -= beta (A[j+1:, j+1:] w) w^T
+                        for(int i = j + 1; i < p; i++){
+                            double* row = A.row(i) + j + 1;
+                            double s = 0;
+                            for(int c = 0; c < len; c++){
+                                s += row[c] * w[c];
+                            }
+                            s *= betaR[j];
+                            for(int c = 0; c < len; c++){
+                                row[c] -= s * w[c];
+                            }
+                        }
+                    }
+                }
+                else if(len == 1){
+                    f[j] = A(j, j + 1);
+                }
+            }
+
+            // The Golub-Kahan tridiagonal acts on (v_0, u_0, v_1, u_1, ...) with off-diagonal d_0, f_0, d_1, f_1, ...
+            // Its eigenvalues are +-sigma_i and the eigenvector for +sigma_i interleaves v_i and u_i.
+            std::vector<double> zero(2 * q, 0.0), e(2 * q, 0.0);
+            for(int i = 0; i < q; i++){
+                e[2 * i] = d[i];
+                if(i + 1 < q){ e[2 * i + 1] = f[i]; }
+            }
+            lambda = zero;
+            std::vector<double> work = e;
+            bool converged = EigenSolver::tridiagonalEigenvalues(lambda, work);
+            std::sort(lambda.begin(), lambda.end(), std::greater<double>());
+            lambda.resize(r);
+            for(int i = 0; i < r; i++){
+                lambda[i] = std::max(lambda[i], 0.0);
+            }
+
+            // Vectors of numerically zero singular values are not resolved by the tridiagonal, whose +-sigma pairs
+            // merge there. Any orthonormal completion is valid for them, so they start random and are orthogonalized.
+            double tol = std::max(p, q) * std::numeric_limits<double>::epsilon() * lambda[0];
+            int nz = 0;
+            while(nz < r && lambda[nz] > tol){
+                nz++;
+            }
+            Matrix Z;
+            EigenSolver::tridiagonalEigenvectors(zero, e, std::vector<double>(lambda.begin(), lambda.begin() + nz), Z);
+
+            V.resize(r, q);
+            V.fill(0);
+            U.resize(r, p);
+            U.fill(0);
+            for(int i = 0; i < nz; i++){
+                for(int j = 0; j < q; j++){
+                    V(i, j) = Z(i, 2 * j);
+                    U(i, j) = Z(i, 2 * j + 1);
+                }
+            }
+            std::mt19937 gen(0);
+            std::uniform_real_distribution<double> dist(-1.0, 1.0);
+            for(int i = nz; i < r; i++){
+                for(int j = 0; j < q; j++){
+                    V(i, j) = dist(gen);
+                    U(i, j) = dist(gen);
+                }
+            }
+            EigenSolver::orthonormalizeRows(V, 0, r);
+            EigenSolver::orthonormalizeRows(U, 0, r);
+
+            Householder::apply(L, betaL, 0, U);
+            Householder::apply(R, betaR, 1, V);
+            return converged;
+        }
+    }
+
+    SVDSolver::SVDSolver(const Matrix& A, int rank)
+    : isConverged(true)
+    {
+        Matrix a;
+        if(A.rows() >= A.cols()){
+            a.resize(A.rows(), A.cols());
+            for(int i = 0; i < A.rows(); i++){
+                std::copy(A.row(i), A.row(i) + A.cols(), a.row(i));
+            }
+        }
+        else{
+            transposeInto(A, a);
+        }
+        compute(a, A.rows() < A.cols(), rank);
+    }
+
+    SVDSolver::SVDSolver(const std::vector<std::vector<double>>& A, int rank)
+    : isConverged(true)
+    {
+        Matrix a(A);
+        if(a.rows() >= a.cols()){
+            compute(a, false, rank);
+        }
+        else{
+            Matrix aT;
+            transposeInto(a, aT);
+            compute(aT, true, rank);
+        }
+    }
+
+    // A is p x q with p >= q. When transposed is set it holds the transpose of the caller's matrix.
+    // Tall matrices are first reduced to their q x q triangular factor, which is then bidiagonalized instead;
+    // 1.6 is the crossover LAPACK uses for the same choice.
+    void SVDSolver::compute(Matrix& A, bool transposed, int rank){
+        int p = A.rows();
+        int q = A.cols();
+        int r = rank <= 0 || rank > q ? q : rank;
+        if(q == 0){
+            left.resize(transposed ? q : p, 0);
+            rightT.resize(0, transposed ? p : q);
+            return;
+        }
+
+        std::vector<double> lambda;
+        Matrix U, V;
+        if(p >= 1.6 * q){
+            QR qr(A);
+            Matrix R = qr.triangular();
+            Matrix UR;
+            isConverged = bidiagonalSVD(R, r, lambda, UR, V);
+            U.resize(r, p);
+            U.fill(0);
+            for(int i = 0; i < r; i++){
+                std::copy(UR.row(i), UR.row(i) + q, U.row(i));
+            }
+            qr.multiplyQ(U);
+        }
+        else{
+            isConverged = bidiagonalSVD(A, r, lambda, U, V);
+        }
+
+        sigma = Vector(std::move(lambda));
+        if(transposed){
+            transposeInto(V, left);
+            rightT = std::move(U);
+        }
+        else{
+            transposeInto(U, left);
+            rightT = std::move(V);
+        }
+    }
+}
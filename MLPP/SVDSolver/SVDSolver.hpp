@@ -0,0 +1,45 @@
+//
+//  SVDSolver.hpp
+//
+//  Thin singular value decomposition.
+//
+
+#ifndef SVDSolver_hpp
+#define SVDSolver_hpp
+
+#include "Matrix/Matrix.hpp"
+#include <vector>
+
+namespace MLPP{
+    // Golub-Kahan bidiagonalization of A followed, as in LAPACK's bdsvdx, by the eigenproblem of the
+    // tridiagonal [0 B^T; B 0] whose positive eigenpairs are the singular triplets of the bidiagonal B.
+    // A is never squared, so small singular values keep their accuracy, and storage is O(mn + min(m, n)^2).
+    class SVDSolver{
+        public:
+            // A = U diag(S) Vt for an m x n matrix A. rank > 0 keeps only the rank largest singular triplets;
+            // otherwise all min(m, n) are kept.
+            explicit SVDSolver(const Matrix& A, int rank = 0);
+            explicit SVDSolver(const std::vector<std::vector<double>>& A, int rank = 0);
+
+            // Sorted in descending order.
+            const Vector& singularValues() const { return sigma; }
+
+            // m x r with orthonormal columns.
+            const Matrix& U() const { return left; }
+
+            // r x n with orthonormal rows.
+            const Matrix& Vt() const { return rightT; }
+
+            bool converged() const { return isConverged; }
+
+        private:
+            void compute(Matrix& A, bool transposed, int rank);
+
+            Vector sigma;
+            Matrix left;
+            Matrix rightT;
+            bool isConverged;
+    };
+}
+
+#endif /* SVDSolver_hpp */
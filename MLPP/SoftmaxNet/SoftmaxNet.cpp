@@ -11,6 +11,7 @@
 #include "Activation/Activation.hpp"
 #include "Utilities/Utilities.hpp"
 #include "Cost/Cost.hpp"
+#include "Checkpoint/Checkpoint.hpp"
 
 #include <iostream>
 #include <random>
@@ -35,6 +36,16 @@ namespace MLPP{
         return Evaluate(X);
     }
 
+    InferenceModel SoftmaxNet::compile(std::string precision) const{
+        InferenceModel model(precision);
+        model.addLayer(weights1, bias1, Activation::Function::Sigmoid);
+        model.addLayer(weights2, bias2, Activation::Function::Softmax);
+        if(precision == "Int8"){
+            model.calibrate(inputSet);
+        }
+        return model;
+    }
+
     void SoftmaxNet::gradientDescent(double learning_rate, int max_epoch, bool UI){
         Activation avn;
         LinAlg alg;
@@ -51,7 +62,7 @@ namespace MLPP{
                     
             // Calculating the weight/bias gradients for layer 2
 
-            std::vector<std::vector<double>> D2_1 = alg.matmult(alg.transpose(a2), error);
+            std::vector<std::vector<double>> D2_1 = alg.transposeMatmult(a2, error);
 
             // weights and bias updation for layer 2
             weights2 = alg.subtraction(weights2, alg.scalarMultiply(learning_rate, D2_1));
@@ -61,11 +72,11 @@ namespace MLPP{
 
             //Calculating the weight/bias for layer 1
 
-            std::vector<std::vector<double>> D1_1 = alg.matmult(error, alg.transpose(weights2));
+            std::vector<std::vector<double>> D1_1 = alg.matmultTranspose(error, weights2);
 
             std::vector<std::vector<double>> D1_2 = alg.hadamard_product(D1_1, avn.sigmoid(z2, 1));
 
-            std::vector<std::vector<double>> D1_3 = alg.matmult(alg.transpose(inputSet), D1_2);
+            std::vector<std::vector<double>> D1_3 = alg.transposeMatmult(inputSet, D1_2);
 
 
             // weight an bias updation for layer 1
@@ -184,7 +195,7 @@ namespace MLPP{
                         
                 // Calculating the weight/bias gradients for layer 2
 
-                std::vector<std::vector<double>> D2_1 = alg.matmult(alg.transpose(a2), error);
+                std::vector<std::vector<double>> D2_1 = alg.transposeMatmult(a2, error);
 
                 // weights and bias updation for layser 2
                 weights2 = alg.subtraction(weights2, alg.scalarMultiply(learning_rate, D2_1));
@@ -195,11 +206,11 @@ namespace MLPP{
 
                 //Calculating the weight/bias for layer 1
 
-                std::vector<std::vector<double>> D1_1 = alg.matmult(error, alg.transpose(weights2));
+                std::vector<std::vector<double>> D1_1 = alg.matmultTranspose(error, weights2);
 
                 std::vector<std::vector<double>> D1_2 = alg.hadamard_product(D1_1, avn.sigmoid(z2, 1));
 
-                std::vector<std::vector<double>> D1_3 = alg.matmult(alg.transpose(inputMiniBatches[i]), D1_2);
+                std::vector<std::vector<double>> D1_3 = alg.transposeMatmult(inputMiniBatches[i], D1_2);
 
 
                 // weight an bias updation for layer 1
@@ -237,6 +248,35 @@ namespace MLPP{
          LinAlg alg; 
      }
 
+    void SoftmaxNet::saveCheckpoint(std::string fileName){
+        Checkpoint::Writer writer("SoftmaxNet");
+        writer.add("weights1", weights1);
+        writer.add("bias1", bias1);
+        writer.add("weights2", weights2);
+        writer.add("bias2", bias2);
+        writer.write(fileName);
+    }
+
+    bool SoftmaxNet::loadCheckpoint(std::string fileName){
+        Checkpoint checkpoint(fileName);
+        if(!checkpoint.valid()){ return false; }
+        if(checkpoint.kind() != "SoftmaxNet"){
+            std::cout << fileName << " is not a SoftmaxNet checkpoint." << std::endl;
+            return false;
+        }
+        if(checkpoint.rows("weights1") != weights1.size() || checkpoint.cols("weights1") != n_hidden || checkpoint.cols("bias1") != bias1.size()
+        || checkpoint.rows("weights2") != weights2.size() || checkpoint.cols("weights2") != weights2[0].size() || checkpoint.cols("bias2") != bias2.size()){
+            std::cout << "The shapes in " << fileName << " do not match this network." << std::endl;
+            return false;
+        }
+        weights1 = checkpoint.matrix("weights1");
+        bias1 = checkpoint.vector("bias1");
+        weights2 = checkpoint.matrix("weights2");
+        bias2 = checkpoint.vector("bias2");
+        forwardPass();
+        return true;
+    }
+
     std::vector<std::vector<double>> SoftmaxNet::getEmbeddings(){
         return weights1;
     }
@@ -8,6 +8,8 @@
 #define SoftmaxNet_hpp
 
 
+#include "InferenceModel/InferenceModel.hpp"
+
 #include <vector>
 #include <string>
 
@@ -25,6 +27,14 @@ namespace MLPP {
             double score();
             void save(std::string fileName);
 
+            // Binary checkpoint of the parameters; see Checkpoint. The network must have been built with the same shape.
+            void saveCheckpoint(std::string fileName);
+            bool loadCheckpoint(std::string fileName);
+
+            // Frozen copy of the current weights for concurrent, allocation-free prediction; see InferenceModel. An "Int8"
+            // model is calibrated on the training inputs.
+            InferenceModel compile(std::string precision = "Double") const;
+
             std::vector<std::vector<double>> getEmbeddings(); // This class is used (mostly) for word2Vec. This function returns our embeddings.
          private:
 
@@ -13,6 +13,8 @@
 
 #include <iostream>
 #include <random>
+#include <cmath>
+#include <algorithm>
 
 namespace MLPP{
     SoftmaxReg::SoftmaxReg(std::vector<std::vector<double>> inputSet, std::vector<std::vector<double>> outputSet, std::string reg, double lambda, double alpha)
@@ -45,7 +47,7 @@ namespace MLPP{
  
                 
             //Calculating the weight gradients
-            std::vector<std::vector<double>> w_gradient = alg.matmult(alg.transpose(inputSet), error);
+            std::vector<std::vector<double>> w_gradient = alg.transposeMatmult(inputSet, error);
                 
             //Weight updation
             weights = alg.subtraction(weights, alg.scalarMultiply(learning_rate, w_gradient));
@@ -113,10 +115,60 @@ namespace MLPP{
 
     }
 
-    void SoftmaxReg::MBGD(double learning_rate, int max_epoch, int mini_batch_size, bool UI){
-        LinAlg alg;
+    Hogwild::Report SoftmaxReg::asyncSGD(double learning_rate, int max_epoch, int threads, bool UI){
         Reg regularization;
-        double cost_prev = 0;
+        forwardPass();
+        double cost_prev = Cost(y_hat, outputSet);
+
+        // The same step as SGD, but only the rows of the weights where the sample is nonzero are read, written and
+        // regularized, so workers on sparse rows rarely touch the same weights. Each worker keeps its own scores.
+        bool regularize = reg != "None";
+        std::vector<std::vector<double>> scores(std::max(threads, 1), std::vector<double>(n_class));
+        auto step = [&](int worker, long, int i){
+            const std::vector<double>& x = inputSet[i];
+            std::vector<double>& p = scores[worker];
+            for(int c = 0; c < n_class; c++){
+                p[c] = Hogwild::load(bias[c]);
+            }
+            for(int j = 0; j < k; j++){
+                if(x[j] != 0){
+                    for(int c = 0; c < n_class; c++){
+                        p[c] += Hogwild::load(weights[j][c]) * x[j];
+                    }
+                }
+            }
+            double max = *std::max_element(p.begin(), p.end());
+            double sum = 0;
+            for(int c = 0; c < n_class; c++){
+                p[c] = std::exp(p[c] - max);
+                sum += p[c];
+            }
+            for(int c = 0; c < n_class; c++){
+                p[c] = p[c] / sum - outputSet[i][c];
+            }
+
+            for(int j = 0; j < k; j++){
+                if(x[j] != 0){
+                    for(int c = 0; c < n_class; c++){
+                        double w = Hogwild::load(weights[j][c]) - learning_rate * x[j] * p[c];
+                        Hogwild::store(weights[j][c], regularize ? regularization.regWeight(w, lambda, alpha, reg) : w);
+                    }
+                }
+            }
+            for(int c = 0; c < n_class; c++){
+                Hogwild::store(bias[c], Hogwild::load(bias[c]) - learning_rate * p[c]);
+            }
+        };
+        Hogwild::Report report = Hogwild::run(threads, max_epoch, n, step);
+
+        forwardPass();
+        report.costBefore = cost_prev;
+        report.costAfter = Cost(y_hat, outputSet);
+        if(UI) { Hogwild::UI(report); }
+        return report;
+    }
+
+    void SoftmaxReg::MBGD(double learning_rate, int max_epoch, int mini_batch_size, bool UI){
         int epoch = 1;
         
         // Creating the mini-batches
@@ -125,26 +177,7 @@ namespace MLPP{
         
         while(true){
             for(int i = 0; i < n_mini_batch; i++){
-                std::vector<std::vector<double>> y_hat = Evaluate(inputMiniBatches[i]);
-                cost_prev = Cost(y_hat, outputMiniBatches[i]);
-                
-                std::vector<std::vector<double>> error = alg.subtraction(y_hat, outputMiniBatches[i]);
-
-                // Calculating the weight gradients
-                std::vector<std::vector<double>> w_gradient = alg.matmult(alg.transpose(inputMiniBatches[i]), error);
-                
-                //Weight updation
-                weights = alg.subtraction(weights, alg.scalarMultiply(learning_rate, w_gradient));
-                weights = regularization.regWeights(weights, lambda, alpha, reg);
-        
-                // Calculating the bias gradients
-                bias = alg.subtractMatrixRows(bias, alg.scalarMultiply(learning_rate, error));
-                y_hat = Evaluate(inputMiniBatches[i]);
-                    
-                if(UI) { 
-                    Utilities::CostInfo(epoch, cost_prev, Cost(y_hat, outputMiniBatches[i]));
-                    Utilities::UI(weights, bias); 
-                }
+                batchStep(inputMiniBatches[i], outputMiniBatches[i], learning_rate, epoch, UI);
             }
             epoch++;
             if(epoch > max_epoch) { break; }
@@ -152,6 +185,46 @@ namespace MLPP{
         forwardPass(); 
     }
 
+    void SoftmaxReg::MBGD(BatchStream& batches, double learning_rate, int max_epoch, bool UI){
+        if(batches.source().inputs() != k || batches.source().outputs() != n_class){
+            std::cout << "The stream's samples do not match the model's " << k << " inputs and " << n_class << " outputs." << std::endl;
+            return;
+        }
+        for(int epoch = 1; epoch <= max_epoch; epoch++){
+            while(const BatchStream::Batch* batch = batches.next()){
+                batchStep(batch->inputs.toStdVector(), batch->outputs.toStdVector(), learning_rate, epoch, UI);
+            }
+        }
+        forwardPass();
+        if(UI) { BatchStream::UI(batches.timing()); }
+    }
+
+    void SoftmaxReg::batchStep(const std::vector<std::vector<double>>& X, const std::vector<std::vector<double>>& Y, double learning_rate, int epoch, bool UI){
+        LinAlg alg;
+        Reg regularization;
+
+        std::vector<std::vector<double>> y_hat = Evaluate(X);
+        double cost_prev = Cost(y_hat, Y);
+        
+        std::vector<std::vector<double>> error = alg.subtraction(y_hat, Y);
+
+        // Calculating the weight gradients
+        std::vector<std::vector<double>> w_gradient = alg.transposeMatmult(X, error);
+        
+        //Weight updation
+        weights = alg.subtraction(weights, alg.scalarMultiply(learning_rate, w_gradient));
+        weights = regularization.regWeights(weights, lambda, alpha, reg);
+
+        // Calculating the bias gradients
+        bias = alg.subtractMatrixRows(bias, alg.scalarMultiply(learning_rate, error));
+        y_hat = Evaluate(X);
+            
+        if(UI) { 
+            Utilities::CostInfo(epoch, cost_prev, Cost(y_hat, Y));
+            Utilities::UI(weights, bias); 
+        }
+    }
+
     double SoftmaxReg::score(){
         Utilities util;
         return util.performance(y_hat, outputSet);
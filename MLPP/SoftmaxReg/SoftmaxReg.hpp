@@ -7,6 +7,9 @@
 #ifndef SoftmaxReg_hpp
 #define SoftmaxReg_hpp
 
+#include "Hogwild/Hogwild.hpp"
+#include "DataSource/DataSource.hpp"
+
 
 #include <vector>
 #include <string>
@@ -21,7 +24,13 @@ namespace MLPP {
             std::vector<std::vector<double>> modelSetTest(std::vector<std::vector<double>> X);
             void gradientDescent(double learning_rate, int max_epoch, bool UI = 1);
             void SGD(double learning_rate, int max_epoch, bool UI = 1);
+            // Lock-free asynchronous SGD, max_epoch steps over the given number of threads. See Hogwild.
+            Hogwild::Report asyncSGD(double learning_rate, int max_epoch, int threads, bool UI = 1);
             void MBGD(double learning_rate, int max_epoch, int mini_batch_size, bool UI = 1);
+            // The same, on the batches of a stream, one pass of which is an epoch. The outputs are one-hot rows, such as
+            // those of a MemorySource over class labels. Each batch is converted to nested vectors on the training
+            // thread, so that copy counts as compute in the stream's Timing, which UI ends with.
+            void MBGD(BatchStream& batches, double learning_rate, int max_epoch, bool UI = 1);
             double score();
             void save(std::string fileName);
         private:
@@ -31,6 +40,8 @@ namespace MLPP {
             std::vector<std::vector<double>> Evaluate(std::vector<std::vector<double>> X);
             std::vector<double> Evaluate(std::vector<double> x);
             void forwardPass();
+            // One MBGD step on a mini-batch.
+            void batchStep(const std::vector<std::vector<double>>& X, const std::vector<std::vector<double>>& Y, double learning_rate, int epoch, bool UI);
         
             std::vector<std::vector<double>> inputSet;
             std::vector<std::vector<double>> outputSet;
@@ -0,0 +1,134 @@
+//
+//  ThreadPool.cpp
+//
+//  Library-wide worker pool used to split large LinAlg kernels across cores.
+//
+
+#include "ThreadPool.hpp"
+#include <algorithm>
+#include <cstdlib>
+
+namespace MLPP{
+    namespace {
+        thread_local bool insideChunk = false;
+
+        int defaultThreadCount(){
+            if(const char* env = std::getenv("MLPP_NUM_THREADS")){
+                int n = std::atoi(env);
+                if(n > 0){ return n; }
+            }
+            return std::max(1u, std::thread::hardware_concurrency());
+        }
+    }
+
+    ThreadPool::ThreadPool(int n)
+    : threadCount(1), body(nullptr), n_items(0), n_chunks(0), nextChunk(0), finishedChunks(0), generation(0), stopping(false)
+    {
+        start(n);
+    }
+
+    ThreadPool::~ThreadPool(){
+        stop();
+    }
+
+    ThreadPool& ThreadPool::instance(){
+        static ThreadPool pool(defaultThreadCount());
+        return pool;
+    }
+
+    void ThreadPool::setNumThreads(int n){
+        ThreadPool& pool = instance();
+        std::lock_guard<std::mutex> guard(pool.dispatchMutex);
+        pool.stop();
+        pool.start(std::max(1, n));
+    }
+
+    int ThreadPool::numThreads(){
+        return instance().threadCount.load(std::memory_order_relaxed);
+    }
+
+    void ThreadPool::start(int n){
+        stopping = false;
+        for(int i = 0; i < n - 1; i++){
+            workers.emplace_back(&ThreadPool::workerLoop, this);
+        }
+        threadCount.store(int(workers.size()) + 1, std::memory_order_relaxed); // The dispatching thread works too.
+    }
+
+    void ThreadPool::stop(){
+        {
+            std::lock_guard<std::mutex> lock(mutex);
+            stopping = true;
+        }
+        wake.notify_all();
+        for(int i = 0; i < workers.size(); i++){
+            workers[i].join();
+        }
+        workers.clear();
+    }
+
+    void ThreadPool::parallelFor(long n, long minChunk, const std::function<void(long, long)>& body){
+        if(n <= 0){ return; }
+        ThreadPool& pool = instance();
+        int chunks = int(std::min<long>(numThreads(), n / std::max(1L, minChunk)));
+        if(chunks <= 1 || insideChunk){
+            body(0, n);
+            return;
+        }
+        std::unique_lock<std::mutex> dispatch(pool.dispatchMutex, std::try_to_lock);
+        if(!dispatch.owns_lock()){
+            body(0, n);
+            return;
+        }
+
+        {
+            std::lock_guard<std::mutex> lock(pool.mutex);
+            pool.body = &body;
+            pool.n_items = n;
+            pool.n_chunks = chunks;
+            pool.nextChunk = 0;
+            pool.finishedChunks = 0;
+            pool.generation++;
+        }
+        pool.wake.notify_all();
+        pool.runChunks();
+
+        std::unique_lock<std::mutex> lock(pool.mutex);
+        pool.done.wait(lock, [&pool]{ return pool.finishedChunks == pool.n_chunks; });
+        pool.body = nullptr;
+    }
+
+    void ThreadPool::runChunks(){
+        while(true){
+            int chunk;
+            {
+                std::lock_guard<std::mutex> lock(mutex);
+                if(body == nullptr || nextChunk >= n_chunks){ return; }
+                chunk = nextChunk++;
+            }
+            long begin = n_items * chunk / n_chunks;
+            long end = n_items * (chunk + 1) / n_chunks;
+            insideChunk = true;
+            (*body)(begin, end);
+            insideChunk = false;
+            {
+                std::lock_guard<std::mutex> lock(mutex);
+                finishedChunks++;
+                if(finishedChunks == n_chunks){ done.notify_all(); }
+            }
+        }
+    }
+
+    void ThreadPool::workerLoop(){
+        long seen = 0;
+        while(true){
+            {
+                std::unique_lock<std::mutex> lock(mutex);
+                wake.wait(lock, [this, seen]{ return stopping || generation != seen; });
+                if(stopping){ return; }
+                seen = generation;
+            }
+            runChunks();
+        }
+    }
+}
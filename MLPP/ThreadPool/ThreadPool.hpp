@@ -0,0 +1,61 @@
+//
+//  ThreadPool.hpp
+//
+//  Library-wide worker pool used to split large LinAlg kernels across cores.
+//
+
+#ifndef ThreadPool_hpp
+#define ThreadPool_hpp
+
+#include <atomic>
+#include <condition_variable>
+#include <functional>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+namespace MLPP{
+    class ThreadPool{
+        public:
+            // The pool starts with MLPP_NUM_THREADS workers if that variable is set, and otherwise one per hardware thread.
+            // A count of 1 turns every parallelFor into a plain loop on the calling thread.
+            static void setNumThreads(int n);
+            static int numThreads();
+
+            // Splits [0, n) into at most numThreads() contiguous chunks of at least minChunk items and runs body(begin, end)
+            // on each, returning once all chunks are done. Chunk boundaries depend only on n, minChunk and the thread count,
+            // so a given configuration always partitions work the same way. Calls made from inside a chunk, or while
+            // another thread is already dispatching, run inline.
+            static void parallelFor(long n, long minChunk, const std::function<void(long, long)>& body);
+
+            ~ThreadPool();
+
+        private:
+            explicit ThreadPool(int n);
+            static ThreadPool& instance();
+
+            void start(int n);
+            void stop();
+            void workerLoop();
+            void runChunks();
+
+            std::vector<std::thread> workers;
+            // workers.size() + 1, readable without a lock while setNumThreads rebuilds the workers. Chunks ask for the
+            // count while their dispatcher holds dispatchMutex, so that mutex cannot guard it.
+            std::atomic<int> threadCount;
+            std::mutex dispatchMutex;
+            std::mutex mutex;
+            std::condition_variable wake;
+            std::condition_variable done;
+
+            const std::function<void(long, long)>* body;
+            long n_items;
+            int n_chunks;
+            int nextChunk;
+            int finishedChunks;
+            long generation;
+            bool stopping;
+    };
+}
+
+#endif /* ThreadPool_hpp */
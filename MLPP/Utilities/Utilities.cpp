@@ -280,7 +280,7 @@ namespace MLPP{
         std::cout << Cost << std::endl;
     }
 
-    std::vector<std::vector<std::vector<double>>> Utilities::createMiniBatches(std::vector<std::vector<double>> inputSet, int n_mini_batch){
+    std::vector<std::vector<std::vector<double>>> Utilities::createMiniBatches(const std::vector<std::vector<double>>& inputSet, int n_mini_batch){
         int n = inputSet.size();
         
         std::vector<std::vector<std::vector<double>>> inputMiniBatches; 
@@ -302,7 +302,7 @@ namespace MLPP{
         return inputMiniBatches;
     }
 
-    std::tuple<std::vector<std::vector<std::vector<double>>>, std::vector<std::vector<double>>> Utilities::createMiniBatches(std::vector<std::vector<double>> inputSet, std::vector<double> outputSet, int n_mini_batch){
+    std::tuple<std::vector<std::vector<std::vector<double>>>, std::vector<std::vector<double>>> Utilities::createMiniBatches(const std::vector<std::vector<double>>& inputSet, const std::vector<double>& outputSet, int n_mini_batch){
         int n = inputSet.size();
         
         std::vector<std::vector<std::vector<double>>> inputMiniBatches; 
@@ -328,7 +328,7 @@ namespace MLPP{
         return {inputMiniBatches, outputMiniBatches};
     }
 
-    std::tuple<std::vector<std::vector<std::vector<double>>>, std::vector<std::vector<std::vector<double>>>> Utilities::createMiniBatches(std::vector<std::vector<double>> inputSet, std::vector<std::vector<double>> outputSet, int n_mini_batch){
+    std::tuple<std::vector<std::vector<std::vector<double>>>, std::vector<std::vector<std::vector<double>>>> Utilities::createMiniBatches(const std::vector<std::vector<double>>& inputSet, const std::vector<std::vector<double>>& outputSet, int n_mini_batch){
         int n = inputSet.size();
         
         std::vector<std::vector<std::vector<double>>> inputMiniBatches; 
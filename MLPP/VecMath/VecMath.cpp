@@ -0,0 +1,503 @@
+//
+//  VecMath.cpp
+//
+//  Vectorized element-wise math on contiguous buffers.
+//
+
+#include "VecMath.hpp"
+#include <algorithm>
+#include <atomic>
+#include <cmath>
+#include <cstring>
+#include <limits>
+
+#if defined(__x86_64__) || defined(__i386__)
+#include <immintrin.h>
+#define MLPP_VECMATH_X86
+#endif
+
+// The vector helpers are all inlined into their entry points, so the ABI of returning AVX types is moot.
+#pragma GCC diagnostic ignored "-Wpsabi"
+
+namespace MLPP{
+    namespace {
+        enum UnaryOp { Exp, Log, Sqrt, Erf, Abs, Sigmoid, Tanh, Softplus, Gelu, Swish, Mish };
+        enum BinaryOp { Hadamard, Max };
+        enum ScalarOp { Scale, Shift };
+
+        const double GELU_SCALE = 0.79788456080286535588; // sqrt(2 / pi)
+
+        double sigmoidRef(double x){
+            double e = std::exp(-std::abs(x));
+            return x >= 0 ? 1 / (1 + e) : e / (1 + e);
+        }
+        double softplusRef(double x){ return std::max(x, 0.0) + std::log1p(std::exp(-std::abs(x))); }
+
+        void scalarUnary(UnaryOp op, const double* x, double* y, long n){
+            for(long i = 0; i < n; i++){
+                double v = x[i];
+                switch(op){
+                    case Exp: y[i] = std::exp(v); break;
+                    case Log: y[i] = std::log(v); break;
+                    case Sqrt: y[i] = std::sqrt(v); break;
+                    case Erf: y[i] = std::erf(v); break;
+                    case Abs: y[i] = std::abs(v); break;
+                    case Sigmoid: y[i] = sigmoidRef(v); break;
+                    case Tanh: y[i] = std::tanh(v); break;
+                    case Softplus: y[i] = softplusRef(v); break;
+                    case Gelu: y[i] = v * sigmoidRef(2 * GELU_SCALE * (v + 0.044715 * v * v * v)); break;
+                    case Swish: y[i] = v * sigmoidRef(v); break;
+                    case Mish: y[i] = v * std::tanh(softplusRef(v)); break;
+                }
+            }
+        }
+
+        void scalarBinary(BinaryOp op, const double* a, const double* b, double* c, long n){
+            for(long i = 0; i < n; i++){
+                c[i] = op == Hadamard ? a[i] * b[i] : (a[i] >= b[i] ? a[i] : b[i]);
+            }
+        }
+
+        void scalarScalar(ScalarOp op, double alpha, const double* x, double* y, long n){
+            for(long i = 0; i < n; i++){
+                y[i] = op == Scale ? alpha * x[i] : alpha + x[i];
+            }
+        }
+
+        #ifdef MLPP_VECMATH_X86
+
+        // The math is written once against GCC's generic vector types. Every template below is always inlined,
+        // so it is compiled for AVX2 or AVX-512 by the target attribute of the entry point it ends up in.
+        typedef double Vec4 __attribute__((vector_size(32)));
+        typedef long long Int4 __attribute__((vector_size(32)));
+        typedef unsigned long long Bits4 __attribute__((vector_size(32)));
+        typedef double Vec8 __attribute__((vector_size(64)));
+        typedef long long Int8 __attribute__((vector_size(64)));
+        typedef unsigned long long Bits8 __attribute__((vector_size(64)));
+
+        template <class V> struct Lanes;
+        template <> struct Lanes<Vec4>{ typedef Int4 Int; typedef Bits4 Bits; };
+        template <> struct Lanes<Vec8>{ typedef Int8 Int; typedef Bits8 Bits; };
+
+        #define MLPP_VECMATH_INLINE inline __attribute__((always_inline))
+
+        const double LOG2E = 1.44269504088896338700;
+        // ln 2 split so that k * LN2_HI is exact for every exponent k a double can have.
+        const double LN2_HI = 6.93147180369123816490e-01;
+        const double LN2_LO = 1.90821492927058770002e-10;
+        // Adding 1.5 * 2^52 rounds to an integer, which then sits in the low bits of the sum.
+        const double SHIFTER = 0x1.8p52;
+        const long long SIGN = (long long)0x8000000000000000ULL;
+
+        // 1/13!, ..., 1/2!: the Taylor series of (e^r - 1 - r) / r^2, truncated below 2^-60 for |r| <= ln2 / 2.
+        const double EXPM1_SERIES[12] = {
+            1.0 / 6227020800, 1.0 / 479001600, 1.0 / 39916800, 1.0 / 3628800, 1.0 / 362880, 1.0 / 40320,
+            1.0 / 5040, 1.0 / 720, 1.0 / 120, 1.0 / 24, 1.0 / 6, 1.0 / 2
+        };
+
+        // 2/23, ..., 2/3: the series of (2 atanh(s) - 2s) / s^3 in z = s^2, truncated below 2^-60 for s^2 <= 0.0295.
+        const double LOG_SERIES[11] = {
+            2.0 / 23, 2.0 / 21, 2.0 / 19, 2.0 / 17, 2.0 / 15, 2.0 / 13, 2.0 / 11, 2.0 / 9, 2.0 / 7, 2.0 / 5, 2.0 / 3
+        };
+
+        // erf(x) / x in u - 1/2, u = x^2, for |x| < 1, and erfc(x) e^(x^2) in x - 3.45 for 1 <= x <= 5.9.
+        // Chebyshev interpolants computed in quadruple precision; past 5.9, erf(x) rounds to 1.
+        const double ERF_SMALL[12] = {
+            -7.7958988270021425e-10, 9.432320191926508e-09, -1.0420387617195658e-07,
+            1.0536323840680666e-06, -9.6148086413901952e-06, 7.829649688379886e-05,
+            -0.00056118942212096635, 0.003480274496570158, -0.018283884489152684,
+            0.079409986755936871, -0.28107217804543422, 0.96546873866986727
+        };
+        const double ERFCX[27] = {
+            9.957076706054683e-19, -5.8937609443127525e-18, -5.7907509969157874e-18,
+            3.8213973692065798e-17, 4.793291999472179e-16, -2.7310081883585088e-15,
+            7.7565427185034006e-15, -4.0891484366005813e-14, 2.6453362850110405e-13,
+            -1.3908479481648866e-12, 6.972713627770722e-12, -3.5505329544823454e-11,
+            1.7891961420109785e-10, -8.8462221422938741e-10, 4.302987871176545e-09,
+            -2.0593298042561123e-08, 9.6866872017236077e-08, -4.4745650705247173e-07,
+            2.0280572880548972e-06, -9.0103497251411197e-06, 3.9197936935665741e-05,
+            -0.00016676910754454533, 0.00069294723141331447, -0.002807590716964071,
+            0.011072082436420029, -0.04241007048112224, 0.15738682559628858
+        };
+
+        template <class V>
+        MLPP_VECMATH_INLINE V splat(double a){
+            return V{} + a;
+        }
+
+        template <class V, int N>
+        MLPP_VECMATH_INLINE V horner(const V& x, const double (&c)[N]){
+            V p = splat<V>(c[0]);
+            for(int i = 1; i < N; i++){
+                p = p * x + c[i];
+            }
+            return p;
+        }
+
+        template <class V>
+        MLPP_VECMATH_INLINE V absV(const V& x){
+            typedef typename Lanes<V>::Int I;
+            return (V)((I)x & ~SIGN);
+        }
+
+        template <class V>
+        MLPP_VECMATH_INLINE V copySign(const V& magnitude, const V& sign){
+            typedef typename Lanes<V>::Int I;
+            return (V)(((I)magnitude & ~SIGN) | ((I)sign & SIGN));
+        }
+
+        // x = k ln2 + r with |r| <= ln2 / 2; k comes back as an integral double.
+        template <class V>
+        MLPP_VECMATH_INLINE V reduce(const V& x, V& k){
+            V t = x * LOG2E + SHIFTER;
+            k = t - SHIFTER;
+            return (x - k * LN2_HI) - k * LN2_LO;
+        }
+
+        // 2^k for integral k in [-1022, 1023], built directly in the exponent field.
+        template <class V>
+        MLPP_VECMATH_INLINE V pow2(const V& k){
+            typedef typename Lanes<V>::Int I;
+            I e = (I)(k + SHIFTER) - (I)splat<V>(SHIFTER);
+            return (V)((e + 1023) << 52);
+        }
+
+        // Exact conversion of small integers, avoiding the 64-bit conversion that AVX2 lacks.
+        template <class V>
+        MLPP_VECMATH_INLINE V toDouble(const typename Lanes<V>::Int& e){
+            typedef typename Lanes<V>::Int I;
+            return (V)(e + (I)splat<V>(SHIFTER)) - SHIFTER;
+        }
+
+        template <class V>
+        MLPP_VECMATH_INLINE V expm1Reduced(const V& r){
+            return r + r * r * horner(r, EXPM1_SERIES);
+        }
+
+        template <class V>
+        MLPP_VECMATH_INLINE V expV(const V& in){
+            V x = in < -746.0 ? splat<V>(-746) : in;
+            x = x > 710.0 ? splat<V>(710) : x;
+            V k;
+            V r = reduce(x, k);
+            // Scaling in two halves keeps each factor normal, so subnormal results are rounded only once.
+            V k1 = (k * 0.5 + SHIFTER) - SHIFTER;
+            return (expm1Reduced(r) + 1) * pow2(k1) * pow2(k - k1);
+        }
+
+        // Only for 0 <= x <= 700, where 2^k stays normal.
+        template <class V>
+        MLPP_VECMATH_INLINE V expm1V(const V& x){
+            V k;
+            V r = reduce(x, k);
+            V s = pow2(k);
+            return s * expm1Reduced(r) + (s - 1);
+        }
+
+        // fdlibm's reduction: x = 2^e m with sqrt(1/2) <= m < sqrt(2), and log(m) = 2 atanh(f / (2 + f)), f = m - 1.
+        template <class V>
+        MLPP_VECMATH_INLINE V logV(const V& x){
+            typedef typename Lanes<V>::Int I;
+            typedef typename Lanes<V>::Bits B;
+            I subnormal = x < 0x1p-1022;
+            V xs = subnormal ? x * 0x1p54 : x;
+            I bits = (I)xs;
+            I e = (I)(((B)bits >> 52) & 0x7ff) - 1023 - (subnormal & 54);
+            V m = (V)((bits & 0x000fffffffffffffLL) | 0x3ff0000000000000LL);
+            I high = m > M_SQRT2;
+            m = high ? m * 0.5 : m;
+            e -= high;
+            V f = m - 1;
+            V s = f / (f + 2);
+            V z = s * s;
+            V R = z * horner(z, LOG_SERIES);
+            V hfsq = 0.5 * f * f;
+            V dk = toDouble<V>(e);
+            V y = dk * LN2_HI - ((hfsq - (s * (hfsq + R) + dk * LN2_LO)) - f);
+            y = x == 0.0 ? splat<V>(-std::numeric_limits<double>::infinity()) : y;
+            y = x < 0.0 ? splat<V>(std::numeric_limits<double>::quiet_NaN()) : y;
+            y = x == std::numeric_limits<double>::infinity() ? x : y;
+            return x != x ? x : y;
+        }
+
+        template <class V>
+        MLPP_VECMATH_INLINE V erfV(const V& x){
+            V a = absV(x);
+            V small = a * horner(a * a - 0.5, ERF_SMALL);
+            V b = a > 5.9 ? splat<V>(5.9) : a;
+            V large = 1 - expV(-(b * b)) * horner(b - 3.45, ERFCX);
+            // Past 5.92 erfc(x) is under half an ulp of 1.
+            large = a > 5.92 ? splat<V>(1) : large;
+            return copySign(a < 1.0 ? small : large, x);
+        }
+
+        // e^-|x| never overflows, so the far negative tail keeps its tiny values instead of collapsing to 0.
+        template <class V>
+        MLPP_VECMATH_INLINE V sigmoidV(const V& x){
+            V e = expV(-absV(x));
+            V r = 1 / (1 + e);
+            return x >= 0.0 ? r : e * r;
+        }
+
+        // tanh |x| = t / (t + 2) with t = e^(2|x|) - 1, which keeps full relative accuracy near 0.
+        // Past |x| = 20, tanh rounds to +-1.
+        template <class V>
+        MLPP_VECMATH_INLINE V tanhV(const V& x){
+            V a = absV(x);
+            a = a > 20.0 ? splat<V>(20) : a;
+            V t = expm1V(2 * a);
+            return copySign(t / (t + 2), x);
+        }
+
+        // log(1 + e^x) = max(x, 0) + log1p(e^-|x|), with log1p from log and the usual correction term.
+        template <class V>
+        MLPP_VECMATH_INLINE V softplusV(const V& x){
+            V e = expV(-absV(x));
+            V w = 1 + e;
+            V l = logV(w) + (e - (w - 1)) / w;
+            return (x > 0.0 ? x : V{}) + l;
+        }
+
+        // 0.5 x (1 + tanh(u)) is x sigmoid(2u), which needs one exp instead of a tanh.
+        template <class V>
+        MLPP_VECMATH_INLINE V geluV(const V& x){
+            return x * sigmoidV(2 * GELU_SCALE * (x + 0.044715 * x * x * x));
+        }
+
+        template <class V>
+        MLPP_VECMATH_INLINE V swishV(const V& x){
+            return x * sigmoidV(x);
+        }
+
+        // tanh(log(1 + e^x)) = n / (n + 2) with n = e^x (e^x + 2). Past x = 20 it rounds to 1.
+        template <class V>
+        MLPP_VECMATH_INLINE V mishV(const V& x){
+            V e = expV(x);
+            V n = e * (e + 2);
+            return x > 20.0 ? x : x * n / (n + 2);
+        }
+
+        template <class V>
+        MLPP_VECMATH_INLINE V hadamardV(const V& a, const V& b){
+            return a * b;
+        }
+
+        template <class V>
+        MLPP_VECMATH_INLINE V maxV(const V& a, const V& b){
+            return a >= b ? a : b;
+        }
+
+        // Full registers first; the tail goes through the same code in a zero-padded register, so an element's
+        // result never depends on where it sits in the buffer.
+        template <class V, V (*F)(const V&)>
+        MLPP_VECMATH_INLINE void mapArray(const double* x, double* y, long n){
+            const int W = sizeof(V) / sizeof(double);
+            long i = 0;
+            for(; i + W <= n; i += W){
+                V v;
+                std::memcpy(&v, x + i, sizeof(V));
+                v = F(v);
+                std::memcpy(y + i, &v, sizeof(V));
+            }
+            if(i < n){
+                V v = V{};
+                std::memcpy(&v, x + i, (n - i) * sizeof(double));
+                v = F(v);
+                std::memcpy(y + i, &v, (n - i) * sizeof(double));
+            }
+        }
+
+        template <class V, V (*F)(const V&, const V&)>
+        MLPP_VECMATH_INLINE void zipArrays(const double* a, const double* b, double* c, long n){
+            const int W = sizeof(V) / sizeof(double);
+            long i = 0;
+            for(; i + W <= n; i += W){
+                V u, v;
+                std::memcpy(&u, a + i, sizeof(V));
+                std::memcpy(&v, b + i, sizeof(V));
+                u = F(u, v);
+                std::memcpy(c + i, &u, sizeof(V));
+            }
+            for(; i < n; i++){
+                c[i] = F(splat<V>(a[i]), splat<V>(b[i]))[0];
+            }
+        }
+
+        template <class V>
+        MLPP_VECMATH_INLINE void scalarArray(ScalarOp op, double alpha, const double* x, double* y, long n){
+            const int W = sizeof(V) / sizeof(double);
+            long i = 0;
+            for(; i + W <= n; i += W){
+                V v;
+                std::memcpy(&v, x + i, sizeof(V));
+                v = op == Scale ? alpha * v : alpha + v;
+                std::memcpy(y + i, &v, sizeof(V));
+            }
+            for(; i < n; i++){
+                y[i] = op == Scale ? alpha * x[i] : alpha + x[i];
+            }
+        }
+
+        template <class V>
+        MLPP_VECMATH_INLINE void unaryArray(UnaryOp op, const double* x, double* y, long n){
+            switch(op){
+                case Exp: mapArray<V, expV<V>>(x, y, n); break;
+                case Log: mapArray<V, logV<V>>(x, y, n); break;
+                case Erf: mapArray<V, erfV<V>>(x, y, n); break;
+                case Abs: mapArray<V, absV<V>>(x, y, n); break;
+                case Sigmoid: mapArray<V, sigmoidV<V>>(x, y, n); break;
+                case Tanh: mapArray<V, tanhV<V>>(x, y, n); break;
+                case Softplus: mapArray<V, softplusV<V>>(x, y, n); break;
+                case Gelu: mapArray<V, geluV<V>>(x, y, n); break;
+                case Swish: mapArray<V, swishV<V>>(x, y, n); break;
+                case Mish: mapArray<V, mishV<V>>(x, y, n); break;
+                case Sqrt: break;
+            }
+        }
+
+        template <class V>
+        MLPP_VECMATH_INLINE void binaryArray(BinaryOp op, const double* a, const double* b, double* c, long n){
+            if(op == Hadamard){
+                zipArrays<V, hadamardV<V>>(a, b, c, n);
+            }
+            else{
+                zipArrays<V, maxV<V>>(a, b, c, n);
+            }
+        }
+
+        // Entry points. sqrt is a single instruction, so it is issued directly rather than through the templates.
+        __attribute__((target("avx2,fma")))
+        void avx2Unary(UnaryOp op, const double* x, double* y, long n){
+            if(op != Sqrt){
+                unaryArray<Vec4>(op, x, y, n);
+                return;
+            }
+            long i = 0;
+            for(; i + 4 <= n; i += 4){
+                _mm256_storeu_pd(y + i, _mm256_sqrt_pd(_mm256_loadu_pd(x + i)));
+            }
+            for(; i < n; i++){
+                y[i] = std::sqrt(x[i]);
+            }
+        }
+
+        __attribute__((target("avx2,fma")))
+        void avx2Binary(BinaryOp op, const double* a, const double* b, double* c, long n){
+            binaryArray<Vec4>(op, a, b, c, n);
+        }
+
+        __attribute__((target("avx2,fma")))
+        void avx2Scalar(ScalarOp op, double alpha, const double* x, double* y, long n){
+            scalarArray<Vec4>(op, alpha, x, y, n);
+        }
+
+        __attribute__((target("avx512f")))
+        void avx512Unary(UnaryOp op, const double* x, double* y, long n){
+            if(op != Sqrt){
+                unaryArray<Vec8>(op, x, y, n);
+                return;
+            }
+            long i = 0;
+            for(; i + 8 <= n; i += 8){
+                _mm512_storeu_pd(y + i, _mm512_sqrt_pd(_mm512_loadu_pd(x + i)));
+            }
+            for(; i < n; i++){
+                y[i] = std::sqrt(x[i]);
+            }
+        }
+
+        __attribute__((target("avx512f")))
+        void avx512Binary(BinaryOp op, const double* a, const double* b, double* c, long n){
+            binaryArray<Vec8>(op, a, b, c, n);
+        }
+
+        __attribute__((target("avx512f")))
+        void avx512Scalar(ScalarOp op, double alpha, const double* x, double* y, long n){
+            scalarArray<Vec8>(op, alpha, x, y, n);
+        }
+        #endif
+
+        VecMath::Kernel bestKernel(){
+            #ifdef MLPP_VECMATH_X86
+            __builtin_cpu_init();
+            if(__builtin_cpu_supports("avx512f")){ return VecMath::AVX512; }
+            if(__builtin_cpu_supports("avx2") && __builtin_cpu_supports("fma")){ return VecMath::AVX2; }
+            #endif
+            return VecMath::Scalar;
+        }
+
+        std::atomic<int> activeKernel(VecMath::Auto);
+
+        void unary(UnaryOp op, const double* x, double* y, long n){
+            switch(VecMath::kernel()){
+                #ifdef MLPP_VECMATH_X86
+                case VecMath::AVX512: avx512Unary(op, x, y, n); return;
+                case VecMath::AVX2: avx2Unary(op, x, y, n); return;
+                #endif
+                default: scalarUnary(op, x, y, n);
+            }
+        }
+
+        void binary(BinaryOp op, const double* a, const double* b, double* c, long n){
+            switch(VecMath::kernel()){
+                #ifdef MLPP_VECMATH_X86
+                case VecMath::AVX512: avx512Binary(op, a, b, c, n); return;
+                case VecMath::AVX2: avx2Binary(op, a, b, c, n); return;
+                #endif
+                default: scalarBinary(op, a, b, c, n);
+            }
+        }
+
+        void withScalar(ScalarOp op, double alpha, const double* x, double* y, long n){
+            switch(VecMath::kernel()){
+                #ifdef MLPP_VECMATH_X86
+                case VecMath::AVX512: avx512Scalar(op, alpha, x, y, n); return;
+                case VecMath::AVX2: avx2Scalar(op, alpha, x, y, n); return;
+                #endif
+                default: scalarScalar(op, alpha, x, y, n);
+            }
+        }
+    }
+
+    void VecMath::exp(const double* x, double* y, long n){ unary(Exp, x, y, n); }
+    void VecMath::log(const double* x, double* y, long n){ unary(Log, x, y, n); }
+    void VecMath::sqrt(const double* x, double* y, long n){ unary(Sqrt, x, y, n); }
+    void VecMath::erf(const double* x, double* y, long n){ unary(Erf, x, y, n); }
+    void VecMath::abs(const double* x, double* y, long n){ unary(Abs, x, y, n); }
+    void VecMath::sigmoid(const double* x, double* y, long n){ unary(Sigmoid, x, y, n); }
+    void VecMath::tanh(const double* x, double* y, long n){ unary(Tanh, x, y, n); }
+    void VecMath::softplus(const double* x, double* y, long n){ unary(Softplus, x, y, n); }
+    void VecMath::GELU(const double* x, double* y, long n){ unary(Gelu, x, y, n); }
+    void VecMath::swish(const double* x, double* y, long n){ unary(Swish, x, y, n); }
+    void VecMath::mish(const double* x, double* y, long n){ unary(Mish, x, y, n); }
+
+    void VecMath::hadamard(const double* a, const double* b, double* c, long n){ binary(Hadamard, a, b, c, n); }
+    void VecMath::max(const double* a, const double* b, double* c, long n){ binary(Max, a, b, c, n); }
+
+    void VecMath::scale(double alpha, const double* x, double* y, long n){ withScalar(Scale, alpha, x, y, n); }
+    void VecMath::shift(double alpha, const double* x, double* y, long n){ withScalar(Shift, alpha, x, y, n); }
+
+    void VecMath::setKernel(Kernel kernel){
+        if(kernel != Auto){
+            kernel = Kernel(std::min<int>(kernel, bestKernel()));
+        }
+        activeKernel = kernel;
+    }
+
+    VecMath::Kernel VecMath::kernel(){
+        int kernel = activeKernel;
+        if(kernel == Auto){
+            static const Kernel best = bestKernel();
+            return best;
+        }
+        return Kernel(kernel);
+    }
+
+    std::string VecMath::kernelName(){
+        switch(kernel()){
+            case AVX512: return "AVX-512";
+            case AVX2: return "AVX2";
+            default: return "Scalar";
+        }
+    }
+}
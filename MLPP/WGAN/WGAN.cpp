@@ -10,13 +10,14 @@
 #include "Regularization/Reg.hpp"
 #include "Utilities/Utilities.hpp"
 #include "Cost/Cost.hpp"
+#include "Checkpoint/Checkpoint.hpp"
 
 #include <iostream>
 #include <cmath>
 
 namespace MLPP {
     WGAN::WGAN(double k, std::vector<std::vector<double>> outputSet)
-    : outputSet(outputSet), n(outputSet.size()), k(k)
+    : outputSet(outputSet), outputLayer(nullptr), n(outputSet.size()), k(k)
     {
 
     }
@@ -105,6 +106,56 @@ namespace MLPP {
         }
      }
 
+    void WGAN::saveCheckpoint(std::string fileName){
+        Checkpoint::Writer writer("WGAN");
+        writer.add("layers", (double)network.size());
+        for(int i = 0; i < network.size(); i++){
+            network[i].save(writer, "layer" + std::to_string(i));
+        }
+        if(outputLayer){
+            outputLayer->save(writer, "output");
+        }
+        writer.write(fileName);
+    }
+
+    bool WGAN::loadCheckpoint(std::string fileName){
+        Checkpoint checkpoint(fileName);
+        if(!checkpoint.valid()){ return false; }
+        if(checkpoint.kind() != "WGAN" || !checkpoint.has("output.weights")){
+            std::cout << fileName << " is not a WGAN checkpoint." << std::endl;
+            return false;
+        }
+        int layers = checkpoint.scalar("layers");
+        // Every shape is checked before anything is copied, so a failed load leaves the network as it was.
+        bool built = network.empty() && !outputLayer;
+        if(built){
+            for(int i = 0; i < layers; i++){
+                std::string prefix = "layer" + std::to_string(i);
+                addLayer(checkpoint.scalar(prefix + ".units"), checkpoint.text(prefix + ".activation"), checkpoint.text(prefix + ".weightInit"), checkpoint.text(prefix + ".reg"), checkpoint.scalar(prefix + ".lambda"), checkpoint.scalar(prefix + ".alpha"));
+            }
+            addOutputLayer(checkpoint.text("output.weightInit"), checkpoint.text("output.reg"), checkpoint.scalar("output.lambda"), checkpoint.scalar("output.alpha"));
+        }
+        bool matches = outputLayer && layers == network.size();
+        for(int i = 0; matches && i < layers; i++){
+            matches = network[i].fits(checkpoint, "layer" + std::to_string(i));
+        }
+        if(!matches || !outputLayer->fits(checkpoint, "output")){
+            std::cout << "The architecture in " << fileName << " does not match this network." << std::endl;
+            if(built){
+                network.clear();
+                delete outputLayer;
+                outputLayer = nullptr;
+            }
+            return false;
+        }
+        for(int i = 0; i < layers; i++){
+            network[i].load(checkpoint, "layer" + std::to_string(i));
+        }
+        outputLayer->load(checkpoint, "output");
+        forwardPass();
+        return true;
+    }
+
     void WGAN::addLayer(int n_hidden, std::string activation, std::string weightInit, std::string reg, double lambda, double alpha){
         LinAlg alg;
         if(network.empty()){
@@ -160,13 +211,12 @@ namespace MLPP {
         class Cost cost;
         double totalRegTerm = 0;
 
-        auto cost_function = outputLayer->cost_map[outputLayer->cost];
         if(!network.empty()){
             for(int i = 0; i < network.size() - 1; i++){
                 totalRegTerm += regularization.regTerm(network[i].weights, network[i].lambda, network[i].alpha, network[i].reg);
             }
         }
-        return (cost.*cost_function)(y_hat, y) + totalRegTerm + regularization.regTerm(outputLayer->weights, outputLayer->lambda, outputLayer->alpha, outputLayer->reg);
+        return cost.evaluate(outputLayer->costFunction, y_hat, y) + totalRegTerm + regularization.regTerm(outputLayer->weights, outputLayer->lambda, outputLayer->alpha, outputLayer->reg);
     }
 
     void WGAN::forwardPass(){
@@ -227,18 +277,15 @@ namespace MLPP {
 
         std::vector<std::vector<std::vector<double>>> cumulativeHiddenLayerWGrad; // Tensor containing ALL hidden grads. 
 
-        auto costDeriv = outputLayer->costDeriv_map[outputLayer->cost];
-        auto outputAvn = outputLayer->activation_map[outputLayer->activation];
-        outputLayer->delta = alg.hadamard_product((cost.*costDeriv)(y_hat, outputSet), (avn.*outputAvn)(outputLayer->z, 1));
+        outputLayer->delta = alg.hadamard_product(cost.derivative(outputLayer->costFunction, y_hat, outputSet), avn.apply(outputLayer->activationFunction, outputLayer->z, 1));
         std::vector<double> outputWGrad = alg.mat_vec_mult(alg.transpose(outputLayer->input), outputLayer->delta);
         outputWGrad = alg.addition(outputWGrad, regularization.regDerivTerm(outputLayer->weights, outputLayer->lambda, outputLayer->alpha, outputLayer->reg));
 
 
         if(!network.empty()){
-            auto hiddenLayerAvn = network[network.size() - 1].activation_map[network[network.size() - 1].activation];
 
-            network[network.size() - 1].delta = alg.hadamard_product(alg.outerProduct(outputLayer->delta, outputLayer->weights), (avn.*hiddenLayerAvn)(network[network.size() - 1].z, 1));
-            std::vector<std::vector<double>> hiddenLayerWGrad = alg.matmult(alg.transpose(network[network.size() - 1].input), network[network.size() - 1].delta);
+            network[network.size() - 1].delta = alg.hadamard_product(alg.outerProduct(outputLayer->delta, outputLayer->weights), avn.apply(network[network.size() - 1].activationFunction, network[network.size() - 1].z, 1));
+            std::vector<std::vector<double>> hiddenLayerWGrad = alg.transposeMatmult(network[network.size() - 1].input, network[network.size() - 1].delta);
 
             cumulativeHiddenLayerWGrad.push_back(alg.addition(hiddenLayerWGrad, regularization.regDerivTerm(network[network.size() - 1].weights, network[network.size() - 1].lambda, network[network.size() - 1].alpha, network[network.size() - 1].reg))); // Adding to our cumulative hidden layer grads. Maintain reg terms as well.
 
@@ -246,9 +293,8 @@ namespace MLPP {
             //std::cout << "WEIGHTS SECOND:" << network[network.size() - 1].weights.size() << "x" << network[network.size() - 1].weights[0].size() << std::endl;
 
             for(int i = network.size() - 2; i > network.size()/2; i--){
-                auto hiddenLayerAvn = network[i].activation_map[network[i].activation];
-                network[i].delta = alg.hadamard_product(alg.matmult(network[i + 1].delta, alg.transpose(network[i + 1].weights)), (avn.*hiddenLayerAvn)(network[i].z, 1));
-                std::vector<std::vector<double>> hiddenLayerWGrad = alg.matmult(alg.transpose(network[i].input), network[i].delta);
+                network[i].delta = alg.hadamard_product(alg.matmultTranspose(network[i + 1].delta, network[i + 1].weights), avn.apply(network[i].activationFunction, network[i].z, 1));
+                std::vector<std::vector<double>> hiddenLayerWGrad = alg.transposeMatmult(network[i].input, network[i].delta);
 
                 cumulativeHiddenLayerWGrad.push_back(alg.addition(hiddenLayerWGrad, regularization.regDerivTerm(network[i].weights, network[i].lambda, network[i].alpha, network[i].reg))); // Adding to our cumulative hidden layer grads. Maintain reg terms as well.
 
@@ -265,21 +311,17 @@ namespace MLPP {
 
         std::vector<std::vector<std::vector<double>>> cumulativeHiddenLayerWGrad; // Tensor containing ALL hidden grads. 
 
-        auto costDeriv = outputLayer->costDeriv_map[outputLayer->cost];
-        auto outputAvn = outputLayer->activation_map[outputLayer->activation];
-        outputLayer->delta = alg.hadamard_product((cost.*costDeriv)(y_hat, outputSet), (avn.*outputAvn)(outputLayer->z, 1));
+        outputLayer->delta = alg.hadamard_product(cost.derivative(outputLayer->costFunction, y_hat, outputSet), avn.apply(outputLayer->activationFunction, outputLayer->z, 1));
         std::vector<double> outputWGrad = alg.mat_vec_mult(alg.transpose(outputLayer->input), outputLayer->delta);
         outputWGrad = alg.addition(outputWGrad, regularization.regDerivTerm(outputLayer->weights, outputLayer->lambda, outputLayer->alpha, outputLayer->reg));
         if(!network.empty()){
-            auto hiddenLayerAvn = network[network.size() - 1].activation_map[network[network.size() - 1].activation];
-            network[network.size() - 1].delta = alg.hadamard_product(alg.outerProduct(outputLayer->delta, outputLayer->weights), (avn.*hiddenLayerAvn)(network[network.size() - 1].z, 1));
-            std::vector<std::vector<double>> hiddenLayerWGrad = alg.matmult(alg.transpose(network[network.size() - 1].input), network[network.size() - 1].delta);
+            network[network.size() - 1].delta = alg.hadamard_product(alg.outerProduct(outputLayer->delta, outputLayer->weights), avn.apply(network[network.size() - 1].activationFunction, network[network.size() - 1].z, 1));
+            std::vector<std::vector<double>> hiddenLayerWGrad = alg.transposeMatmult(network[network.size() - 1].input, network[network.size() - 1].delta);
             cumulativeHiddenLayerWGrad.push_back(alg.addition(hiddenLayerWGrad, regularization.regDerivTerm(network[network.size() - 1].weights, network[network.size() - 1].lambda, network[network.size() - 1].alpha, network[network.size() - 1].reg))); // Adding to our cumulative hidden layer grads. Maintain reg terms as well.
 
             for(int i = network.size() - 2; i >= 0; i--){
-                auto hiddenLayerAvn = network[i].activation_map[network[i].activation];
-                network[i].delta = alg.hadamard_product(alg.matmult(network[i + 1].delta, alg.transpose(network[i + 1].weights)), (avn.*hiddenLayerAvn)(network[i].z, 1));
-                std::vector<std::vector<double>> hiddenLayerWGrad = alg.matmult(alg.transpose(network[i].input), network[i].delta);
+                network[i].delta = alg.hadamard_product(alg.matmultTranspose(network[i + 1].delta, network[i + 1].weights), avn.apply(network[i].activationFunction, network[i].z, 1));
+                std::vector<std::vector<double>> hiddenLayerWGrad = alg.transposeMatmult(network[i].input, network[i].delta);
                 cumulativeHiddenLayerWGrad.push_back(alg.addition(hiddenLayerWGrad, regularization.regDerivTerm(network[i].weights, network[i].lambda, network[i].alpha, network[i].reg))); // Adding to our cumulative hidden layer grads. Maintain reg terms as well.
             }
         }
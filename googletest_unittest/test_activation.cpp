@@ -212,3 +212,39 @@ TEST_F(ActivationTest, SELUDerivativeMissingLambda) {
     EXPECT_NEAR(d, 1.0, EPSILON);
     EXPECT_FALSE(fabs(d - lambda) < EPSILON);
 }
+
+TEST_F(ActivationTest, ResolvedFunctionsMatchScalarMembers) {
+    // Every element-wise activation goes through its specialized kernel; values stay inside each domain.
+    const std::pair<const char*, double (Activation::*)(double, bool)> functions[] = {
+        {"Linear", &Activation::linear}, {"Sigmoid", &Activation::sigmoid}, {"Swish", &Activation::swish},
+        {"Mish", &Activation::mish}, {"SinC", &Activation::sinc}, {"Softplus", &Activation::softplus},
+        {"Softsign", &Activation::softsign}, {"CLogLog", &Activation::cloglog}, {"Logit", &Activation::logit},
+        {"GaussianCDF", &Activation::gaussianCDF}, {"RELU", &Activation::RELU}, {"GELU", &Activation::GELU},
+        {"Sign", &Activation::sign}, {"UnitStep", &Activation::unitStep}, {"Sinh", &Activation::sinh},
+        {"Cosh", &Activation::cosh}, {"Tanh", &Activation::tanh}, {"Csch", &Activation::csch},
+        {"Sech", &Activation::sech}, {"Coth", &Activation::coth}, {"Arsinh", &Activation::arsinh},
+        {"Arcosh", &Activation::arcosh}, {"Artanh", &Activation::artanh}, {"Arcsch", &Activation::arcsch},
+        {"Arsech", &Activation::arsech}, {"Arcoth", &Activation::arcoth}};
+    std::vector<std::vector<double>> z{{0.15, 0.35, 0.6}, {0.45, 0.8, 0.25}};
+    for (const auto& f : functions) {
+        std::string name = f.first;
+        std::vector<std::vector<double>> x = z;
+        if (name == "Arcosh" || name == "Arcoth") for (auto& row : x) for (auto& v : row) v += 1;
+        auto fn = Activation::function(name);
+        for (bool deriv : {false, true}) {
+            auto a = activation.apply(fn, x, deriv);
+            for (int i = 0; i < 2; ++i)
+                for (int j = 0; j < 3; ++j)
+                    EXPECT_NEAR(a[i][j], (activation.*f.second)(x[i][j], deriv), 1e-12) << name << " deriv=" << deriv;
+            EXPECT_NEAR(activation.apply(fn, x[0][0], deriv), (activation.*f.second)(x[0][0], deriv), 1e-12) << name;
+        }
+    }
+}
+
+TEST_F(ActivationTest, SoftmaxResolvesRowWise) {
+    auto fn = Activation::function("Softmax");
+    EXPECT_EQ(Activation::bufferFunction(fn), nullptr);
+    std::vector<std::vector<double>> z{{1.0, 2.0, 3.0}, {0.0, 0.0, 0.0}};
+    expectMatrixNear(activation.apply(fn, z), activation.softmax(z));
+    EXPECT_EQ(Activation::bufferFunction("NoSuchActivation"), nullptr);
+}
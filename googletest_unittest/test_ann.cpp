@@ -0,0 +1,202 @@
+// test_ann.cpp
+
+#include <gtest/gtest.h>
+#include <atomic>
+#include <cstdlib>
+#include <new>
+#include <random>
+#include <string>
+#include <vector>
+#include "ANN/ANN.hpp"
+#include "ThreadPool/ThreadPool.hpp"
+#include "InferenceModel/InferenceModel.hpp"
+
+using namespace MLPP;
+
+// Counts every heap allocation made by the test binary.
+static std::atomic<long> allocations{0};
+
+void* operator new(std::size_t size) {
+    allocations++;
+    if (void* p = std::malloc(size ? size : 1)) return p;
+    throw std::bad_alloc();
+}
+void operator delete(void* p) noexcept { std::free(p); }
+void operator delete(void* p, std::size_t) noexcept { std::free(p); }
+
+// Two Gaussian blobs labelled 0 and 1, centred at -gap and +gap in every coordinate.
+static void blobs(int n, std::vector<std::vector<double>>& X, std::vector<double>& y, double gap = 2.0) {
+    std::mt19937 gen(7);
+    std::normal_distribution<double> dist(0.0, 1.0);
+    X.assign(n, std::vector<double>(4));
+    y.assign(n, 0);
+    for (int i = 0; i < n; ++i) {
+        y[i] = i % 2;
+        for (auto& x : X[i]) x = dist(gen) + (y[i] ? gap : -gap);
+    }
+}
+
+static void build(ANN& ann) {
+    ann.addLayer(8, "Sigmoid");
+    ann.addLayer(6, "RELU", "Default", "Ridge", 0.01);
+    ann.addOutputLayer("Sigmoid", "LogLoss");
+}
+
+TEST(ANN, TrainingEpochsDoNotAllocate) {
+    std::vector<std::vector<double>> X;
+    std::vector<double> y;
+    blobs(200, X, y);
+    ANN ann(X, y);
+    build(ann);
+
+    // Each call allocates a fixed amount to set up and to refresh the layers when it returns, so the count
+    // must not depend on the number of epochs.
+    auto count = [&](int epochs, int which) {
+        long before = allocations;
+        switch (which) {
+            case 0: ann.gradientDescent(0.1, epochs, false); break;
+            case 1: ann.SGD(0.1, epochs, false); break;
+            case 2: ann.MBGD(0.1, epochs, 32, false); break;
+            case 3: ann.Momentum(0.1, epochs, 32, 0.9, true, false); break;
+            case 4: ann.Adagrad(0.1, epochs, 32, 1e-8, false); break;
+            case 5: ann.Adadelta(0.1, epochs, 32, 0.9, 1e-8, false); break;
+            case 6: ann.Adam(0.1, epochs, 32, 0.9, 0.999, 1e-8, false); break;
+            case 7: ann.Adamax(0.1, epochs, 32, 0.9, 0.999, 1e-8, false); break;
+            case 8: ann.Nadam(0.1, epochs, 32, 0.9, 0.999, 1e-8, false); break;
+            case 9: ann.AMSGrad(0.1, epochs, 32, 0.9, 0.999, 1e-8, false); break;
+        }
+        return allocations - before;
+    };
+    for (int which = 0; which < 10; ++which) {
+        count(1, which); // warm-up
+        EXPECT_EQ(count(2, which), count(12, which)) << "optimizer " << which;
+    }
+}
+
+TEST(ANN, OptimizersSeparateBlobs) {
+    std::vector<std::vector<double>> X;
+    std::vector<double> y;
+    blobs(200, X, y);
+    for (int which = 0; which < 3; ++which) {
+        ANN ann(X, y);
+        build(ann);
+        if (which == 0) ann.MBGD(1.0, 200, 20, false);
+        if (which == 1) ann.Adam(0.5, 100, 20, 0.9, 0.999, 1e-8, false);
+        if (which == 2) ann.Momentum(0.1, 200, 20, 0.9, true, false);
+        EXPECT_GE(ann.score(), 0.95) << "optimizer " << which;
+    }
+}
+
+TEST(ANN, OutputLayerOnly) {
+    // No hidden layers: plain logistic regression through the same workspace.
+    std::vector<std::vector<double>> X;
+    std::vector<double> y;
+    blobs(100, X, y);
+    ANN ann(X, y);
+    ann.addOutputLayer("Sigmoid", "LogLoss");
+    ann.gradientDescent(1.0, 300, false);
+    EXPECT_GE(ann.score(), 0.95);
+    auto y_hat = ann.modelSetTest(X);
+    for (int i = 0; i < 100; ++i) EXPECT_EQ(y_hat[i] > 0.5, y[i] == 1);
+}
+
+TEST(ANN, ShardedTrainingDoesNotAllocatePerEpoch) {
+    int previous = ThreadPool::numThreads();
+    ThreadPool::setNumThreads(4);
+    std::vector<std::vector<double>> X;
+    std::vector<double> y;
+    blobs(200, X, y);
+    ANN ann(X, y);
+    build(ann);
+    ann.setThreads(4);
+
+    auto count = [&](int epochs) {
+        long before = allocations;
+        ann.Adam(0.1, epochs, 32, 0.9, 0.999, 1e-8, false);
+        return allocations - before;
+    };
+    count(1);
+    EXPECT_EQ(count(2), count(12));
+    ThreadPool::setNumThreads(previous);
+}
+
+TEST(ANN, ShardedGradientsReachTheSameOptimum) {
+    // Overlapping blobs make the regularized logistic loss strictly convex, so the sharded and serial runs have to
+    // converge to the same model from different random starts.
+    int previous = ThreadPool::numThreads();
+    ThreadPool::setNumThreads(4);
+    std::vector<std::vector<double>> X;
+    std::vector<double> y;
+    blobs(203, X, y, 0.5);
+
+    std::vector<std::vector<double>> y_hat;
+    for (int threads : {1, 4, 7}) {
+        ANN ann(X, y);
+        ann.addOutputLayer("Sigmoid", "LogLoss", "Default", "Ridge", 0.01);
+        ann.setThreads(threads);
+        ann.gradientDescent(1.0, 3000, false);
+        y_hat.push_back(ann.modelSetTest(X));
+    }
+    for (int t = 1; t < y_hat.size(); ++t)
+        for (int i = 0; i < X.size(); ++i) EXPECT_NEAR(y_hat[t][i], y_hat[0][i], 1e-7);
+    ThreadPool::setNumThreads(previous);
+}
+
+TEST(ANN, ShardedHiddenLayersSeparateBlobs) {
+    std::vector<std::vector<double>> X;
+    std::vector<double> y;
+    blobs(200, X, y);
+    ANN ann(X, y);
+    build(ann);
+    ann.setThreads(3);
+    ann.MBGD(1.0, 200, 20, false);
+    EXPECT_GE(ann.score(), 0.95);
+}
+
+TEST(ANN, CompiledPredictionDoesNotAllocate) {
+    std::vector<std::vector<double>> X;
+    std::vector<double> y;
+    blobs(200, X, y);
+    ANN ann(X, y);
+    build(ann);
+    InferenceModel model = ann.compile();
+
+    Matrix batch(X), one(1, 4), out;
+    for (int j = 0; j < 4; ++j) one(0, j) = X[0][j];
+    model.predictBatch(batch, out); // Grows the scratch buffers and out to the largest batch.
+    long before = allocations;
+    for (int i = 0; i < 10; ++i) {
+        model.predictBatch(one, out);
+        model.predictBatch(batch, out);
+    }
+    EXPECT_EQ(allocations - before, 0);
+}
+
+TEST(ANN, MixedPrecisionTracksDouble) {
+    std::vector<std::vector<double>> X;
+    std::vector<double> y;
+    blobs(200, X, y);
+    ANN reference(X, y);
+    build(reference);
+    // Both runs start from the same weights.
+    std::string start = ::testing::TempDir() + "mixed_start.ckpt";
+    reference.saveCheckpoint(start);
+    ANN mixed(X, y);
+    mixed.setPrecision("Mixed");
+    ASSERT_TRUE(mixed.loadCheckpoint(start));
+
+    reference.MBGD(0.5, 30, 20, false);
+    mixed.MBGD(0.5, 30, 20, false);
+    EXPECT_GE(mixed.score(), 0.95);
+    auto expected = reference.modelSetTest(X);
+    auto y_hat = mixed.modelSetTest(X);
+    for (int i = 0; i < X.size(); ++i) EXPECT_NEAR(y_hat[i], expected[i], 1e-3);
+
+    auto count = [&](int epochs) {
+        long before = allocations;
+        mixed.Adam(0.1, epochs, 32, 0.9, 0.999, 1e-8, false);
+        return allocations - before;
+    };
+    count(1);
+    EXPECT_EQ(count(2), count(12));
+}
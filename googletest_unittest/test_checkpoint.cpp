@@ -0,0 +1,197 @@
+// test_checkpoint.cpp
+
+#include <gtest/gtest.h>
+#include <cstdint>
+#include <fstream>
+#include <random>
+#include <string>
+#include <vector>
+#include "Checkpoint/Checkpoint.hpp"
+#include "ANN/ANN.hpp"
+#include "MANN/MANN.hpp"
+#include "SoftmaxNet/SoftmaxNet.hpp"
+#include "Optimizer/Optimizer.hpp"
+
+using namespace MLPP;
+
+static std::string path(const std::string& name) {
+    return ::testing::TempDir() + name;
+}
+
+// Two Gaussian blobs labelled 0 and 1, centred at -2 and +2 in every coordinate.
+static void blobs(int n, std::vector<std::vector<double>>& X, std::vector<double>& y) {
+    std::mt19937 gen(11);
+    std::normal_distribution<double> dist(0.0, 1.0);
+    X.assign(n, std::vector<double>(3));
+    y.assign(n, 0);
+    for (int i = 0; i < n; ++i) {
+        y[i] = i % 2;
+        for (auto& x : X[i]) x = dist(gen) + (y[i] ? 2 : -2);
+    }
+}
+
+TEST(Checkpoint, SectionsRoundTrip) {
+    std::vector<double> v{1.5, -2.25, 3};
+    std::vector<std::vector<double>> A{{1, 2}, {3, 4}, {5, 6}};
+    std::vector<double> raw{7, 8, 9, 10};
+    Checkpoint::Writer writer("Test");
+    writer.add("v", v);
+    writer.add("A", A);
+    writer.add("raw", raw.data(), 2, 2);
+    writer.add("pi", 3.25);
+    writer.add("name", std::string("Sigmoid"));
+    writer.add("pi", 4.5); // Replaces the earlier section.
+    ASSERT_TRUE(writer.write(path("sections.ckpt")));
+
+    Checkpoint checkpoint(path("sections.ckpt"));
+    ASSERT_TRUE(checkpoint.valid());
+    EXPECT_EQ(checkpoint.kind(), "Test");
+    EXPECT_EQ(checkpoint.vector("v"), v);
+    EXPECT_EQ(checkpoint.matrix("A"), A);
+    EXPECT_EQ(checkpoint.rows("raw"), 2);
+    EXPECT_EQ(checkpoint.cols("raw"), 2);
+    EXPECT_EQ(checkpoint.vector("raw"), raw);
+    EXPECT_EQ(checkpoint.scalar("pi"), 4.5);
+    EXPECT_EQ(checkpoint.scalar("missing", -1), -1);
+    EXPECT_EQ(checkpoint.text("name"), "Sigmoid");
+    EXPECT_FALSE(checkpoint.has("missing"));
+    EXPECT_EQ(checkpoint.data("name"), nullptr);
+
+    // Arrays are read in place, so they have to stay aligned for vector loads.
+    for (auto name : {"v", "A", "raw"})
+        EXPECT_EQ(reinterpret_cast<std::uintptr_t>(checkpoint.data(name)) % 64, 0u) << name;
+}
+
+TEST(Checkpoint, RejectsOtherFiles) {
+    EXPECT_FALSE(Checkpoint(path("does-not-exist.ckpt")).valid());
+
+    std::ofstream(path("garbage.ckpt")) << "this is not a checkpoint at all, just some text";
+    EXPECT_FALSE(Checkpoint(path("garbage.ckpt")).valid());
+
+    Checkpoint::Writer writer("Test");
+    writer.add("v", std::vector<double>(100, 1.0));
+    ASSERT_TRUE(writer.write(path("versioned.ckpt")));
+    std::string bytes;
+    {
+        std::ifstream file(path("versioned.ckpt"), std::ios::binary);
+        bytes.assign(std::istreambuf_iterator<char>(file), std::istreambuf_iterator<char>());
+    }
+    // A newer format version.
+    std::string newer = bytes;
+    newer[8] = Checkpoint::VERSION + 1;
+    std::ofstream(path("newer.ckpt"), std::ios::binary) << newer;
+    EXPECT_FALSE(Checkpoint(path("newer.ckpt")).valid());
+    // Cut off in the middle of the data.
+    std::ofstream(path("truncated.ckpt"), std::ios::binary) << bytes.substr(0, bytes.size() / 2);
+    EXPECT_FALSE(Checkpoint(path("truncated.ckpt")).valid());
+}
+
+TEST(Checkpoint, ANNRebuildsArchitecture) {
+    std::vector<std::vector<double>> X;
+    std::vector<double> y;
+    blobs(100, X, y);
+    ANN trained(X, y);
+    trained.addLayer(5, "Tanh");
+    trained.addLayer(4, "RELU", "Default", "Ridge", 0.01);
+    trained.addOutputLayer("Sigmoid", "LogLoss");
+    trained.MBGD(0.5, 20, 10, false);
+    trained.saveCheckpoint(path("ann.ckpt"));
+
+    ANN restored(X, y);
+    ASSERT_TRUE(restored.loadCheckpoint(path("ann.ckpt")));
+    EXPECT_EQ(restored.modelSetTest(X), trained.modelSetTest(X));
+
+    // A network built with a different shape refuses the parameters.
+    ANN other(X, y);
+    other.addLayer(3, "Tanh");
+    other.addOutputLayer("Sigmoid", "LogLoss");
+    EXPECT_FALSE(other.loadCheckpoint(path("ann.ckpt")));
+}
+
+TEST(Checkpoint, ANNResumesAdamExactly) {
+    std::vector<std::vector<double>> X;
+    std::vector<double> y;
+    blobs(100, X, y);
+    auto build = [](ANN& ann) {
+        ann.addLayer(5, "Sigmoid");
+        ann.addOutputLayer("Sigmoid", "LogLoss");
+    };
+
+    ANN straight(X, y);
+    build(straight);
+    straight.saveCheckpoint(path("start.ckpt"));
+    AdamOptimizer adam(0.9, 0.999, 1e-8);
+    straight.train(adam, 0.1, 10, 10, false);
+
+    // The same start, stopped after five epochs and picked up from the checkpoint in a new network.
+    ANN first(X, y);
+    ASSERT_TRUE(first.loadCheckpoint(path("start.ckpt")));
+    AdamOptimizer adam1(0.9, 0.999, 1e-8);
+    first.train(adam1, 0.1, 5, 10, false);
+    first.saveCheckpoint(path("epoch5.ckpt"), &adam1);
+
+    ANN resumed(X, y);
+    AdamOptimizer adam2(0.9, 0.999, 1e-8);
+    ASSERT_TRUE(resumed.loadCheckpoint(path("epoch5.ckpt"), &adam2));
+    EXPECT_EQ(adam2.step(), 5);
+    resumed.train(adam2, 0.1, 10, 10, false);
+    EXPECT_EQ(resumed.modelSetTest(X), straight.modelSetTest(X));
+}
+
+TEST(Checkpoint, FailedLoadsLeaveTheNetworkUnchanged) {
+    std::vector<std::vector<double>> X;
+    std::vector<double> y;
+    blobs(100, X, y);
+    ANN saved(X, y);
+    saved.addLayer(5, "Tanh", "Uniform");
+    saved.addOutputLayer("Sigmoid", "LogLoss", "Uniform");
+    AdamOptimizer adam(0.9, 0.999, 1e-8);
+    saved.train(adam, 0.1, 3, 10, false);
+    saved.saveCheckpoint(path("adam.ckpt"), &adam);
+
+    // Matching layers but an optimizer with other moments: neither the weights nor the optimizer change.
+    ANN target(X, y);
+    target.addLayer(5, "Tanh", "Uniform");
+    target.addOutputLayer("Sigmoid", "LogLoss", "Uniform");
+    auto before = target.modelSetTest(X);
+    MomentumOptimizer momentum(0.9, false);
+    EXPECT_FALSE(target.loadCheckpoint(path("adam.ckpt"), &momentum));
+    EXPECT_EQ(target.modelSetTest(X), before);
+    EXPECT_EQ(momentum.step(), 0);
+
+    // A network built from a checkpoint that does not fit its inputs is discarded, so it can still load one that does.
+    std::vector<std::vector<double>> wide(100, std::vector<double>(4, 1.0));
+    ANN rebuilt(wide, y);
+    EXPECT_FALSE(rebuilt.loadCheckpoint(path("adam.ckpt")));
+    rebuilt.addLayer(2, "Tanh", "Uniform");
+    rebuilt.addOutputLayer("Sigmoid", "LogLoss", "Uniform");
+    rebuilt.saveCheckpoint(path("wide.ckpt"));
+    ANN fresh(wide, y);
+    EXPECT_TRUE(fresh.loadCheckpoint(path("wide.ckpt")));
+}
+
+TEST(Checkpoint, MANNAndSoftmaxNetRoundTrip) {
+    std::vector<std::vector<double>> X;
+    std::vector<double> y;
+    blobs(60, X, y);
+    std::vector<std::vector<double>> Y(y.size());
+    for (int i = 0; i < y.size(); ++i) Y[i] = {y[i], 1 - y[i]};
+
+    MANN mann(X, Y);
+    mann.addLayer(4, "Tanh");
+    mann.addOutputLayer("Softmax", "CrossEntropy");
+    mann.gradientDescent(0.1, 20, false);
+    mann.saveCheckpoint(path("mann.ckpt"));
+    MANN mannRestored(X, Y);
+    ASSERT_TRUE(mannRestored.loadCheckpoint(path("mann.ckpt")));
+    EXPECT_EQ(mannRestored.modelSetTest(X), mann.modelSetTest(X));
+
+    SoftmaxNet net(X, Y, 4);
+    net.gradientDescent(0.1, 20, false);
+    net.saveCheckpoint(path("softmaxnet.ckpt"));
+    SoftmaxNet netRestored(X, Y, 4);
+    ASSERT_TRUE(netRestored.loadCheckpoint(path("softmaxnet.ckpt")));
+    EXPECT_EQ(netRestored.modelSetTest(X), net.modelSetTest(X));
+    EXPECT_FALSE(SoftmaxNet(X, Y, 3).loadCheckpoint(path("softmaxnet.ckpt")));
+    EXPECT_FALSE(mannRestored.loadCheckpoint(path("softmaxnet.ckpt")));
+}
@@ -146,4 +146,21 @@ TEST_F(CostTest, WassersteinDeriv) {
     auto d = cost.WassersteinLossDeriv({0,0}, y);
     EXPECT_EQ(d[0], -3.0);
     EXPECT_EQ(d[1],  4.0);
-}
\ No newline at end of file
+}
+TEST_F(CostTest, ResolvedFunctionsMatchMembers) {
+    std::vector<double> y_hat{0.2, 0.7, 0.9}, y{0.0, 1.0, 1.0};
+    EXPECT_EQ(cost.evaluate(Cost::function("MSE"), y_hat, y), cost.MSE(y_hat, y));
+    EXPECT_EQ(cost.evaluate(Cost::function("LogLoss"), y_hat, y), cost.LogLoss(y_hat, y));
+    EXPECT_EQ(cost.derivative(Cost::function("CrossEntropy"), y_hat, y), cost.CrossEntropyDeriv(y_hat, y));
+    // The output layers have always trained WassersteinLoss as HingeLoss.
+    EXPECT_EQ(cost.evaluate(Cost::function("WassersteinLoss"), y_hat, y), cost.HingeLoss(y_hat, y));
+
+    std::vector<std::vector<double>> Y_hat{y_hat, y}, Y{y, y_hat};
+    EXPECT_EQ(cost.evaluate(Cost::function("MAE"), Y_hat, Y), cost.MAE(Y_hat, Y));
+    EXPECT_EQ(cost.derivative(Cost::function("MBE"), Y_hat, Y), cost.MBEDeriv(Y_hat, Y));
+
+    std::vector<double> d(3);
+    Cost::bufferDerivative(Cost::function("LogLoss"))(y_hat.data(), y.data(), d.data(), 3);
+    auto ref = cost.LogLossDeriv(y_hat, y);
+    for (int i = 0; i < 3; ++i) EXPECT_NEAR(d[i], ref[i], 1e-12);
+}
@@ -0,0 +1,127 @@
+// test_csvreader.cpp
+
+#include <gtest/gtest.h>
+#include <cstdio>
+#include <cstdlib>
+#include <fstream>
+#include <random>
+#include <sstream>
+#include <string>
+#include <vector>
+#include "CSVReader/CSVReader.hpp"
+#include "Data/Data.hpp"
+#include "ThreadPool/ThreadPool.hpp"
+
+using namespace MLPP;
+
+static std::string write(const std::string& name, const std::string& text) {
+    std::string path = ::testing::TempDir() + name;
+    std::ofstream(path, std::ios::binary) << text;
+    return path;
+}
+
+TEST(CSVReader, ReadsRowsInOrder) {
+    CSVReader reader(write("csv_plain.csv", "1,2,3\n-4.5, 6e2 ,+7\n\n8,9,10,11\r\n1e-3,0,-0"));
+    Matrix m;
+    ASSERT_TRUE(reader.read(3, m));
+    ASSERT_EQ(m.rows(), 4);
+    ASSERT_EQ(m.cols(), 3);
+    EXPECT_EQ(m.toStdVector(), (std::vector<std::vector<double>>{{1, 2, 3}, {-4.5, 600, 7}, {8, 9, 10}, {1e-3, 0, -0.0}}));
+    EXPECT_TRUE(reader.malformedLines().empty());
+}
+
+TEST(CSVReader, ReportsMalformedLines) {
+    CSVReader reader(write("csv_bad.csv", "1,2\n3\n4,x\n5,6\n7,,8\n9,10abc\n11,12\n"));
+    Matrix m;
+    ASSERT_TRUE(reader.read(2, m));
+    EXPECT_EQ(m.toStdVector(), (std::vector<std::vector<double>>{{1, 2}, {5, 6}, {11, 12}}));
+    EXPECT_EQ(reader.malformedLines(), (std::vector<long>{2, 3, 5, 6}));
+}
+
+// Short decimals take a shortcut past std::from_chars, which must still round exactly as strtod does.
+TEST(CSVReader, DecimalsRoundLikeStrtod) {
+    std::mt19937 gen(3);
+    std::uniform_real_distribution<double> dist(-1000.0, 1000.0);
+    std::vector<std::string> fields;
+    std::string text;
+    for (int i = 0; i < 3000; ++i) {
+        char field[64];
+        std::snprintf(field, sizeof field, i % 3 ? "%.*f" : "%.*g", 1 + i % 16, dist(gen));
+        fields.push_back(field);
+        text += fields.back() + (i % 3 == 2 ? "\n" : ",");
+    }
+    CSVReader reader(write("csv_decimals.csv", text));
+    Matrix m;
+    reader.read(3, m);
+    ASSERT_EQ(m.rows(), 1000);
+    for (int i = 0; i < 3000; ++i) EXPECT_EQ(m(i / 3, i % 3), std::strtod(fields[i].c_str(), nullptr)) << fields[i];
+}
+
+TEST(CSVReader, MissingFileIsInvalid) {
+    CSVReader reader(::testing::TempDir() + "csv_does_not_exist.csv");
+    EXPECT_FALSE(reader.valid());
+    Matrix m;
+    EXPECT_FALSE(reader.read(2, m));
+    EXPECT_EQ(m.rows(), 0);
+
+    CSVReader empty(write("csv_empty.csv", ""));
+    EXPECT_TRUE(empty.valid());
+    EXPECT_TRUE(empty.read(2, m));
+    EXPECT_EQ(m.rows(), 0);
+}
+
+TEST(CSVReader, RefusesMoreValuesThanAMatrixHolds) {
+    CSVReader reader(write("csv_too_wide.csv", "1,2\n3,4\n5,6\n"));
+    Matrix m;
+    EXPECT_FALSE(reader.read(1 << 30, m));
+    EXPECT_EQ(m.rows(), 0);
+    EXPECT_TRUE(reader.read(2, m));
+    EXPECT_EQ(m.rows(), 3);
+}
+
+// A file several chunks long, parsed on four threads, has to come back exactly as written and in order.
+TEST(CSVReader, ParallelChunksMatchValues) {
+    std::mt19937 gen(5);
+    std::normal_distribution<double> dist(0.0, 100.0);
+    const int n = 40000, d = 6;
+    std::vector<std::vector<double>> expected(n, std::vector<double>(d));
+    std::ostringstream text;
+    text.precision(17);
+    for (int i = 0; i < n; ++i) {
+        for (int j = 0; j < d; ++j) {
+            expected[i][j] = dist(gen);
+            text << expected[i][j] << (j + 1 < d ? "," : i % 3 ? "\n" : "\r\n");
+        }
+        if (i == 12345) text << "1,2\n";
+    }
+    std::string path = write("csv_large.csv", text.str());
+
+    int threads = ThreadPool::numThreads();
+    ThreadPool::setNumThreads(4);
+    CSVReader reader(path);
+    Matrix m;
+    reader.read(d, m);
+    ThreadPool::setNumThreads(threads);
+
+    EXPECT_EQ(m.toStdVector(), expected);
+    EXPECT_EQ(reader.malformedLines(), (std::vector<long>{12347}));
+}
+
+TEST(CSVReader, SetDataOverloads) {
+    std::string path = write("csv_data.csv", "1,2,0\n3,4,1\n5,6,1\n");
+    Data data;
+    std::vector<std::vector<double>> X;
+    std::vector<double> y;
+    data.setData(2, path, X, y);
+    EXPECT_EQ(X, (std::vector<std::vector<double>>{{1, 2}, {3, 4}, {5, 6}}));
+    EXPECT_EQ(y, (std::vector<double>{0, 1, 1}));
+
+    std::vector<std::vector<double>> U;
+    data.setData(3, path, U);
+    EXPECT_EQ(U, (std::vector<std::vector<double>>{{1, 2, 0}, {3, 4, 1}, {5, 6, 1}}));
+
+    std::vector<double> a, b;
+    data.setData(path, a, b);
+    EXPECT_EQ(a, (std::vector<double>{1, 3, 5}));
+    EXPECT_EQ(b, (std::vector<double>{2, 4, 6}));
+}
@@ -0,0 +1,76 @@
+// test_dataset.cpp
+
+#include <gtest/gtest.h>
+#include <chrono>
+#include <filesystem>
+#include <fstream>
+#include <string>
+#include <vector>
+#include "Dataset/Dataset.hpp"
+#include "Data/Data.hpp"
+
+using namespace MLPP;
+
+static std::string path(const std::string& name) {
+    return ::testing::TempDir() + name;
+}
+
+TEST(Dataset, RoundTripsInPlace) {
+    std::vector<double> values = {1, 2, 3, 4, 5, 6};
+    ASSERT_TRUE(Dataset::write(path("dataset.bin"), values.data(), 3, 2, {"x", "y"}, "note"));
+    Dataset dataset(path("dataset.bin"));
+    ASSERT_TRUE(dataset.valid());
+    EXPECT_EQ(dataset.rows(), 3);
+    EXPECT_EQ(dataset.cols(), 2);
+    EXPECT_EQ(reinterpret_cast<uintptr_t>(dataset.data()) % 64, 0u);
+    EXPECT_EQ(std::vector<double>(dataset.row(1), dataset.row(1) + 2), (std::vector<double>{3, 4}));
+    EXPECT_EQ(dataset.columnNames(), (std::vector<std::string>{"x", "y"}));
+    EXPECT_EQ(dataset.source(), "note");
+
+    ASSERT_TRUE(Dataset::write(path("dataset_unnamed.bin"), values.data(), 2, 3));
+    Dataset unnamed(path("dataset_unnamed.bin"));
+    ASSERT_TRUE(unnamed.valid());
+    EXPECT_TRUE(unnamed.columnNames().empty());
+    EXPECT_EQ(unnamed.row(1)[0], 4);
+}
+
+TEST(Dataset, RejectsOtherCheckpoints) {
+    Checkpoint::Writer writer("ANN");
+    writer.add("data", std::vector<double>{1, 2});
+    ASSERT_TRUE(writer.write(path("dataset_ann.bin")));
+    EXPECT_FALSE(Dataset(path("dataset_ann.bin")).valid());
+    EXPECT_FALSE(Dataset(path("dataset_missing.bin")).valid());
+}
+
+TEST(Dataset, CacheIsReusedUntilTheCSVChanges) {
+    std::string csv = path("dataset_cached.csv");
+    std::filesystem::remove(csv + ".cache");
+    std::ofstream(csv) << "1,2,0\n3,4,1\n";
+    Data data;
+    std::string cacheName = data.cache(csv);
+    ASSERT_EQ(cacheName, csv + ".cache");
+    {
+        Dataset dataset(cacheName);
+        ASSERT_TRUE(dataset.valid());
+        EXPECT_EQ(dataset.rows(), 2);
+        EXPECT_EQ(dataset.cols(), 3);
+        EXPECT_EQ(dataset.row(1)[1], 4);
+    }
+
+    // A current cache is left alone.
+    auto written = std::filesystem::last_write_time(cacheName);
+    std::filesystem::last_write_time(cacheName, written - std::chrono::hours(1));
+    written = std::filesystem::last_write_time(cacheName);
+    EXPECT_EQ(data.cache(csv), cacheName);
+    EXPECT_EQ(std::filesystem::last_write_time(cacheName), written);
+
+    // Editing the CSV rebuilds it.
+    std::ofstream(csv) << "1,2,0\n3,4,1\n5,6,0\n";
+    EXPECT_EQ(data.cache(csv), cacheName);
+    Dataset dataset(cacheName);
+    ASSERT_TRUE(dataset.valid());
+    EXPECT_EQ(dataset.rows(), 3);
+    EXPECT_EQ(dataset.row(2)[0], 5);
+
+    EXPECT_EQ(data.cache(path("dataset_missing.csv")), "");
+}
@@ -0,0 +1,302 @@
+// test_datasource.cpp
+
+#include <gtest/gtest.h>
+#include <algorithm>
+#include <fstream>
+#include <random>
+#include <string>
+#include <vector>
+#include "DataSource/DataSource.hpp"
+#include "Dataset/Dataset.hpp"
+#include "Data/Data.hpp"
+#include "ANN/ANN.hpp"
+#include "LogReg/LogReg.hpp"
+#include "MANN/MANN.hpp"
+#include "SoftmaxReg/SoftmaxReg.hpp"
+#include "Optimizer/Optimizer.hpp"
+
+using namespace MLPP;
+
+static std::string path(const std::string& name) {
+    return ::testing::TempDir() + name;
+}
+
+// Sample i has inputs {i, -i} and output i, so a batch row shows which sample it came from.
+static void numbered(int n, std::vector<std::vector<double>>& X, std::vector<double>& y) {
+    X.resize(n);
+    y.resize(n);
+    for (int i = 0; i < n; ++i) {
+        X[i] = {double(i), -double(i)};
+        y[i] = i;
+    }
+}
+
+// Every sample of a pass, in the order the stream produced them; checks that inputs and outputs stay paired.
+static std::vector<int> pass(BatchStream& stream, std::vector<int>* sizes = nullptr) {
+    std::vector<int> order;
+    while (const BatchStream::Batch* batch = stream.next()) {
+        if (sizes) sizes->push_back(batch->rows());
+        for (int i = 0; i < batch->rows(); ++i) {
+            EXPECT_EQ(batch->inputs(i, 0), batch->outputs(i, 0));
+            EXPECT_EQ(batch->inputs(i, 1), -batch->outputs(i, 0));
+            order.push_back(batch->outputs(i, 0));
+        }
+    }
+    return order;
+}
+
+TEST(DataSource, StreamsBatchesInOrder) {
+    std::vector<std::vector<double>> X;
+    std::vector<double> y;
+    numbered(23, X, y);
+    MemorySource source(X, y);
+    BatchStream stream(source, 5);
+    std::vector<int> expected(23);
+    for (int i = 0; i < 23; ++i) expected[i] = i;
+    for (int p = 0; p < 3; ++p) {
+        std::vector<int> sizes;
+        EXPECT_EQ(pass(stream, &sizes), expected);
+        EXPECT_EQ(sizes, (std::vector<int>{5, 5, 5, 5, 3}));
+    }
+}
+
+TEST(DataSource, ShuffleBufferPermutesEveryPass) {
+    std::vector<std::vector<double>> X;
+    std::vector<double> y;
+    numbered(1000, X, y);
+    MemorySource source(X, y);
+    BatchStream stream(source, 32, 256);
+    std::vector<int> previous;
+    for (int p = 0; p < 3; ++p) {
+        std::vector<int> order = pass(stream);
+        ASSERT_EQ(order.size(), 1000u);
+        std::vector<int> sorted = order;
+        std::sort(sorted.begin(), sorted.end());
+        for (int i = 0; i < 1000; ++i) ASSERT_EQ(sorted[i], i);
+        EXPECT_NE(order, sorted);
+        EXPECT_NE(order, previous);
+        // A sample can only be drawn once it has entered the buffer.
+        for (int i = 0; i < 1000; ++i) EXPECT_LT(order[i], 256 + (i / 32 + 1) * 32);
+        previous = order;
+    }
+}
+
+TEST(DataSource, ShuffleBufferSmallerThanABatchKeepsBatchesFull) {
+    std::vector<std::vector<double>> X;
+    std::vector<double> y;
+    numbered(100, X, y);
+    MemorySource source(X, y);
+    BatchStream stream(source, 32, 10);
+    for (int p = 0; p < 2; ++p) {
+        std::vector<int> sizes;
+        std::vector<int> order = pass(stream, &sizes);
+        EXPECT_EQ(sizes, (std::vector<int>{32, 32, 32, 4}));
+        std::sort(order.begin(), order.end());
+        ASSERT_EQ(order.size(), 100u);
+        for (int i = 0; i < 100; ++i) ASSERT_EQ(order[i], i);
+    }
+}
+
+TEST(DataSource, CSVAndDatasetSourcesMatchTheFile) {
+    std::vector<double> values;
+    std::string text;
+    for (int i = 0; i < 3000; ++i) {
+        for (int j = 0; j < 4; ++j) {
+            values.push_back(i * 4 + j + 0.25);
+            text += std::to_string(values.back()) + (j < 3 ? "," : "\n");
+        }
+        if (i == 10) text += "1,2\n\n";
+    }
+    std::ofstream(path("source.csv"), std::ios::binary) << text;
+    ASSERT_TRUE(Dataset::write(path("source.bin"), values.data(), 3000, 4));
+
+    CSVSource csv(path("source.csv"), 3);
+    DatasetSource dataset(path("source.bin"));
+    ASSERT_TRUE(csv.valid());
+    ASSERT_TRUE(dataset.valid());
+    EXPECT_EQ(csv.size(), 3001);
+    EXPECT_EQ(dataset.size(), 3000);
+    EXPECT_EQ(dataset.inputs(), 3);
+    for (DataSource* source : {(DataSource*)&csv, (DataSource*)&dataset}) {
+        BatchStream stream(*source, 128);
+        for (int p = 0; p < 2; ++p) {
+            long row = 0;
+            while (const BatchStream::Batch* batch = stream.next()) {
+                for (int i = 0; i < batch->rows(); ++i, ++row) {
+                    for (int j = 0; j < 3; ++j) ASSERT_EQ(batch->inputs(i, j), values[row * 4 + j]);
+                    ASSERT_EQ(batch->outputs(i, 0), values[row * 4 + 3]);
+                }
+            }
+            EXPECT_EQ(row, 3000);
+        }
+    }
+    EXPECT_EQ(csv.malformedLines(), (std::vector<long>{12}));
+}
+
+TEST(DataSource, MissingDatasetStreamsNothing) {
+    DatasetSource missing(path("missing.bin"));
+    EXPECT_FALSE(missing.valid());
+    EXPECT_EQ(missing.size(), 0);
+    EXPECT_EQ(missing.inputs(), 0);
+    EXPECT_EQ(missing.outputs(), 0);
+    BatchStream stream(missing, 16);
+    EXPECT_EQ(stream.next(), nullptr);
+}
+
+// Streamed in order with the same batches, a network trains to exactly the weights it reaches in memory.
+TEST(DataSource, ANNTrainsFromAStreamAsInMemory) {
+    std::mt19937 gen(9);
+    std::normal_distribution<double> dist(0.0, 1.0);
+    std::vector<std::vector<double>> X(60, std::vector<double>(4));
+    std::vector<double> y(60);
+    for (int i = 0; i < 60; ++i) {
+        for (auto& x : X[i]) x = dist(gen);
+        y[i] = X[i][0] - X[i][1] > 0;
+    }
+    ANN memory(X, y);
+    memory.addLayer(8, "Tanh", "Uniform");
+    memory.addOutputLayer("Sigmoid", "LogLoss", "Uniform");
+    memory.saveCheckpoint(path("stream_ann.ckpt"));
+
+    MemorySource source(X, y);
+    ANN streamed(source);
+    ASSERT_TRUE(streamed.loadCheckpoint(path("stream_ann.ckpt")));
+
+    GradientDescentOptimizer a, b;
+    memory.train(a, 0.5, 4, 10, false);
+    BatchStream stream(source, 10);
+    streamed.train(stream, b, 0.5, 4, false);
+
+    auto expected = memory.modelSetTest(X);
+    auto predicted = streamed.modelSetTest(X);
+    for (int i = 0; i < 60; ++i) EXPECT_NEAR(predicted[i], expected[i], 1e-12);
+}
+
+TEST(DataSource, LogRegTrainsFromAShuffledStream) {
+    std::mt19937 gen(4);
+    std::normal_distribution<double> dist(0.0, 1.0);
+    std::vector<std::vector<double>> X(400, std::vector<double>(3));
+    std::vector<double> y(400);
+    for (int i = 0; i < 400; ++i) {
+        for (auto& x : X[i]) x = dist(gen);
+        y[i] = 2 * X[i][0] + X[i][2] > 0;
+    }
+    MemorySource source(X, y);
+    LogReg model(source);
+    BatchStream stream(source, 16, 100);
+    AdamOptimizer optimizer(0.9, 0.999, 1e-8);
+    model.train(stream, optimizer, 0.05, 30, false);
+
+    auto y_hat = model.modelSetTest(X);
+    int correct = 0;
+    for (int i = 0; i < 400; ++i) correct += (y_hat[i] > 0.5) == (y[i] > 0.5);
+    EXPECT_GT(correct, 380);
+}
+
+TEST(DataSource, StreamBuiltModelsOnlyTrainOnStreams) {
+    std::vector<std::vector<double>> X = {{1, 0}, {0, 1}, {1, 1}, {0, 0}};
+    std::vector<double> y = {1, 0, 1, 0};
+    MemorySource source(X, y);
+
+    LogReg model(source);
+    auto weights = model.getWeights();
+    double bias = model.getBias();
+    model.gradientDescent(0.1, 5, false);
+    model.MLE(0.1, 5, false);
+    model.SGD(0.1, 5, false);
+    model.MBGD(0.1, 5, 2, false);
+    EXPECT_EQ(model.asyncSGD(0.1, 5, 2, false).updates, 0);
+    GradientDescentOptimizer optimizer;
+    model.train(optimizer, 0.1, 5, 2, false);
+    EXPECT_EQ(model.getWeights(), weights);
+    EXPECT_EQ(model.getBias(), bias);
+
+    ANN network(source);
+    network.addLayer(3, "Tanh", "Uniform");
+    network.addOutputLayer("Sigmoid", "LogLoss", "Uniform");
+    auto before = network.modelSetTest(X);
+    network.gradientDescent(0.1, 5, false);
+    network.SGD(0.1, 5, false);
+    network.MBGD(0.1, 5, 2, false);
+    EXPECT_EQ(network.asyncSGD(0.1, 5, false).updates, 0);
+    EXPECT_EQ(network.modelSetTest(X), before);
+}
+
+// Three blobs with class labels 0, 1 and 2, blob c centred at 4 * e_c.
+static void labelled(int n, std::vector<std::vector<double>>& X, std::vector<double>& labels) {
+    std::mt19937 gen(12);
+    std::normal_distribution<double> dist(0.0, 1.0);
+    X.assign(n, std::vector<double>(3));
+    labels.resize(n);
+    for (int i = 0; i < n; ++i) {
+        labels[i] = i % 3;
+        for (int j = 0; j < 3; ++j) X[i][j] = dist(gen) + (j == i % 3 ? 4 : 0);
+    }
+}
+
+static int correct(const std::vector<std::vector<double>>& y_hat, const std::vector<double>& labels) {
+    int count = 0;
+    for (int i = 0; i < y_hat.size(); ++i)
+        count += std::max_element(y_hat[i].begin(), y_hat[i].end()) - y_hat[i].begin() == labels[i];
+    return count;
+}
+
+TEST(DataSource, ShuffledMemorySourceReadsOneHotPermutations) {
+    std::vector<std::vector<double>> X(50);
+    std::vector<double> labels(50);
+    for (int i = 0; i < 50; ++i) {
+        X[i] = {double(i)};
+        labels[i] = i % 4;
+    }
+    MemorySource source(X, labels, 4);
+    source.setShuffle(true);
+    EXPECT_EQ(source.outputs(), 4);
+    BatchStream stream(source, 8);
+    std::vector<int> previous;
+    for (int p = 0; p < 3; ++p) {
+        std::vector<int> order;
+        while (const BatchStream::Batch* batch = stream.next()) {
+            for (int i = 0; i < batch->rows(); ++i) {
+                int sample = batch->inputs(i, 0);
+                for (int c = 0; c < 4; ++c) ASSERT_EQ(batch->outputs(i, c), c == sample % 4);
+                order.push_back(sample);
+            }
+        }
+        EXPECT_NE(order, previous);
+        previous = order;
+        std::sort(order.begin(), order.end());
+        ASSERT_EQ(order.size(), 50u);
+        for (int i = 0; i < 50; ++i) ASSERT_EQ(order[i], i);
+    }
+    BatchStream::Timing timing = stream.timing();
+    EXPECT_EQ(timing.batches, 3 * 7);
+    EXPECT_GT(timing.prepare, 0);
+    EXPECT_GE(timing.wait, 0);
+    EXPECT_GE(timing.compute, 0);
+}
+
+TEST(DataSource, SoftmaxRegAndMANNTrainFromAPrefetchedStream) {
+    std::vector<std::vector<double>> X;
+    std::vector<double> labels;
+    labelled(300, X, labels);
+    Data data;
+    std::vector<std::vector<double>> Y = data.oneHotRep(labels, 3);
+    MemorySource source(X, labels, 3);
+    source.setShuffle(true);
+
+    SoftmaxReg softmax(X, Y);
+    {
+        BatchStream stream(source, 20);
+        softmax.MBGD(stream, 0.01, 20, false);
+    }
+    EXPECT_GE(correct(softmax.modelSetTest(X), labels), 285);
+
+    MANN mann(X, Y);
+    mann.addLayer(6, "RELU");
+    mann.addOutputLayer("Softmax", "CrossEntropy");
+    {
+        BatchStream stream(source, 20, 0, 3);
+        mann.MBGD(stream, 0.1, 30, false);
+    }
+    EXPECT_GE(mann.score(), 0.95);
+}
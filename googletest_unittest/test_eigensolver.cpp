@@ -0,0 +1,96 @@
+// test_eigensolver.cpp
+
+#include <gtest/gtest.h>
+#include <cmath>
+#include <random>
+#include <vector>
+#include "EigenSolver/EigenSolver.hpp"
+#include "LinAlg/LinAlg.hpp"
+
+using namespace MLPP;
+
+static std::vector<std::vector<double>> randomSymmetric(int n, unsigned seed) {
+    std::mt19937 gen(seed);
+    std::normal_distribution<double> dist(0.0, 1.0);
+    std::vector<std::vector<double>> A(n, std::vector<double>(n));
+    for (int i = 0; i < n; ++i)
+        for (int j = 0; j <= i; ++j) A[i][j] = A[j][i] = dist(gen);
+    return A;
+}
+
+// max |A v - lambda v| and max |V^T V - I| over the returned pairs
+static void expectEigenpairs(const std::vector<std::vector<double>>& A, const EigenSolver& es, double tol) {
+    int n = A.size();
+    const Matrix& V = es.eigenvectors();
+    const Vector& L = es.eigenvalues();
+    for (int j = 0; j < V.cols(); ++j) {
+        for (int i = 0; i < n; ++i) {
+            double Av = 0;
+            for (int q = 0; q < n; ++q) Av += A[i][q] * V(q, j);
+            EXPECT_NEAR(Av, L[j] * V(i, j), tol) << "pair " << j << " row " << i;
+        }
+        for (int j2 = 0; j2 <= j; ++j2) {
+            double dot = 0;
+            for (int i = 0; i < n; ++i) dot += V(i, j) * V(i, j2);
+            EXPECT_NEAR(dot, j == j2 ? 1.0 : 0.0, tol);
+        }
+    }
+}
+
+TEST(EigenSolver, SmallKnownSpectrum) {
+    std::vector<std::vector<double>> A{{2, 1, 0}, {1, 2, 0}, {0, 0, 5}};
+    EigenSolver es(A);
+    ASSERT_EQ(es.eigenvalues().size(), 3);
+    EXPECT_NEAR(es.eigenvalues()[0], 5.0, 1e-12);
+    EXPECT_NEAR(es.eigenvalues()[1], 3.0, 1e-12);
+    EXPECT_NEAR(es.eigenvalues()[2], 1.0, 1e-12);
+    expectEigenpairs(A, es, 1e-12);
+}
+
+TEST(EigenSolver, RandomSymmetricFullSpectrum) {
+    auto A = randomSymmetric(120, 1);
+    EigenSolver es(A);
+    EXPECT_TRUE(es.converged());
+    for (int j = 1; j < es.eigenvalues().size(); ++j)
+        EXPECT_GE(es.eigenvalues()[j - 1], es.eigenvalues()[j]);
+    expectEigenpairs(A, es, 1e-10);
+}
+
+TEST(EigenSolver, TopKMatchesFullSpectrum) {
+    auto A = randomSymmetric(90, 2);
+    EigenSolver full(A);
+    EigenSolver top(A, 5);
+    ASSERT_EQ(top.eigenvectors().rows(), 90);
+    ASSERT_EQ(top.eigenvectors().cols(), 5);
+    for (int j = 0; j < 5; ++j) EXPECT_NEAR(top.eigenvalues()[j], full.eigenvalues()[j], 1e-10);
+    expectEigenpairs(A, top, 1e-10);
+}
+
+TEST(EigenSolver, RepeatedEigenvaluesStayOrthogonal) {
+    // A low-rank Gram matrix has a large cluster of zero eigenvalues.
+    std::mt19937 gen(3);
+    std::normal_distribution<double> dist(0.0, 1.0);
+    std::vector<std::vector<double>> X(60, std::vector<double>(4));
+    for (auto& row : X) for (auto& x : row) x = dist(gen);
+    auto A = LinAlg().matmultTranspose(X, X);
+    EigenSolver es(A);
+    expectEigenpairs(A, es, 1e-10);
+    for (int j = 4; j < 60; ++j) EXPECT_NEAR(es.eigenvalues()[j], 0.0, 1e-10);
+
+    EigenSolver identity(LinAlg().identity(10));
+    expectEigenpairs(LinAlg().identity(10), identity, 1e-12);
+}
+
+TEST(EigenSolver, LinAlgEigDiagonalForm) {
+    std::vector<std::vector<double>> A{{4, 1}, {1, 3}};
+    auto [vectors, values] = LinAlg().eig(A);
+    ASSERT_EQ(values.size(), 2u);
+    EXPECT_NEAR(values[0][0], (7 + std::sqrt(5.0)) / 2, 1e-12);
+    EXPECT_NEAR(values[1][1], (7 - std::sqrt(5.0)) / 2, 1e-12);
+    EXPECT_EQ(values[0][1], 0.0);
+    // A = V diag V^T
+    LinAlg alg;
+    auto R = alg.matmult(alg.matmult(vectors, values), alg.transpose(vectors));
+    for (int i = 0; i < 2; ++i)
+        for (int j = 0; j < 2; ++j) EXPECT_NEAR(R[i][j], A[i][j], 1e-12);
+}
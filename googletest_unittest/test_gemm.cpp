@@ -0,0 +1,205 @@
+// test_gemm.cpp
+
+#include <gtest/gtest.h>
+#include <cmath>
+#include <cstdint>
+#include <random>
+#include <vector>
+#include "GEMM/GEMM.hpp"
+#include "LinAlg/LinAlg.hpp"
+#include "Activation/Activation.hpp"
+#include "ThreadPool/ThreadPool.hpp"
+
+using namespace MLPP;
+
+// Helpers
+static std::vector<double> randomBuffer(int n, unsigned seed) {
+    std::mt19937 gen(seed);
+    std::uniform_real_distribution<double> dist(-1.0, 1.0);
+    std::vector<double> v(n);
+    for (auto& x : v) x = dist(gen);
+    return v;
+}
+
+static void referenceGemm(bool tA, bool tB, int m, int n, int k, double alpha,
+                          const double* A, int lda, const double* B, int ldb,
+                          double beta, double* C, int ldc) {
+    for (int i = 0; i < m; ++i)
+        for (int j = 0; j < n; ++j) {
+            double s = 0;
+            for (int p = 0; p < k; ++p)
+                s += (tA ? A[p*lda + i] : A[i*lda + p]) * (tB ? B[j*ldb + p] : B[p*ldb + j]);
+            C[i*ldc + j] = alpha * s + beta * C[i*ldc + j];
+        }
+}
+
+class GEMMKernelTest : public ::testing::TestWithParam<GEMM::Kernel> {
+protected:
+    void SetUp() override { GEMM::setKernel(GetParam()); }
+    void TearDown() override { GEMM::setKernel(GEMM::Auto); }
+};
+
+TEST_P(GEMMKernelTest, MatchesReferenceOnAllTransposes) {
+    // Sizes straddle the micro-tile and cache-block edges; the ones with fewer rows than a tile skip packing.
+    const int shapes[][3] = {{1,1,1},{1,70,129},{5,37,64},{7,9,5},{33,47,29},{97,25,300},{130,70,257}};
+    for (auto& s : shapes) {
+        int m = s[0], n = s[1], k = s[2];
+        for (int tA = 0; tA < 2; ++tA)
+            for (int tB = 0; tB < 2; ++tB) {
+                int lda = (tA ? m : k) + 3, ldb = (tB ? k : n) + 1, ldc = n + 2;
+                auto A = randomBuffer((tA ? k : m) * lda, 1);
+                auto B = randomBuffer((tB ? n : k) * ldb, 2);
+                auto C = randomBuffer(m * ldc, 3);
+                auto R = C;
+                GEMM::gemm(tA, tB, m, n, k, 0.5, A.data(), lda, B.data(), ldb, -2.0, C.data(), ldc);
+                referenceGemm(tA, tB, m, n, k, 0.5, A.data(), lda, B.data(), ldb, -2.0, R.data(), ldc);
+                for (int i = 0; i < m; ++i)
+                    for (int j = 0; j < n; ++j)
+                        ASSERT_NEAR(C[i*ldc + j], R[i*ldc + j], 1e-10)
+                            << GEMM::kernelName() << " " << m << "x" << n << "x" << k
+                            << " tA=" << tA << " tB=" << tB << " at (" << i << "," << j << ")";
+            }
+    }
+}
+
+TEST_P(GEMMKernelTest, ZeroBetaIgnoresGarbageInC) {
+    int m = 40, n = 50, k = 60;
+    auto A = randomBuffer(m * k, 4);
+    auto B = randomBuffer(k * n, 5);
+    std::vector<double> C(m * n, NAN), R(m * n, 0.0);
+    GEMM::gemm(false, false, m, n, k, 1.0, A.data(), k, B.data(), n, 0.0, C.data(), n);
+    referenceGemm(false, false, m, n, k, 1.0, A.data(), k, B.data(), n, 0.0, R.data(), n);
+    for (int i = 0; i < m * n; ++i) ASSERT_NEAR(C[i], R[i], 1e-10);
+}
+
+TEST_P(GEMMKernelTest, FusedEpiloguesMatchSeparatePasses) {
+    // Covers the small, blocked and striped paths; the last shape is split across threads.
+    int previous = ThreadPool::numThreads();
+    ThreadPool::setNumThreads(4);
+    auto f = Activation::bufferFunction("Tanh");
+    const int shapes[][3] = {{3,5,7},{33,47,29},{97,25,300},{130,70,257}};
+    for (auto& s : shapes) {
+        int m = s[0], n = s[1], k = s[2], ld = n + 3;
+        auto A = randomBuffer(m * k, 8);
+        auto B = randomBuffer(k * n, 9);
+        auto bias = randomBuffer(n, 10);
+        std::vector<double> Z(m * ld, NAN), Act(m * ld, NAN), R(m * ld, 0.0);
+        GEMM::gemmBiasActivation(false, false, m, n, k, A.data(), k, B.data(), n, bias.data(), f, Z.data(), ld, Act.data(), ld);
+        referenceGemm(false, false, m, n, k, 1.0, A.data(), k, B.data(), n, 0.0, R.data(), ld);
+        for (int i = 0; i < m; ++i)
+            for (int j = 0; j < n; ++j) {
+                double z = R[i*ld + j] + bias[j];
+                ASSERT_NEAR(Z[i*ld + j], z, 1e-10) << GEMM::kernelName() << " " << m << "x" << n << "x" << k;
+                ASSERT_NEAR(Act[i*ld + j], std::tanh(z), 1e-10) << GEMM::kernelName() << " " << m << "x" << n << "x" << k;
+            }
+
+        // Backward: the product of the transposes, scaled by tanh'(Z).
+        std::vector<double> D(n * m, NAN), Rt(n * m, 0.0);
+        auto Zt = randomBuffer(n * m, 11);
+        GEMM::gemmActivationDeriv(true, true, n, m, k, B.data(), n, A.data(), k, f, Zt.data(), m, D.data(), m);
+        referenceGemm(true, true, n, m, k, 1.0, B.data(), n, A.data(), k, 0.0, Rt.data(), m);
+        for (int i = 0; i < n * m; ++i) {
+            double t = std::tanh(Zt[i]);
+            ASSERT_NEAR(D[i], Rt[i] * (1 - t * t), 1e-10) << GEMM::kernelName() << " " << m << "x" << n << "x" << k;
+        }
+    }
+    ThreadPool::setNumThreads(previous);
+}
+
+TEST_P(GEMMKernelTest, SinglePrecisionMatchesReference) {
+    int previous = ThreadPool::numThreads();
+    ThreadPool::setNumThreads(4);
+    auto f = Activation::bufferFunction("Sigmoid");
+    const int shapes[][3] = {{1,70,129},{5,37,64},{33,47,29},{97,25,300},{130,70,257}};
+    for (auto& s : shapes) {
+        int m = s[0], n = s[1], k = s[2];
+        for (int tA = 0; tA < 2; ++tA)
+            for (int tB = 0; tB < 2; ++tB) {
+                int lda = (tA ? m : k) + 3, ldb = (tB ? k : n) + 1, ldc = n + 2;
+                auto A = randomBuffer((tA ? k : m) * lda, 1);
+                auto B = randomBuffer((tB ? n : k) * ldb, 2);
+                auto C = randomBuffer(m * ldc, 3);
+                auto R = C;
+                std::vector<float> Af(A.begin(), A.end()), Bf(B.begin(), B.end()), Cf(C.begin(), C.end());
+                GEMM::gemm(tA, tB, m, n, k, 0.5f, Af.data(), lda, Bf.data(), ldb, -2.0f, Cf.data(), ldc);
+                referenceGemm(tA, tB, m, n, k, 0.5, A.data(), lda, B.data(), ldb, -2.0, R.data(), ldc);
+                for (int i = 0; i < m; ++i)
+                    for (int j = 0; j < n; ++j)
+                        ASSERT_NEAR(Cf[i*ldc + j], R[i*ldc + j], 1e-5 * k)
+                            << GEMM::kernelName() << " " << m << "x" << n << "x" << k
+                            << " tA=" << tA << " tB=" << tB << " at (" << i << "," << j << ")";
+            }
+
+        // Fused epilogues, with the activation evaluated in double.
+        int ld = n + 3;
+        auto A = randomBuffer(m * k, 8);
+        auto B = randomBuffer(k * n, 9);
+        auto bias = randomBuffer(n, 10);
+        std::vector<float> Af(A.begin(), A.end()), Bf(B.begin(), B.end()), biasf(bias.begin(), bias.end());
+        std::vector<float> Z(m * ld), Act(m * ld);
+        std::vector<double> R(m * ld, 0.0);
+        GEMM::gemmBiasActivation(false, false, m, n, k, Af.data(), k, Bf.data(), n, biasf.data(), f, Z.data(), ld, Act.data(), ld);
+        referenceGemm(false, false, m, n, k, 1.0, A.data(), k, B.data(), n, 0.0, R.data(), ld);
+        for (int i = 0; i < m; ++i)
+            for (int j = 0; j < n; ++j) {
+                double z = R[i*ld + j] + bias[j];
+                ASSERT_NEAR(Z[i*ld + j], z, 1e-5 * k) << GEMM::kernelName() << " " << m << "x" << n << "x" << k;
+                ASSERT_NEAR(Act[i*ld + j], 1 / (1 + std::exp(-z)), 1e-5 * k) << GEMM::kernelName() << " " << m << "x" << n << "x" << k;
+            }
+    }
+    ThreadPool::setNumThreads(previous);
+}
+
+TEST_P(GEMMKernelTest, Int8SumsExactly) {
+    int previous = ThreadPool::numThreads();
+    ThreadPool::setNumThreads(4);
+    std::mt19937 gen(12);
+    std::uniform_int_distribution<int> byte(0, 255), weight(-128, 127);
+    // Depths that are not a multiple of four and widths on both sides of every tile; the last shape runs in parallel.
+    const int shapes[][3] = {{1,1,1},{3,7,5},{5,16,64},{4,70,129},{9,100,33},{130,65,300}};
+    for (auto& s : shapes) {
+        int m = s[0], n = s[1], k = s[2];
+        int lda = (k + 3) / 4 * 4 + 4, ldb = n + 1, ldc = n + 2;
+        std::vector<uint8_t> A(m * lda);
+        std::vector<int8_t> B(k * ldb), Bp(GEMM::packedInt8Size(k, n));
+        for (auto& a : A) a = byte(gen); // Including the bytes past k, which the packed zeros must cancel.
+        for (auto& b : B) b = weight(gen);
+        auto scale = randomBuffer(n, 4), offset = randomBuffer(n, 5);
+        std::vector<double> C(m * ldc, -7.0);
+        GEMM::packInt8(k, n, B.data(), ldb, Bp.data());
+        GEMM::gemmInt8(m, n, k, A.data(), lda, Bp.data(), scale.data(), offset.data(), C.data(), ldc);
+        for (int i = 0; i < m; ++i) {
+            for (int j = 0; j < n; ++j) {
+                long sum = 0;
+                for (int p = 0; p < k; ++p) sum += A[i*lda + p] * B[p*ldb + j];
+                ASSERT_NEAR(C[i*ldc + j], sum * scale[j] + offset[j], 1e-9 * (std::abs(sum) + 1))
+                    << GEMM::kernelName() << " " << m << "x" << n << "x" << k << " at (" << i << "," << j << ")";
+            }
+            for (int j = n; j < ldc; ++j) ASSERT_EQ(C[i*ldc + j], -7.0);
+        }
+    }
+    ThreadPool::setNumThreads(previous);
+}
+
+INSTANTIATE_TEST_SUITE_P(Kernels, GEMMKernelTest,
+    ::testing::Values(GEMM::Scalar, GEMM::AVX2, GEMM::AVX512));
+
+TEST(GEMMLinAlg, TransposedProductsMatchExplicitTranspose) {
+    LinAlg alg;
+    std::vector<std::vector<double>> A(30, std::vector<double>(20)), B(30, std::vector<double>(25));
+    auto a = randomBuffer(600, 6), b = randomBuffer(750, 7);
+    for (int i = 0; i < 30; ++i) {
+        for (int j = 0; j < 20; ++j) A[i][j] = a[i*20 + j];
+        for (int j = 0; j < 25; ++j) B[i][j] = b[i*25 + j];
+    }
+    auto AtB = alg.transposeMatmult(A, B);
+    auto ref = alg.matmult(alg.transpose(A), B);
+    auto BBt = alg.matmultTranspose(B, B);
+    auto ref2 = alg.matmult(B, alg.transpose(B));
+    ASSERT_EQ(AtB.size(), 20u);
+    ASSERT_EQ(BBt.size(), 30u);
+    for (int i = 0; i < 20; ++i)
+        for (int j = 0; j < 25; ++j) EXPECT_NEAR(AtB[i][j], ref[i][j], 1e-10);
+    for (int i = 0; i < 30; ++i)
+        for (int j = 0; j < 30; ++j) EXPECT_NEAR(BBt[i][j], ref2[i][j], 1e-10);
+}
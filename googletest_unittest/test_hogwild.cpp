@@ -0,0 +1,128 @@
+// test_hogwild.cpp
+
+#include <gtest/gtest.h>
+#include <atomic>
+#include <random>
+#include <vector>
+#include "Hogwild/Hogwild.hpp"
+#include "ThreadPool/ThreadPool.hpp"
+#include "LogReg/LogReg.hpp"
+#include "SoftmaxReg/SoftmaxReg.hpp"
+#include "SVC/SVC.hpp"
+#include "ANN/ANN.hpp"
+
+using namespace MLPP;
+
+class HogwildTest : public ::testing::Test {
+protected:
+    void SetUp() override { previous = ThreadPool::numThreads(); ThreadPool::setNumThreads(4); }
+    void TearDown() override { ThreadPool::setNumThreads(previous); }
+    int previous = 1;
+};
+
+// Wide, sparse binary data: each row has a handful of nonzero features, and the label follows a fixed
+// weight vector through them.
+static void sparseRows(int n, int k, std::vector<std::vector<double>>& X, std::vector<double>& y) {
+    std::mt19937 gen(5);
+    std::uniform_int_distribution<int> feature(0, k - 1);
+    std::normal_distribution<double> dist(0.0, 1.0);
+    std::vector<double> truth(k);
+    for (auto& w : truth) w = dist(gen);
+    X.assign(n, std::vector<double>(k, 0));
+    y.assign(n, 0);
+    for (int i = 0; i < n; ++i) {
+        double z = 0;
+        for (int j = 0; j < 6; ++j) {
+            int f = feature(gen);
+            X[i][f] = 1;
+        }
+        for (int f = 0; f < k; ++f) z += truth[f] * X[i][f];
+        y[i] = z > 0;
+    }
+}
+
+TEST_F(HogwildTest, RunDealsEveryUpdateOnce) {
+    std::vector<std::atomic<int>> seen(1000);
+    std::atomic<int> badIndex{0};
+    auto report = Hogwild::run(3, 1000, 17, [&](int worker, long update, int i) {
+        if (update % 3 != worker) badIndex++;
+        if (i < 0 || i >= 17) badIndex++;
+        seen[update]++;
+    });
+    EXPECT_EQ(report.threads, 3);
+    EXPECT_EQ(report.updates, 1000);
+    EXPECT_EQ(badIndex, 0);
+    for (auto& s : seen) EXPECT_EQ(s, 1);
+}
+
+TEST_F(HogwildTest, RunSkipsAnEmptyTrainingSet) {
+    int steps = 0;
+    auto report = Hogwild::run(2, 100, 0, [&](int, long, int) { steps++; });
+    EXPECT_EQ(steps, 0);
+    EXPECT_EQ(report.updates, 0);
+}
+
+TEST_F(HogwildTest, SingleThreadIsReproducible) {
+    std::vector<std::vector<double>> X;
+    std::vector<double> y;
+    sparseRows(300, 40, X, y);
+
+    LogReg a(X, y, "Ridge", 0.001);
+    LogReg b = a;
+    a.asyncSGD(0.1, 3000, 1, false);
+    b.asyncSGD(0.1, 3000, 1, false);
+    EXPECT_EQ(a.getWeights(), b.getWeights());
+    EXPECT_EQ(a.getBias(), b.getBias());
+
+    std::vector<double> s(y.size());
+    for (int i = 0; i < y.size(); ++i) s[i] = y[i] ? 1 : -1;
+    SVC c(X, s, 1), d = c;
+    c.asyncSGD(0.01, 3000, 1, false);
+    d.asyncSGD(0.01, 3000, 1, false);
+    EXPECT_EQ(c.modelSetTest(X), d.modelSetTest(X));
+}
+
+TEST_F(HogwildTest, LogRegConvergesOnSparseRows) {
+    std::vector<std::vector<double>> X;
+    std::vector<double> y;
+    sparseRows(2000, 200, X, y);
+    LogReg model(X, y);
+    auto report = model.asyncSGD(0.5, 100000, 4, false);
+    EXPECT_EQ(report.threads, 4);
+    EXPECT_LT(report.costAfter, report.costBefore);
+    EXPECT_GT(report.updatesPerSecond, 0);
+    EXPECT_GE(model.score(), 0.9);
+}
+
+TEST_F(HogwildTest, SoftmaxRegSeparatesClasses) {
+    std::mt19937 gen(9);
+    std::normal_distribution<double> dist(0.0, 1.0);
+    std::vector<std::vector<double>> X(300, std::vector<double>(3)), Y(300, std::vector<double>(3, 0));
+    for (int i = 0; i < 300; ++i) {
+        Y[i][i % 3] = 1;
+        for (int j = 0; j < 3; ++j) X[i][j] = dist(gen) + (j == i % 3 ? 4 : 0);
+    }
+    SoftmaxReg model(X, Y);
+    auto report = model.asyncSGD(0.05, 20000, 4, false);
+    EXPECT_LT(report.costAfter, report.costBefore);
+    EXPECT_GE(model.score(), 0.9);
+}
+
+TEST_F(HogwildTest, ANNSeparatesBlobs) {
+    std::mt19937 gen(7);
+    std::normal_distribution<double> dist(0.0, 1.0);
+    std::vector<std::vector<double>> X(200, std::vector<double>(4));
+    std::vector<double> y(200);
+    for (int i = 0; i < 200; ++i) {
+        y[i] = i % 2;
+        for (auto& x : X[i]) x = dist(gen) + (y[i] ? 2.0 : -2.0);
+    }
+    ANN ann(X, y);
+    ann.addLayer(6, "RELU");
+    ann.addOutputLayer("Sigmoid", "LogLoss");
+    ann.setThreads(4);
+    auto report = ann.asyncSGD(2, 20000, false);
+    EXPECT_EQ(report.threads, 4);
+    EXPECT_LT(report.costAfter, report.costBefore);
+    EXPECT_GE(ann.score(), 0.95);
+}
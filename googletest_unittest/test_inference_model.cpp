@@ -0,0 +1,211 @@
+// test_inference_model.cpp
+
+#include <gtest/gtest.h>
+#include <algorithm>
+#include <cmath>
+#include <random>
+#include <thread>
+#include <vector>
+#include "InferenceModel/InferenceModel.hpp"
+#include "ANN/ANN.hpp"
+#include "MANN/MANN.hpp"
+#include "MLP/MLP.hpp"
+#include "SoftmaxNet/SoftmaxNet.hpp"
+#include "Utilities/Utilities.hpp"
+
+using namespace MLPP;
+
+static std::vector<std::vector<double>> gaussian(int n, int d, unsigned seed) {
+    std::mt19937 gen(seed);
+    std::normal_distribution<double> dist(0.0, 1.0);
+    std::vector<std::vector<double>> X(n, std::vector<double>(d));
+    for (auto& row : X)
+        for (auto& x : row) x = dist(gen);
+    return X;
+}
+
+TEST(InferenceModel, MatchesANNPredictions) {
+    auto X = gaussian(50, 6, 1);
+    std::vector<double> y(50);
+    for (int i = 0; i < 50; ++i) y[i] = X[i][0] > 0;
+    ANN ann(X, y);
+    ann.addLayer(40, "Tanh");
+    ann.addLayer(9, "Sigmoid");
+    ann.addOutputLayer("Sigmoid", "LogLoss");
+    ann.MBGD(0.1, 5, 10, false);
+    InferenceModel model = ann.compile();
+    EXPECT_EQ(model.inputs(), 6);
+    EXPECT_EQ(model.outputs(), 1);
+    EXPECT_EQ(model.numLayers(), 3);
+
+    auto expected = ann.modelSetTest(X);
+    auto batch = model.predict(X);
+    for (int i = 0; i < X.size(); ++i) {
+        EXPECT_NEAR(batch[i][0], expected[i], 1e-12);
+        // A single sample goes through the unpacked path of GEMM, which has to give the same answer.
+        EXPECT_NEAR(model.predict(X[i])[0], expected[i], 1e-12);
+    }
+
+    // Training afterwards leaves the compiled copy alone.
+    ann.MBGD(0.1, 5, 10, false);
+    EXPECT_EQ(model.predict(X), batch);
+}
+
+TEST(InferenceModel, SinglePrecisionStaysClose) {
+    auto X = gaussian(50, 6, 4);
+    std::vector<std::vector<double>> Y(50, std::vector<double>(3, 0));
+    for (int i = 0; i < 50; ++i) Y[i][i % 3] = 1;
+    MANN mann(X, Y);
+    mann.addLayer(40, "Tanh");
+    mann.addLayer(20, "RELU");
+    mann.addOutputLayer("Softmax", "CrossEntropy");
+    InferenceModel model = mann.compile("Single");
+    EXPECT_TRUE(model.singlePrecision());
+    auto expected = mann.compile().predict(X);
+    auto predicted = model.predict(X);
+    for (int i = 0; i < X.size(); ++i) {
+        for (int j = 0; j < 3; ++j) EXPECT_NEAR(predicted[i][j], expected[i][j], 1e-4);
+        auto one = model.predict(X[i]);
+        for (int j = 0; j < 3; ++j) EXPECT_NEAR(one[j], expected[i][j], 1e-4);
+    }
+}
+
+// Quantization moves individual outputs near a decision boundary, so the checks are on the mean error and accuracy.
+TEST(InferenceModel, Int8KeepsAccuracy) {
+    auto X = gaussian(400, 12, 6);
+    std::vector<double> y(400);
+    for (int i = 0; i < 400; ++i) y[i] = X[i][0] + 0.5 * X[i][1] - X[i][2] > 0;
+    ANN ann(X, y);
+    ann.addLayer(32, "Tanh", "Uniform");
+    ann.addLayer(16, "Sigmoid", "Uniform");
+    ann.addOutputLayer("Sigmoid", "LogLoss", "Uniform");
+    ann.Adam(0.01, 100, 32, 0.9, 0.999, 1e-8, false);
+
+    InferenceModel model = ann.compile("Int8");
+    ASSERT_TRUE(model.quantized());
+    EXPECT_FALSE(ann.compile().quantized());
+    auto expected = ann.modelSetTest(X);
+    auto predicted = model.predict(X);
+    std::vector<double> y_hat(X.size());
+    double error = 0;
+    for (int i = 0; i < X.size(); ++i) {
+        y_hat[i] = predicted[i][0];
+        error += std::abs(y_hat[i] - expected[i]) / X.size();
+        EXPECT_EQ(model.predict(X[i])[0], y_hat[i]);
+    }
+    EXPECT_LT(error, 0.01);
+    Utilities util;
+    EXPECT_GE(util.performance(y_hat, y), util.performance(expected, y) - 0.05);
+}
+
+TEST(InferenceModel, Int8CompilesMLPAndSoftmaxNet) {
+    auto X = gaussian(120, 5, 7);
+    std::vector<double> y(120);
+    std::vector<std::vector<double>> Y(120, std::vector<double>(3, 0));
+    for (int i = 0; i < 120; ++i) {
+        y[i] = X[i][0] > 0;
+        Y[i][X[i][1] > 0.5 ? 0 : X[i][1] > -0.5 ? 1 : 2] = 1;
+    }
+    Utilities util;
+    MLP mlp(X, y, 8);
+    mlp.gradientDescent(0.1, 50, false);
+    auto expected = mlp.modelSetTest(X);
+    auto predicted = mlp.compile("Int8").predict(X);
+    std::vector<double> y_hat(X.size());
+    double error = 0;
+    for (int i = 0; i < X.size(); ++i) {
+        y_hat[i] = predicted[i][0];
+        error += std::abs(y_hat[i] - expected[i]) / X.size();
+    }
+    EXPECT_LT(error, 0.02);
+    EXPECT_GE(util.performance(y_hat, y), util.performance(expected, y) - 0.05);
+
+    SoftmaxNet net(X, Y, 8);
+    net.gradientDescent(0.1, 50, false);
+    auto expectedY = net.modelSetTest(X);
+    auto predictedY = net.compile("Int8").predict(X);
+    // Gradient descent can leave a large weight in a unit, which coarsens that unit's scale, so a few confident
+    // predictions are allowed to change class.
+    error = 0;
+    int flips = 0;
+    for (int i = 0; i < X.size(); ++i) {
+        double sum = 0;
+        for (int j = 0; j < 3; ++j) {
+            error += std::abs(predictedY[i][j] - expectedY[i][j]) / (3 * X.size());
+            sum += predictedY[i][j];
+        }
+        EXPECT_NEAR(sum, 1, 1e-12);
+        auto before = std::max_element(expectedY[i].begin(), expectedY[i].end());
+        auto after = std::max_element(predictedY[i].begin(), predictedY[i].end());
+        flips += *before > 0.9 && before - expectedY[i].begin() != after - predictedY[i].begin();
+    }
+    EXPECT_LT(error, 0.06);
+    EXPECT_LE(flips, 3);
+}
+
+TEST(InferenceModel, MatchesMANNSoftmax) {
+    auto X = gaussian(40, 5, 2);
+    std::vector<std::vector<double>> Y(40, std::vector<double>(3, 0));
+    for (int i = 0; i < 40; ++i) Y[i][i % 3] = 1;
+    MANN mann(X, Y);
+    mann.addLayer(7, "Sigmoid");
+    mann.addOutputLayer("Softmax", "CrossEntropy");
+    mann.gradientDescent(0.1, 10, false);
+    auto expected = mann.modelSetTest(X);
+    auto predicted = mann.compile().predict(X);
+    for (int i = 0; i < X.size(); ++i) {
+        double sum = 0;
+        for (int j = 0; j < 3; ++j) {
+            EXPECT_NEAR(predicted[i][j], expected[i][j], 1e-12);
+            sum += predicted[i][j];
+        }
+        EXPECT_NEAR(sum, 1, 1e-12);
+    }
+}
+
+TEST(InferenceModel, ConcurrentCallersAgree) {
+    auto X = gaussian(64, 10, 3);
+    std::vector<double> y(64, 1);
+    ANN ann(X, y);
+    ann.addLayer(32, "RELU");
+    ann.addLayer(16, "Tanh");
+    ann.addOutputLayer("Sigmoid", "LogLoss");
+    const InferenceModel model = ann.compile();
+    Matrix batch(X), expected;
+    model.predictBatch(batch, expected);
+
+    std::vector<int> mismatches(8, 0);
+    std::vector<std::thread> threads;
+    for (int t = 0; t < 8; ++t)
+        threads.emplace_back([&, t] {
+            Matrix out, one(1, 10);
+            for (int it = 0; it < 200; ++it) {
+                int i = (it * 7 + t) % 64;
+                for (int j = 0; j < 10; ++j) one(0, j) = X[i][j];
+                model.predictBatch(it % 2 ? one : batch, out);
+                double got = it % 2 ? out(0, 0) : out(i, 0);
+                if (std::abs(got - expected(i, 0)) > 1e-12) mismatches[t]++;
+            }
+        });
+    for (auto& thread : threads) thread.join();
+    for (int t = 0; t < 8; ++t) EXPECT_EQ(mismatches[t], 0) << "thread " << t;
+}
+
+TEST(InferenceModel, RejectsMismatchedLayers) {
+    InferenceModel model;
+    model.addLayer({{1, 2}, {3, 4}, {5, 6}}, {0, 0}, Activation::Function::Linear);
+    model.addLayer({{1}, {2}, {3}}, {0}, Activation::Function::Linear); // Three inputs after two units.
+    EXPECT_EQ(model.numLayers(), 1);
+    EXPECT_EQ(model.predict(std::vector<double>{1, 1, 1}), (std::vector<double>{9, 12}));
+}
+
+TEST(InferenceModel, RejectsSamplesOfTheWrongWidth) {
+    InferenceModel model;
+    model.addLayer({{1, 2}, {3, 4}, {5, 6}}, {0, 0}, Activation::Function::Linear);
+    Matrix out(4, 2);
+    out.fill(7);
+    model.predictBatch(Matrix(std::vector<std::vector<double>>{{1, 1}, {2, 2}}), out);
+    EXPECT_EQ(out.rows(), 0);
+    EXPECT_TRUE(model.predict(std::vector<double>{1, 1}).empty());
+    EXPECT_TRUE(model.predict(std::vector<std::vector<double>>{{1, 1}}).empty());
+}
@@ -144,14 +144,15 @@ TEST(LinAlgAdvanced, PseudoinverseSquareEqualsInverse) {
     expectMatrixNear(Aplus, expected);
 }
 
-TEST(LinAlgAdvanced, PseudoinverseWideMatrixIsnan) {
+TEST(LinAlgAdvanced, PseudoinverseWideMatrix) {
     std::vector<std::vector<double>> A{{1.0, 2.0, 3.0}};  // 1×3
+    // AᵀA is singular, but the SVD-based pseudoinverse is Aᵀ / ||A||² = [1,2,3]ᵀ / 14
     auto Aplus = LinAlg().pinverse(A);
     ASSERT_EQ(Aplus.size(), 3u);
     ASSERT_EQ(Aplus[0].size(), 1u);
     for (size_t i = 0; i < 3; ++i) {
-        EXPECT_TRUE(std::isnan(Aplus[i][0]))
-            << "Expected NaN at row " << i;
+        EXPECT_NEAR(Aplus[i][0], (i + 1) / 14.0, EPS)
+            << "Row " << i;
     }
 }
 
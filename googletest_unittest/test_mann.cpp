@@ -0,0 +1,55 @@
+// test_mann.cpp
+
+#include <gtest/gtest.h>
+#include <random>
+#include <vector>
+#include "MANN/MANN.hpp"
+#include "ThreadPool/ThreadPool.hpp"
+
+using namespace MLPP;
+
+// Three Gaussian blobs with one-hot labels, blob c centred at gap * e_c.
+static void blobs(int n, std::vector<std::vector<double>>& X, std::vector<std::vector<double>>& Y, double gap) {
+    std::mt19937 gen(11);
+    std::normal_distribution<double> dist(0.0, 1.0);
+    X.assign(n, std::vector<double>(3));
+    Y.assign(n, std::vector<double>(3, 0));
+    for (int i = 0; i < n; ++i) {
+        int c = i % 3;
+        Y[i][c] = 1;
+        for (int j = 0; j < 3; ++j) X[i][j] = dist(gen) + (j == c ? gap : 0);
+    }
+}
+
+TEST(MANN, ShardedGradientsReachTheSameOptimum) {
+    // Softmax regression on overlapping blobs is convex in the predicted probabilities, so runs with different
+    // shard counts and random starts have to land on the same model.
+    int previous = ThreadPool::numThreads();
+    ThreadPool::setNumThreads(4);
+    std::vector<std::vector<double>> X, Y;
+    blobs(151, X, Y, 1.0);
+
+    std::vector<std::vector<std::vector<double>>> y_hat;
+    for (int threads : {1, 4}) {
+        MANN mann(X, Y);
+        mann.addOutputLayer("Softmax", "CrossEntropy");
+        mann.setThreads(threads);
+        mann.gradientDescent(1.0, 2000, false);
+        y_hat.push_back(mann.modelSetTest(X));
+    }
+    for (int i = 0; i < X.size(); ++i)
+        for (int j = 0; j < 3; ++j) EXPECT_NEAR(y_hat[1][i][j], y_hat[0][i][j], 1e-6);
+    ThreadPool::setNumThreads(previous);
+}
+
+TEST(MANN, ShardedHiddenLayersSeparateBlobs) {
+    std::vector<std::vector<double>> X, Y;
+    blobs(150, X, Y, 4.0);
+    MANN mann(X, Y);
+    mann.addLayer(8, "RELU");
+    mann.addLayer(5, "RELU");
+    mann.addOutputLayer("Softmax", "CrossEntropy");
+    mann.setThreads(4);
+    mann.gradientDescent(0.1, 300, false);
+    EXPECT_GE(mann.score(), 0.95);
+}
@@ -0,0 +1,114 @@
+// test_matrix.cpp
+
+#include <gtest/gtest.h>
+#include <cmath>
+#include <vector>
+#include "Matrix/Matrix.hpp"
+#include "LinAlg/LinAlg.hpp"
+
+using namespace MLPP;
+static constexpr double EPS = 1e-9;
+
+// --- Storage ---
+TEST(MatrixBasic, RoundTripNested) {
+    std::vector<std::vector<double>> A{{1,2,3},{4,5,6}};
+    Matrix M(A);
+    EXPECT_EQ(M.rows(), 2);
+    EXPECT_EQ(M.cols(), 3);
+    EXPECT_TRUE(M.contiguous());
+    EXPECT_DOUBLE_EQ(M(1,2), 6.0);
+    EXPECT_EQ(M.toStdVector(), A);
+}
+
+TEST(MatrixBasic, PaddedStride) {
+    Matrix M(2, 3, 8, 1.0);
+    EXPECT_EQ(M.stride(), 8);
+    EXPECT_FALSE(M.contiguous());
+    M(1,0) = 7;
+    EXPECT_DOUBLE_EQ(M.data()[8], 7.0);
+    EXPECT_EQ(M.toStdVector(), (std::vector<std::vector<double>>{{1,1,1},{7,1,1}}));
+}
+
+TEST(MatrixBasic, ResizeKeepsAllocation) {
+    Matrix M(4, 4);
+    const double* before = M.data();
+    M.resize(2, 8);
+    EXPECT_EQ(M.data(), before);
+    M.resize(3, 3);
+    EXPECT_EQ(M.data(), before);
+}
+
+TEST(MatrixBasic, ResizeToTheSameShapeKeepsStride) {
+    Matrix M(2, 3, 8, 1.0);
+    M(1,0) = 7;
+    M.resize(2, 3);
+    EXPECT_EQ(M.stride(), 8);
+    EXPECT_DOUBLE_EQ(M(1,0), 7.0);
+    M.resize(3, 2);
+    EXPECT_TRUE(M.contiguous());
+}
+
+TEST(VectorBasic, MoveInAndOut) {
+    std::vector<double> a{1,2,3};
+    const double* p = a.data();
+    Vector v(std::move(a));
+    EXPECT_EQ(v.data(), p);
+    std::vector<double> b = v.release();
+    EXPECT_EQ(b.data(), p);
+}
+
+// --- LinAlg overloads ---
+TEST(MatrixLinAlg, MatchesNestedResults) {
+    LinAlg alg;
+    std::vector<std::vector<double>> A{{1,2,3},{4,5,6}};
+    std::vector<std::vector<double>> B{{7,8},{9,10},{11,12}};
+    std::vector<std::vector<double>> D{{0.5,-1,2},{3,0.25,-6}};
+
+    Matrix C;
+    alg.matmult(Matrix(A), Matrix(B), C);
+    EXPECT_EQ(C.toStdVector(), alg.matmult(A, B));
+
+    alg.addition(Matrix(A), Matrix(D), C);
+    EXPECT_EQ(C.toStdVector(), alg.addition(A, D));
+
+    alg.hadamard_product(Matrix(A), Matrix(D), C);
+    EXPECT_EQ(C.toStdVector(), alg.hadamard_product(A, D));
+
+    alg.transpose(Matrix(A), C);
+    EXPECT_EQ(C.toStdVector(), alg.transpose(A));
+
+    alg.mat_vec_add(Matrix(A), Vector(std::vector<double>{1,1,1}), C);
+    EXPECT_EQ(C.toStdVector(), alg.mat_vec_add(A, {1,1,1}));
+}
+
+TEST(MatrixLinAlg, InPlaceElementWise) {
+    LinAlg alg;
+    Matrix A(std::vector<std::vector<double>>{{1,4},{9,16}});
+    alg.sqrt(A, A);
+    alg.scalarMultiply(2, A, A);
+    alg.scalarAdd(-1, A, A);
+    EXPECT_EQ(A.toStdVector(), (std::vector<std::vector<double>>{{1,3},{5,7}}));
+    EXPECT_NEAR(alg.sum_elements(A), 16.0, EPS);
+}
+
+TEST(MatrixLinAlg, PaddedInputsIgnorePadding) {
+    LinAlg alg;
+    Matrix A(2, 2, 4, 1.0);
+    A.data()[2] = A.data()[3] = A.data()[6] = A.data()[7] = NAN; // padding
+    Matrix C;
+    alg.matmult(A, A, C);
+    EXPECT_EQ(C.toStdVector(), (std::vector<std::vector<double>>{{2,2},{2,2}}));
+    EXPECT_NEAR(alg.norm_2(A), 2.0, EPS);
+}
+
+TEST(VectorLinAlg, MatVecAndDot) {
+    LinAlg alg;
+    Matrix A(std::vector<std::vector<double>>{{1,2},{3,4}});
+    Vector x(std::vector<double>{1,-1}), y;
+    alg.mat_vec_mult(A, x, y);
+    EXPECT_EQ(y.toStdVector(), (std::vector<double>{-1,-1}));
+    EXPECT_NEAR(alg.dot(x, y), 0.0, EPS);
+    Matrix O;
+    alg.outerProduct(x, y, O);
+    EXPECT_EQ(O.toStdVector(), alg.outerProduct({1,-1}, {-1,-1}));
+}
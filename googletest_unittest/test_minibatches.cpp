@@ -0,0 +1,130 @@
+// test_minibatches.cpp
+
+#include <gtest/gtest.h>
+#include <algorithm>
+#include <random>
+#include <vector>
+#include "MiniBatches/MiniBatches.hpp"
+#include "Data/Data.hpp"
+#include "ANN/ANN.hpp"
+#include "LogReg/LogReg.hpp"
+#include "Optimizer/Optimizer.hpp"
+
+using namespace MLPP;
+
+// Two blobs on either side of x0 = x1.
+static void blobs(int n, unsigned seed, std::vector<std::vector<double>>& X, std::vector<double>& y) {
+    std::mt19937 gen(seed);
+    std::normal_distribution<double> dist(0.0, 1.0);
+    X.assign(n, std::vector<double>(3));
+    y.resize(n);
+    for (int i = 0; i < n; ++i) {
+        for (auto& x : X[i]) x = dist(gen);
+        y[i] = X[i][0] - X[i][1] > 0;
+    }
+}
+
+TEST(MiniBatches, RangesMatchCreateMiniBatches) {
+    MiniBatches batches(23, 4);
+    ASSERT_EQ(batches.size(), 4);
+    EXPECT_TRUE(batches.inOrder());
+    EXPECT_EQ(batches.first(3), 15);
+    EXPECT_EQ(batches.rows(0), 5);
+    EXPECT_EQ(batches.rows(3), 8);
+    for (int i = 0; i < 23; ++i) EXPECT_EQ(batches.indices(0)[i], i);
+
+    EXPECT_EQ(MiniBatches(5, 10).size(), 5);
+    EXPECT_EQ(MiniBatches(5, 0).size(), 1);
+    EXPECT_EQ(MiniBatches(0, 3).size(), 0);
+}
+
+TEST(MiniBatches, ShuffleIsAPermutation) {
+    std::default_random_engine generator(3);
+    MiniBatches batches(100, 7);
+    std::vector<int> previous;
+    for (int epoch = 0; epoch < 3; ++epoch) {
+        batches.shuffle(generator);
+        EXPECT_FALSE(batches.inOrder());
+        std::vector<int> order(batches.indices(0), batches.indices(0) + 100);
+        EXPECT_NE(order, previous);
+        previous = order;
+        std::sort(order.begin(), order.end());
+        for (int i = 0; i < 100; ++i) ASSERT_EQ(order[i], i);
+    }
+}
+
+TEST(MiniBatches, GatherCopiesTheListedRows) {
+    Matrix source(5, 2);
+    for (int i = 0; i < 5; ++i) {
+        source(i, 0) = i;
+        source(i, 1) = 10 * i;
+    }
+    std::vector<double> targets = {0, 1, 2, 3, 4};
+    int rows[] = {4, 1, 3};
+    Matrix scratch;
+    std::vector<double> batchTargets;
+    MiniBatches::gather(source, rows, 3, scratch);
+    MiniBatches::gather(targets, rows, 3, batchTargets);
+    ASSERT_EQ(scratch.rows(), 3);
+    for (int i = 0; i < 3; ++i) {
+        EXPECT_EQ(scratch(i, 0), rows[i]);
+        EXPECT_EQ(scratch(i, 1), 10 * rows[i]);
+        EXPECT_EQ(batchTargets[i], rows[i]);
+    }
+}
+
+TEST(MiniBatches, TrainTestSplitKeepsRowsPaired) {
+    std::vector<std::vector<double>> X(50), Y(50);
+    for (int i = 0; i < 50; ++i) {
+        X[i] = {double(i), -double(i)};
+        Y[i] = {double(i)};
+    }
+    Data data;
+    auto [inputTrain, outputTrain, inputTest, outputTest] = data.trainTestSplit(X, Y, 0.3);
+    ASSERT_EQ(inputTest.size(), 15u);
+    ASSERT_EQ(outputTest.size(), 15u);
+    ASSERT_EQ(inputTrain.size(), 35u);
+    ASSERT_EQ(outputTrain.size(), 35u);
+    std::vector<int> seen;
+    for (int i = 0; i < 15; ++i) {
+        EXPECT_EQ(inputTest[i][0], outputTest[i][0]);
+        seen.push_back(outputTest[i][0]);
+    }
+    for (int i = 0; i < 35; ++i) {
+        EXPECT_EQ(inputTrain[i][0], outputTrain[i][0]);
+        seen.push_back(outputTrain[i][0]);
+    }
+    std::sort(seen.begin(), seen.end());
+    for (int i = 0; i < 50; ++i) EXPECT_EQ(seen[i], i);
+}
+
+TEST(MiniBatches, ANNTrainsOnShuffledBatches) {
+    std::vector<std::vector<double>> X;
+    std::vector<double> y;
+    blobs(200, 5, X, y);
+    ANN model(X, y);
+    model.addLayer(6, "Tanh", "Uniform");
+    model.addOutputLayer("Sigmoid", "LogLoss", "Uniform");
+    model.setShuffle(true);
+    GradientDescentOptimizer optimizer;
+    model.train(optimizer, 0.5, 200, 16, false);
+    EXPECT_GT(model.score(), 0.95);
+}
+
+TEST(MiniBatches, LogRegTrainsOnShuffledBatches) {
+    std::vector<std::vector<double>> X;
+    std::vector<double> y;
+    blobs(300, 8, X, y);
+    LogReg ordered(X, y), shuffled(X, y);
+    shuffled.setShuffle(true);
+    ordered.MBGD(0.1, 200, 10, false);
+    shuffled.MBGD(0.1, 200, 10, false);
+    EXPECT_GT(ordered.score(), 0.95);
+    EXPECT_GT(shuffled.score(), 0.95);
+
+    LogReg adam(X, y);
+    adam.setShuffle(true);
+    AdamOptimizer optimizer(0.9, 0.999, 1e-8);
+    adam.train(optimizer, 0.05, 50, 16, false);
+    EXPECT_GT(adam.score(), 0.95);
+}
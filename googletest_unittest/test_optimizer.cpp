@@ -0,0 +1,138 @@
+// test_optimizer.cpp
+
+#include <gtest/gtest.h>
+#include <algorithm>
+#include <cmath>
+#include <functional>
+#include <memory>
+#include <random>
+#include <vector>
+#include "Optimizer/Optimizer.hpp"
+#include "VecMath/VecMath.hpp"
+#include "LogReg/LogReg.hpp"
+
+using namespace MLPP;
+
+static std::vector<double> uniform(int n, double lo, double hi, unsigned seed) {
+    std::mt19937 gen(seed);
+    std::uniform_real_distribution<double> dist(lo, hi);
+    std::vector<double> v(n);
+    for (auto& x : v) x = dist(gen);
+    return v;
+}
+
+struct OptimizerCase {
+    const char* name;
+    std::function<std::unique_ptr<Optimizer>()> make;
+    std::function<void(int t, double lr, double& w, double g, double& m, double& v, double& u)> rule;
+};
+
+static const double b1 = 0.9, b2 = 0.999, e = 1e-8;
+
+static const OptimizerCase CASES[] = {
+    {"GradientDescent", [] { return std::unique_ptr<Optimizer>(new GradientDescentOptimizer()); },
+        [](int, double lr, double& w, double g, double&, double&, double&) { w -= lr * g; }},
+    {"Momentum", [] { return std::unique_ptr<Optimizer>(new MomentumOptimizer(0.9, false)); },
+        [](int, double lr, double& w, double g, double&, double& v, double&) { v = 0.9 * v + lr * g; w -= v; }},
+    {"NAG", [] { return std::unique_ptr<Optimizer>(new MomentumOptimizer(0.9, true)); },
+        [](int, double lr, double& w, double g, double&, double& v, double&) { w -= v; v = 0.9 * v + lr * g; w -= v; }},
+    {"Adagrad", [] { return std::unique_ptr<Optimizer>(new AdagradOptimizer(e)); },
+        [](int, double lr, double& w, double g, double&, double& v, double&) { v += g * g; w -= lr * g / (e + std::sqrt(v)); }},
+    {"Adadelta", [] { return std::unique_ptr<Optimizer>(new AdadeltaOptimizer(b1, e)); },
+        [](int, double lr, double& w, double g, double&, double& v, double&) {
+            v = (1 - b1) * v + b1 * g * g;
+            w -= lr * g / (e + std::sqrt(v));
+        }},
+    {"Adam", [] { return std::unique_ptr<Optimizer>(new AdamOptimizer(b1, b2, e)); },
+        [](int t, double lr, double& w, double g, double& m, double& v, double&) {
+            m = b1 * m + (1 - b1) * g;
+            v = b2 * v + (1 - b2) * g * g;
+            w -= lr * (m / (1 - std::pow(b1, t))) / (e + std::sqrt(v / (1 - std::pow(b2, t))));
+        }},
+    {"Adamax", [] { return std::unique_ptr<Optimizer>(new AdamaxOptimizer(b1, b2, e)); },
+        [](int t, double lr, double& w, double g, double& m, double&, double& u) {
+            m = b1 * m + (1 - b1) * g;
+            u = std::max(b2 * u, std::abs(g));
+            w -= lr * (m / (1 - std::pow(b1, t))) / (e + u);
+        }},
+    {"Nadam", [] { return std::unique_ptr<Optimizer>(new NadamOptimizer(b1, b2, e)); },
+        [](int t, double lr, double& w, double g, double& m, double& v, double&) {
+            m = b1 * m + (1 - b1) * g;
+            v = b2 * v + (1 - b2) * g * g;
+            double c1 = 1 / (1 - std::pow(b1, t));
+            w -= lr * (b1 * c1 * m + (1 - b1) * c1 * g) / (e + std::sqrt(v / (1 - std::pow(b2, t))));
+        }},
+    {"AMSGrad", [] { return std::unique_ptr<Optimizer>(new AMSGradOptimizer(b1, b2, e)); },
+        [](int, double lr, double& w, double g, double& m, double& v, double& u) {
+            m = b1 * m + (1 - b1) * g;
+            v = b2 * v + (1 - b2) * g * g;
+            u = std::max(u, v);
+            w -= lr * m / (e + std::sqrt(u));
+        }},
+};
+
+class OptimizerKernelTest : public ::testing::TestWithParam<VecMath::Kernel> {
+protected:
+    void SetUp() override { VecMath::setKernel(GetParam()); }
+    void TearDown() override { VecMath::setKernel(VecMath::Auto); }
+};
+
+TEST_P(OptimizerKernelTest, FusedUpdateMatchesReference) {
+    // Two blocks of odd sizes, so each has a partial register at the end and keeps its own moments.
+    const std::vector<long> sizes{37, 11};
+    for (const auto& c : CASES) {
+        auto optimizer = c.make();
+        optimizer->reset(sizes);
+        std::vector<std::vector<double>> w, wRef, m, v, u;
+        for (int b = 0; b < sizes.size(); ++b) {
+            w.push_back(uniform(sizes[b], -1, 1, b));
+            wRef.push_back(w[b]);
+            m.emplace_back(sizes[b], 0.0);
+            v.emplace_back(sizes[b], 0.0);
+            u.emplace_back(sizes[b], 0.0);
+        }
+        for (int t = 1; t <= 5; ++t) {
+            optimizer->beginStep(t);
+            for (int b = 0; b < sizes.size(); ++b) {
+                auto g = uniform(sizes[b], -2, 2, 100 * t + b);
+                optimizer->update(b, w[b].data(), g.data(), sizes[b], 0.01);
+                for (int i = 0; i < sizes[b]; ++i) c.rule(t, 0.01, wRef[b][i], g[i], m[b][i], v[b][i], u[b][i]);
+            }
+        }
+        for (int b = 0; b < sizes.size(); ++b)
+            for (int i = 0; i < sizes[b]; ++i)
+                ASSERT_NEAR(w[b][i], wRef[b][i], 1e-14) << VecMath::kernelName() << " " << c.name << " block " << b << " [" << i << "]";
+    }
+}
+
+TEST_P(OptimizerKernelTest, ResetClearsMoments) {
+    AdamOptimizer optimizer(b1, b2, e);
+    std::vector<double> w1(9, 1.0), w2(9, 1.0), g = uniform(9, -1, 1, 3);
+    optimizer.reset({9});
+    optimizer.update(0, w1.data(), g.data(), 9, 0.1);
+    optimizer.update(0, w1.data(), g.data(), 9, 0.1);
+    optimizer.reset({9});
+    optimizer.update(0, w2.data(), g.data(), 9, 0.1);
+    optimizer.update(0, w2.data(), g.data(), 9, 0.1);
+    EXPECT_EQ(w1, w2);
+}
+
+INSTANTIATE_TEST_SUITE_P(Kernels, OptimizerKernelTest,
+    ::testing::Values(VecMath::Scalar, VecMath::AVX2, VecMath::AVX512));
+
+TEST(OptimizerLogReg, AnyOptimizerTrainsLogReg) {
+    std::mt19937 gen(4);
+    std::normal_distribution<double> dist(0.0, 1.0);
+    std::vector<std::vector<double>> X(200, std::vector<double>(3));
+    std::vector<double> y(200);
+    for (int i = 0; i < 200; ++i) {
+        y[i] = i % 2;
+        for (auto& x : X[i]) x = dist(gen) + (y[i] ? 1.5 : -1.5);
+    }
+    for (const auto& c : CASES) {
+        LogReg model(X, y);
+        auto optimizer = c.make();
+        model.train(*optimizer, 0.05, 50, 20, false);
+        EXPECT_GE(model.score(), 0.95) << c.name;
+    }
+}
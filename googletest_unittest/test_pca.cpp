@@ -0,0 +1,91 @@
+// test_pca.cpp
+
+#include <gtest/gtest.h>
+#include <cmath>
+#include <random>
+#include <vector>
+#include "PCA/PCA.hpp"
+#include "LinAlg/LinAlg.hpp"
+
+using namespace MLPP;
+
+// features x samples: `rank` latent factors with decreasing weight, a per-feature offset, and optional noise.
+static std::vector<std::vector<double>> lowRankData(int d, int n, int rank, double noise, unsigned seed) {
+    std::mt19937 gen(seed);
+    std::normal_distribution<double> dist(0.0, 1.0);
+    std::vector<std::vector<double>> W(d, std::vector<double>(rank));
+    for (auto& row : W) for (auto& x : row) x = dist(gen);
+    std::vector<std::vector<double>> X(d, std::vector<double>(n));
+    for (int j = 0; j < n; ++j) {
+        std::vector<double> z(rank);
+        for (int q = 0; q < rank; ++q) z[q] = (rank - q) * dist(gen);
+        for (int i = 0; i < d; ++i) {
+            double x = 5.0 + i;
+            for (int q = 0; q < rank; ++q) x += W[i][q] * z[q];
+            X[i][j] = x + noise * dist(gen);
+        }
+    }
+    return X;
+}
+
+static std::vector<std::vector<double>> columns(const std::vector<std::vector<double>>& X, int begin, int end) {
+    std::vector<std::vector<double>> B(X.size());
+    for (int i = 0; i < X.size(); ++i) B[i].assign(X[i].begin() + begin, X[i].begin() + end);
+    return B;
+}
+
+TEST(PCA, PartialFitTracksMeanAndVariance) {
+    auto X = lowRankData(7, 230, 2, 0.5, 1);
+    PCA pca(2);
+    for (int j = 0; j < 230; j += 40) pca.partialFit(columns(X, j, std::min(j + 40, 230)));
+
+    LinAlg alg;
+    auto mean = pca.mean();
+    auto var = pca.variance();
+    for (int i = 0; i < 7; ++i) {
+        double m = 0, v = 0;
+        for (double x : X[i]) m += x;
+        m /= 230;
+        for (double x : X[i]) v += (x - m) * (x - m);
+        EXPECT_NEAR(mean[i], m, 1e-10);
+        EXPECT_NEAR(var[i], v / 229, 1e-9);
+    }
+}
+
+TEST(PCA, PartialFitIsExactForLowRankData) {
+    // Centered data of rank k: truncating to k after every batch loses nothing.
+    auto X = lowRankData(10, 300, 3, 0.0, 2);
+    PCA streamed(3);
+    for (int j = 0; j < 300; j += 25) streamed.partialFit(columns(X, j, j + 25));
+    PCA full(X, 3);
+    auto Zfull = full.principalComponents();
+
+    auto components = streamed.components();
+    ASSERT_EQ(components.size(), 3u);
+    ASSERT_EQ(components[0].size(), 10u);
+    EXPECT_TRUE(streamed.principalComponents().empty());
+    auto fullComponents = full.components();
+    ASSERT_EQ(fullComponents.size(), 3u);
+    ASSERT_EQ(fullComponents[0].size(), 10u);
+    auto Z = streamed.transform(X);
+    for (int q = 0; q < 3; ++q) {
+        // Same projections up to the sign of each direction.
+        double s = Z[q][0] * Zfull[q][0] < 0 ? -1 : 1;
+        for (int j = 0; j < 300; ++j) EXPECT_NEAR(s * Z[q][j], Zfull[q][j], 1e-8);
+    }
+    EXPECT_NEAR(streamed.score(), 1.0, 1e-10);
+    EXPECT_NEAR(full.score(), 1.0, 1e-10);
+}
+
+TEST(PCA, PartialFitApproximatesBatchFitOnNoisyData) {
+    auto X = lowRankData(12, 600, 2, 0.1, 3);
+    PCA streamed(2);
+    for (int j = 0; j < 600; j += 50) streamed.partialFit(columns(X, j, j + 50));
+    PCA full(X, 2);
+    full.principalComponents();
+    EXPECT_NEAR(streamed.score(), full.score(), 1e-3);
+
+    PCA randomized(2, "Randomized");
+    for (int j = 0; j < 600; j += 50) randomized.partialFit(columns(X, j, j + 50));
+    EXPECT_NEAR(randomized.score(), streamed.score(), 1e-6);
+}
@@ -0,0 +1,116 @@
+// test_qr.cpp
+
+#include <gtest/gtest.h>
+#include <cmath>
+#include <random>
+#include <vector>
+#include "QR/QR.hpp"
+#include "LinAlg/LinAlg.hpp"
+
+using namespace MLPP;
+
+static std::vector<std::vector<double>> randomMatrix(int n, int m, unsigned seed) {
+    std::mt19937 gen(seed);
+    std::normal_distribution<double> dist(0.0, 1.0);
+    std::vector<std::vector<double>> A(n, std::vector<double>(m));
+    for (auto& row : A) for (auto& x : row) x = dist(gen);
+    return A;
+}
+
+TEST(QR, FactorsReconstructAndQIsOrthonormal) {
+    LinAlg alg;
+    // 150 x 70 spans several panels; 40 x 90 is wide, with a trapezoidal R.
+    for (auto [m, n] : std::vector<std::pair<int, int>>{{150, 70}, {40, 90}, {5, 5}}) {
+        auto A = randomMatrix(m, n, m + n);
+        QR qr(A);
+        auto Q = qr.Q();
+        auto R = qr.R();
+        int k = std::min(m, n);
+        ASSERT_EQ(Q.size(), (size_t)m);
+        ASSERT_EQ(Q[0].size(), (size_t)k);
+        ASSERT_EQ(R.size(), (size_t)k);
+        for (int i = 0; i < k; ++i)
+            for (int j = 0; j < i; ++j) EXPECT_EQ(R[i][j], 0.0);
+        auto QR_ = alg.matmult(Q, R);
+        for (int i = 0; i < m; ++i)
+            for (int j = 0; j < n; ++j) EXPECT_NEAR(QR_[i][j], A[i][j], 1e-12);
+        auto QtQ = alg.matmult(alg.transpose(Q), Q);
+        for (int i = 0; i < k; ++i)
+            for (int j = 0; j < k; ++j) EXPECT_NEAR(QtQ[i][j], i == j ? 1.0 : 0.0, 1e-13);
+    }
+}
+
+TEST(QR, LeastSquaresResidualIsOrthogonalToColumns) {
+    LinAlg alg;
+    int m = 200, n = 45;
+    auto A = randomMatrix(m, n, 1);
+    auto b = randomMatrix(1, m, 2)[0];
+    QR qr(A);
+    EXPECT_FALSE(qr.rankDeficient());
+    auto x = qr.solve(b);
+    auto r = alg.subtraction(alg.mat_vec_mult(A, x), b);
+    auto Atr = alg.mat_vec_mult(alg.transpose(A), r);
+    for (double v : Atr) EXPECT_NEAR(v, 0.0, 1e-10);
+}
+
+TEST(QR, MultipleRightHandSidesMatchSingleSolves) {
+    int m = 80, n = 20, k = 4;
+    auto A = randomMatrix(m, n, 3);
+    auto B = randomMatrix(m, k, 4);
+    QR qr(A);
+    auto X = qr.solve(B);
+    ASSERT_EQ(X.size(), (size_t)n);
+    for (int c = 0; c < k; ++c) {
+        std::vector<double> b(m);
+        for (int i = 0; i < m; ++i) b[i] = B[i][c];
+        auto x = qr.solve(b);
+        for (int i = 0; i < n; ++i) EXPECT_NEAR(x[i], X[i][c], 1e-12);
+    }
+}
+
+TEST(QR, RankDeficientIsDetected) {
+    std::vector<std::vector<double>> A{{1, 2}, {2, 4}, {3, 6}};
+    QR qr(A);
+    EXPECT_TRUE(qr.rankDeficient());
+    for (double v : qr.solve(std::vector<double>{1, 2, 3})) EXPECT_TRUE(std::isnan(v));
+    EXPECT_TRUE(QR(randomMatrix(3, 5, 5)).rankDeficient());
+}
+
+TEST(QR, LstsqFallsBackToMinimumNorm) {
+    LinAlg alg;
+    // Wide: infinitely many exact solutions, lstsq returns the one with the smallest norm, which lies in the row space.
+    std::vector<std::vector<double>> A{{1, 2, 3}};
+    auto x = alg.lstsq(A, {14});
+    EXPECT_NEAR(x[0], 1.0, 1e-12);
+    EXPECT_NEAR(x[1], 2.0, 1e-12);
+    EXPECT_NEAR(x[2], 3.0, 1e-12);
+
+    // Tall and rank-deficient goes through the same path.
+    std::vector<std::vector<double>> B{{1, 1}, {1, 1}, {1, 1}};
+    auto y = alg.lstsq(B, {2, 2, 2});
+    EXPECT_NEAR(y[0], 1.0, 1e-12);
+    EXPECT_NEAR(y[1], 1.0, 1e-12);
+}
+
+TEST(QR, QRDHasNonNegativeDiagonal) {
+    LinAlg alg;
+    auto A = randomMatrix(6, 4, 6);
+    auto [Q, R] = alg.QRD(A);
+    for (int i = 0; i < 4; ++i) EXPECT_GE(R[i][i], 0.0);
+    auto QR_ = alg.matmult(Q, R);
+    for (int i = 0; i < 6; ++i)
+        for (int j = 0; j < 4; ++j) EXPECT_NEAR(QR_[i][j], A[i][j], 1e-12);
+}
+
+TEST(QR, CholSolveMatchesLU) {
+    LinAlg alg;
+    auto X = randomMatrix(60, 25, 7);
+    auto A = alg.transposeMatmult(X, X);
+    auto b = randomMatrix(1, 25, 8)[0];
+    auto x = alg.cholSolve(A, b);
+    auto y = alg.solve(A, b);
+    for (int i = 0; i < 25; ++i) EXPECT_NEAR(x[i], y[i], 1e-10);
+
+    std::vector<std::vector<double>> indefinite{{1, 2}, {2, 1}};
+    for (double v : alg.cholSolve(indefinite, {1, 1})) EXPECT_TRUE(std::isnan(v));
+}
@@ -0,0 +1,164 @@
+// test_svdsolver.cpp
+
+#include <gtest/gtest.h>
+#include <cmath>
+#include <random>
+#include <vector>
+#include "SVDSolver/SVDSolver.hpp"
+#include "PCA/PCA.hpp"
+#include "LinAlg/LinAlg.hpp"
+
+using namespace MLPP;
+
+static std::vector<std::vector<double>> randomMatrix(int n, int m, unsigned seed) {
+    std::mt19937 gen(seed);
+    std::normal_distribution<double> dist(0.0, 1.0);
+    std::vector<std::vector<double>> A(n, std::vector<double>(m));
+    for (auto& row : A) for (auto& x : row) x = dist(gen);
+    return A;
+}
+
+// A v_i = s_i u_i, orthonormal U columns and Vt rows
+static void expectTriplets(const std::vector<std::vector<double>>& A, const SVDSolver& svd, double tol) {
+    int m = A.size(), n = A[0].size();
+    const Matrix& U = svd.U();
+    const Matrix& Vt = svd.Vt();
+    const Vector& S = svd.singularValues();
+    ASSERT_EQ(U.rows(), m);
+    ASSERT_EQ(Vt.cols(), n);
+    for (int k = 0; k < S.size(); ++k) {
+        if (k > 0) EXPECT_GE(S[k - 1], S[k]);
+        for (int i = 0; i < m; ++i) {
+            double Av = 0;
+            for (int j = 0; j < n; ++j) Av += A[i][j] * Vt(k, j);
+            EXPECT_NEAR(Av, S[k] * U(i, k), tol);
+        }
+        for (int l = 0; l <= k; ++l) {
+            double uu = 0, vv = 0;
+            for (int i = 0; i < m; ++i) uu += U(i, k) * U(i, l);
+            for (int j = 0; j < n; ++j) vv += Vt(k, j) * Vt(l, j);
+            EXPECT_NEAR(uu, k == l ? 1.0 : 0.0, tol);
+            EXPECT_NEAR(vv, k == l ? 1.0 : 0.0, tol);
+        }
+    }
+}
+
+TEST(SVDSolver, KnownSingularValues) {
+    std::vector<std::vector<double>> A{{3, 0}, {0, -2}, {0, 0}};
+    SVDSolver svd(A);
+    ASSERT_EQ(svd.singularValues().size(), 2);
+    EXPECT_NEAR(svd.singularValues()[0], 3.0, 1e-12);
+    EXPECT_NEAR(svd.singularValues()[1], 2.0, 1e-12);
+    expectTriplets(A, svd, 1e-12);
+}
+
+TEST(SVDSolver, TallWideAndSquare) {
+    // 150 x 40 goes through the QR reduction, the others bidiagonalize directly.
+    for (auto [m, n] : std::vector<std::pair<int, int>>{{150, 40}, {50, 40}, {40, 90}, {60, 60}}) {
+        auto A = randomMatrix(m, n, m + n);
+        SVDSolver svd(A);
+        EXPECT_EQ(svd.singularValues().size(), std::min(m, n));
+        expectTriplets(A, svd, 1e-10);
+    }
+}
+
+TEST(SVDSolver, TruncatedRankMatchesFull) {
+    auto A = randomMatrix(80, 50, 4);
+    SVDSolver full(A);
+    SVDSolver top(A, 6);
+    ASSERT_EQ(top.singularValues().size(), 6);
+    ASSERT_EQ(top.U().cols(), 6);
+    ASSERT_EQ(top.Vt().rows(), 6);
+    for (int k = 0; k < 6; ++k) EXPECT_NEAR(top.singularValues()[k], full.singularValues()[k], 1e-10);
+    expectTriplets(A, top, 1e-10);
+}
+
+TEST(SVDSolver, RankDeficientKeepsOrthonormalBases) {
+    LinAlg alg;
+    auto A = alg.matmult(randomMatrix(30, 3, 5), randomMatrix(3, 20, 6));
+    SVDSolver svd(A);
+    for (int k = 3; k < 20; ++k) EXPECT_NEAR(svd.singularValues()[k], 0.0, 1e-10);
+    expectTriplets(A, svd, 1e-10);
+}
+
+TEST(SVDSolver, PCAMatchesCovarianceEigenvectors) {
+    // Rows are features, columns samples.
+    auto X = randomMatrix(6, 200, 7);
+    for (int j = 0; j < 200; ++j) X[1][j] += 3 * X[0][j];
+    LinAlg alg;
+    PCA pca(X, 2);
+    auto Z = pca.principalComponents();
+    ASSERT_EQ(Z.size(), 2u);
+    ASSERT_EQ(Z[0].size(), 200u);
+
+    // The variance of each component equals the matching eigenvalue of the covariance matrix.
+    auto [vectors, values] = alg.eig(alg.cov(X), 2);
+    for (int k = 0; k < 2; ++k) {
+        double var = 0;
+        for (double z : Z[k]) var += z * z;
+        EXPECT_NEAR(var / 199, values[k][k], 1e-8);
+    }
+}
+
+// m x n with singular values 0.7^k, a spectrum that decays like real data.
+static std::vector<std::vector<double>> decayingMatrix(int m, int n, unsigned seed) {
+    int r = std::min(m, n);
+    LinAlg alg;
+    SVDSolver left(randomMatrix(m, r, seed));
+    SVDSolver right(randomMatrix(r, n, seed + 1));
+    std::vector<std::vector<double>> A(m, std::vector<double>(n, 0.0));
+    for (int k = 0; k < r; ++k) {
+        double s = std::pow(0.7, k);
+        for (int i = 0; i < m; ++i)
+            for (int j = 0; j < n; ++j) A[i][j] += s * left.U()(i, k) * right.Vt()(k, j);
+    }
+    return A;
+}
+
+TEST(SVDSolver, RandomizedMatchesExactTopK) {
+    LinAlg alg;
+    for (auto [m, n] : std::vector<std::pair<int, int>>{{60, 300}, {300, 60}}) {
+        auto A = decayingMatrix(m, n, m);
+        SVDSolver exact(A, 5);
+        Matrix U, Vt;
+        Vector S;
+        alg.randomizedSVD(Matrix(A), 5, U, S, Vt);
+        ASSERT_EQ(S.size(), 5);
+        ASSERT_EQ(U.rows(), m);
+        ASSERT_EQ(U.cols(), 5);
+        ASSERT_EQ(Vt.rows(), 5);
+        ASSERT_EQ(Vt.cols(), n);
+        for (int k = 0; k < 5; ++k) {
+            EXPECT_NEAR(S[k], exact.singularValues()[k], 1e-9);
+            // Same singular vectors up to sign.
+            double uu = 0, vv = 0;
+            for (int i = 0; i < m; ++i) uu += U(i, k) * exact.U()(i, k);
+            for (int j = 0; j < n; ++j) vv += Vt(k, j) * exact.Vt()(k, j);
+            EXPECT_NEAR(std::abs(uu), 1.0, 1e-8);
+            EXPECT_NEAR(std::abs(vv), 1.0, 1e-8);
+        }
+    }
+}
+
+TEST(SVDSolver, RandomizedHandlesLowRankInput) {
+    // The sketch is wider than the rank, so some basis rows collapse to zero; the result must stay finite.
+    LinAlg alg;
+    auto A = alg.matmult(randomMatrix(40, 3, 8), randomMatrix(3, 70, 9));
+    auto [U, S, Vt] = alg.randomizedSVD(A, 3);
+    SVDSolver exact(A, 3);
+    for (int k = 0; k < 3; ++k) EXPECT_NEAR(S[k][k], exact.singularValues()[k], 1e-9);
+    for (auto& row : U) for (double x : row) EXPECT_TRUE(std::isfinite(x));
+}
+
+TEST(SVDSolver, RandomizedPCAMatchesExactPCA) {
+    auto X = randomMatrix(8, 300, 10);
+    for (int j = 0; j < 300; ++j) X[1][j] += 3 * X[0][j];
+    auto Zexact = PCA(X, 2).principalComponents();
+    auto Zrand = PCA(X, 2, "Randomized").principalComponents();
+    for (int k = 0; k < 2; ++k) {
+        double ve = 0, vr = 0;
+        for (double z : Zexact[k]) ve += z * z;
+        for (double z : Zrand[k]) vr += z * z;
+        EXPECT_NEAR(vr, ve, 1e-6 * ve);
+    }
+}
@@ -0,0 +1,97 @@
+// test_threadpool.cpp
+
+#include <gtest/gtest.h>
+#include <atomic>
+#include <mutex>
+#include <random>
+#include <set>
+#include <utility>
+#include <vector>
+#include "ThreadPool/ThreadPool.hpp"
+#include "LinAlg/LinAlg.hpp"
+#include "Stat/Stat.hpp"
+
+using namespace MLPP;
+
+class ThreadPoolTest : public ::testing::Test {
+protected:
+    void SetUp() override { previous = ThreadPool::numThreads(); ThreadPool::setNumThreads(4); }
+    void TearDown() override { ThreadPool::setNumThreads(previous); }
+    int previous = 1;
+};
+
+static std::vector<std::vector<double>> randomMatrix(int n, int m, unsigned seed) {
+    std::mt19937 gen(seed);
+    std::normal_distribution<double> dist(0.0, 1.0);
+    std::vector<std::vector<double>> A(n, std::vector<double>(m));
+    for (auto& row : A) for (auto& x : row) x = dist(gen);
+    return A;
+}
+
+// --- Pool ---
+TEST_F(ThreadPoolTest, CoversEveryIndexOnce) {
+    std::vector<std::atomic<int>> hits(1000);
+    ThreadPool::parallelFor(1000, 1, [&](long begin, long end) {
+        for (long i = begin; i < end; ++i) hits[i]++;
+    });
+    for (auto& h : hits) EXPECT_EQ(h.load(), 1);
+}
+
+TEST_F(ThreadPoolTest, PartitionIsDeterministic) {
+    auto chunks = [] {
+        std::mutex m;
+        std::set<std::pair<long, long>> seen;
+        ThreadPool::parallelFor(103, 10, [&](long b, long e) {
+            std::lock_guard<std::mutex> lock(m);
+            seen.insert({b, e});
+        });
+        return seen;
+    };
+    auto first = chunks();
+    EXPECT_EQ(first.size(), 4u);
+    for (int i = 0; i < 5; ++i) EXPECT_EQ(chunks(), first);
+}
+
+TEST_F(ThreadPoolTest, SmallAndNestedCallsRunInline) {
+    int calls = 0;
+    ThreadPool::parallelFor(5, 10, [&](long b, long e) { calls++; EXPECT_EQ(e - b, 5); });
+    EXPECT_EQ(calls, 1);
+
+    std::atomic<int> inner(0);
+    ThreadPool::parallelFor(8, 1, [&](long, long) {
+        ThreadPool::parallelFor(100, 1, [&](long b, long e) { inner += int(e - b); });
+    });
+    EXPECT_EQ(inner.load(), 4 * 100);
+}
+
+// --- Parallel LinAlg ---
+TEST_F(ThreadPoolTest, ParallelKernelsMatchSingleThread) {
+    LinAlg alg;
+    auto A = randomMatrix(300, 200, 1);
+    auto B = randomMatrix(200, 150, 2);
+    std::vector<double> x(200, 0.5);
+
+    auto C4 = alg.matmult(A, B);
+    auto y4 = alg.mat_vec_mult(A, x);
+    auto T4 = alg.transpose(A);
+    ThreadPool::setNumThreads(1);
+    auto C1 = alg.matmult(A, B);
+    auto y1 = alg.mat_vec_mult(A, x);
+    auto T1 = alg.transpose(A);
+
+    for (int i = 0; i < 300; ++i)
+        for (int j = 0; j < 150; ++j) EXPECT_NEAR(C4[i][j], C1[i][j], 1e-10);
+    EXPECT_EQ(y4, y1);
+    EXPECT_EQ(T4, T1);
+}
+
+TEST_F(ThreadPoolTest, CovarianceMatchesPairwiseDefinition) {
+    LinAlg alg;
+    Stat stat;
+    auto A = randomMatrix(40, 500, 3);
+    auto C = alg.cov(A);
+    ASSERT_EQ(C.size(), 40u);
+    for (int i = 0; i < 40; ++i)
+        for (int j = 0; j < 40; ++j)
+            EXPECT_NEAR(C[i][j], stat.covariance(A[i], A[j]), 1e-10);
+}
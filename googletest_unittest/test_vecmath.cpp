@@ -0,0 +1,184 @@
+// test_vecmath.cpp
+
+#include <gtest/gtest.h>
+#include <cmath>
+#include <limits>
+#include <random>
+#include <vector>
+#include "VecMath/VecMath.hpp"
+#include "LinAlg/LinAlg.hpp"
+#include "Activation/Activation.hpp"
+
+using namespace MLPP;
+
+static const double INF = std::numeric_limits<double>::infinity();
+static const double NaN = std::numeric_limits<double>::quiet_NaN();
+static const double ULP = std::numeric_limits<double>::epsilon();
+
+static std::vector<double> uniform(int n, double lo, double hi, unsigned seed) {
+    std::mt19937 gen(seed);
+    std::uniform_real_distribution<double> dist(lo, hi);
+    std::vector<double> v(n);
+    for (auto& x : v) x = dist(gen);
+    return v;
+}
+
+static double sigmoidRef(double x) {
+    double e = std::exp(-std::abs(x));
+    return x >= 0 ? 1 / (1 + e) : e / (1 + e);
+}
+
+static double softplusRef(double x) {
+    return std::max(x, 0.0) + std::log1p(std::exp(-std::abs(x)));
+}
+
+struct UnaryCase {
+    const char* name;
+    void (*f)(const double*, double*, long);
+    double (*ref)(double);
+    double lo, hi;
+    double ulps;
+};
+
+static const UnaryCase UNARY[] = {
+    {"exp", VecMath::exp, [](double x) { return std::exp(x); }, -708, 709, 4},
+    {"log", VecMath::log, [](double x) { return std::log(std::exp(x)); }, -700, 700, 4},
+    {"sqrt", VecMath::sqrt, [](double x) { return std::sqrt(x); }, 0, 1e6, 1},
+    {"erf", VecMath::erf, [](double x) { return std::erf(x); }, -6, 6, 8},
+    {"abs", VecMath::abs, [](double x) { return std::abs(x); }, -10, 10, 0},
+    {"sigmoid", VecMath::sigmoid, sigmoidRef, -40, 40, 8},
+    {"tanh", VecMath::tanh, [](double x) { return std::tanh(x); }, -25, 25, 8},
+    {"softplus", VecMath::softplus, softplusRef, -40, 40, 8},
+    {"swish", VecMath::swish, [](double x) { return x * sigmoidRef(x); }, -40, 40, 8},
+    {"mish", VecMath::mish, [](double x) { return x * std::tanh(softplusRef(x)); }, -30, 30, 16},
+    // Ill-conditioned in the left tail, where the cubic dominates.
+    {"GELU", VecMath::GELU, [](double x) { return x * sigmoidRef(2 * std::sqrt(2 / M_PI) * (x + 0.044715 * x * x * x)); }, -3, 8, 16},
+};
+
+class VecMathKernelTest : public ::testing::TestWithParam<VecMath::Kernel> {
+protected:
+    void SetUp() override { VecMath::setKernel(GetParam()); }
+    void TearDown() override { VecMath::setKernel(VecMath::Auto); }
+};
+
+TEST_P(VecMathKernelTest, UnaryMatchesLibm) {
+    // An odd length leaves a partial register at the end.
+    const int n = 4099;
+    for (const auto& c : UNARY) {
+        auto x = uniform(n, c.lo, c.hi, 1);
+        // log is checked on exp(x) so its input spans the whole exponent range.
+        if (c.f == VecMath::log) for (auto& v : x) v = std::exp(v);
+        std::vector<double> y(n);
+        c.f(x.data(), y.data(), n);
+        for (int i = 0; i < n; ++i) {
+            double r = c.f == VecMath::log ? std::log(x[i]) : c.ref(x[i]);
+            ASSERT_LE(std::abs(y[i] - r), c.ulps * ULP * std::abs(r))
+                << VecMath::kernelName() << " " << c.name << "(" << x[i] << ")";
+        }
+    }
+}
+
+TEST_P(VecMathKernelTest, SpecialValues) {
+    std::vector<double> x{-INF, INF, NaN, 0.0, -0.0, -1000, 1000, 4.9e-324};
+    std::vector<double> y(x.size());
+
+    VecMath::exp(x.data(), y.data(), x.size());
+    EXPECT_EQ(y[0], 0);
+    EXPECT_EQ(y[1], INF);
+    EXPECT_TRUE(std::isnan(y[2]));
+    EXPECT_EQ(y[3], 1);
+    EXPECT_EQ(y[5], 0);
+    EXPECT_EQ(y[6], INF);
+
+    VecMath::log(x.data(), y.data(), x.size());
+    EXPECT_TRUE(std::isnan(y[0]));
+    EXPECT_EQ(y[1], INF);
+    EXPECT_TRUE(std::isnan(y[2]));
+    EXPECT_EQ(y[3], -INF);
+    EXPECT_EQ(y[4], -INF);
+    EXPECT_TRUE(std::isnan(y[5]));
+    EXPECT_NEAR(y[7], std::log(4.9e-324), 1e-12);
+
+    VecMath::sigmoid(x.data(), y.data(), x.size());
+    EXPECT_EQ(y[0], 0);
+    EXPECT_EQ(y[1], 1);
+    EXPECT_TRUE(std::isnan(y[2]));
+    EXPECT_EQ(y[3], 0.5);
+
+    VecMath::tanh(x.data(), y.data(), x.size());
+    EXPECT_EQ(y[0], -1);
+    EXPECT_EQ(y[1], 1);
+    EXPECT_TRUE(std::isnan(y[2]));
+    EXPECT_EQ(y[6], 1);
+
+    VecMath::erf(x.data(), y.data(), x.size());
+    EXPECT_EQ(y[0], -1);
+    EXPECT_EQ(y[1], 1);
+    EXPECT_TRUE(std::isnan(y[2]));
+
+    VecMath::softplus(x.data(), y.data(), x.size());
+    EXPECT_EQ(y[0], 0);
+    EXPECT_EQ(y[1], INF);
+    EXPECT_TRUE(std::isnan(y[2]));
+    EXPECT_EQ(y[6], 1000);
+}
+
+TEST_P(VecMathKernelTest, InPlaceAndShortLengths) {
+    for (int n = 0; n <= 19; ++n) {
+        auto x = uniform(n, -3, 3, n);
+        std::vector<double> y(n + 1, 42.0);
+        VecMath::tanh(x.data(), y.data(), n);
+        EXPECT_EQ(y[n], 42.0) << "wrote past the end at n=" << n;
+        VecMath::tanh(x.data(), x.data(), n);
+        for (int i = 0; i < n; ++i) EXPECT_EQ(x[i], y[i]);
+    }
+}
+
+TEST_P(VecMathKernelTest, ArithmeticIsExact) {
+    const int n = 37;
+    auto a = uniform(n, -5, 5, 2);
+    auto b = uniform(n, -5, 5, 3);
+    std::vector<double> c(n);
+
+    VecMath::hadamard(a.data(), b.data(), c.data(), n);
+    for (int i = 0; i < n; ++i) EXPECT_EQ(c[i], a[i] * b[i]);
+    VecMath::max(a.data(), b.data(), c.data(), n);
+    for (int i = 0; i < n; ++i) EXPECT_EQ(c[i], std::max(a[i], b[i]));
+    VecMath::scale(-1.5, a.data(), c.data(), n);
+    for (int i = 0; i < n; ++i) EXPECT_EQ(c[i], -1.5 * a[i]);
+    VecMath::shift(0.25, a.data(), c.data(), n);
+    for (int i = 0; i < n; ++i) EXPECT_EQ(c[i], 0.25 + a[i]);
+}
+
+INSTANTIATE_TEST_SUITE_P(Kernels, VecMathKernelTest,
+    ::testing::Values(VecMath::Scalar, VecMath::AVX2, VecMath::AVX512));
+
+TEST(VecMathLinAlg, MatrixAndNestedAgree) {
+    LinAlg alg;
+    std::vector<std::vector<double>> A(13, std::vector<double>(21));
+    for (int i = 0; i < 13; ++i) A[i] = uniform(21, -2, 2, 10 + i);
+    Matrix M(A), E;
+    alg.exp(M, E);
+    auto nested = alg.exp(A);
+    for (int i = 0; i < 13; ++i)
+        for (int j = 0; j < 21; ++j) {
+            EXPECT_EQ(E(i, j), nested[i][j]);
+            EXPECT_NEAR(nested[i][j], std::exp(A[i][j]), 4 * ULP * nested[i][j]);
+        }
+}
+
+TEST(VecMathActivation, DerivativesFromForwardPass) {
+    Activation act;
+    auto z = uniform(29, -6, 6, 4);
+    auto ds = act.sigmoid(z, true);
+    auto dt = act.tanh(z, true);
+    for (int i = 0; i < z.size(); ++i) {
+        double s = sigmoidRef(z[i]), t = std::tanh(z[i]);
+        EXPECT_NEAR(ds[i], s * (1 - s), 1e-15);
+        EXPECT_NEAR(dt[i], 1 - t * t, 1e-15);
+    }
+    // No overflow to inf / inf far out in the tails.
+    auto far = act.tanh(std::vector<double>{-800, 800});
+    EXPECT_EQ(far[0], -1);
+    EXPECT_EQ(far[1], 1);
+}